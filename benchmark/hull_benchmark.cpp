@@ -0,0 +1,152 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "box2d/box2d.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Times polygon creation from random point clouds and from points that are already
+// convex, through b2PolygonShape::Set, b2PolygonShape::SetConvex and b2SetPolygons.
+
+static float RandomFloat(float lo, float hi)
+{
+	float r = (float)(rand() & (RAND_MAX));
+	r /= RAND_MAX;
+	return (hi - lo) * r + lo;
+}
+
+const int32 e_polygonCount = 4096;
+
+static b2Vec2 s_points[e_polygonCount * b2_maxPolygonVertices];
+static int32 s_counts[e_polygonCount];
+static b2PolygonShape s_polygons[e_polygonCount];
+
+// Random points in a square. Some points end up inside the hull.
+static void CreateClouds()
+{
+	b2Vec2* points = s_points;
+	for (int32 i = 0; i < e_polygonCount; ++i)
+	{
+		int32 count = 3 + rand() % (b2_maxPolygonVertices - 2);
+		for (int32 j = 0; j < count; ++j)
+		{
+			points[j].Set(RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f));
+		}
+
+		s_counts[i] = count;
+		points += count;
+	}
+}
+
+// Random convex polygons in counter-clockwise order like procedural debris.
+static void CreateConvex()
+{
+	b2Vec2* points = s_points;
+	for (int32 i = 0; i < e_polygonCount; ++i)
+	{
+		int32 count = 3 + rand() % (b2_maxPolygonVertices - 2);
+		float angle = RandomFloat(0.0f, 2.0f * b2_pi);
+		float radius = RandomFloat(0.5f, 1.0f);
+		float sector = 2.0f * b2_pi / count;
+		for (int32 j = 0; j < count; ++j)
+		{
+			// Points on a circle with jittered spacing
+			float a = angle + sector * (j + RandomFloat(-0.25f, 0.25f));
+			points[j].Set(radius * cosf(a), radius * sinf(a));
+		}
+
+		s_counts[i] = count;
+		points += count;
+	}
+}
+
+static void Report(const char* name, float ms, int32 passCount)
+{
+	float count = float(passCount) * e_polygonCount;
+	printf("%s: %.2f ms, %.1f ns/polygon, %.2f million polygons/s\n", name, ms, 1.0e6f * ms / count, 1.0e-3f * count / ms);
+}
+
+static void RunSet(const char* name, int32 passCount)
+{
+	b2Timer timer;
+	for (int32 pass = 0; pass < passCount; ++pass)
+	{
+		const b2Vec2* points = s_points;
+		for (int32 i = 0; i < e_polygonCount; ++i)
+		{
+			s_polygons[i].Set(points, s_counts[i]);
+			points += s_counts[i];
+		}
+	}
+
+	Report(name, timer.GetMilliseconds(), passCount);
+}
+
+static void RunSetConvex(const char* name, int32 passCount)
+{
+	b2Timer timer;
+	for (int32 pass = 0; pass < passCount; ++pass)
+	{
+		const b2Vec2* points = s_points;
+		for (int32 i = 0; i < e_polygonCount; ++i)
+		{
+			s_polygons[i].SetConvex(points, s_counts[i]);
+			points += s_counts[i];
+		}
+	}
+
+	Report(name, timer.GetMilliseconds(), passCount);
+}
+
+static void RunBulk(const char* name, int32 passCount)
+{
+	b2Timer timer;
+	for (int32 pass = 0; pass < passCount; ++pass)
+	{
+		b2SetPolygons(s_polygons, s_points, s_counts, e_polygonCount, true);
+	}
+
+	Report(name, timer.GetMilliseconds(), passCount);
+}
+
+int main(int argc, char** argv)
+{
+	int32 passCount = 200;
+	if (argc > 1)
+	{
+		passCount = atoi(argv[1]);
+	}
+
+	srand(12345);
+
+	CreateClouds();
+	RunSet("clouds Set", passCount);
+
+	CreateConvex();
+	RunSet("convex Set", passCount);
+	RunSetConvex("convex SetConvex", passCount);
+	RunBulk("convex b2SetPolygons", passCount);
+
+	return 0;
+}
@@ -0,0 +1,378 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "box2d/box2d.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Times world steps in joint heavy scenes. Each scene mixes joint types in island
+// order. Some scenes are also run with the wide joint solver.
+
+// Bridges of revolute joints with weld joint planks.
+static void CreateBridges(b2World* world, int32 bridgeCount)
+{
+	b2BodyDef bodyDef;
+	b2Body* ground = world->CreateBody(&bodyDef);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.125f);
+
+	b2FixtureDef fixtureDef;
+	fixtureDef.shape = &box;
+	fixtureDef.density = 20.0f;
+	fixtureDef.friction = 0.2f;
+
+	const int32 plankCount = 30;
+	for (int32 k = 0; k < bridgeCount; ++k)
+	{
+		float y = 5.0f * k;
+		b2Body* prevBody = ground;
+		for (int32 i = 0; i < plankCount; ++i)
+		{
+			bodyDef.type = b2_dynamicBody;
+			bodyDef.position.Set(-14.5f + i, y);
+			b2Body* body = world->CreateBody(&bodyDef);
+			body->CreateFixture(&fixtureDef);
+
+			b2Vec2 anchor(-15.0f + i, y);
+			if (i % 4 == 3)
+			{
+				b2WeldJointDef jd;
+				jd.Initialize(prevBody, body, anchor);
+				jd.stiffness = 0.0f;
+				world->CreateJoint(&jd);
+			}
+			else
+			{
+				b2RevoluteJointDef jd;
+				jd.Initialize(prevBody, body, anchor);
+				world->CreateJoint(&jd);
+			}
+
+			prevBody = body;
+		}
+
+		b2RevoluteJointDef jd;
+		jd.Initialize(prevBody, ground, b2Vec2(-15.0f + plankCount, y));
+		world->CreateJoint(&jd);
+	}
+}
+
+// Boxes tied together by distance joints, like the web test.
+static void CreateWebs(b2World* world, int32 webCount)
+{
+	b2BodyDef bodyDef;
+	b2Body* ground = world->CreateBody(&bodyDef);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	for (int32 k = 0; k < webCount; ++k)
+	{
+		float x = 10.0f * k;
+		b2Body* bodies[4];
+		b2Vec2 positions[4] = {b2Vec2(x - 5.0f, 5.0f), b2Vec2(x + 5.0f, 5.0f), b2Vec2(x + 5.0f, 15.0f), b2Vec2(x - 5.0f, 15.0f)};
+		for (int32 i = 0; i < 4; ++i)
+		{
+			bodyDef.type = b2_dynamicBody;
+			bodyDef.position = positions[i];
+			bodies[i] = world->CreateBody(&bodyDef);
+			bodies[i]->CreateFixture(&box, 5.0f);
+		}
+
+		b2Vec2 corners[4] = {b2Vec2(x - 10.0f, 0.0f), b2Vec2(x + 10.0f, 0.0f), b2Vec2(x + 10.0f, 20.0f), b2Vec2(x - 10.0f, 20.0f)};
+		for (int32 i = 0; i < 4; ++i)
+		{
+			b2DistanceJointDef jd;
+			jd.Initialize(ground, bodies[i], corners[i], bodies[i]->GetPosition());
+			b2LinearStiffness(jd.stiffness, jd.damping, 2.0f, 0.0f, ground, bodies[i]);
+			world->CreateJoint(&jd);
+
+			b2PrismaticJointDef pd;
+			pd.Initialize(bodies[i], bodies[(i + 1) % 4], bodies[i]->GetPosition(), b2Vec2(0.0f, 1.0f));
+			pd.enableLimit = true;
+			pd.lowerTranslation = -1.0f;
+			pd.upperTranslation = 1.0f;
+			world->CreateJoint(&pd);
+		}
+	}
+}
+
+// Adds a leg of a Theo Jansen walker. The leg is two triangles held together by
+// soft distance joints and hinged on the chassis.
+static void AddLeg(b2World* world, b2Body* chassis, b2Body* wheel, const b2Vec2& offset, float s, const b2Vec2& wheelAnchor)
+{
+	b2Vec2 p1(5.4f * s, -6.1f);
+	b2Vec2 p2(7.2f * s, -1.2f);
+	b2Vec2 p3(4.3f * s, -1.9f);
+	b2Vec2 p4(3.1f * s, 0.8f);
+	b2Vec2 p5(6.0f * s, 1.5f);
+	b2Vec2 p6(2.5f * s, 3.7f);
+
+	b2Vec2 vertices[3];
+	b2PolygonShape poly1, poly2;
+	vertices[0] = p1;
+	vertices[1] = p2;
+	vertices[2] = p3;
+	poly1.Set(vertices, 3);
+
+	vertices[0] = b2Vec2_zero;
+	vertices[1] = p5 - p4;
+	vertices[2] = p6 - p4;
+	poly2.Set(vertices, 3);
+
+	b2FixtureDef fd;
+	fd.filter.groupIndex = -1;
+	fd.density = 1.0f;
+
+	b2BodyDef bd;
+	bd.type = b2_dynamicBody;
+	bd.angularDamping = 10.0f;
+
+	bd.position = offset;
+	b2Body* body1 = world->CreateBody(&bd);
+	fd.shape = &poly1;
+	body1->CreateFixture(&fd);
+
+	bd.position = p4 + offset;
+	b2Body* body2 = world->CreateBody(&bd);
+	fd.shape = &poly2;
+	body2->CreateFixture(&fd);
+
+	b2DistanceJointDef jd;
+	jd.Initialize(body1, body2, p2 + offset, p5 + offset);
+	b2LinearStiffness(jd.stiffness, jd.damping, 10.0f, 0.5f, jd.bodyA, jd.bodyB);
+	world->CreateJoint(&jd);
+
+	jd.Initialize(body1, body2, p3 + offset, p4 + offset);
+	b2LinearStiffness(jd.stiffness, jd.damping, 10.0f, 0.5f, jd.bodyA, jd.bodyB);
+	world->CreateJoint(&jd);
+
+	jd.Initialize(body1, wheel, p3 + offset, wheelAnchor + offset);
+	b2LinearStiffness(jd.stiffness, jd.damping, 10.0f, 0.5f, jd.bodyA, jd.bodyB);
+	world->CreateJoint(&jd);
+
+	jd.Initialize(body2, wheel, p6 + offset, wheelAnchor + offset);
+	b2LinearStiffness(jd.stiffness, jd.damping, 10.0f, 0.5f, jd.bodyA, jd.bodyB);
+	world->CreateJoint(&jd);
+
+	b2RevoluteJointDef rjd;
+	rjd.Initialize(body2, chassis, p4 + offset);
+	world->CreateJoint(&rjd);
+}
+
+// Theo Jansen walkers like the testbed scene, each on its own stretch of ground.
+static void CreateWalkers(b2World* world, int32 walkerCount)
+{
+	b2BodyDef bodyDef;
+	b2Body* ground = world->CreateBody(&bodyDef);
+
+	b2EdgeShape edge;
+	edge.SetTwoSided(b2Vec2(-50.0f, 0.0f), b2Vec2(-50.0f + 40.0f * walkerCount, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	for (int32 k = 0; k < walkerCount; ++k)
+	{
+		b2Vec2 offset(-30.0f + 40.0f * k, 8.0f);
+		b2Vec2 pivot(0.0f, 0.8f);
+
+		b2FixtureDef fd;
+		fd.density = 1.0f;
+		fd.filter.groupIndex = -1;
+
+		b2BodyDef bd;
+		bd.type = b2_dynamicBody;
+		bd.position = pivot + offset;
+
+		b2PolygonShape box;
+		box.SetAsBox(2.5f, 1.0f);
+		fd.shape = &box;
+		b2Body* chassis = world->CreateBody(&bd);
+		chassis->CreateFixture(&fd);
+
+		b2CircleShape circle;
+		circle.m_radius = 1.6f;
+		fd.shape = &circle;
+		b2Body* wheel = world->CreateBody(&bd);
+		wheel->CreateFixture(&fd);
+
+		b2RevoluteJointDef jd;
+		jd.Initialize(wheel, chassis, pivot + offset);
+		jd.motorSpeed = 2.0f;
+		jd.maxMotorTorque = 400.0f;
+		jd.enableMotor = true;
+		world->CreateJoint(&jd);
+
+		b2Vec2 wheelAnchor = pivot + b2Vec2(0.0f, -0.8f);
+		for (int32 i = 0; i < 3; ++i)
+		{
+			wheel->SetTransform(wheel->GetPosition(), (120.0f * i) * b2_pi / 180.0f);
+			AddLeg(world, chassis, wheel, offset, -1.0f, wheelAnchor);
+			AddLeg(world, chassis, wheel, offset, 1.0f, wheelAnchor);
+		}
+	}
+}
+
+// Adds a limb segment to a ragdoll with a limited revolute joint. The motor acts as
+// joint friction.
+static b2Body* AddLimb(b2World* world, b2Body* parent, const b2Vec2& anchor, const b2Vec2& center, float hx, float hy)
+{
+	b2BodyDef bodyDef;
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.position = center;
+	b2Body* body = world->CreateBody(&bodyDef);
+
+	b2PolygonShape box;
+	box.SetAsBox(hx, hy);
+
+	b2FixtureDef fixtureDef;
+	fixtureDef.shape = &box;
+	fixtureDef.density = 1.0f;
+	fixtureDef.filter.groupIndex = -1;
+	body->CreateFixture(&fixtureDef);
+
+	b2RevoluteJointDef jd;
+	jd.Initialize(parent, body, anchor);
+	jd.enableLimit = true;
+	jd.lowerAngle = -0.25f * b2_pi;
+	jd.upperAngle = 0.25f * b2_pi;
+	jd.enableMotor = true;
+	jd.maxMotorTorque = 0.5f;
+	world->CreateJoint(&jd);
+
+	return body;
+}
+
+// Ragdolls made of revolute joints with a weld joint for the head, lying on the ground.
+static void CreateRagdolls(b2World* world, int32 ragdollCount)
+{
+	b2BodyDef bodyDef;
+	b2Body* ground = world->CreateBody(&bodyDef);
+
+	b2EdgeShape edge;
+	edge.SetTwoSided(b2Vec2(-200.0f, 0.0f), b2Vec2(200.0f + 3.0f * ragdollCount, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2PolygonShape box;
+	b2FixtureDef fixtureDef;
+	fixtureDef.shape = &box;
+	fixtureDef.density = 1.0f;
+	fixtureDef.filter.groupIndex = -1;
+
+	for (int32 k = 0; k < ragdollCount; ++k)
+	{
+		float x = -150.0f + 3.0f * k;
+		float y = 3.0f;
+
+		bodyDef.type = b2_dynamicBody;
+		bodyDef.position.Set(x, y);
+		b2Body* torso = world->CreateBody(&bodyDef);
+		box.SetAsBox(0.25f, 0.5f);
+		torso->CreateFixture(&fixtureDef);
+
+		bodyDef.position.Set(x, y + 0.75f);
+		b2Body* head = world->CreateBody(&bodyDef);
+		box.SetAsBox(0.2f, 0.2f);
+		head->CreateFixture(&fixtureDef);
+
+		b2WeldJointDef wd;
+		wd.Initialize(torso, head, b2Vec2(x, y + 0.5f));
+		b2AngularStiffness(wd.stiffness, wd.damping, 5.0f, 0.7f, torso, head);
+		world->CreateJoint(&wd);
+
+		for (int32 side = -1; side <= 1; side += 2)
+		{
+			float s = float(side);
+			b2Body* upperArm = AddLimb(world, torso, b2Vec2(x + 0.25f * s, y + 0.4f), b2Vec2(x + 0.55f * s, y + 0.4f), 0.3f, 0.08f);
+			AddLimb(world, upperArm, b2Vec2(x + 0.85f * s, y + 0.4f), b2Vec2(x + 1.15f * s, y + 0.4f), 0.3f, 0.07f);
+
+			b2Body* upperLeg = AddLimb(world, torso, b2Vec2(x + 0.15f * s, y - 0.5f), b2Vec2(x + 0.15f * s, y - 0.85f), 0.1f, 0.35f);
+			AddLimb(world, upperLeg, b2Vec2(x + 0.15f * s, y - 1.2f), b2Vec2(x + 0.15f * s, y - 1.55f), 0.09f, 0.35f);
+		}
+	}
+}
+
+static void Run(const char* name, b2World* world, int32 stepCount)
+{
+	// Keep everything awake so every step does the same work.
+	world->SetAllowSleeping(false);
+
+	b2Timer timer;
+	for (int32 i = 0; i < stepCount; ++i)
+	{
+		world->Step(1.0f / 60.0f, 8, 3);
+	}
+	float ms = timer.GetMilliseconds();
+
+	printf("%s: %d joints, %d steps, %.2f ms, %.3f ms/step\n", name, world->GetJointCount(), stepCount, ms, ms / stepCount);
+}
+
+int main(int argc, char** argv)
+{
+	int32 stepCount = 600;
+	if (argc > 1)
+	{
+		stepCount = atoi(argv[1]);
+	}
+
+	{
+		b2World world(b2Vec2(0.0f, -10.0f));
+		CreateBridges(&world, 20);
+		Run("bridges", &world, stepCount);
+	}
+
+	{
+		b2World world(b2Vec2(0.0f, -10.0f));
+		CreateWebs(&world, 100);
+		Run("webs", &world, stepCount);
+	}
+
+	{
+		b2World world(b2Vec2(0.0f, -10.0f));
+		CreateWalkers(&world, 50);
+		Run("walkers", &world, stepCount);
+	}
+
+	{
+		b2World world(b2Vec2(0.0f, -10.0f));
+		CreateRagdolls(&world, 200);
+		Run("ragdolls", &world, stepCount);
+	}
+
+	{
+		b2World world(b2Vec2(0.0f, -10.0f));
+		world.SetWideJointSolver(true);
+		CreateRagdolls(&world, 200);
+		Run("ragdolls wide", &world, stepCount);
+	}
+
+	{
+		b2World world(b2Vec2(0.0f, -10.0f));
+		world.SetWideJointSolver(true);
+		CreateBridges(&world, 20);
+		Run("bridges wide", &world, stepCount);
+	}
+
+	return 0;
+}
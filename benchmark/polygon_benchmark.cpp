@@ -0,0 +1,104 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "box2d/box2d.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Times b2CollidePolygons over random overlapping polygon pairs. Build with
+// BOX2D_DISABLE_SIMD to compare against the scalar fallback.
+
+static float RandomFloat(float lo, float hi)
+{
+	float r = (float)(rand() & (RAND_MAX));
+	r /= RAND_MAX;
+	return (hi - lo) * r + lo;
+}
+
+static void RandomPolygon(b2PolygonShape* polygon)
+{
+	b2Vec2 points[b2_maxPolygonVertices];
+	int32 count = 3 + rand() % (b2_maxPolygonVertices - 2);
+	for (int32 i = 0; i < count; ++i)
+	{
+		points[i].Set(RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f));
+	}
+
+	// Degenerate point sets fall back to a box.
+	polygon->SetAsBox(0.5f, 0.5f);
+	polygon->Set(points, count);
+}
+
+const int32 e_pairCount = 1024;
+
+static b2PolygonShape s_polygons[2 * e_pairCount];
+static b2Transform s_transforms[2 * e_pairCount];
+
+static void Run(const char* name, int32 passCount)
+{
+	int32 pairCount = e_pairCount;
+	int32 pointCount = 0;
+	b2Timer timer;
+	for (int32 pass = 0; pass < passCount; ++pass)
+	{
+		for (int32 i = 0; i < pairCount; ++i)
+		{
+			b2Manifold manifold;
+			b2CollidePolygons(&manifold, s_polygons + 2 * i, s_transforms[2 * i], s_polygons + 2 * i + 1, s_transforms[2 * i + 1]);
+			pointCount += manifold.pointCount;
+		}
+	}
+	float ms = timer.GetMilliseconds();
+
+	float ns = 1000000.0f * ms / (float(pairCount) * float(passCount));
+	printf("%s: %d pairs, %.2f ms, %.1f ns/pair, %d points\n", name, pairCount * passCount, ms, ns, pointCount);
+}
+
+int main(int argc, char** argv)
+{
+	int32 passCount = 1000;
+	if (argc > 1)
+	{
+		passCount = atoi(argv[1]);
+	}
+
+	srand(12345);
+
+	for (int32 i = 0; i < 2 * e_pairCount; ++i)
+	{
+		RandomPolygon(s_polygons + i);
+		s_transforms[i].Set(b2Vec2(RandomFloat(-0.75f, 0.75f), RandomFloat(-0.75f, 0.75f)), RandomFloat(-b2_pi, b2_pi));
+	}
+
+	Run("random polygons", passCount);
+
+	for (int32 i = 0; i < 2 * e_pairCount; ++i)
+	{
+		s_polygons[i].SetAsBox(RandomFloat(0.25f, 1.0f), RandomFloat(0.25f, 1.0f));
+	}
+
+	Run("boxes", passCount);
+
+	return 0;
+}
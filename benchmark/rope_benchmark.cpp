@@ -0,0 +1,144 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "box2d/box2d.h"
+#include "box2d/b2_rope.h"
+#include "box2d/b2_rope_system.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Times stepping many ropes one at a time with b2Rope and together with b2RopeSystem.
+
+static const int32 e_vertexCount = 40;
+
+static void CreateRopeDef(b2RopeDef* def, b2Vec2* vertices, float* masses, const b2RopeTuning& tuning, int32 index)
+{
+	for (int32 i = 0; i < e_vertexCount; ++i)
+	{
+		vertices[i].Set(0.25f * i, 0.0f);
+		masses[i] = i == 0 ? 0.0f : 1.0f;
+	}
+
+	def->position.Set(12.0f * (index % 32), 12.0f * (index / 32));
+	def->vertices = vertices;
+	def->count = e_vertexCount;
+	def->masses = masses;
+	def->gravity.Set(0.0f, -10.0f);
+	def->tuning = tuning;
+}
+
+static void RunRopes(const char* name, const b2RopeTuning& tuning, int32 ropeCount, int32 stepCount)
+{
+	b2Vec2 vertices[e_vertexCount];
+	float masses[e_vertexCount];
+
+	b2Rope* ropes = new b2Rope[ropeCount];
+	b2Vec2* positions = new b2Vec2[ropeCount];
+	for (int32 i = 0; i < ropeCount; ++i)
+	{
+		b2RopeDef def;
+		CreateRopeDef(&def, vertices, masses, tuning, i);
+		ropes[i].Create(def);
+		positions[i] = def.position;
+	}
+
+	b2Timer timer;
+	for (int32 step = 0; step < stepCount; ++step)
+	{
+		for (int32 i = 0; i < ropeCount; ++i)
+		{
+			ropes[i].Step(1.0f / 60.0f, 8, positions[i]);
+		}
+	}
+	float ms = timer.GetMilliseconds();
+
+	printf("%s b2Rope: %d ropes, %d steps, %.2f ms, %.3f ms/step\n", name, ropeCount, stepCount, ms, ms / stepCount);
+
+	delete [] ropes;
+	delete [] positions;
+}
+
+static void RunSystem(const char* name, const b2RopeTuning& tuning, int32 ropeCount, int32 stepCount, b2ThreadPool* pool)
+{
+	b2Vec2 vertices[e_vertexCount];
+	float masses[e_vertexCount];
+
+	b2RopeSystem system(pool);
+	for (int32 i = 0; i < ropeCount; ++i)
+	{
+		b2RopeDef def;
+		CreateRopeDef(&def, vertices, masses, tuning, i);
+		system.CreateRope(def);
+	}
+
+	b2Timer timer;
+	for (int32 step = 0; step < stepCount; ++step)
+	{
+		system.Step(1.0f / 60.0f, 8);
+	}
+	float ms = timer.GetMilliseconds();
+
+	int32 threadCount = pool != nullptr ? pool->GetThreadCount() : 1;
+	printf("%s b2RopeSystem, %d threads: %d ropes, %d steps, %.2f ms, %.3f ms/step\n",
+		name, threadCount, ropeCount, stepCount, ms, ms / stepCount);
+}
+
+int main(int argc, char** argv)
+{
+	int32 stepCount = 300;
+	if (argc > 1)
+	{
+		stepCount = atoi(argv[1]);
+	}
+
+	const int32 ropeCount = 1000;
+
+	b2RopeTuning xpbd;
+	xpbd.stretchingModel = b2_xpbdStretchingModel;
+	xpbd.bendingModel = b2_xpbdAngleBendingModel;
+	xpbd.stretchHertz = 30.0f;
+	xpbd.stretchDamping = 4.0f;
+	xpbd.bendHertz = 10.0f;
+	xpbd.bendDamping = 4.0f;
+	xpbd.damping = 0.1f;
+
+	b2RopeTuning pbd;
+	pbd.stretchingModel = b2_pbdStretchingModel;
+	pbd.bendingModel = b2_pbdTriangleBendingModel;
+	pbd.stretchHertz = 30.0f;
+	pbd.stretchDamping = 4.0f;
+	pbd.damping = 0.1f;
+
+	b2ThreadPool pool(3);
+
+	RunRopes("xpbd", xpbd, ropeCount, stepCount);
+	RunSystem("xpbd", xpbd, ropeCount, stepCount, nullptr);
+	RunSystem("xpbd", xpbd, ropeCount, stepCount, &pool);
+
+	RunRopes("pbd", pbd, ropeCount, stepCount);
+	RunSystem("pbd", pbd, ropeCount, stepCount, nullptr);
+	RunSystem("pbd", pbd, ropeCount, stepCount, &pool);
+
+	return 0;
+}
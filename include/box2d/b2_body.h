@@ -66,6 +66,7 @@ struct B2_API b2BodyDef
 		bullet = false;
 		type = b2_staticBody;
 		enabled = true;
+		allowLOD = true;
 		gravityScale = 1.0f;
 	}
 
@@ -117,6 +118,11 @@ struct B2_API b2BodyDef
 	/// Does this body start out enabled?
 	bool enabled;
 
+	/// Can this body be simulated at a reduced level of detail when it is far from the
+	/// focus points? Set this to false for important bodies such as players. An island
+	/// is only reduced if all of its bodies allow it. See b2World::SetLODLevels.
+	bool allowLOD;
+
 	/// Use this to store application specific body data.
 	b2BodyUserData userData;
 
@@ -324,8 +330,15 @@ public:
 	/// Is this body allowed to sleep
 	bool IsSleepingAllowed() const;
 
+	/// Allow or prevent level of detail simulation for this body.
+	void SetLODAllowed(bool flag);
+
+	/// Is this body allowed to use level of detail simulation?
+	bool IsLODAllowed() const;
+
 	/// Set the sleep state of the body. A sleeping body has very
-	/// low CPU cost.
+	/// low CPU cost. Waking a body wakes every sleeping body connected
+	/// to it by touching contacts or joints.
 	/// @param flag set to true to wake the body, false to put it to sleep.
 	void SetAwake(bool flag);
 
@@ -391,6 +404,9 @@ private:
 	friend class b2Island;
 	friend class b2ContactManager;
 	friend class b2ContactSolver;
+	friend class b2JointSolver;
+	friend class b2RopeSystem;
+	friend class b2WideJointSolver;
 	friend class b2Contact;
 
 	friend class b2DistanceJoint;
@@ -414,7 +430,9 @@ private:
 		e_bulletFlag		= 0x0008,
 		e_fixedRotationFlag	= 0x0010,
 		e_enabledFlag		= 0x0020,
-		e_toiFlag			= 0x0040
+		e_toiFlag			= 0x0040,
+		e_lodFlag			= 0x0080,
+		e_lodSkipFlag		= 0x0100
 	};
 
 	b2Body(const b2BodyDef* bd, b2World* world);
@@ -465,6 +483,16 @@ private:
 
 	float m_sleepTime;
 
+	// Time skipped by level of detail stepping.
+	float m_lodTime;
+
+	// The time step of the last level of detail solve, or zero if the body was
+	// last solved with the world time step.
+	float m_lodStep;
+
+	// Index in the world's awake body array, or -1.
+	int32 m_awakeIndex;
+
 	b2BodyUserData m_userData;
 };
 
@@ -632,29 +660,6 @@ inline bool b2Body::IsBullet() const
 	return (m_flags & e_bulletFlag) == e_bulletFlag;
 }
 
-inline void b2Body::SetAwake(bool flag)
-{
-	if (m_type == b2_staticBody)
-	{
-		return;
-	}
-
-	if (flag)
-	{
-		m_flags |= e_awakeFlag;
-		m_sleepTime = 0.0f;
-	}
-	else
-	{
-		m_flags &= ~e_awakeFlag;
-		m_sleepTime = 0.0f;
-		m_linearVelocity.SetZero();
-		m_angularVelocity = 0.0f;
-		m_force.SetZero();
-		m_torque = 0.0f;
-	}
-}
-
 inline bool b2Body::IsAwake() const
 {
 	return (m_flags & e_awakeFlag) == e_awakeFlag;
@@ -688,6 +693,23 @@ inline bool b2Body::IsSleepingAllowed() const
 	return (m_flags & e_autoSleepFlag) == e_autoSleepFlag;
 }
 
+inline void b2Body::SetLODAllowed(bool flag)
+{
+	if (flag)
+	{
+		m_flags |= e_lodFlag;
+	}
+	else
+	{
+		m_flags &= ~e_lodFlag;
+	}
+}
+
+inline bool b2Body::IsLODAllowed() const
+{
+	return (m_flags & e_lodFlag) == e_lodFlag;
+}
+
 inline b2Fixture* b2Body::GetFixtureList()
 {
 	return m_fixtureList;
@@ -28,12 +28,32 @@
 #include "b2_collision.h"
 #include "b2_dynamic_tree.h"
 
+#if defined(B2_DETERMINISTIC)
+#include <algorithm>
+#endif
+
 struct B2_API b2Pair
 {
 	int32 proxyIdA;
 	int32 proxyIdB;
 };
 
+/// This is used to sort pairs.
+inline bool b2PairLessThan(const b2Pair& pair1, const b2Pair& pair2)
+{
+	if (pair1.proxyIdA < pair2.proxyIdA)
+	{
+		return true;
+	}
+
+	if (pair1.proxyIdA == pair2.proxyIdA)
+	{
+		return pair1.proxyIdB < pair2.proxyIdB;
+	}
+
+	return false;
+}
+
 /// The broad-phase is used for computing pairs and performing volume queries and ray casts.
 /// This broad-phase does not persist pairs. Instead, this reports potentially new pairs.
 /// It is up to the client to consume the new pairs and to track subsequent overlap.
@@ -53,6 +73,10 @@ public:
 	/// UpdatePairs is called.
 	int32 CreateProxy(const b2AABB& aabb, void* userData);
 
+	/// Create many proxies at once using a bulk tree insertion. Pairs are not
+	/// reported until UpdatePairs is called.
+	void CreateProxies(int32 count, const b2AABB* aabbs, void* const* userData, int32* proxyIds);
+
 	/// Destroy a proxy. It is up to the client to remove any pairs.
 	void DestroyProxy(int32 proxyId);
 
@@ -60,6 +84,9 @@ public:
 	/// call UpdatePairs to finalized the proxy pairs (for your time step).
 	void MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement);
 
+	/// Move many proxies at once. This is faster than calling MoveProxy for each proxy.
+	void MoveProxies(int32 count, const int32* proxyIds, const b2AABB* aabbs, const b2Vec2* displacements);
+
 	/// Call to trigger a re-processing of it's pairs on the next call to UpdatePairs.
 	void TouchProxy(int32 proxyId);
 
@@ -94,6 +121,10 @@ public:
 	template <typename T>
 	void RayCast(T* callback, const b2RayCastInput& input) const;
 
+	/// Sweep a box through the proxies. See b2DynamicTree::ShapeCast.
+	template <typename T>
+	void ShapeCast(T* callback, const b2AABBCastInput& input) const;
+
 	/// Get the height of the embedded tree.
 	int32 GetTreeHeight() const;
 
@@ -103,6 +134,9 @@ public:
 	/// Get the quality metric of the embedded tree.
 	float GetTreeQuality() const;
 
+	/// Get the number of proxy re-insertions in the embedded tree.
+	int32 GetReinsertCount() const;
+
 	/// Shift the world origin. Useful for large worlds.
 	/// The shift formula is: position -= newOrigin
 	/// @param newOrigin the new origin with respect to the old origin
@@ -111,6 +145,7 @@ public:
 private:
 
 	friend class b2DynamicTree;
+	friend class b2QuerySnapshot;
 
 	void BufferMove(int32 proxyId);
 	void UnBufferMove(int32 proxyId);
@@ -169,6 +204,11 @@ inline float b2BroadPhase::GetTreeQuality() const
 	return m_tree.GetAreaRatio();
 }
 
+inline int32 b2BroadPhase::GetReinsertCount() const
+{
+	return m_tree.GetReinsertCount();
+}
+
 template <typename T>
 void b2BroadPhase::UpdatePairs(T* callback)
 {
@@ -192,6 +232,12 @@ void b2BroadPhase::UpdatePairs(T* callback)
 		m_tree.Query(this, fatAABB);
 	}
 
+#if defined(B2_DETERMINISTIC)
+	// The query order depends on the tree structure. Sort the pairs so that new
+	// contacts are created in an order that only depends on the proxy ids.
+	std::sort(m_pairBuffer, m_pairBuffer + m_pairCount, b2PairLessThan);
+#endif
+
 	// Send pairs to caller
 	for (int32 i = 0; i < m_pairCount; ++i)
 	{
@@ -230,6 +276,12 @@ inline void b2BroadPhase::RayCast(T* callback, const b2RayCastInput& input) cons
 	m_tree.RayCast(callback, input);
 }
 
+template <typename T>
+inline void b2BroadPhase::ShapeCast(T* callback, const b2AABBCastInput& input) const
+{
+	m_tree.ShapeCast(callback, input);
+}
+
 inline void b2BroadPhase::ShiftOrigin(const b2Vec2& newOrigin)
 {
 	m_tree.ShiftOrigin(newOrigin);
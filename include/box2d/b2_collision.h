@@ -36,6 +36,7 @@ class b2Shape;
 class b2CircleShape;
 class b2EdgeShape;
 class b2PolygonShape;
+struct b2SimplexCache;
 
 const uint8 b2_nullFeature = UCHAR_MAX;
 
@@ -112,6 +113,17 @@ struct B2_API b2Manifold
 	int32 pointCount;								///< the number of manifold points
 };
 
+/// Separating axis cache for b2CollidePolygons. This lets persistent polygon pairs skip
+/// most of the separating axis search. Set count to zero on the first call.
+struct B2_API b2PolygonCache
+{
+	b2Transform relativeTransform;	///< transform of B relative to A at the last full search
+	uint8 edge;						///< the reference or separating edge
+	uint8 flip;						///< 1 if the edge belongs to polygon B
+	uint8 touching;					///< 1 if the edge is a reference face, 0 if it is separating
+	uint8 count;					///< 0 if the cache is empty
+};
+
 /// This is used to compute the current state of a contact manifold.
 struct B2_API b2WorldManifold
 {
@@ -236,6 +248,14 @@ B2_API void b2CollidePolygons(b2Manifold* manifold,
 					   const b2PolygonShape* polygonA, const b2Transform& xfA,
 					   const b2PolygonShape* polygonB, const b2Transform& xfB);
 
+/// Compute the collision manifold between two polygons using a separating axis cache.
+/// A cached separating axis is tested first. A cached reference face is reused while the
+/// relative transform stays within a small tolerance of the last full search.
+B2_API void b2CollidePolygons(b2Manifold* manifold,
+					   const b2PolygonShape* polygonA, const b2Transform& xfA,
+					   const b2PolygonShape* polygonB, const b2Transform& xfB,
+					   b2PolygonCache* cache);
+
 /// Compute the collision manifold between an edge and a circle.
 B2_API void b2CollideEdgeAndCircle(b2Manifold* manifold,
 							   const b2EdgeShape* polygonA, const b2Transform& xfA,
@@ -250,11 +270,23 @@ B2_API void b2CollideEdgeAndPolygon(b2Manifold* manifold,
 B2_API int32 b2ClipSegmentToLine(b2ClipVertex vOut[2], const b2ClipVertex vIn[2],
 							const b2Vec2& normal, float offset, int32 vertexIndexA);
 
+/// Compute the closest points between the segments p1-q1 and p2-q2. The results are
+/// fractions along each segment in the range [0,1].
+B2_API void b2SegmentDistance(float* fraction1, float* fraction2,
+							  const b2Vec2& p1, const b2Vec2& q1, const b2Vec2& p2, const b2Vec2& q2);
+
 /// Determine if two generic shapes overlap.
 B2_API bool b2TestOverlap(	const b2Shape* shapeA, int32 indexA,
 					const b2Shape* shapeB, int32 indexB,
 					const b2Transform& xfA, const b2Transform& xfB);
 
+/// Determine if two generic shapes overlap. The simplex cache warm starts the
+/// distance query and is updated. Set cache->count to zero on the first call.
+B2_API bool b2TestOverlap(	const b2Shape* shapeA, int32 indexA,
+					const b2Shape* shapeB, int32 indexB,
+					const b2Transform& xfA, const b2Transform& xfB,
+					b2SimplexCache* cache);
+
 // ---------------- Inline Functions ------------------------------------------
 
 inline bool b2AABB::IsValid() const
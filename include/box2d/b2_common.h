@@ -28,6 +28,7 @@
 #include <stddef.h>
 #include <assert.h>
 #include <float.h>
+#include <string.h>
 
 #if !defined(NDEBUG)
 	#define b2DEBUG
@@ -60,6 +61,14 @@
 /// This is a dimensionless multiplier.
 #define b2_aabbMultiplier		4.0f
 
+/// The fat AABB extension adapts per proxy between these bounds. A proxy that escapes
+/// its fat AABB within b2_aabbMinAge moves doubles its extension. A proxy that stays
+/// inside its fat AABB for b2_aabbMaxAge moves halves its extension.
+#define b2_aabbMinExtension		(0.25f * b2_aabbExtension)
+#define b2_aabbMaxExtension		(8.0f * b2_aabbExtension)
+#define b2_aabbMinAge			4
+#define b2_aabbMaxAge			32
+
 /// A small length used as a collision and constraint tolerance. Usually it is
 /// chosen to be numerically significant, but visually insignificant. In meters.
 #define b2_linearSlop			(0.005f * b2_lengthUnitsPerMeter)
@@ -123,6 +132,19 @@ void b2OpenDump(const char* fileName);
 void b2Dump(const char* string, ...);
 void b2CloseDump();
 
+/// The initial value for a hash.
+#define b2_hashInit	2166136261u
+
+/// Accumulate the bits of a float into a 32-bit hash. This is FNV-1a over
+/// whole words with an extra shift to mix the high bits into the low bits.
+inline uint32 b2HashFloat(uint32 hash, float x)
+{
+	uint32 bits;
+	memcpy(&bits, &x, sizeof(uint32));
+	hash = (hash ^ bits) * 16777619u;
+	return hash ^ (hash >> 16);
+}
+
 /// Version numbering scheme.
 /// See http://en.wikipedia.org/wiki/Software_versioning
 struct b2Version
@@ -0,0 +1,195 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_COMPOUND_SHAPE_H
+#define B2_COMPOUND_SHAPE_H
+
+#include "b2_api.h"
+#include "b2_growable_stack.h"
+#include "b2_polygon_shape.h"
+#include "b2_shape.h"
+
+/// A node in the bounding volume hierarchy of a compound shape.
+struct B2_API b2CompoundNode
+{
+	bool IsLeaf() const
+	{
+		return child1 == -1;
+	}
+
+	/// Bounds of the polygons below this node in the shape frame.
+	b2AABB aabb;
+
+	/// Child node indices, or -1 for a leaf.
+	int32 child1;
+	int32 child2;
+
+	/// The polygon index for a leaf.
+	int32 polygonIndex;
+};
+
+/// A compound shape is a rigid collection of convex polygons, usually the convex
+/// decomposition of a concave object. Unlike one fixture per polygon, the compound
+/// has a single broad-phase proxy and a single contact per overlapping fixture. The
+/// contact culls polygon pairs with a small bounding volume hierarchy built when the
+/// compound is created and keeps one manifold per touching polygon pair.
+/// All polygons must have the same radius.
+class B2_API b2CompoundShape : public b2Shape
+{
+public:
+	b2CompoundShape();
+
+	/// The destructor frees the polygons and the hierarchy using b2Free.
+	~b2CompoundShape();
+
+	/// Clear all data.
+	void Clear();
+
+	/// Create the compound and build its hierarchy.
+	/// @param polygons an array of convex polygons in the shape frame, these are copied
+	/// @param count the polygon count
+	void Create(const b2PolygonShape* polygons, int32 count);
+
+	/// Implement b2Shape. Polygons are cloned using b2Alloc.
+	b2Shape* Clone(b2BlockAllocator* allocator) const override;
+
+	/// A compound has a single child so it has one broad-phase proxy.
+	/// @see b2Shape::GetChildCount
+	int32 GetChildCount() const override;
+
+	/// Get the number of polygons.
+	int32 GetPolygonCount() const;
+
+	/// Get a polygon by index.
+	const b2PolygonShape* GetPolygon(int32 index) const;
+
+	/// Test a point against all polygons.
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2Transform& transform, const b2Vec2& p) const override;
+
+	/// Cast a ray against the polygons. This reports the closest hit.
+	/// @see b2Shape::RayCast
+	bool RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+					const b2Transform& transform, int32 childIndex) const override;
+
+	/// Cast a ray against the polygons. This also returns the index of the polygon hit.
+	bool RayCast(b2RayCastOutput* output, int32* polygonIndex, const b2RayCastInput& input,
+					const b2Transform& transform) const;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2Transform& transform, int32 childIndex) const override;
+
+	/// The mass is the sum of the polygon masses.
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float density) const override;
+
+	/// Test the polygons for overlap with a child of another shape, which may also be a compound.
+	bool TestOverlap(const b2Transform& xf, const b2Shape* shape, int32 childIndex, const b2Transform& shapeTransform) const;
+
+	/// Query the polygons whose bounds overlap a box in the shape frame. The callback
+	/// receives the polygon index and returns false to stop the query.
+	template <typename T>
+	void Query(T* callback, const b2AABB& aabb) const;
+
+	/// Get the bounds of the polygons in the shape frame.
+	const b2AABB& GetBounds() const;
+
+	/// The polygons. Owned by this class.
+	b2PolygonShape* m_polygons;
+
+	/// The polygon count.
+	int32 m_count;
+
+	/// The hierarchy with the root at index zero. Owned by this class.
+	b2CompoundNode* m_nodes;
+	int32 m_nodeCount;
+
+	/// The convex hull of all polygon vertices. This bounds the compound in ComputeAABB.
+	b2Vec2* m_hull;
+	int32 m_hullCount;
+};
+
+inline b2CompoundShape::b2CompoundShape()
+{
+	m_type = e_compound;
+	m_radius = b2_polygonRadius;
+	m_polygons = nullptr;
+	m_count = 0;
+	m_nodes = nullptr;
+	m_nodeCount = 0;
+	m_hull = nullptr;
+	m_hullCount = 0;
+}
+
+inline int32 b2CompoundShape::GetPolygonCount() const
+{
+	return m_count;
+}
+
+inline const b2PolygonShape* b2CompoundShape::GetPolygon(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count);
+	return m_polygons + index;
+}
+
+inline const b2AABB& b2CompoundShape::GetBounds() const
+{
+	b2Assert(m_nodeCount > 0);
+	return m_nodes[0].aabb;
+}
+
+template <typename T>
+inline void b2CompoundShape::Query(T* callback, const b2AABB& aabb) const
+{
+	if (m_nodeCount == 0)
+	{
+		return;
+	}
+
+	b2GrowableStack<int32, 64> stack;
+	stack.Push(0);
+
+	while (stack.GetCount() > 0)
+	{
+		const b2CompoundNode* node = m_nodes + stack.Pop();
+		if (b2TestOverlap(node->aabb, aabb) == false)
+		{
+			continue;
+		}
+
+		if (node->IsLeaf())
+		{
+			bool proceed = callback->QueryCallback(node->polygonIndex);
+			if (proceed == false)
+			{
+				return;
+			}
+		}
+		else
+		{
+			stack.Push(node->child1);
+			stack.Push(node->child2);
+		}
+	}
+}
+
+#endif
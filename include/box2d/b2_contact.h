@@ -25,6 +25,7 @@
 
 #include "b2_api.h"
 #include "b2_collision.h"
+#include "b2_distance.h"
 #include "b2_fixture.h"
 #include "b2_math.h"
 #include "b2_shape.h"
@@ -36,6 +37,7 @@ class b2World;
 class b2BlockAllocator;
 class b2StackAllocator;
 class b2ContactListener;
+struct b2Counters;
 
 /// Friction mixing law. The idea is to allow either fixture to drive the friction to zero.
 /// For example, anything slides on ice.
@@ -69,6 +71,15 @@ struct B2_API b2ContactRegister
 	bool primary;
 };
 
+/// A manifold between one polygon of a compound shape and the other shape, or between
+/// two polygons when both shapes are compounds.
+struct B2_API b2ChildManifold
+{
+	b2Manifold manifold;
+	int32 childA;	///< the polygon index for compound fixture A, otherwise the contact child index
+	int32 childB;	///< the polygon index for compound fixture B, otherwise the contact child index
+};
+
 /// A contact edge is used to connect bodies and contacts together
 /// in a contact graph where each body is a node and each contact
 /// is an edge. A contact edge belongs to a doubly linked list
@@ -97,6 +108,14 @@ public:
 	/// Get the world manifold.
 	void GetWorldManifold(b2WorldManifold* worldManifold) const;
 
+	/// Get the number of child manifolds. A compound shape contact has one manifold for
+	/// each touching polygon pair and GetManifold returns a copy of the first. Other contacts
+	/// have no child manifolds.
+	int32 GetChildManifoldCount() const;
+
+	/// Get the child manifolds. Do not modify these unless you understand the internals of Box2D.
+	const b2ChildManifold* GetChildManifolds() const;
+
 	/// Is this contact touching?
 	bool IsTouching() const;
 
@@ -191,7 +210,10 @@ protected:
 		e_bulletHitFlag		= 0x0010,
 
 		// This contact has a valid TOI in m_toi
-		e_toiFlag			= 0x0020
+		e_toiFlag			= 0x0020,
+
+		// The manifold was evaluated at m_relativeTransform
+		e_manifoldFlag		= 0x0040
 	};
 
 	/// Flag this contact for filtering. Filtering will occur the next time step.
@@ -199,16 +221,16 @@ protected:
 
 	static void AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destroyFcn,
 						b2Shape::Type typeA, b2Shape::Type typeB);
-	static void InitializeRegisters();
+	static bool InitializeRegisters();
 	static b2Contact* Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator);
 	static void Destroy(b2Contact* contact, b2Shape::Type typeA, b2Shape::Type typeB, b2BlockAllocator* allocator);
 	static void Destroy(b2Contact* contact, b2BlockAllocator* allocator);
 
-	b2Contact() : m_fixtureA(nullptr), m_fixtureB(nullptr) {}
+	b2Contact() : m_fixtureA(nullptr), m_fixtureB(nullptr), m_childManifolds(nullptr), m_childManifoldCount(0) {}
 	b2Contact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
 	virtual ~b2Contact() {}
 
-	void Update(b2ContactListener* listener);
+	void Update(b2ContactListener* listener, b2Counters* counters);
 
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
@@ -231,6 +253,16 @@ protected:
 
 	b2Manifold m_manifold;
 
+	// Compound shape contacts solve these instead of m_manifold.
+	b2ChildManifold* m_childManifolds;
+	int32 m_childManifoldCount;
+
+	// Transform of body B relative to body A when the manifold was evaluated.
+	b2Transform m_relativeTransform;
+
+	// Warm starts the distance queries for sensor overlap and time of impact.
+	b2SimplexCache m_simplexCache;
+
 	int32 m_toiCount;
 	float m_toi;
 
@@ -251,6 +283,16 @@ inline const b2Manifold* b2Contact::GetManifold() const
 	return &m_manifold;
 }
 
+inline int32 b2Contact::GetChildManifoldCount() const
+{
+	return m_childManifoldCount;
+}
+
+inline const b2ChildManifold* b2Contact::GetChildManifolds() const
+{
+	return m_childManifolds;
+}
+
 inline void b2Contact::GetWorldManifold(b2WorldManifold* worldManifold) const
 {
 	const b2Body* bodyA = m_fixtureA->GetBody();
@@ -30,6 +30,7 @@ class b2Contact;
 class b2ContactFilter;
 class b2ContactListener;
 class b2BlockAllocator;
+struct b2Counters;
 
 // Delegate of b2World.
 class B2_API b2ContactManager
@@ -44,14 +45,29 @@ public:
 
 	void Destroy(b2Contact* c);
 
+	// Update all contacts that have an awake body.
 	void Collide();
 
+	// Filter and update a single contact. The contact may be destroyed.
+	void Collide(b2Contact* c);
+
+	// Flag a contact for filtering at the next step, even if both bodies sleep.
+	void FlagForFiltering(b2Contact* c);
+
+	// Filter the flagged contacts, including those Collide does not visit.
+	void FilterContacts();
+
+	// Returns false if the contact was destroyed.
+	bool FilterContact(b2Contact* c);
+
 	b2BroadPhase m_broadPhase;
 	b2Contact* m_contactList;
 	int32 m_contactCount;
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
 	b2BlockAllocator* m_allocator;
+	b2Counters* m_counters;
+	bool m_filterPending;
 };
 
 #endif
@@ -29,6 +29,15 @@
 
 #define b2_nullNode (-1)
 
+/// Input for b2DynamicTree::ShapeCast. The box sweeps from aabb to
+/// aabb + maxFraction * translation.
+struct B2_API b2AABBCastInput
+{
+	b2AABB aabb;
+	b2Vec2 translation;
+	float maxFraction;
+};
+
 /// A node in the dynamic tree. The client does not interact with this directly.
 struct B2_API b2TreeNode
 {
@@ -54,6 +63,13 @@ struct B2_API b2TreeNode
 	// leaf = 0, free node = -1
 	int32 height;
 
+	// Leaf motion history for the adaptive fat AABB. This is the smoothed
+	// displacement, the fat AABB extension, and the number of moves since
+	// the last re-insertion.
+	b2Vec2 displacement;
+	float extension;
+	int16 age;
+
 	bool moved;
 };
 
@@ -62,7 +78,9 @@ struct B2_API b2TreeNode
 /// queries such as volume queries and ray casts. Leafs are proxies
 /// with an AABB. In the tree we expand the proxy AABB by b2_fatAABBFactor
 /// so that the proxy AABB is bigger than the client object. This allows the client
-/// object to move by small amounts without triggering a tree update.
+/// object to move by small amounts without triggering a tree update. The expansion
+/// adapts to each proxy: proxies that are re-inserted often get a larger margin
+/// and proxies that rarely move get a smaller one.
 ///
 /// Nodes are pooled and relocatable, so we use node indices rather than pointers.
 class B2_API b2DynamicTree
@@ -77,6 +95,15 @@ public:
 	/// Create a proxy. Provide a tight fitting AABB and a userData pointer.
 	int32 CreateProxy(const b2AABB& aabb, void* userData);
 
+	/// Create many proxies at once. This builds a subtree over the new proxies and inserts
+	/// the subtree as one node. This is much faster than creating the proxies one by one
+	/// and gives a better tree for large batches such as static geometry.
+	/// @param count the number of proxies
+	/// @param aabbs tight fitting AABBs
+	/// @param userData user data pointers
+	/// @param proxyIds receives the new proxy ids
+	void CreateProxies(int32 count, const b2AABB* aabbs, void* const* userData, int32* proxyIds);
+
 	/// Destroy a proxy. This asserts if the id is invalid.
 	void DestroyProxy(int32 proxyId);
 
@@ -86,6 +113,17 @@ public:
 	/// @return true if the proxy was re-inserted.
 	bool MoveProxy(int32 proxyId, const b2AABB& aabb1, const b2Vec2& displacement);
 
+	/// Move many proxies at once. The proxies that escaped their fattened AABB are all
+	/// removed first and then re-inserted in one pass.
+	/// @param count the number of proxies
+	/// @param proxyIds the proxies to move
+	/// @param aabbs swept AABBs
+	/// @param displacements predicted displacements
+	/// @param movedIds receives the ids of the re-inserted proxies, must hold count ids
+	/// @return the number of re-inserted proxies
+	int32 MoveProxies(int32 count, const int32* proxyIds, const b2AABB* aabbs,
+					  const b2Vec2* displacements, int32* movedIds);
+
 	/// Get proxy user data.
 	/// @return the proxy user data or 0 if the id is invalid.
 	void* GetUserData(int32 proxyId) const;
@@ -111,6 +149,14 @@ public:
 	template <typename T>
 	void RayCast(T* callback, const b2RayCastInput& input) const;
 
+	/// Sweep a box through the proxies in the tree. This relies on the callback
+	/// to perform an exact shape cast. The callback returns the new max fraction,
+	/// which shrinks the swept bounds, or zero to terminate, as in RayCast.
+	/// @param input the swept box.
+	/// @param callback a callback class that is called for each proxy touched by the box.
+	template <typename T>
+	void ShapeCast(T* callback, const b2AABBCastInput& input) const;
+
 	/// Validate this tree. For testing.
 	void Validate() const;
 
@@ -125,6 +171,9 @@ public:
 	/// Get the ratio of the sum of the node areas to the root area.
 	float GetAreaRatio() const;
 
+	/// Get the number of times a moved proxy was re-inserted since the tree was created.
+	int32 GetReinsertCount() const;
+
 	/// Build an optimal tree. Very expensive. For testing.
 	void RebuildBottomUp();
 
@@ -135,12 +184,18 @@ public:
 
 private:
 
+	friend class b2QuerySnapshot;
+
 	int32 AllocateNode();
 	void FreeNode(int32 node);
 
 	void InsertLeaf(int32 node);
 	void RemoveLeaf(int32 node);
 
+	bool ComputeFatAABB(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement, b2AABB* fatAABB);
+
+	int32 BuildSubtree(int32* leaves, int32 count);
+
 	int32 Balance(int32 index);
 
 	int32 ComputeHeight() const;
@@ -158,8 +213,14 @@ private:
 	int32 m_freeList;
 
 	int32 m_insertionCount;
+	int32 m_reinsertCount;
 };
 
+inline int32 b2DynamicTree::GetReinsertCount() const
+{
+	return m_reinsertCount;
+}
+
 inline void* b2DynamicTree::GetUserData(int32 proxyId) const
 {
 	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
@@ -305,4 +366,89 @@ inline void b2DynamicTree::RayCast(T* callback, const b2RayCastInput& input) con
 	}
 }
 
+template <typename T>
+inline void b2DynamicTree::ShapeCast(T* callback, const b2AABBCastInput& input) const
+{
+	// The box is treated as its center sweeping through nodes grown by its extents.
+	b2Vec2 p1 = input.aabb.GetCenter();
+	b2Vec2 extents = input.aabb.GetExtents();
+	b2Vec2 d = input.translation;
+
+	// v is perpendicular to the translation.
+	b2Vec2 v = b2Cross(1.0f, d);
+	bool moving = v.Normalize() > 0.0f;
+	b2Vec2 abs_v = b2Abs(v);
+
+	float maxFraction = input.maxFraction;
+
+	// Build a bounding box for the sweep.
+	b2AABB sweptAABB;
+	{
+		b2Vec2 t = maxFraction * d;
+		sweptAABB.lowerBound = input.aabb.lowerBound + b2Min(b2Vec2_zero, t);
+		sweptAABB.upperBound = input.aabb.upperBound + b2Max(b2Vec2_zero, t);
+	}
+
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(m_root);
+
+	while (stack.GetCount() > 0)
+	{
+		int32 nodeId = stack.Pop();
+		if (nodeId == b2_nullNode)
+		{
+			continue;
+		}
+
+		const b2TreeNode* node = m_nodes + nodeId;
+
+		if (b2TestOverlap(node->aabb, sweptAABB) == false)
+		{
+			continue;
+		}
+
+		// Separating axis for the swept center against the grown node.
+		if (moving)
+		{
+			b2Vec2 c = node->aabb.GetCenter();
+			b2Vec2 h = node->aabb.GetExtents() + extents;
+			float separation = b2Abs(b2Dot(v, p1 - c)) - b2Dot(abs_v, h);
+			if (separation > 0.0f)
+			{
+				continue;
+			}
+		}
+
+		if (node->IsLeaf())
+		{
+			b2AABBCastInput subInput;
+			subInput.aabb = input.aabb;
+			subInput.translation = input.translation;
+			subInput.maxFraction = maxFraction;
+
+			float value = callback->ShapeCastCallback(subInput, nodeId);
+
+			if (value == 0.0f)
+			{
+				// The client has terminated the shape cast.
+				return;
+			}
+
+			if (value > 0.0f)
+			{
+				// Update swept bounding box.
+				maxFraction = value;
+				b2Vec2 t = maxFraction * d;
+				sweptAABB.lowerBound = input.aabb.lowerBound + b2Min(b2Vec2_zero, t);
+				sweptAABB.upperBound = input.aabb.upperBound + b2Max(b2Vec2_zero, t);
+			}
+		}
+		else
+		{
+			stack.Push(node->child1);
+			stack.Push(node->child2);
+		}
+	}
+}
+
 #endif
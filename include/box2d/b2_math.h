@@ -34,8 +34,30 @@ inline bool b2IsValid(float x)
 	return isfinite(x);
 }
 
+/// Portable approximations of the trigonometric functions. These only use basic
+/// IEEE arithmetic so they give the same bits on every platform and compiler.
+/// The error is within a few ulps over the range of angles seen in practice.
+B2_API float b2ComputeSin(float x);
+B2_API float b2ComputeCos(float x);
+B2_API float b2ComputeAtan2(float y, float x);
+
+/// Portable exponential in the same style, accurate to a few ulps.
+B2_API float b2ComputeExp(float x);
+
+// The square root is correctly rounded by IEEE 754 so sqrtf is deterministic already.
 #define	b2Sqrt(x)	sqrtf(x)
+
+#if defined(B2_DETERMINISTIC)
+#define	b2Sin(x)		b2ComputeSin(x)
+#define	b2Cos(x)		b2ComputeCos(x)
+#define	b2Atan2(y, x)	b2ComputeAtan2(y, x)
+#define	b2Exp(x)		b2ComputeExp(x)
+#else
+#define	b2Sin(x)		sinf(x)
+#define	b2Cos(x)		cosf(x)
 #define	b2Atan2(y, x)	atan2f(y, x)
+#define	b2Exp(x)		expf(x)
+#endif
 
 /// A 2D column vector.
 struct B2_API b2Vec2
@@ -128,6 +150,18 @@ struct B2_API b2Vec2
 	float x, y;
 };
 
+/// A 2D column vector with double precision. This holds absolute positions in large worlds.
+struct B2_API b2Vec2d
+{
+	/// Default constructor does nothing (for performance).
+	b2Vec2d() {}
+
+	/// Construct using coordinates.
+	b2Vec2d(double xIn, double yIn) : x(xIn), y(yIn) {}
+
+	double x, y;
+};
+
 /// A 2D column vector with 3 elements.
 struct B2_API b2Vec3
 {
@@ -292,16 +326,16 @@ struct B2_API b2Rot
 	explicit b2Rot(float angle)
 	{
 		/// TODO_ERIN optimize
-		s = sinf(angle);
-		c = cosf(angle);
+		s = b2Sin(angle);
+		c = b2Cos(angle);
 	}
 
 	/// Set using an angle in radians.
 	void Set(float angle)
 	{
 		/// TODO_ERIN optimize
-		s = sinf(angle);
-		c = cosf(angle);
+		s = b2Sin(angle);
+		c = b2Cos(angle);
 	}
 
 	/// Set to the identity rotation
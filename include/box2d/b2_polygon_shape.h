@@ -47,6 +47,14 @@ public:
 	/// may lead to poor stacking behavior.
 	void Set(const b2Vec2* points, int32 count);
 
+	/// Create a polygon from points that already form a convex hull. This skips the
+	/// welding and hull computation of Set, so it is much faster for procedural
+	/// geometry that is convex by construction.
+	/// The points must be in counter-clockwise order without duplicate or collinear
+	/// points and the count must be in the range [3, b2_maxPolygonVertices]. This is
+	/// only checked in debug builds.
+	void SetConvex(const b2Vec2* points, int32 count);
+
 	/// Build vertices to represent an axis-aligned box centered on the local origin.
 	/// @param hx the half-width.
 	/// @param hy the half-height.
@@ -59,6 +67,15 @@ public:
 	/// @param angle the rotation of the box in local coordinates.
 	void SetAsBox(float hx, float hy, const b2Vec2& center, float angle);
 
+	/// Round the corners of the polygon. The rounding is added to the collision skin
+	/// and is included in point tests, ray casts and mass. A rounded box only needs
+	/// four vertices.
+	/// @param radius the rounding radius, must not be negative.
+	void SetRounding(float radius);
+
+	/// Get the rounding radius, not including the collision skin.
+	float GetRounding() const;
+
 	/// @see b2Shape::TestPoint
 	bool TestPoint(const b2Transform& transform, const b2Vec2& p) const override;
 
@@ -82,8 +99,17 @@ public:
 	b2Vec2 m_vertices[b2_maxPolygonVertices];
 	b2Vec2 m_normals[b2_maxPolygonVertices];
 	int32 m_count;
+
+private:
+
+	void SetHull(const b2Vec2* points, int32 count);
 };
 
+/// Create many polygons. The points of polygon i follow the points of polygon i - 1
+/// and counts[i] is the number of points of polygon i.
+/// @param convex use SetConvex instead of Set.
+B2_API void b2SetPolygons(b2PolygonShape* polygons, const b2Vec2* points, const int32* counts, int32 polygonCount, bool convex);
+
 inline b2PolygonShape::b2PolygonShape()
 {
 	m_type = e_polygon;
@@ -92,4 +118,15 @@ inline b2PolygonShape::b2PolygonShape()
 	m_centroid.SetZero();
 }
 
+inline void b2PolygonShape::SetRounding(float radius)
+{
+	b2Assert(radius >= 0.0f);
+	m_radius = b2_polygonRadius + radius;
+}
+
+inline float b2PolygonShape::GetRounding() const
+{
+	return b2Max(m_radius - b2_polygonRadius, 0.0f);
+}
+
 #endif
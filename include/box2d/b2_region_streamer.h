@@ -0,0 +1,179 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_REGION_STREAMER_H
+#define B2_REGION_STREAMER_H
+
+#include "b2_api.h"
+#include "b2_dynamic_tree.h"
+#include "b2_math.h"
+#include "b2_settings.h"
+
+class b2Body;
+class b2World;
+struct b2FixtureDef;
+
+/// A region definition holds the static geometry of one tile of a large map.
+/// The geometry is only added to the world while the region is near a point of interest.
+struct B2_API b2RegionDef
+{
+	b2RegionDef()
+	{
+		position.SetZero();
+		angle = 0.0f;
+		fixtures = nullptr;
+		fixtureCount = 0;
+	}
+
+	/// The position of the static body that holds the region geometry. This is relative
+	/// to the world origin at the time the streamer was created, so the streamer keeps
+	/// working when the world origin moves. See b2World::GetOrigin.
+	b2Vec2 position;
+
+	/// The world angle of the static body in radians.
+	float angle;
+
+	/// The fixtures of the region. This array and the shapes it references are owned
+	/// by you and must remain in scope while the region is in the streamer.
+	const b2FixtureDef* fixtures;
+
+	/// The number of fixtures.
+	int32 fixtureCount;
+
+	/// The user data given to the static body when the region is loaded.
+	b2BodyUserData userData;
+};
+
+/// The region streamer loads and unloads the static geometry of a large map around
+/// points of interest. A loaded region is a static body whose proxies are inserted
+/// into the broad-phase in bulk. An unloaded region has no body, proxies or contacts,
+/// so the step time and memory of the world only depend on the loaded regions.
+class B2_API b2RegionStreamer
+{
+public:
+	/// Construct a streamer for a world. The world must outlive the streamer.
+	b2RegionStreamer(b2World* world);
+
+	/// Unloads all loaded regions.
+	~b2RegionStreamer();
+
+	/// Add a region. The region is not loaded until Update is called.
+	/// @return the region index.
+	int32 AddRegion(const b2RegionDef* def);
+
+	/// Set the streaming distances. A region is loaded when it is within the load
+	/// distance of a point of interest and unloaded when it is farther than the unload
+	/// distance from all of them. The unload distance should be larger to avoid
+	/// loading and unloading a region every step near the boundary.
+	void SetDistances(float loadDistance, float unloadDistance);
+
+	/// Load and unload regions around the points of interest. The points are world
+	/// points. This costs time proportional to the loaded regions and the regions
+	/// near the points.
+	/// @warning this function is locked during callbacks.
+	void Update(const b2Vec2* points, int32 pointCount);
+
+	/// Get the number of regions.
+	int32 GetRegionCount() const;
+
+	/// Get the number of loaded regions.
+	int32 GetLoadedCount() const;
+
+	/// Is this region loaded?
+	bool IsLoaded(int32 index) const;
+
+	/// Get the static body of a loaded region or nullptr if the region is not loaded.
+	b2Body* GetBody(int32 index) const;
+
+	/// Get the bounds of a region relative to the streamer origin.
+	const b2AABB& GetBounds(int32 index) const;
+
+	/// This is called from b2DynamicTree::Query.
+	bool QueryCallback(int32 proxyId);
+
+private:
+
+	struct b2Region
+	{
+		b2RegionDef def;
+		b2AABB bounds;
+		b2Body* body;
+		int32 loadedIndex;
+		bool queued;
+	};
+
+	void Load(int32 count);
+	void Unload(int32 index);
+
+	b2World* m_world;
+
+	b2DynamicTree m_tree;
+
+	b2Region* m_regions;
+	int32 m_regionCount;
+	int32 m_regionCapacity;
+
+	// Indices of the loaded regions.
+	int32* m_loaded;
+	int32 m_loadedCount;
+
+	// Regions to load in the current update.
+	int32* m_queue;
+	int32 m_queueCount;
+
+	// The world origin when the streamer was created.
+	b2Vec2d m_origin;
+
+	b2Vec2 m_queryPoint;
+	float m_loadDistance;
+	float m_unloadDistance;
+};
+
+inline int32 b2RegionStreamer::GetRegionCount() const
+{
+	return m_regionCount;
+}
+
+inline int32 b2RegionStreamer::GetLoadedCount() const
+{
+	return m_loadedCount;
+}
+
+inline bool b2RegionStreamer::IsLoaded(int32 index) const
+{
+	b2Assert(0 <= index && index < m_regionCount);
+	return m_regions[index].body != nullptr;
+}
+
+inline b2Body* b2RegionStreamer::GetBody(int32 index) const
+{
+	b2Assert(0 <= index && index < m_regionCount);
+	return m_regions[index].body;
+}
+
+inline const b2AABB& b2RegionStreamer::GetBounds(int32 index) const
+{
+	b2Assert(0 <= index && index < m_regionCount);
+	return m_regions[index].bounds;
+}
+
+#endif
@@ -164,6 +164,7 @@ public:
 protected:
 
 	friend class b2Joint;
+	friend class b2WideJointSolver;
 	friend class b2GearJoint;
 
 	b2RevoluteJoint(const b2RevoluteJointDef* def);
@@ -0,0 +1,309 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef B2_ROPE_SYSTEM_H
+#define B2_ROPE_SYSTEM_H
+
+#include "b2_api.h"
+#include "b2_fixture.h"
+#include "b2_math.h"
+#include "b2_rope.h"
+
+class b2Body;
+class b2Draw;
+class b2ThreadPool;
+class b2World;
+
+/// Columns of float and integer data with a shared count. This is an internal structure.
+struct b2RopeBuffer
+{
+	float* GetFloats(int32 field) const
+	{
+		return floats + field * capacity;
+	}
+
+	int32* GetInts(int32 field) const
+	{
+		return ints + field * capacity;
+	}
+
+	float* floats;
+	int32* ints;
+	int32 floatFieldCount;
+	int32 intFieldCount;
+	int32 count;
+	int32 capacity;
+};
+
+/// A rope vertex attached to a body. This is an internal structure.
+struct b2RopeAttachment
+{
+	b2Body* body;
+	b2Vec2 localAnchor;
+	int32 vertexIndex;
+
+	// Solver temporaries. The body doesn't move while the rope is solved, so each
+	// attachment tracks how far its own impulses would move the body.
+	b2Vec2 center;
+	b2Vec2 rA;
+	b2Vec2 deltaPosition;
+	float deltaAngle;
+	float invMass;
+	float invI;
+	b2Vec2 impulse;
+};
+
+/// A rope vertex touching a fixture. This is an internal structure.
+struct b2RopeContact
+{
+	b2Body* body;
+	b2Vec2 point;
+	b2Vec2 normal;
+	b2Vec2 rA;
+	float friction;
+	float tangentMotion;
+	float invMass;
+	float invI;
+	int32 vertexIndex;
+
+	// How far the body has been pushed back along the normal.
+	float separation;
+	float normalImpulse;
+	float tangentImpulse;
+};
+
+/// A rope in a rope system. This is an internal structure.
+struct b2RopeRecord
+{
+	b2RopeTuning tuning;
+	b2Vec2 position;
+	b2Vec2 gravity;
+	float radius;
+	b2Filter filter;
+
+	b2RopeAttachment* attachments;
+	int32 attachmentCount;
+	int32 attachmentCapacity;
+
+	b2RopeContact* contacts;
+	int32 contactCount;
+	int32 contactCapacity;
+
+	int32 vertexStart;
+	int32 vertexCount;
+
+	// The constraints are grouped by color. Constraints of the same color don't share
+	// vertices. Color c is in [starts[c], starts[c + 1]) and is padded to a multiple of
+	// the SIMD width.
+	int32 stretchStarts[3];
+	int32 bendStarts[4];
+};
+
+/// A rope system steps many ropes. This is like many b2Rope objects but the ropes
+/// share buffers, the constraints of a rope are solved several at a time with SIMD
+/// and the ropes are spread across the threads of an optional thread pool.
+/// Stretch constraints are solved in red-black order: even constraints first, then
+/// odd constraints. Bend constraints span three vertices so they use three colors.
+/// The results differ slightly from b2Rope, which solves the constraints in order.
+///
+/// Ropes can be coupled to a world. Rope vertices can be attached to bodies and ropes
+/// with a radius collide with the fixtures of the world. The rope pushes and pulls on
+/// dynamic bodies with impulses that are applied at the end of the rope step, so step
+/// the ropes after the world and never at the same time.
+class B2_API b2RopeSystem
+{
+public:
+	/// Construct a rope system. The pool is owned by you and must remain in scope.
+	/// It may be shared with other users, whose loops then run one after the other.
+	/// A null pool steps the ropes one at a time.
+	explicit b2RopeSystem(b2ThreadPool* pool);
+
+	~b2RopeSystem();
+
+	/// Create a rope. The definition is copied.
+	/// @return the index of the rope.
+	int32 CreateRope(const b2RopeDef& def);
+
+	/// Destroy a rope. The last rope takes its index.
+	void DestroyRope(int32 index);
+
+	/// Get the number of ropes.
+	int32 GetRopeCount() const;
+
+	/// Set the tuning of a rope.
+	void SetTuning(int32 index, const b2RopeTuning& tuning);
+
+	/// Get the tuning of a rope.
+	const b2RopeTuning& GetTuning(int32 index) const;
+
+	/// Move a rope. Vertices with zero mass follow the position.
+	/// This is the position given to b2Rope::Step.
+	void SetPosition(int32 index, const b2Vec2& position);
+
+	/// Get the position of a rope.
+	const b2Vec2& GetPosition(int32 index) const;
+
+	/// Put a rope back in its bind pose at the given position. See b2Rope::Reset.
+	void Reset(int32 index, const b2Vec2& position);
+
+	/// Get the number of vertices in a rope.
+	int32 GetVertexCount(int32 index) const;
+
+	/// Get the position of a rope vertex.
+	b2Vec2 GetVertex(int32 index, int32 vertexIndex) const;
+
+	/// Set the world the ropes collide with. Use null to disable collision.
+	void SetWorld(b2World* world);
+
+	/// Get the world the ropes collide with.
+	b2World* GetWorld() const;
+
+	/// Set the collision radius of a rope. A rope with zero radius doesn't collide.
+	/// The default is zero.
+	void SetRadius(int32 index, float radius);
+
+	/// Get the collision radius of a rope.
+	float GetRadius(int32 index) const;
+
+	/// Set the collision filter of a rope. This is tested against the filter data of
+	/// fixtures like b2ContactFilter does. Sensors are ignored.
+	void SetFilterData(int32 index, const b2Filter& filter);
+
+	/// Get the collision filter of a rope.
+	const b2Filter& GetFilterData(int32 index) const;
+
+	/// Attach a rope vertex to a point on a body. A vertex with mass pulls on the body
+	/// and a vertex with zero mass just follows the body. A rope doesn't collide with
+	/// the bodies it is attached to. Remove the attachments of a body with DetachBody
+	/// before destroying the body.
+	/// @param localAnchor the attachment point relative to the body origin.
+	void Attach(int32 index, int32 vertexIndex, b2Body* body, const b2Vec2& localAnchor);
+
+	/// Remove the attachment of a rope vertex, if any.
+	void Detach(int32 index, int32 vertexIndex);
+
+	/// Remove every attachment to a body.
+	void DetachBody(b2Body* body);
+
+	/// Get the number of attachments of a rope.
+	int32 GetAttachmentCount(int32 index) const;
+
+	/// Get the number of rope contacts found in the last step.
+	int32 GetContactCount() const;
+
+	/// Step every rope. See b2Rope::Step.
+	void Step(float timeStep, int32 iterations);
+
+	/// Shift the rope positions to follow b2World::ShiftOrigin. The world doesn't do
+	/// this for you. Call it from a b2OriginListener so the ropes also follow
+	/// automatic recentering.
+	void ShiftOrigin(const b2Vec2& newOrigin);
+
+	/// Draw every rope.
+	void Draw(b2Draw* draw) const;
+
+private:
+
+	friend struct b2RopeSystemTask;
+
+	b2RopeSystem(const b2RopeSystem&);
+	b2RopeSystem& operator=(const b2RopeSystem&);
+
+	void StepRope(int32 index, float dt, int32 iterations);
+	void ComputeSprings(int32 index);
+	void FindContacts(b2RopeRecord* rope, float dt);
+	void AddContacts(b2RopeRecord* rope, b2Fixture* fixture, const b2Shape* shape, int32 childIndex,
+					const b2AABB& shapeAABB, float dt);
+	void PrepareAttachments(b2RopeRecord* rope, float dt);
+	void SolveAttachments(b2RopeRecord* rope);
+	void SolveContacts(b2RopeRecord* rope);
+	void ApplyImpulses(float dt);
+
+	void SolveStretch_PBD(const b2RopeRecord& rope);
+	void SolveStretch_XPBD(const b2RopeRecord& rope, float dt);
+	void SolveBend_PBD_Angle(const b2RopeRecord& rope);
+	void SolveBend_XPBD_Angle(const b2RopeRecord& rope, float dt);
+	void SolveBend_PBD_Distance(const b2RopeRecord& rope);
+	void SolveBend_PBD_Height(const b2RopeRecord& rope);
+	void SolveBend_PBD_Triangle(const b2RopeRecord& rope);
+	void ApplyBendForces(const b2RopeRecord& rope, float dt);
+
+	b2ThreadPool* m_pool;
+	b2World* m_world;
+
+	b2RopeRecord* m_ropes;
+	int32 m_ropeCount;
+	int32 m_ropeCapacity;
+
+	b2RopeBuffer m_vertices;
+	b2RopeBuffer m_stretches;
+	b2RopeBuffer m_bends;
+};
+
+inline int32 b2RopeSystem::GetRopeCount() const
+{
+	return m_ropeCount;
+}
+
+inline const b2RopeTuning& b2RopeSystem::GetTuning(int32 index) const
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	return m_ropes[index].tuning;
+}
+
+inline const b2Vec2& b2RopeSystem::GetPosition(int32 index) const
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	return m_ropes[index].position;
+}
+
+inline b2World* b2RopeSystem::GetWorld() const
+{
+	return m_world;
+}
+
+inline float b2RopeSystem::GetRadius(int32 index) const
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	return m_ropes[index].radius;
+}
+
+inline const b2Filter& b2RopeSystem::GetFilterData(int32 index) const
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	return m_ropes[index].filter;
+}
+
+inline int32 b2RopeSystem::GetAttachmentCount(int32 index) const
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	return m_ropes[index].attachmentCount;
+}
+
+inline int32 b2RopeSystem::GetVertexCount(int32 index) const
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	return m_ropes[index].vertexCount;
+}
+
+#endif
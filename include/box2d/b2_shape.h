@@ -55,7 +55,8 @@ public:
 		e_edge = 1,
 		e_polygon = 2,
 		e_chain = 3,
-		e_typeCount = 4
+		e_compound = 4,
+		e_typeCount = 5
 	};
 
 	virtual ~b2Shape() {}
@@ -97,8 +98,8 @@ public:
 
 	Type m_type;
 
-	/// Radius of a shape. For polygonal shapes this must be b2_polygonRadius. There is no support for
-	/// making rounded polygons.
+	/// Radius of a shape. For polygonal shapes this is b2_polygonRadius plus the rounding
+	/// radius. See b2PolygonShape::SetRounding.
 	float m_radius;
 };
 
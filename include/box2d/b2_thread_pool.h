@@ -0,0 +1,74 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_THREAD_POOL_H
+#define B2_THREAD_POOL_H
+
+#include "b2_api.h"
+#include "b2_settings.h"
+
+struct b2ThreadPoolState;
+
+/// Task callback for b2ThreadPool::ParallelFor. This processes the items in [begin, end).
+/// The thread index is in [0, GetThreadCount()) and is unique among the threads running
+/// the task concurrently, so it can be used to index per thread scratch data.
+typedef void b2TaskCallback(int32 begin, int32 end, int32 threadIndex, void* context);
+
+/// A pool of worker threads that runs parallel loops. The items of a loop are split
+/// evenly among the threads and a thread that runs out of work steals half of the
+/// remaining items of another thread. The calling thread takes part in the loop.
+/// The pool may be shared by many users. Only one loop runs at a time: loops started
+/// from different threads wait for each other.
+class B2_API b2ThreadPool
+{
+public:
+	/// Create a pool with the given number of worker threads. Zero is valid
+	/// and runs every loop on the calling thread.
+	explicit b2ThreadPool(int32 workerCount);
+
+	/// Stops and joins the worker threads.
+	~b2ThreadPool();
+
+	/// Get the number of threads that run a loop. This includes the calling thread.
+	int32 GetThreadCount() const;
+
+	/// Run the callback over [0, itemCount) and return when all items are done.
+	/// @param minRange the smallest number of items a thread processes in one callback.
+	/// This may be called from several threads at once, the loops run one after the other.
+	/// @warning this is not re-entrant. Do not call it from a task callback.
+	void ParallelFor(int32 itemCount, int32 minRange, b2TaskCallback* callback, void* context);
+
+private:
+
+	b2ThreadPool(const b2ThreadPool&);
+	b2ThreadPool& operator=(const b2ThreadPool&);
+
+	b2ThreadPoolState* m_state;
+	int32 m_workerCount;
+};
+
+inline int32 b2ThreadPool::GetThreadCount() const
+{
+	return m_workerCount + 1;
+}
+
+#endif
@@ -27,6 +27,8 @@
 #include "b2_math.h"
 #include "b2_distance.h"
 
+class b2Shape;
+
 /// Input parameters for b2TimeOfImpact
 struct B2_API b2TOIInput
 {
@@ -60,4 +62,17 @@ struct B2_API b2TOIOutput
 /// Note: use b2Distance to compute the contact point and normal at the time of impact.
 B2_API void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input);
 
+/// Compute the time of impact using a simplex cache to warm start the distance queries.
+/// The cache is updated. Set cache->count to zero on the first call.
+B2_API void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input, b2SimplexCache* cache);
+
+/// Compute the time of impact between two shape children over the interval [0, tMax].
+/// Unlike b2TOIInput this supports compound shapes, which report the earliest impact of
+/// the polygons near the swept bounds of the other shape. The cache is only used when
+/// neither shape is a compound.
+B2_API void b2TimeOfImpact(b2TOIOutput* output,
+						const b2Shape* shapeA, int32 indexA, const b2Sweep& sweepA,
+						const b2Shape* shapeB, int32 indexB, const b2Sweep& sweepB,
+						float tMax, b2SimplexCache* cache);
+
 #endif
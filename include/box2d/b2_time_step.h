@@ -38,6 +38,17 @@ struct B2_API b2Profile
 	float solveTOI;
 };
 
+/// Counters for the last time step. These are reset at the beginning of each step.
+struct B2_API b2Counters
+{
+	int32 contactUpdates;	///< narrow-phase contact updates, including TOI updates
+	int32 manifoldReuses;	///< contact updates that reused the previous manifold
+	int32 gjkCalls;			///< calls to b2Distance
+	int32 gjkIters;			///< total GJK iterations
+	int32 toiCalls;			///< calls to b2TimeOfImpact
+	int32 proxyReinserts;	///< broad-phase proxies re-inserted into the tree
+};
+
 /// This is an internal structure.
 struct B2_API b2TimeStep
 {
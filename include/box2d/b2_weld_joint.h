@@ -98,6 +98,7 @@ public:
 protected:
 
 	friend class b2Joint;
+	friend class b2WideJointSolver;
 
 	b2WeldJoint(const b2WeldJointDef* def);
 
@@ -39,6 +39,40 @@ class b2Body;
 class b2Draw;
 class b2Fixture;
 class b2Joint;
+class b2Island;
+class b2QuerySnapshot;
+class b2ThreadPool;
+class b2TOIQueue;
+
+/// The maximum number of level of detail levels.
+#define b2_maxLODLevels		4
+
+/// The maximum number of level of detail focus points.
+#define b2_maxFocusPoints	8
+
+/// A level of detail for islands far from the focus points.
+struct B2_API b2LODLevel
+{
+	b2LODLevel()
+	{
+		distance = 0.0f;
+		stepInterval = 1;
+		velocityIterations = 0;
+		positionIterations = 0;
+	}
+
+	/// An island uses this level if every body is farther than this from all focus points.
+	float distance;
+
+	/// The island is stepped once every this many steps using the accumulated time.
+	int32 stepInterval;
+
+	/// The velocity iterations for this level. Zero uses the value given to Step.
+	int32 velocityIterations;
+
+	/// The position iterations for this level. Zero uses the value given to Step.
+	int32 positionIterations;
+};
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -57,6 +91,10 @@ public:
 	/// remain in scope.
 	void SetDestructionListener(b2DestructionListener* listener);
 
+	/// Register an origin listener. It is called whenever the origin moves, including
+	/// automatic recentering. The listener is owned by you and must remain in scope.
+	void SetOriginListener(b2OriginListener* listener);
+
 	/// Register a contact filter to provide specific control over collision.
 	/// Otherwise the default filter is used (b2_defaultFilter). The listener is
 	/// owned by you and must remain in scope.
@@ -118,6 +156,14 @@ public:
 	/// @param aabb the query box.
 	void QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const;
 
+	/// Query the world for all fixtures that overlap the provided shape. Unlike QueryAABB
+	/// the candidates from the broad-phase are tested exactly, so only fixtures that
+	/// touch the shape are reported. A chain fixture is reported once per overlapping edge.
+	/// @param callback a user implemented callback class.
+	/// @param shape a circle, edge, polygon, or compound shape.
+	/// @param transform the transform of the shape.
+	void QueryShape(b2QueryCallback* callback, const b2Shape* shape, const b2Transform& transform) const;
+
 	/// Ray-cast the world for all fixtures in the path of the ray. Your callback
 	/// controls whether you get the closest point, any point, or n-points.
 	/// The ray-cast ignores shapes that contain the starting point.
@@ -126,6 +172,49 @@ public:
 	/// @param point2 the ray ending point
 	void RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const;
 
+	/// Enable/disable query snapshots. When enabled, every Step ends by publishing a
+	/// read only copy of the broad-phase that holds the fixture transforms at that time.
+	/// QuerySnapshotAABB and RayCastSnapshot read the latest snapshot and may be called
+	/// from any number of threads, including while Step runs on another thread. They take
+	/// no locks. Destroyed bodies and fixtures are freed after the next snapshot is
+	/// published by Step or PublishQuerySnapshot, once no query reads an older one, so
+	/// reported fixtures stay valid for the duration of the callback. Until then queries
+	/// may still report destroyed fixtures. Only read fixture data that Step does not
+	/// write, such as the shape, filter, and user data. Snapshots must not be disabled
+	/// and the world must not be destroyed while snapshot queries are running.
+	void SetQuerySnapshots(bool flag);
+	bool GetQuerySnapshots() const { return m_querySnapshot != nullptr; }
+
+	/// Publish a query snapshot now, for example after creating or destroying bodies
+	/// outside of Step. This frees the bodies and fixtures destroyed since the last
+	/// publish. Query snapshots must be enabled.
+	void PublishQuerySnapshot();
+
+	/// Query the latest snapshot for all fixtures that potentially overlap the
+	/// provided AABB. This is thread safe. See SetQuerySnapshots.
+	/// @param callback a user implemented callback class.
+	/// @param aabb the query box.
+	void QuerySnapshotAABB(b2QueryCallback* callback, const b2AABB& aabb) const;
+
+	/// Ray-cast the latest snapshot. Shapes are tested at their published transforms.
+	/// This is thread safe. See SetQuerySnapshots and RayCast.
+	/// @param callback a user implemented callback class.
+	/// @param point1 the ray starting point
+	/// @param point2 the ray ending point
+	void RayCastSnapshot(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const;
+
+	/// Cast a shape through the world for all fixtures in its path. The shape moves
+	/// by the translation without rotating. Your callback controls whether you get
+	/// the closest hit, any hit, or all hits, as with RayCast. Each hit shrinks the
+	/// swept bounds used to search the broad-phase.
+	/// Fixtures that overlap the shape at the start are not reported.
+	/// @param callback a user implemented callback class.
+	/// @param shape a circle, edge, or polygon shape.
+	/// @param transform the initial transform of the shape.
+	/// @param translation the translation of the shape.
+	void ShapeCast(b2ShapeCastCallback* callback, const b2Shape* shape,
+				   const b2Transform& transform, const b2Vec2& translation) const;
+
 	/// Get the world body list. With the returned body, use b2Body::GetNext to get
 	/// the next body in the world list. A nullptr body indicates the end of the list.
 	/// @return the head of the world body list.
@@ -162,12 +251,39 @@ public:
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 	bool GetSubStepping() const { return m_subStepping; }
 
+	/// Enable/disable the soft step solver. The soft step solver divides the time step
+	/// into sub-steps and solves contacts as soft constraints with relaxation. This is
+	/// usually more stable for stacking with less work. The velocity iteration count is
+	/// ignored and the position iteration count only applies to joints.
+	void SetSoftStep(bool flag) { m_softStep = flag; }
+	bool GetSoftStep() const { return m_softStep; }
+
+	/// Set the number of sub-steps used by the soft step solver.
+	void SetSubStepCount(int32 count) { b2Assert(count > 0); m_subStepCount = count; }
+	int32 GetSubStepCount() const { return m_subStepCount; }
+
+	/// Enable/disable the wide joint solver. Revolute and weld joints are graph colored
+	/// and their velocity constraints are solved several joints at a time with SIMD.
+	/// This is faster for many articulated bodies, such as ragdolls. The joints are
+	/// solved in a different order so results differ from the default solver.
+	void SetWideJointSolver(bool flag) { m_wideJointSolver = flag; }
+	bool GetWideJointSolver() const { return m_wideJointSolver; }
+
+	/// Set a thread pool used to spread parts of the step across threads, or nullptr to
+	/// run the whole step on the calling thread (the default). Do not give a world the
+	/// pool of the b2WorldGroup that steps it because pool loops cannot be nested.
+	void SetThreadPool(b2ThreadPool* pool) { m_threadPool = pool; }
+	b2ThreadPool* GetThreadPool() const { return m_threadPool; }
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
 	/// Get the number of bodies.
 	int32 GetBodyCount() const;
 
+	/// Get the number of awake bodies.
+	int32 GetAwakeBodyCount() const;
+
 	/// Get the number of joints.
 	int32 GetJointCount() const;
 
@@ -201,15 +317,70 @@ public:
 
 	/// Shift the world origin. Useful for large worlds.
 	/// The body shift formula is: position -= newOrigin
+	/// This visits every body, joint and broad-phase proxy, so the cost grows with
+	/// the size of the world. The origin listener is called afterwards.
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Get the absolute position of the world origin. Body positions and all other world
+	/// coordinates are relative to this origin.
+	b2Vec2d GetOrigin() const;
+
+	/// Move the world origin to an absolute position. This shifts the world by the
+	/// difference between the new and old origins. See ShiftOrigin.
+	void SetOrigin(const b2Vec2d& origin);
+
+	/// Convert a world point to an absolute position.
+	b2Vec2d GetAbsolutePoint(const b2Vec2& point) const;
+
+	/// Convert an absolute position to a world point.
+	b2Vec2 GetLocalPoint(const b2Vec2d& point) const;
+
+	/// Enable automatic recentering for large worlds. When the focus point is farther
+	/// than the given distance from the origin, the next Step moves the origin to the
+	/// focus point snapped to a grid with this spacing. Moving the origin costs a
+	/// ShiftOrigin, including the sleeping bodies, but it only happens when the focus
+	/// crosses the distance. State kept outside the world, such as a b2RopeSystem,
+	/// must follow through a b2OriginListener. Use zero to disable (the default).
+	void SetRecenterDistance(float distance);
+	float GetRecenterDistance() const { return m_recenterDistance; }
+
+	/// Set the focus point for automatic recentering, usually the camera or player.
+	/// This is a world point and must be set again after the origin moves.
+	void SetFocus(const b2Vec2& focus) { m_focus = focus; }
+	const b2Vec2& GetFocus() const { return m_focus; }
+
+	/// Set the level of detail levels, sorted by increasing distance. Awake islands far from
+	/// the focus points are stepped less often and/or with fewer iterations. An island
+	/// that skips a step does not move during that step and catches up with a larger
+	/// time step later. Use a count of zero to disable (the default).
+	void SetLODLevels(const b2LODLevel* levels, int32 count);
+
+	/// Set the points that receive full simulation detail, usually the cameras or players.
+	void SetLODFocusPoints(const b2Vec2* points, int32 count);
+
 	/// Get the contact manager for testing.
 	const b2ContactManager& GetContactManager() const;
 
 	/// Get the current profile.
 	const b2Profile& GetProfile() const;
 
+	/// Get the counters for the last time step.
+	const b2Counters& GetCounters() const;
+
+	/// Compute a hash of the transform and velocity of every body and the impulses of
+	/// every contact. The bits of each value are hashed so two worlds only match if
+	/// their state is bit-identical. Use this to verify a rollback restore.
+	/// @warning this should be called outside of a time step.
+	uint32 ComputeStateHash() const;
+
+	/// Get the hash of the state written by the solver during the last time step. This
+	/// covers the bodies and contact impulses of every island that was simulated, including
+	/// time of impact sub-steps. Sleeping bodies are not included. This is accumulated as
+	/// the solver writes back results, so it is much cheaper than ComputeStateHash and
+	/// can be compared every step to detect a desync between peers.
+	uint32 GetStepHash() const;
+
 	/// Dump the world into the log file.
 	/// @warning this should be called outside of a time step.
 	void Dump();
@@ -220,12 +391,36 @@ private:
 	friend class b2Fixture;
 	friend class b2ContactManager;
 	friend class b2Controller;
+	friend class b2RegionStreamer;
 
 	void Solve(const b2TimeStep& step);
+	void SolveIsland(b2Island* island, const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
+	bool ComputeTOI(b2Contact* contact);
 
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
 
+	void EnableBodies(b2Body* const* bodies, int32 count);
+
+	// Destroyed fixtures and bodies are kept while query snapshots may report them.
+	void RetireFixture(b2Fixture* fixture);
+	void RetireBody(b2Body* body);
+
+	// Call after publishing. Waits for readers of older snapshots.
+	void FreeRetired();
+
+	void Recenter();
+	void MoveOrigin(const b2Vec2& newOrigin);
+
+	int32 ComputeLODLevel(const b2Island& island) const;
+
+	void AddAwakeBody(b2Body* body);
+	void RemoveAwakeBody(b2Body* body);
+	void WakeIsland(b2Body* seed);
+	void RemoveSleepingBodies();
+	void Collide();
+	void SynchronizeFixtures();
+
 	b2BlockAllocator m_blockAllocator;
 	b2StackAllocator m_stackAllocator;
 
@@ -237,10 +432,17 @@ private:
 	int32 m_bodyCount;
 	int32 m_jointCount;
 
+	// Every awake body is in this array. Bodies that fall asleep during a step
+	// are removed at the end of the step.
+	b2Body** m_awakeBodies;
+	int32 m_awakeCount;
+	int32 m_awakeCapacity;
+
 	b2Vec2 m_gravity;
 	bool m_allowSleep;
 
 	b2DestructionListener* m_destructionListener;
+	b2OriginListener* m_originListener;
 	b2Draw* m_debugDraw;
 
 	// This is used to compute the time step ratio to
@@ -255,10 +457,32 @@ private:
 	bool m_warmStarting;
 	bool m_continuousPhysics;
 	bool m_subStepping;
+	bool m_softStep;
+	bool m_wideJointSolver;
+	int32 m_subStepCount;
+
+	b2ThreadPool* m_threadPool;
+
+	b2QuerySnapshot* m_querySnapshot;
+	b2Fixture* m_retiredFixtures;
+	b2Body* m_retiredBodies;
 
 	bool m_stepComplete;
 
 	b2Profile m_profile;
+	b2Counters m_counters;
+	uint32 m_stepHash;
+
+	// Large world support.
+	b2Vec2d m_origin;
+	b2Vec2 m_focus;
+	float m_recenterDistance;
+
+	// Level of detail.
+	b2LODLevel m_lodLevels[b2_maxLODLevels];
+	int32 m_lodLevelCount;
+	b2Vec2 m_lodPoints[b2_maxFocusPoints];
+	int32 m_lodPointCount;
 };
 
 inline b2Body* b2World::GetBodyList()
@@ -296,6 +520,11 @@ inline int32 b2World::GetBodyCount() const
 	return m_bodyCount;
 }
 
+inline int32 b2World::GetAwakeBodyCount() const
+{
+	return m_awakeCount;
+}
+
 inline int32 b2World::GetJointCount() const
 {
 	return m_jointCount;
@@ -342,4 +571,29 @@ inline const b2Profile& b2World::GetProfile() const
 	return m_profile;
 }
 
+inline const b2Counters& b2World::GetCounters() const
+{
+	return m_counters;
+}
+
+inline uint32 b2World::GetStepHash() const
+{
+	return m_stepHash;
+}
+
+inline b2Vec2d b2World::GetOrigin() const
+{
+	return m_origin;
+}
+
+inline b2Vec2d b2World::GetAbsolutePoint(const b2Vec2& point) const
+{
+	return b2Vec2d(m_origin.x + double(point.x), m_origin.y + double(point.y));
+}
+
+inline b2Vec2 b2World::GetLocalPoint(const b2Vec2d& point) const
+{
+	return b2Vec2(float(point.x - m_origin.x), float(point.y - m_origin.y));
+}
+
 #endif
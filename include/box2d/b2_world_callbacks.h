@@ -32,6 +32,7 @@ class b2Fixture;
 class b2Body;
 class b2Joint;
 class b2Contact;
+class b2World;
 struct b2ContactResult;
 struct b2Manifold;
 
@@ -52,6 +53,19 @@ public:
 	virtual void SayGoodbye(b2Fixture* fixture) = 0;
 };
 
+/// Implement this listener to move your own state with the world origin, for
+/// example rope systems, particles and cameras. Automatic recentering moves the
+/// origin inside b2World::Step, so this is the only way to follow it.
+class B2_API b2OriginListener
+{
+public:
+	virtual ~b2OriginListener() {}
+
+	/// Called after the world origin moved. Subtract newOrigin from your world points.
+	/// @param newOrigin the new origin with respect to the old origin
+	virtual void ShiftOrigin(b2World* world, const b2Vec2& newOrigin) = 0;
+};
+
 /// Implement this class to provide collision filtering. In other words, you can implement
 /// this class if you want finer control over contact creation.
 class B2_API b2ContactFilter
@@ -116,6 +130,7 @@ public:
 	/// arbitrarily large if the sub-step is small. Hence the impulse is provided explicitly
 	/// in a separate data structure.
 	/// Note: this is only called for contacts that are touching, solid, and awake.
+	/// Note: compound shape contacts are reported once for each child manifold.
 	virtual void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse)
 	{
 		B2_NOT_USED(contact);
@@ -158,4 +173,27 @@ public:
 									const b2Vec2& normal, float fraction) = 0;
 };
 
+/// Callback class for shape casts.
+/// See b2World::ShapeCast
+class B2_API b2ShapeCastCallback
+{
+public:
+	virtual ~b2ShapeCastCallback() {}
+
+	/// Called for each fixture hit by the shape. You control how the shape cast
+	/// proceeds by returning a float:
+	/// return -1: ignore this fixture and continue
+	/// return 0: terminate the shape cast
+	/// return fraction: clip the translation to this point
+	/// return 1: don't clip the translation and continue
+	/// @param fixture the fixture hit by the shape
+	/// @param point the point of initial contact on the fixture
+	/// @param normal the surface normal of the fixture at the point of contact
+	/// @param fraction the fraction of the translation at the point of contact
+	/// @return -1 to filter, 0 to terminate, fraction to clip the translation for
+	/// closest hit, 1 to continue
+	virtual float ReportFixture(	b2Fixture* fixture, const b2Vec2& point,
+									const b2Vec2& normal, float fraction) = 0;
+};
+
 #endif
@@ -0,0 +1,102 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_WORLD_GROUP_H
+#define B2_WORLD_GROUP_H
+
+#include "b2_api.h"
+#include "b2_settings.h"
+
+class b2ThreadPool;
+class b2World;
+
+/// A world group steps many independent worlds concurrently on a shared thread pool.
+/// Each world is still stepped by one thread at a time, so the world callbacks
+/// (contact listener, destruction listener, etc.) may be called from any thread of
+/// the pool but never concurrently for the same world. Worlds in a group must not
+/// share listeners unless those listeners are thread-safe.
+/// The global GJK and TOI statistics (b2_gjkCalls, b2_toiCalls, etc.) are atomic and
+/// shared by all worlds, so they mix the counts of the whole group. Use
+/// b2World::GetCounters for the counts of a single world.
+class B2_API b2WorldGroup
+{
+public:
+	/// Construct a world group. The pool is owned by you and must remain in scope.
+	/// It may be shared with other groups, whose loops then run one after the other.
+	/// A null pool steps the worlds one at a time.
+	explicit b2WorldGroup(b2ThreadPool* pool);
+
+	~b2WorldGroup();
+
+	/// Add a world to the group. The world is owned by you and must remain in scope.
+	/// @return the index of the world in the group.
+	int32 AddWorld(b2World* world);
+
+	/// Remove a world from the group. The last world takes its index.
+	void RemoveWorld(b2World* world);
+
+	/// Get the number of worlds.
+	int32 GetWorldCount() const;
+
+	/// Get a world by index.
+	b2World* GetWorld(int32 index) const;
+
+	/// Step every world in the group. See b2World::Step.
+	void Step(float timeStep, int32 velocityIterations, int32 positionIterations);
+
+	/// Get the time taken to step the world at the given index during the last
+	/// call to Step, in milliseconds. Use this to spot expensive worlds.
+	float GetStepTime(int32 index) const;
+
+	/// Get the index of the world with the largest step time.
+	int32 GetSlowestWorld() const;
+
+private:
+
+	friend struct b2WorldGroupTask;
+
+	b2ThreadPool* m_pool;
+
+	b2World** m_worlds;
+	float* m_stepTimes;
+	int32 m_count;
+	int32 m_capacity;
+};
+
+inline int32 b2WorldGroup::GetWorldCount() const
+{
+	return m_count;
+}
+
+inline b2World* b2WorldGroup::GetWorld(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count);
+	return m_worlds[index];
+}
+
+inline float b2WorldGroup::GetStepTime(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count);
+	return m_stepTimes[index];
+}
+
+#endif
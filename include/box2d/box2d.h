@@ -27,10 +27,12 @@
 
 #include "b2_settings.h"
 #include "b2_draw.h"
+#include "b2_thread_pool.h"
 #include "b2_timer.h"
 
 #include "b2_chain_shape.h"
 #include "b2_circle_shape.h"
+#include "b2_compound_shape.h"
 #include "b2_edge_shape.h"
 #include "b2_polygon_shape.h"
 
@@ -40,9 +42,11 @@
 #include "b2_body.h"
 #include "b2_contact.h"
 #include "b2_fixture.h"
+#include "b2_region_streamer.h"
 #include "b2_time_step.h"
 #include "b2_world.h"
 #include "b2_world_callbacks.h"
+#include "b2_world_group.h"
 
 #include "b2_distance_joint.h"
 #include "b2_friction_joint.h"
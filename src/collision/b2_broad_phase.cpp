@@ -50,6 +50,16 @@ int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
 	return proxyId;
 }
 
+void b2BroadPhase::CreateProxies(int32 count, const b2AABB* aabbs, void* const* userData, int32* proxyIds)
+{
+	m_tree.CreateProxies(count, aabbs, userData, proxyIds);
+	m_proxyCount += count;
+	for (int32 i = 0; i < count; ++i)
+	{
+		BufferMove(proxyIds[i]);
+	}
+}
+
 void b2BroadPhase::DestroyProxy(int32 proxyId)
 {
 	UnBufferMove(proxyId);
@@ -66,6 +76,24 @@ void b2BroadPhase::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& di
 	}
 }
 
+void b2BroadPhase::MoveProxies(int32 count, const int32* proxyIds, const b2AABB* aabbs, const b2Vec2* displacements)
+{
+	// Make room so the tree can write the moved proxies straight into the move buffer.
+	if (m_moveCount + count > m_moveCapacity)
+	{
+		int32* oldBuffer = m_moveBuffer;
+		while (m_moveCount + count > m_moveCapacity)
+		{
+			m_moveCapacity *= 2;
+		}
+		m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+		memcpy(m_moveBuffer, oldBuffer, m_moveCount * sizeof(int32));
+		b2Free(oldBuffer);
+	}
+
+	m_moveCount += m_tree.MoveProxies(count, proxyIds, aabbs, displacements, m_moveBuffer + m_moveCount);
+}
+
 void b2BroadPhase::TouchProxy(int32 proxyId)
 {
 	BufferMove(proxyId);
@@ -266,6 +266,24 @@ static b2EPAxis b2ComputePolygonSeparation(const b2TempPolygon& polygonB, const
 	return axis;
 }
 
+// Search for the polygon normal that is most anti-parallel to the edge normal.
+static int32 b2FindIncidentIndex(const b2TempPolygon& polygon, const b2Vec2& normal)
+{
+	int32 bestIndex = 0;
+	float bestValue = b2Dot(normal, polygon.normals[0]);
+	for (int32 i = 1; i < polygon.count; ++i)
+	{
+		float value = b2Dot(normal, polygon.normals[i]);
+		if (value < bestValue)
+		{
+			bestValue = value;
+			bestIndex = i;
+		}
+	}
+
+	return bestIndex;
+}
+
 void b2CollideEdgeAndPolygon(b2Manifold* manifold,
 							const b2EdgeShape* edgeA, const b2Transform& xfA,
 							const b2PolygonShape* polygonB, const b2Transform& xfB)
@@ -329,6 +347,39 @@ void b2CollideEdgeAndPolygon(b2Manifold* manifold,
 		primaryAxis = edgeAxis;
 	}
 
+	// Rounded polygons have circular corners. When the closest features are a vertex
+	// of the edge and a vertex of the polygon the normal joins these vertices.
+	bool vertexContact = false;
+	int32 vertexA = 0;
+	int32 vertexB = 0;
+	if (radius > 2.0f * b2_polygonRadius && primaryAxis.separation > 0.1f * b2_linearSlop)
+	{
+		int32 i1 = primaryAxis.type == b2EPAxis::e_edgeA ? b2FindIncidentIndex(tempPolygonB, primaryAxis.normal) : primaryAxis.index;
+		int32 i2 = i1 + 1 < tempPolygonB.count ? i1 + 1 : 0;
+
+		float f1, f2;
+		b2SegmentDistance(&f1, &f2, v1, v2, tempPolygonB.vertices[i1], tempPolygonB.vertices[i2]);
+
+		if ((f1 == 0.0f || f1 == 1.0f) && (f2 == 0.0f || f2 == 1.0f))
+		{
+			vertexA = f1 == 0.0f ? 0 : 1;
+			vertexB = f2 == 0.0f ? i1 : i2;
+
+			b2Vec2 d = tempPolygonB.vertices[vertexB] - (vertexA == 0 ? v1 : v2);
+			float distance = d.Normalize();
+			if (distance > radius)
+			{
+				return;
+			}
+
+			if (distance > b2_epsilon)
+			{
+				primaryAxis.normal = d;
+				vertexContact = true;
+			}
+		}
+	}
+
 	if (oneSided)
 	{
 		// Smooth collision
@@ -364,6 +415,7 @@ void b2CollideEdgeAndPolygon(b2Manifold* manifold,
 			{
 				// Snap region
 				primaryAxis = edgeAxis;
+				vertexContact = false;
 			}
 		}
 		else
@@ -382,30 +434,33 @@ void b2CollideEdgeAndPolygon(b2Manifold* manifold,
 			{
 				// Snap region
 				primaryAxis = edgeAxis;
+				vertexContact = false;
 			}
 		}
 	}
 
+	if (vertexContact)
+	{
+		manifold->type = b2Manifold::e_circles;
+		manifold->localNormal.SetZero();
+		manifold->localPoint = vertexA == 0 ? v1 : v2;
+		manifold->pointCount = 1;
+		manifold->points[0].localPoint = polygonB->m_vertices[vertexB];
+		manifold->points[0].id.key = 0;
+		manifold->points[0].id.cf.indexA = static_cast<uint8>(vertexA);
+		manifold->points[0].id.cf.indexB = static_cast<uint8>(vertexB);
+		manifold->points[0].id.cf.typeA = b2ContactFeature::e_vertex;
+		manifold->points[0].id.cf.typeB = b2ContactFeature::e_vertex;
+		return;
+	}
+
 	b2ClipVertex clipPoints[2];
 	b2ReferenceFace ref;
 	if (primaryAxis.type == b2EPAxis::e_edgeA)
 	{
 		manifold->type = b2Manifold::e_faceA;
 
-		// Search for the polygon normal that is most anti-parallel to the edge normal.
-		int32 bestIndex = 0;
-		float bestValue = b2Dot(primaryAxis.normal, tempPolygonB.normals[0]);
-		for (int32 i = 1; i < tempPolygonB.count; ++i)
-		{
-			float value = b2Dot(primaryAxis.normal, tempPolygonB.normals[i]);
-			if (value < bestValue)
-			{
-				bestValue = value;
-				bestIndex = i;
-			}
-		}
-
-		int32 i1 = bestIndex;
+		int32 i1 = b2FindIncidentIndex(tempPolygonB, primaryAxis.normal);
 		int32 i2 = i1 + 1 < tempPolygonB.count ? i1 + 1 : 0;
 
 		clipPoints[0].v = tempPolygonB.vertices[i1];
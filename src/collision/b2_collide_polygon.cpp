@@ -23,6 +23,10 @@
 #include "box2d/b2_collision.h"
 #include "box2d/b2_polygon_shape.h"
 
+#include "b2_simd.h"
+
+#if defined(B2_SIMD_NONE)
+
 // Find the max separation between poly1 and poly2 using edge normals from poly1.
 static float b2FindMaxSeparation(int32* edgeIndex,
 								 const b2PolygonShape* poly1, const b2Transform& xf1,
@@ -65,6 +69,84 @@ static float b2FindMaxSeparation(int32* edgeIndex,
 	return maxSeparation;
 }
 
+#else
+
+// Find the max separation between poly1 and poly2 using edge normals from poly1.
+// The SIMD lanes hold the edges of poly1 so the loop over the vertices of poly2
+// needs no horizontal reduction. Lanes past the polygon count hold unused values
+// and are ignored.
+static float b2FindMaxSeparation(int32* edgeIndex,
+								 const b2PolygonShape* poly1, const b2Transform& xf1,
+								 const b2PolygonShape* poly2, const b2Transform& xf2)
+{
+	int32 count1 = poly1->m_count;
+	int32 count2 = poly2->m_count;
+	const b2Vec2* n1s = poly1->m_normals;
+	const b2Vec2* v1s = poly1->m_vertices;
+	const b2Vec2* v2s = poly2->m_vertices;
+	b2Transform xf = b2MulT(xf2, xf1);
+
+	b2FloatW c = b2SplatW(xf.q.c);
+	b2FloatW s = b2SplatW(xf.q.s);
+	b2FloatW px = b2SplatW(xf.p.x);
+	b2FloatW py = b2SplatW(xf.p.y);
+
+	alignas(16) float separations[b2_simdPolygonCapacity];
+	for (int32 i = 0; i < count1; i += b2_simdWidth)
+	{
+		b2FloatW nx0, ny0, vx0, vy0;
+		if (i + b2_simdWidth <= b2_maxPolygonVertices)
+		{
+			b2LoadPointsW(&nx0, &ny0, n1s + i);
+			b2LoadPointsW(&vx0, &vy0, v1s + i);
+		}
+		else
+		{
+			// The polygon arrays are not a multiple of the SIMD width.
+			b2Vec2 n1[b2_simdWidth], v1[b2_simdWidth];
+			for (int32 k = 0; k < b2_simdWidth; ++k)
+			{
+				n1[k] = i + k < count1 ? n1s[i + k] : n1s[0];
+				v1[k] = i + k < count1 ? v1s[i + k] : v1s[0];
+			}
+			b2LoadPointsW(&nx0, &ny0, n1);
+			b2LoadPointsW(&vx0, &vy0, v1);
+		}
+
+		// Get poly1 normals and vertices in frame2.
+		b2FloatW nx = b2SubW(b2MulW(c, nx0), b2MulW(s, ny0));
+		b2FloatW ny = b2AddW(b2MulW(s, nx0), b2MulW(c, ny0));
+		b2FloatW vx = b2AddW(b2SubW(b2MulW(c, vx0), b2MulW(s, vy0)), px);
+		b2FloatW vy = b2AddW(b2AddW(b2MulW(s, vx0), b2MulW(c, vy0)), py);
+		b2FloatW offset = b2AddW(b2MulW(nx, vx), b2MulW(ny, vy));
+
+		// Find deepest point for each normal.
+		b2FloatW si = b2SplatW(b2_maxFloat);
+		for (int32 j = 0; j < count2; ++j)
+		{
+			b2FloatW sij = b2AddW(b2MulW(nx, b2SplatW(v2s[j].x)), b2MulW(ny, b2SplatW(v2s[j].y)));
+			si = b2MinW(si, sij);
+		}
+
+		b2StoreW(separations + i, b2SubW(si, offset));
+	}
+
+	// Branch free search because the best edge is hard to predict.
+	int32 bestIndex = 0;
+	float maxSeparation = separations[0];
+	for (int32 i = 1; i < count1; ++i)
+	{
+		bool better = separations[i] > maxSeparation;
+		maxSeparation = better ? separations[i] : maxSeparation;
+		bestIndex = better ? i : bestIndex;
+	}
+
+	*edgeIndex = bestIndex;
+	return maxSeparation;
+}
+
+#endif
+
 static void b2FindIncidentEdge(b2ClipVertex c[2],
 							 const b2PolygonShape* poly1, const b2Transform& xf1, int32 edge1,
 							 const b2PolygonShape* poly2, const b2Transform& xf2)
@@ -110,58 +192,35 @@ static void b2FindIncidentEdge(b2ClipVertex c[2],
 	c[1].id.cf.typeB = b2ContactFeature::e_vertex;
 }
 
-// Find edge normal of max separation on A - return if separating axis is found
-// Find edge normal of max separation on B - return if separation axis is found
-// Choose reference edge as min(minA, minB)
-// Find incident edge
-// Clip
-
-// The normal points from 1 to 2
-void b2CollidePolygons(b2Manifold* manifold,
-					  const b2PolygonShape* polyA, const b2Transform& xfA,
-					  const b2PolygonShape* polyB, const b2Transform& xfB)
+// Compute the separation of poly2 along edge normal edge1 of poly1.
+static float b2EdgeSeparation(const b2PolygonShape* poly1, const b2Transform& xf1, int32 edge1,
+							  const b2PolygonShape* poly2, const b2Transform& xf2)
 {
-	manifold->pointCount = 0;
-	float totalRadius = polyA->m_radius + polyB->m_radius;
-
-	int32 edgeA = 0;
-	float separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
-	if (separationA > totalRadius)
-		return;
-
-	int32 edgeB = 0;
-	float separationB = b2FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
-	if (separationB > totalRadius)
-		return;
+	int32 count2 = poly2->m_count;
+	const b2Vec2* v2s = poly2->m_vertices;
+	b2Transform xf = b2MulT(xf2, xf1);
 
-	const b2PolygonShape* poly1;	// reference polygon
-	const b2PolygonShape* poly2;	// incident polygon
-	b2Transform xf1, xf2;
-	int32 edge1;					// reference edge
-	uint8 flip;
-	const float k_tol = 0.1f * b2_linearSlop;
+	// Get poly1 normal in frame2.
+	b2Vec2 n = b2Mul(xf.q, poly1->m_normals[edge1]);
+	b2Vec2 v1 = b2Mul(xf, poly1->m_vertices[edge1]);
 
-	if (separationB > separationA + k_tol)
-	{
-		poly1 = polyB;
-		poly2 = polyA;
-		xf1 = xfB;
-		xf2 = xfA;
-		edge1 = edgeB;
-		manifold->type = b2Manifold::e_faceB;
-		flip = 1;
-	}
-	else
+	float separation = b2_maxFloat;
+	for (int32 j = 0; j < count2; ++j)
 	{
-		poly1 = polyA;
-		poly2 = polyB;
-		xf1 = xfA;
-		xf2 = xfB;
-		edge1 = edgeA;
-		manifold->type = b2Manifold::e_faceA;
-		flip = 0;
+		separation = b2Min(separation, b2Dot(n, v2s[j] - v1));
 	}
 
+	return separation;
+}
+
+// Clip the incident edge of poly2 against the reference edge of poly1.
+static void b2ClipPolygons(b2Manifold* manifold,
+						   const b2PolygonShape* poly1, const b2Transform& xf1, int32 edge1,
+						   const b2PolygonShape* poly2, const b2Transform& xf2,
+						   uint8 flip, float totalRadius)
+{
+	manifold->type = flip ? b2Manifold::e_faceB : b2Manifold::e_faceA;
+
 	b2ClipVertex incidentEdge[2];
 	b2FindIncidentEdge(incidentEdge, poly1, xf1, edge1, poly2, xf2);
 
@@ -241,3 +300,190 @@ void b2CollidePolygons(b2Manifold* manifold,
 
 	manifold->pointCount = pointCount;
 }
+
+// Rounded polygons have circular corners. When the closest features of the cores
+// are two vertices the contact is between these corners and the clipped face
+// manifold would report points that are not touching. Returns false if the closest
+// features are not two vertices.
+static bool b2CollideRoundedCorners(b2Manifold* manifold,
+									const b2PolygonShape* poly1, const b2Transform& xf1, int32 edge1,
+									const b2PolygonShape* poly2, const b2Transform& xf2,
+									uint8 flip, float totalRadius)
+{
+	b2ClipVertex incidentEdge[2];
+	b2FindIncidentEdge(incidentEdge, poly1, xf1, edge1, poly2, xf2);
+
+	int32 i11 = edge1;
+	int32 i12 = edge1 + 1 < poly1->m_count ? edge1 + 1 : 0;
+	b2Vec2 v11 = b2Mul(xf1, poly1->m_vertices[i11]);
+	b2Vec2 v12 = b2Mul(xf1, poly1->m_vertices[i12]);
+
+	float f1, f2;
+	b2SegmentDistance(&f1, &f2, v11, v12, incidentEdge[0].v, incidentEdge[1].v);
+
+	bool vertex1 = f1 == 0.0f || f1 == 1.0f;
+	bool vertex2 = f2 == 0.0f || f2 == 1.0f;
+	if (vertex1 == false || vertex2 == false)
+	{
+		return false;
+	}
+
+	int32 index1 = f1 == 0.0f ? i11 : i12;
+	int32 index2 = f2 == 0.0f ? incidentEdge[0].id.cf.indexB : incidentEdge[1].id.cf.indexB;
+	b2Vec2 w1 = f1 == 0.0f ? v11 : v12;
+	b2Vec2 w2 = f2 == 0.0f ? incidentEdge[0].v : incidentEdge[1].v;
+
+	if (b2DistanceSquared(w1, w2) > totalRadius * totalRadius)
+	{
+		manifold->pointCount = 0;
+		return true;
+	}
+
+	// The circle manifold is expressed relative to shape A.
+	b2ContactFeature cf;
+	cf.typeA = b2ContactFeature::e_vertex;
+	cf.typeB = b2ContactFeature::e_vertex;
+	if (flip)
+	{
+		manifold->localPoint = poly2->m_vertices[index2];
+		manifold->points[0].localPoint = poly1->m_vertices[index1];
+		cf.indexA = (uint8)index2;
+		cf.indexB = (uint8)index1;
+	}
+	else
+	{
+		manifold->localPoint = poly1->m_vertices[index1];
+		manifold->points[0].localPoint = poly2->m_vertices[index2];
+		cf.indexA = (uint8)index1;
+		cf.indexB = (uint8)index2;
+	}
+
+	manifold->type = b2Manifold::e_circles;
+	manifold->localNormal.SetZero();
+	manifold->points[0].id.key = 0;
+	manifold->points[0].id.cf = cf;
+	manifold->pointCount = 1;
+	return true;
+}
+
+// Build the manifold for the reference edge of poly1.
+static void b2MakePolygonManifold(b2Manifold* manifold,
+								  const b2PolygonShape* poly1, const b2Transform& xf1, int32 edge1,
+								  const b2PolygonShape* poly2, const b2Transform& xf2,
+								  uint8 flip, float totalRadius, float separation)
+{
+	// Polygons without rounding keep the face manifold at corners so that box
+	// stacking is unchanged. Deep contact always uses the face manifold.
+	bool rounded = poly1->m_radius + poly2->m_radius > 2.0f * b2_polygonRadius;
+	if (rounded && separation > 0.1f * b2_linearSlop)
+	{
+		if (b2CollideRoundedCorners(manifold, poly1, xf1, edge1, poly2, xf2, flip, totalRadius))
+		{
+			return;
+		}
+	}
+
+	b2ClipPolygons(manifold, poly1, xf1, edge1, poly2, xf2, flip, totalRadius);
+}
+
+// Find edge normal of max separation on A - return if separating axis is found
+// Find edge normal of max separation on B - return if separation axis is found
+// Choose reference edge as min(minA, minB)
+// Find incident edge
+// Clip
+
+// The normal points from 1 to 2
+void b2CollidePolygons(b2Manifold* manifold,
+					  const b2PolygonShape* polyA, const b2Transform& xfA,
+					  const b2PolygonShape* polyB, const b2Transform& xfB)
+{
+	b2PolygonCache cache;
+	cache.count = 0;
+	b2CollidePolygons(manifold, polyA, xfA, polyB, xfB, &cache);
+}
+
+void b2CollidePolygons(b2Manifold* manifold,
+					  const b2PolygonShape* polyA, const b2Transform& xfA,
+					  const b2PolygonShape* polyB, const b2Transform& xfB,
+					  b2PolygonCache* cache)
+{
+	manifold->pointCount = 0;
+	float totalRadius = polyA->m_radius + polyB->m_radius;
+
+	// Relative motion allowed before a cached reference face is discarded.
+	const float k_linearTol = 0.25f * b2_linearSlop;
+	const float k_angularTol = 0.25f * b2_angularSlop;
+
+	b2Transform relativeTransform = b2MulT(xfA, xfB);
+
+	if (cache->count > 0)
+	{
+		const b2PolygonShape* poly1 = cache->flip ? polyB : polyA;
+		const b2PolygonShape* poly2 = cache->flip ? polyA : polyB;
+		const b2Transform& xf1 = cache->flip ? xfB : xfA;
+		const b2Transform& xf2 = cache->flip ? xfA : xfB;
+		int32 edge1 = cache->edge;
+
+		// The shapes may have been modified.
+		if (edge1 < poly1->m_count)
+		{
+			// A separating axis is valid regardless of motion.
+			float separation = b2EdgeSeparation(poly1, xf1, edge1, poly2, xf2);
+			if (separation > totalRadius)
+			{
+				return;
+			}
+
+			if (cache->touching)
+			{
+				// Small angle approximation of the relative rotation.
+				b2Vec2 dp = relativeTransform.p - cache->relativeTransform.p;
+				b2Rot dq = b2MulT(cache->relativeTransform.q, relativeTransform.q);
+				if (b2Dot(dp, dp) < k_linearTol * k_linearTol && dq.c > 0.0f && b2Abs(dq.s) < k_angularTol)
+				{
+					b2MakePolygonManifold(manifold, poly1, xf1, edge1, poly2, xf2, cache->flip, totalRadius, separation);
+					return;
+				}
+			}
+		}
+	}
+
+	cache->relativeTransform = relativeTransform;
+	cache->count = 1;
+
+	int32 edgeA = 0;
+	float separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
+	if (separationA > totalRadius)
+	{
+		cache->edge = (uint8)edgeA;
+		cache->flip = 0;
+		cache->touching = 0;
+		return;
+	}
+
+	int32 edgeB = 0;
+	float separationB = b2FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
+	if (separationB > totalRadius)
+	{
+		cache->edge = (uint8)edgeB;
+		cache->flip = 1;
+		cache->touching = 0;
+		return;
+	}
+
+	const float k_tol = 0.1f * b2_linearSlop;
+
+	cache->touching = 1;
+	if (separationB > separationA + k_tol)
+	{
+		cache->edge = (uint8)edgeB;
+		cache->flip = 1;
+		b2MakePolygonManifold(manifold, polyB, xfB, edgeB, polyA, xfA, 1, totalRadius, separationB);
+	}
+	else
+	{
+		cache->edge = (uint8)edgeA;
+		cache->flip = 0;
+		b2MakePolygonManifold(manifold, polyA, xfA, edgeA, polyB, xfB, 0, totalRadius, separationA);
+	}
+}
@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #include "box2d/b2_collision.h"
+#include "box2d/b2_compound_shape.h"
 #include "box2d/b2_distance.h"
 
 void b2WorldManifold::Initialize(const b2Manifold* manifold,
@@ -236,10 +237,92 @@ int32 b2ClipSegmentToLine(b2ClipVertex vOut[2], const b2ClipVertex vIn[2],
 	return count;
 }
 
+void b2SegmentDistance(float* fraction1, float* fraction2,
+					   const b2Vec2& p1, const b2Vec2& q1, const b2Vec2& p2, const b2Vec2& q2)
+{
+	b2Vec2 d1 = q1 - p1;
+	b2Vec2 d2 = q2 - p2;
+	b2Vec2 r = p1 - p2;
+	float dd1 = b2Dot(d1, d1);
+	float dd2 = b2Dot(d2, d2);
+	float rd1 = b2Dot(r, d1);
+	float rd2 = b2Dot(r, d2);
+
+	const float epsSqr = b2_epsilon * b2_epsilon;
+
+	float f1 = 0.0f;
+	float f2 = 0.0f;
+
+	if (dd1 < epsSqr || dd2 < epsSqr)
+	{
+		// Degenerate segments.
+		if (dd1 >= epsSqr)
+		{
+			f1 = b2Clamp(-rd1 / dd1, 0.0f, 1.0f);
+		}
+		else if (dd2 >= epsSqr)
+		{
+			f2 = b2Clamp(rd2 / dd2, 0.0f, 1.0f);
+		}
+	}
+	else
+	{
+		// Non-degenerate segments.
+		float d12 = b2Dot(d1, d2);
+		float denom = dd1 * dd2 - d12 * d12;
+
+		// Parallel segments use the start of segment 1.
+		if (denom != 0.0f)
+		{
+			f1 = b2Clamp((d12 * rd2 - rd1 * dd2) / denom, 0.0f, 1.0f);
+		}
+
+		// Compute point on segment 2 closest to p1 + f1 * d1.
+		f2 = (d12 * f1 + rd2) / dd2;
+
+		// Clamping of segment 2 requires a do over on segment 1.
+		if (f2 < 0.0f)
+		{
+			f2 = 0.0f;
+			f1 = b2Clamp(-rd1 / dd1, 0.0f, 1.0f);
+		}
+		else if (f2 > 1.0f)
+		{
+			f2 = 1.0f;
+			f1 = b2Clamp((d12 - rd1) / dd1, 0.0f, 1.0f);
+		}
+	}
+
+	*fraction1 = f1;
+	*fraction2 = f2;
+}
+
 bool b2TestOverlap(	const b2Shape* shapeA, int32 indexA,
 					const b2Shape* shapeB, int32 indexB,
 					const b2Transform& xfA, const b2Transform& xfB)
 {
+	b2SimplexCache cache;
+	cache.count = 0;
+
+	return b2TestOverlap(shapeA, indexA, shapeB, indexB, xfA, xfB, &cache);
+}
+
+bool b2TestOverlap(	const b2Shape* shapeA, int32 indexA,
+					const b2Shape* shapeB, int32 indexB,
+					const b2Transform& xfA, const b2Transform& xfB,
+					b2SimplexCache* cache)
+{
+	if (shapeA->GetType() == b2Shape::e_compound)
+	{
+		const b2CompoundShape* compound = (const b2CompoundShape*)shapeA;
+		return compound->TestOverlap(xfA, shapeB, indexB, xfB);
+	}
+
+	if (shapeB->GetType() == b2Shape::e_compound)
+	{
+		return b2TestOverlap(shapeB, indexB, shapeA, indexA, xfB, xfA, cache);
+	}
+
 	b2DistanceInput input;
 	input.proxyA.Set(shapeA, indexA);
 	input.proxyB.Set(shapeB, indexB);
@@ -247,12 +330,9 @@ bool b2TestOverlap(	const b2Shape* shapeA, int32 indexA,
 	input.transformB = xfB;
 	input.useRadii = true;
 
-	b2SimplexCache cache;
-	cache.count = 0;
-
 	b2DistanceOutput output;
 
-	b2Distance(&output, &cache, &input);
+	b2Distance(&output, cache, &input);
 
 	return output.distance < 10.0f * b2_epsilon;
 }
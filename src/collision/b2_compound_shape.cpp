@@ -0,0 +1,467 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_compound_shape.h"
+#include "box2d/b2_block_allocator.h"
+
+#include <algorithm>
+#include <new>
+#include <string.h>
+
+b2CompoundShape::~b2CompoundShape()
+{
+	Clear();
+}
+
+void b2CompoundShape::Clear()
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_polygons[i].~b2PolygonShape();
+	}
+
+	b2Free(m_polygons);
+	b2Free(m_nodes);
+	b2Free(m_hull);
+	m_polygons = nullptr;
+	m_count = 0;
+	m_nodes = nullptr;
+	m_nodeCount = 0;
+	m_hull = nullptr;
+	m_hullCount = 0;
+}
+
+// Build the subtree over the given polygons in pre-order and return its root.
+// Splitting at the median center along the longest axis keeps the depth logarithmic.
+static int32 b2BuildNode(b2CompoundNode* nodes, int32* nodeCount, int32* indices, int32 count,
+						const b2AABB* boxes, const b2Vec2* centers)
+{
+	int32 nodeIndex = *nodeCount;
+	*nodeCount += 1;
+
+	b2CompoundNode* node = nodes + nodeIndex;
+	node->aabb = boxes[indices[0]];
+	b2Vec2 lower = centers[indices[0]];
+	b2Vec2 upper = lower;
+	for (int32 i = 1; i < count; ++i)
+	{
+		node->aabb.Combine(boxes[indices[i]]);
+		lower = b2Min(lower, centers[indices[i]]);
+		upper = b2Max(upper, centers[indices[i]]);
+	}
+
+	if (count == 1)
+	{
+		node->child1 = -1;
+		node->child2 = -1;
+		node->polygonIndex = indices[0];
+		return nodeIndex;
+	}
+
+	b2Vec2 extent = upper - lower;
+	int32 half = count / 2;
+	if (extent.x > extent.y)
+	{
+		std::nth_element(indices, indices + half, indices + count,
+			[centers](int32 a, int32 b) { return centers[a].x < centers[b].x; });
+	}
+	else
+	{
+		std::nth_element(indices, indices + half, indices + count,
+			[centers](int32 a, int32 b) { return centers[a].y < centers[b].y; });
+	}
+
+	int32 child1 = b2BuildNode(nodes, nodeCount, indices, half, boxes, centers);
+	int32 child2 = b2BuildNode(nodes, nodeCount, indices + half, count - half, boxes, centers);
+
+	node = nodes + nodeIndex;
+	node->child1 = child1;
+	node->child2 = child2;
+	node->polygonIndex = -1;
+	return nodeIndex;
+}
+
+// Andrew's monotone chain. Sorts the points and returns the hull count.
+static int32 b2ComputeCompoundHull(b2Vec2* hull, b2Vec2* points, int32 count)
+{
+	std::sort(points, points + count, [](const b2Vec2& a, const b2Vec2& b)
+	{
+		return a.x < b.x || (a.x == b.x && a.y < b.y);
+	});
+
+	int32 n = 0;
+
+	// Lower hull
+	for (int32 i = 0; i < count; ++i)
+	{
+		while (n >= 2 && b2Cross(hull[n - 1] - hull[n - 2], points[i] - hull[n - 2]) <= 0.0f)
+		{
+			--n;
+		}
+		hull[n++] = points[i];
+	}
+
+	// Upper hull
+	int32 lowerCount = n + 1;
+	for (int32 i = count - 2; i >= 0; --i)
+	{
+		while (n >= lowerCount && b2Cross(hull[n - 1] - hull[n - 2], points[i] - hull[n - 2]) <= 0.0f)
+		{
+			--n;
+		}
+		hull[n++] = points[i];
+	}
+
+	// The last point repeats the first.
+	return n - 1;
+}
+
+void b2CompoundShape::Create(const b2PolygonShape* polygons, int32 count)
+{
+	b2Assert(m_polygons == nullptr && m_count == 0);
+	b2Assert(count >= 1);
+	if (count < 1)
+	{
+		return;
+	}
+
+	m_radius = polygons[0].m_radius;
+
+	m_count = count;
+	m_polygons = (b2PolygonShape*)b2Alloc(count * sizeof(b2PolygonShape));
+	int32 vertexCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		// Child manifolds are evaluated with the compound radius.
+		b2Assert(polygons[i].m_radius == m_radius);
+		b2Assert(polygons[i].m_count >= 3);
+		new (m_polygons + i) b2PolygonShape(polygons[i]);
+		vertexCount += polygons[i].m_count;
+	}
+
+	// Build the hierarchy.
+	b2AABB* boxes = (b2AABB*)b2Alloc(count * sizeof(b2AABB));
+	b2Vec2* centers = (b2Vec2*)b2Alloc(count * sizeof(b2Vec2));
+	int32* indices = (int32*)b2Alloc(count * sizeof(int32));
+
+	b2Transform identity;
+	identity.SetIdentity();
+	for (int32 i = 0; i < count; ++i)
+	{
+		m_polygons[i].ComputeAABB(boxes + i, identity, 0);
+		centers[i] = boxes[i].GetCenter();
+		indices[i] = i;
+	}
+
+	m_nodes = (b2CompoundNode*)b2Alloc((2 * count - 1) * sizeof(b2CompoundNode));
+	m_nodeCount = 0;
+	b2BuildNode(m_nodes, &m_nodeCount, indices, count, boxes, centers);
+	b2Assert(m_nodeCount == 2 * count - 1);
+
+	b2Free(indices);
+	b2Free(centers);
+	b2Free(boxes);
+
+	// Hull of all vertices for fast bounds.
+	b2Vec2* points = (b2Vec2*)b2Alloc(vertexCount * sizeof(b2Vec2));
+	int32 pointCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		memcpy(points + pointCount, m_polygons[i].m_vertices, m_polygons[i].m_count * sizeof(b2Vec2));
+		pointCount += m_polygons[i].m_count;
+	}
+
+	b2Vec2* hull = (b2Vec2*)b2Alloc(2 * vertexCount * sizeof(b2Vec2));
+	m_hullCount = b2ComputeCompoundHull(hull, points, pointCount);
+	m_hull = (b2Vec2*)b2Alloc(m_hullCount * sizeof(b2Vec2));
+	memcpy(m_hull, hull, m_hullCount * sizeof(b2Vec2));
+
+	b2Free(hull);
+	b2Free(points);
+}
+
+b2Shape* b2CompoundShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2CompoundShape));
+	b2CompoundShape* clone = new (mem) b2CompoundShape;
+	clone->m_radius = m_radius;
+
+	clone->m_count = m_count;
+	clone->m_polygons = (b2PolygonShape*)b2Alloc(m_count * sizeof(b2PolygonShape));
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		new (clone->m_polygons + i) b2PolygonShape(m_polygons[i]);
+	}
+
+	clone->m_nodeCount = m_nodeCount;
+	clone->m_nodes = (b2CompoundNode*)b2Alloc(m_nodeCount * sizeof(b2CompoundNode));
+	memcpy(clone->m_nodes, m_nodes, m_nodeCount * sizeof(b2CompoundNode));
+
+	clone->m_hullCount = m_hullCount;
+	clone->m_hull = (b2Vec2*)b2Alloc(m_hullCount * sizeof(b2Vec2));
+	memcpy(clone->m_hull, m_hull, m_hullCount * sizeof(b2Vec2));
+	return clone;
+}
+
+int32 b2CompoundShape::GetChildCount() const
+{
+	return 1;
+}
+
+struct b2CompoundPointCallback
+{
+	bool QueryCallback(int32 index)
+	{
+		hit = compound->m_polygons[index].TestPoint(*transform, point);
+		return hit == false;
+	}
+
+	const b2CompoundShape* compound;
+	const b2Transform* transform;
+	b2Vec2 point;
+	bool hit;
+};
+
+bool b2CompoundShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
+{
+	b2Vec2 localPoint = b2MulT(xf, p);
+
+	b2CompoundPointCallback callback;
+	callback.compound = this;
+	callback.transform = &xf;
+	callback.point = p;
+	callback.hit = false;
+
+	b2AABB aabb;
+	aabb.lowerBound = localPoint;
+	aabb.upperBound = localPoint;
+	Query(&callback, aabb);
+
+	return callback.hit;
+}
+
+// Test a segment p1 + t * d for t in [0, maxFraction] against a box.
+static bool b2TestSegment(const b2AABB& aabb, const b2Vec2& p1, const b2Vec2& d, float maxFraction)
+{
+	float tmin = 0.0f;
+	float tmax = maxFraction;
+
+	for (int32 i = 0; i < 2; ++i)
+	{
+		float p = i == 0 ? p1.x : p1.y;
+		float dir = i == 0 ? d.x : d.y;
+		float lower = i == 0 ? aabb.lowerBound.x : aabb.lowerBound.y;
+		float upper = i == 0 ? aabb.upperBound.x : aabb.upperBound.y;
+
+		if (b2Abs(dir) < b2_epsilon)
+		{
+			if (p < lower || upper < p)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			float inv = 1.0f / dir;
+			float t1 = (lower - p) * inv;
+			float t2 = (upper - p) * inv;
+			tmin = b2Max(tmin, b2Min(t1, t2));
+			tmax = b2Min(tmax, b2Max(t1, t2));
+
+			if (tmax < tmin)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool b2CompoundShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+								const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	int32 polygonIndex;
+	return RayCast(output, &polygonIndex, input, xf);
+}
+
+bool b2CompoundShape::RayCast(b2RayCastOutput* output, int32* polygonIndex, const b2RayCastInput& input,
+								const b2Transform& xf) const
+{
+	*polygonIndex = -1;
+
+	if (m_nodeCount == 0)
+	{
+		return false;
+	}
+
+	// Put the ray into the compound's frame of reference.
+	b2Vec2 p1 = b2MulT(xf, input.p1);
+	b2Vec2 d = b2MulT(xf.q, input.p2 - input.p1);
+
+	// The closest hit so far clips the ray.
+	b2RayCastInput subInput = input;
+
+	b2GrowableStack<int32, 64> stack;
+	stack.Push(0);
+
+	while (stack.GetCount() > 0)
+	{
+		const b2CompoundNode* node = m_nodes + stack.Pop();
+		if (b2TestSegment(node->aabb, p1, d, subInput.maxFraction) == false)
+		{
+			continue;
+		}
+
+		if (node->IsLeaf())
+		{
+			b2RayCastOutput subOutput;
+			if (m_polygons[node->polygonIndex].RayCast(&subOutput, subInput, xf, 0))
+			{
+				*output = subOutput;
+				*polygonIndex = node->polygonIndex;
+				subInput.maxFraction = subOutput.fraction;
+			}
+		}
+		else
+		{
+			stack.Push(node->child1);
+			stack.Push(node->child2);
+		}
+	}
+
+	return *polygonIndex != -1;
+}
+
+void b2CompoundShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+	b2Assert(m_hullCount > 0);
+
+	b2Vec2 lower = b2Mul(xf, m_hull[0]);
+	b2Vec2 upper = lower;
+
+	for (int32 i = 1; i < m_hullCount; ++i)
+	{
+		b2Vec2 v = b2Mul(xf, m_hull[i]);
+		lower = b2Min(lower, v);
+		upper = b2Max(upper, v);
+	}
+
+	b2Vec2 r(m_radius, m_radius);
+	aabb->lowerBound = lower - r;
+	aabb->upperBound = upper + r;
+}
+
+void b2CompoundShape::ComputeMass(b2MassData* massData, float density) const
+{
+	float mass = 0.0f;
+	b2Vec2 center(0.0f, 0.0f);
+	float I = 0.0f;
+
+	// The polygon inertia is about the shape origin, so it can be summed directly.
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2MassData polygonMass;
+		m_polygons[i].ComputeMass(&polygonMass, density);
+		mass += polygonMass.mass;
+		center += polygonMass.mass * polygonMass.center;
+		I += polygonMass.I;
+	}
+
+	if (mass > 0.0f)
+	{
+		center *= 1.0f / mass;
+	}
+
+	massData->mass = mass;
+	massData->center = center;
+	massData->I = I;
+}
+
+struct b2CompoundOverlapCallback
+{
+	bool QueryCallback(int32 index)
+	{
+		hit = b2TestOverlap(compound->m_polygons + index, 0, shape, childIndex, *xfA, *xfB);
+		return hit == false;
+	}
+
+	const b2CompoundShape* compound;
+	const b2Shape* shape;
+	int32 childIndex;
+	const b2Transform* xfA;
+	const b2Transform* xfB;
+	bool hit;
+};
+
+// Tests the polygons of compound B near compound A against A.
+struct b2CompoundPairOverlapCallback
+{
+	bool QueryCallback(int32 index)
+	{
+		hit = compoundA->TestOverlap(*xfA, compoundB->m_polygons + index, 0, *xfB);
+		return hit == false;
+	}
+
+	const b2CompoundShape* compoundA;
+	const b2CompoundShape* compoundB;
+	const b2Transform* xfA;
+	const b2Transform* xfB;
+	bool hit;
+};
+
+bool b2CompoundShape::TestOverlap(const b2Transform& xf, const b2Shape* shape, int32 childIndex, const b2Transform& shapeTransform) const
+{
+	if (shape->GetType() == e_compound)
+	{
+		b2CompoundPairOverlapCallback callback;
+		callback.compoundA = this;
+		callback.compoundB = (const b2CompoundShape*)shape;
+		callback.xfA = &xf;
+		callback.xfB = &shapeTransform;
+		callback.hit = false;
+
+		// Bounds of this compound in the frame of the other.
+		b2AABB aabb;
+		ComputeAABB(&aabb, b2MulT(shapeTransform, xf), 0);
+		callback.compoundB->Query(&callback, aabb);
+		return callback.hit;
+	}
+
+	// Bounds of the other shape in the compound's frame.
+	b2AABB aabb;
+	shape->ComputeAABB(&aabb, b2MulT(xf, shapeTransform), childIndex);
+
+	b2CompoundOverlapCallback callback;
+	callback.compound = this;
+	callback.shape = shape;
+	callback.childIndex = childIndex;
+	callback.xfA = &xf;
+	callback.xfB = &shapeTransform;
+	callback.hit = false;
+	Query(&callback, aabb);
+
+	return callback.hit;
+}
@@ -26,8 +26,24 @@
 #include "box2d/b2_chain_shape.h"
 #include "box2d/b2_polygon_shape.h"
 
+#include <atomic>
+
 // GJK using Voronoi regions (Christer Ericson) and Barycentric coordinates.
-B2_API int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+// The global statistics are atomic because worlds may be stepped on several threads.
+// They are only statistics, so relaxed ordering is enough.
+B2_API std::atomic<int32> b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+
+// Per thread counts used for the world counters. These stay accurate when
+// several worlds are stepped on different threads.
+thread_local int32 b2_gjkThreadCalls, b2_gjkThreadIters;
+
+static void b2AtomicMax(std::atomic<int32>& a, int32 value)
+{
+	int32 current = a.load(std::memory_order_relaxed);
+	while (value > current && a.compare_exchange_weak(current, value, std::memory_order_relaxed) == false)
+	{
+	}
+}
 
 void b2DistanceProxy::Set(const b2Shape* shape, int32 index)
 {
@@ -455,7 +471,8 @@ void b2Distance(b2DistanceOutput* output,
 				b2SimplexCache* cache,
 				const b2DistanceInput* input)
 {
-	++b2_gjkCalls;
+	b2_gjkCalls.fetch_add(1, std::memory_order_relaxed);
+	++b2_gjkThreadCalls;
 
 	const b2DistanceProxy* proxyA = &input->proxyA;
 	const b2DistanceProxy* proxyB = &input->proxyB;
@@ -536,7 +553,7 @@ void b2Distance(b2DistanceOutput* output,
 
 		// Iteration count is equated to the number of support point calls.
 		++iter;
-		++b2_gjkIters;
+		++b2_gjkThreadIters;
 
 		// Check for duplicate support points. This is the main termination criteria.
 		bool duplicate = false;
@@ -559,7 +576,8 @@ void b2Distance(b2DistanceOutput* output,
 		++simplex.m_count;
 	}
 
-	b2_gjkMaxIters = b2Max(b2_gjkMaxIters, iter);
+	b2_gjkIters.fetch_add(iter, std::memory_order_relaxed);
+	b2AtomicMax(b2_gjkMaxIters, iter);
 
 	// Prepare output.
 	simplex.GetWitnessPoints(&output->pointA, &output->pointB);
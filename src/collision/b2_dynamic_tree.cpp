@@ -22,6 +22,8 @@
 #include "box2d/b2_dynamic_tree.h"
 #include <string.h>
 
+#include <algorithm>
+
 b2DynamicTree::b2DynamicTree()
 {
 	m_root = b2_nullNode;
@@ -42,6 +44,7 @@ b2DynamicTree::b2DynamicTree()
 	m_freeList = 0;
 
 	m_insertionCount = 0;
+	m_reinsertCount = 0;
 }
 
 b2DynamicTree::~b2DynamicTree()
@@ -85,6 +88,9 @@ int32 b2DynamicTree::AllocateNode()
 	m_nodes[nodeId].child2 = b2_nullNode;
 	m_nodes[nodeId].height = 0;
 	m_nodes[nodeId].userData = nullptr;
+	m_nodes[nodeId].displacement.SetZero();
+	m_nodes[nodeId].extension = b2_aabbExtension;
+	m_nodes[nodeId].age = 0;
 	m_nodes[nodeId].moved = false;
 	++m_nodeCount;
 	return nodeId;
@@ -121,6 +127,79 @@ int32 b2DynamicTree::CreateProxy(const b2AABB& aabb, void* userData)
 	return proxyId;
 }
 
+void b2DynamicTree::CreateProxies(int32 count, const b2AABB* aabbs, void* const* userData, int32* proxyIds)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 proxyId = AllocateNode();
+		m_nodes[proxyId].aabb.lowerBound = aabbs[i].lowerBound - r;
+		m_nodes[proxyId].aabb.upperBound = aabbs[i].upperBound + r;
+		m_nodes[proxyId].userData = userData[i];
+		m_nodes[proxyId].height = 0;
+		m_nodes[proxyId].moved = true;
+		proxyIds[i] = proxyId;
+	}
+
+	// The build reorders the leaves so work on a copy.
+	int32* leaves = (int32*)b2Alloc(count * sizeof(int32));
+	memcpy(leaves, proxyIds, count * sizeof(int32));
+	int32 subtree = BuildSubtree(leaves, count);
+	b2Free(leaves);
+
+	InsertLeaf(subtree);
+}
+
+// Build a subtree top-down by splitting the leaves at the median center along
+// the longest axis. This gives a balanced subtree in O(n log n) time.
+int32 b2DynamicTree::BuildSubtree(int32* leaves, int32 count)
+{
+	if (count == 1)
+	{
+		return leaves[0];
+	}
+
+	b2Vec2 lower = m_nodes[leaves[0]].aabb.GetCenter();
+	b2Vec2 upper = lower;
+	for (int32 i = 1; i < count; ++i)
+	{
+		b2Vec2 c = m_nodes[leaves[i]].aabb.GetCenter();
+		lower = b2Min(lower, c);
+		upper = b2Max(upper, c);
+	}
+
+	b2Vec2 d = upper - lower;
+	int32 axis = d.x > d.y ? 0 : 1;
+
+	// No nodes are allocated while partitioning so the pointer stays valid.
+	const b2TreeNode* nodes = m_nodes;
+	int32 half = count >> 1;
+	std::nth_element(leaves, leaves + half, leaves + count, [nodes, axis](int32 a, int32 b)
+	{
+		b2Vec2 ca = nodes[a].aabb.GetCenter();
+		b2Vec2 cb = nodes[b].aabb.GetCenter();
+		return ca(axis) < cb(axis);
+	});
+
+	int32 child1 = BuildSubtree(leaves, half);
+	int32 child2 = BuildSubtree(leaves + half, count - half);
+
+	int32 parent = AllocateNode();
+	m_nodes[parent].child1 = child1;
+	m_nodes[parent].child2 = child2;
+	m_nodes[parent].height = 1 + b2Max(m_nodes[child1].height, m_nodes[child2].height);
+	m_nodes[parent].aabb.Combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+	m_nodes[child1].parent = parent;
+	m_nodes[child2].parent = parent;
+
+	return parent;
+}
+
 void b2DynamicTree::DestroyProxy(int32 proxyId)
 {
 	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
@@ -130,59 +209,99 @@ void b2DynamicTree::DestroyProxy(int32 proxyId)
 	FreeNode(proxyId);
 }
 
-bool b2DynamicTree::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement)
+// Fatten an AABB by the extension and the predicted displacement.
+static void b2ComputeFatAABB(b2AABB* fatAABB, const b2AABB& aabb, float extension, const b2Vec2& displacement)
 {
-	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
-
-	b2Assert(m_nodes[proxyId].IsLeaf());
-
 	// Extend AABB
-	b2AABB fatAABB;
-	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
-	fatAABB.lowerBound = aabb.lowerBound - r;
-	fatAABB.upperBound = aabb.upperBound + r;
+	b2Vec2 r(extension, extension);
+	fatAABB->lowerBound = aabb.lowerBound - r;
+	fatAABB->upperBound = aabb.upperBound + r;
 
 	// Predict AABB movement
 	b2Vec2 d = b2_aabbMultiplier * displacement;
 
 	if (d.x < 0.0f)
 	{
-		fatAABB.lowerBound.x += d.x;
+		fatAABB->lowerBound.x += d.x;
 	}
 	else
 	{
-		fatAABB.upperBound.x += d.x;
+		fatAABB->upperBound.x += d.x;
 	}
 
 	if (d.y < 0.0f)
 	{
-		fatAABB.lowerBound.y += d.y;
+		fatAABB->lowerBound.y += d.y;
 	}
 	else
 	{
-		fatAABB.upperBound.y += d.y;
+		fatAABB->upperBound.y += d.y;
 	}
+}
+
+// Compute the fat AABB for a moved proxy and adapt the margin of the proxy.
+// Returns false if the current tree AABB is still good.
+bool b2DynamicTree::ComputeFatAABB(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement, b2AABB* fatAABB)
+{
+	b2TreeNode* node = m_nodes + proxyId;
 
-	const b2AABB& treeAABB = m_nodes[proxyId].aabb;
-	if (treeAABB.Contains(aabb))
+	// Smooth the displacement so a single jerk doesn't inflate the prediction.
+	node->displacement = 0.5f * (node->displacement + displacement);
+
+	if (node->aabb.Contains(aabb))
 	{
 		// The tree AABB still contains the object, but it might be too large.
 		// Perhaps the object was moving fast but has since gone to sleep.
 		// The huge AABB is larger than the new fat AABB.
+		b2ComputeFatAABB(fatAABB, aabb, node->extension, node->displacement);
+
+		b2Vec2 r(node->extension, node->extension);
 		b2AABB hugeAABB;
-		hugeAABB.lowerBound = fatAABB.lowerBound - 4.0f * r;
-		hugeAABB.upperBound = fatAABB.upperBound + 4.0f * r;
+		hugeAABB.lowerBound = fatAABB->lowerBound - 4.0f * r;
+		hugeAABB.upperBound = fatAABB->upperBound + 4.0f * r;
 
-		if (hugeAABB.Contains(treeAABB))
+		if (hugeAABB.Contains(node->aabb))
 		{
 			// The tree AABB contains the object AABB and the tree AABB is
 			// not too large. No tree update needed.
+			if (++node->age >= b2_aabbMaxAge)
+			{
+				// Stayed inside for a long time. Use a smaller margin next time.
+				node->extension = b2Max(0.5f * node->extension, b2_aabbMinExtension);
+				node->age = 0;
+			}
+
 			return false;
 		}
 
 		// Otherwise the tree AABB is huge and needs to be shrunk
 	}
 
+	// Re-inserted soon after the last time. Use a larger margin.
+	if (node->age < b2_aabbMinAge)
+	{
+		node->extension = b2Min(2.0f * node->extension, b2_aabbMaxExtension);
+	}
+	node->age = 0;
+
+	b2ComputeFatAABB(fatAABB, aabb, node->extension, node->displacement);
+
+	++m_reinsertCount;
+	return true;
+}
+
+bool b2DynamicTree::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement)
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+
+	b2Assert(m_nodes[proxyId].IsLeaf());
+
+	b2AABB fatAABB;
+	if (ComputeFatAABB(proxyId, aabb, displacement, &fatAABB) == false)
+	{
+		return false;
+	}
+
 	RemoveLeaf(proxyId);
 
 	m_nodes[proxyId].aabb = fatAABB;
@@ -194,6 +313,39 @@ bool b2DynamicTree::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& d
 	return true;
 }
 
+int32 b2DynamicTree::MoveProxies(int32 count, const int32* proxyIds, const b2AABB* aabbs,
+								 const b2Vec2* displacements, int32* movedIds)
+{
+	// Pull out every proxy that escaped its fat AABB.
+	int32 movedCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 proxyId = proxyIds[i];
+		b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+		b2Assert(m_nodes[proxyId].IsLeaf());
+
+		b2AABB fatAABB;
+		if (ComputeFatAABB(proxyId, aabbs[i], displacements[i], &fatAABB) == false)
+		{
+			continue;
+		}
+
+		RemoveLeaf(proxyId);
+		m_nodes[proxyId].aabb = fatAABB;
+		movedIds[movedCount++] = proxyId;
+	}
+
+	// Put them back.
+	for (int32 i = 0; i < movedCount; ++i)
+	{
+		int32 proxyId = movedIds[i];
+		InsertLeaf(proxyId);
+		m_nodes[proxyId].moved = true;
+	}
+
+	return movedCount;
+}
+
 void b2DynamicTree::InsertLeaf(int32 leaf)
 {
 	++m_insertionCount;
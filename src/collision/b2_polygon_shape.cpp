@@ -115,6 +115,133 @@ static b2Vec2 ComputeCentroid(const b2Vec2* vs, int32 count)
 	return c;
 }
 
+// Compute the convex hull of welded points with Andrew's monotone chain.
+// The hull is counter-clockwise and starts at the right most point, taking the lowest
+// of those, which is where gift wrapping used to start. Collinear points are removed.
+// http://en.wikibooks.org/wiki/Algorithm_Implementation/Geometry/Convex_hull/Monotone_chain
+static int32 b2ComputeHull(b2Vec2* hull, const b2Vec2* points, int32 count)
+{
+	b2Assert(count <= b2_maxPolygonVertices);
+
+	// Insertion sort by x and then by y is fast for so few points.
+	b2Vec2 ps[b2_maxPolygonVertices];
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Vec2 p = points[i];
+		int32 j = i;
+		while (j > 0 && (ps[j - 1].x > p.x || (ps[j - 1].x == p.x && ps[j - 1].y > p.y)))
+		{
+			ps[j] = ps[j - 1];
+			--j;
+		}
+		ps[j] = p;
+	}
+
+	// The chains share their end points.
+	b2Vec2 chain[2 * b2_maxPolygonVertices];
+	int32 k = 0;
+
+	// Lower chain
+	for (int32 i = 0; i < count; ++i)
+	{
+		while (k >= 2 && b2Cross(chain[k - 1] - chain[k - 2], ps[i] - chain[k - 2]) <= 0.0f)
+		{
+			--k;
+		}
+		chain[k++] = ps[i];
+	}
+
+	// Upper chain
+	int32 lowerCount = k + 1;
+	for (int32 i = count - 2; i >= 0; --i)
+	{
+		while (k >= lowerCount && b2Cross(chain[k - 1] - chain[k - 2], ps[i] - chain[k - 2]) <= 0.0f)
+		{
+			--k;
+		}
+		chain[k++] = ps[i];
+	}
+
+	// The last point repeats the first.
+	int32 m = k - 1;
+	if (m < 3)
+	{
+		return m;
+	}
+
+	// The lower chain ends at the right most point with the largest y. The lowest
+	// right most point is at or before it.
+	int32 i0 = lowerCount - 2;
+	while (i0 > 0 && chain[i0 - 1].x == chain[i0].x)
+	{
+		--i0;
+	}
+
+	for (int32 i = 0; i < m; ++i)
+	{
+		int32 j = i0 + i;
+		hull[i] = chain[j < m ? j : j - m];
+	}
+
+	return m;
+}
+
+// Points that are already a convex polygon in either winding are put in hull order
+// without sorting. Every turn must be strict and the edges must wind around once,
+// which holds when the edge direction changes horizontally at most twice.
+static bool b2OrderConvexPoints(b2Vec2* hull, const b2Vec2* points, int32 count)
+{
+	b2Vec2 edges[b2_maxPolygonVertices];
+	for (int32 i = 0; i < count - 1; ++i)
+	{
+		edges[i] = points[i + 1] - points[i];
+	}
+	edges[count - 1] = points[0] - points[count - 1];
+
+	// Find the winding from the first turn and count the horizontal direction
+	// changes, skipping vertical edges.
+	float sign = b2Cross(edges[count - 1], edges[0]);
+	int32 flips = 0;
+	float lastDx = edges[count - 1].x;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float c = b2Cross(edges[i], edges[i + 1 < count ? i + 1 : 0]);
+		if (c * sign <= 0.0f)
+		{
+			return false;
+		}
+
+		float dx = edges[i].x;
+		flips += dx * lastDx < 0.0f ? 1 : 0;
+		lastDx = dx != 0.0f ? dx : lastDx;
+	}
+
+	if (flips > 2)
+	{
+		return false;
+	}
+
+	int32 i0 = 0;
+	for (int32 i = 1; i < count; ++i)
+	{
+		b2Vec2 p = points[i];
+		bool better = p.x > points[i0].x || (p.x == points[i0].x && p.y < points[i0].y);
+		i0 = better ? i : i0;
+	}
+
+	// Start at the lowest right most point and go counter-clockwise.
+	int32 step = sign > 0.0f ? 1 : count - 1;
+	int32 j = i0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		hull[i] = points[j];
+		j += step;
+		j = j < count ? j : j - count;
+	}
+
+	return true;
+}
+
 void b2PolygonShape::Set(const b2Vec2* vertices, int32 count)
 {
 	b2Assert(3 <= count && count <= b2_maxPolygonVertices);
@@ -158,62 +285,11 @@ void b2PolygonShape::Set(const b2Vec2* vertices, int32 count)
 		return;
 	}
 
-	// Create the convex hull using the Gift wrapping algorithm
-	// http://en.wikipedia.org/wiki/Gift_wrapping_algorithm
-
-	// Find the right most point on the hull
-	int32 i0 = 0;
-	float x0 = ps[0].x;
-	for (int32 i = 1; i < n; ++i)
-	{
-		float x = ps[i].x;
-		if (x > x0 || (x == x0 && ps[i].y < ps[i0].y))
-		{
-			i0 = i;
-			x0 = x;
-		}
-	}
-
-	int32 hull[b2_maxPolygonVertices];
-	int32 m = 0;
-	int32 ih = i0;
-
-	for (;;)
+	b2Vec2 hull[b2_maxPolygonVertices];
+	int32 m = n;
+	if (b2OrderConvexPoints(hull, ps, n) == false)
 	{
-		b2Assert(m < b2_maxPolygonVertices);
-		hull[m] = ih;
-
-		int32 ie = 0;
-		for (int32 j = 1; j < n; ++j)
-		{
-			if (ie == ih)
-			{
-				ie = j;
-				continue;
-			}
-
-			b2Vec2 r = ps[ie] - ps[hull[m]];
-			b2Vec2 v = ps[j] - ps[hull[m]];
-			float c = b2Cross(r, v);
-			if (c < 0.0f)
-			{
-				ie = j;
-			}
-
-			// Collinearity check
-			if (c == 0.0f && v.LengthSquared() > r.LengthSquared())
-			{
-				ie = j;
-			}
-		}
-
-		++m;
-		ih = ie;
-
-		if (ie == i0)
-		{
-			break;
-		}
+		m = b2ComputeHull(hull, ps, n);
 	}
 	
 	if (m < 3)
@@ -224,19 +300,31 @@ void b2PolygonShape::Set(const b2Vec2* vertices, int32 count)
 		return;
 	}
 
-	m_count = m;
+	SetHull(hull, m);
+}
+
+void b2PolygonShape::SetConvex(const b2Vec2* vertices, int32 count)
+{
+	b2Assert(3 <= count && count <= b2_maxPolygonVertices);
+	SetHull(vertices, count);
+	b2Assert(Validate());
+}
+
+void b2PolygonShape::SetHull(const b2Vec2* vertices, int32 count)
+{
+	m_count = count;
 
 	// Copy vertices.
-	for (int32 i = 0; i < m; ++i)
+	for (int32 i = 0; i < count; ++i)
 	{
-		m_vertices[i] = ps[hull[i]];
+		m_vertices[i] = vertices[i];
 	}
 
 	// Compute normals. Ensure the edges have non-zero length.
-	for (int32 i = 0; i < m; ++i)
+	for (int32 i = 0; i < count; ++i)
 	{
 		int32 i1 = i;
-		int32 i2 = i + 1 < m ? i + 1 : 0;
+		int32 i2 = i + 1 < count ? i + 1 : 0;
 		b2Vec2 edge = m_vertices[i2] - m_vertices[i1];
 		b2Assert(edge.LengthSquared() > b2_epsilon * b2_epsilon);
 		m_normals[i] = b2Cross(edge, 1.0f);
@@ -244,23 +332,145 @@ void b2PolygonShape::Set(const b2Vec2* vertices, int32 count)
 	}
 
 	// Compute the polygon centroid.
-	m_centroid = ComputeCentroid(m_vertices, m);
+	m_centroid = ComputeCentroid(m_vertices, count);
+}
+
+void b2SetPolygons(b2PolygonShape* polygons, const b2Vec2* points, const int32* counts, int32 polygonCount, bool convex)
+{
+	for (int32 i = 0; i < polygonCount; ++i)
+	{
+		int32 count = counts[i];
+		if (convex)
+		{
+			polygons[i].SetConvex(points, count);
+		}
+		else
+		{
+			polygons[i].Set(points, count);
+		}
+
+		points += count;
+	}
+}
+
+// Squared distance from a point outside the polygon to the polygon boundary.
+static float b2BoundaryDistanceSquared(const b2PolygonShape* polygon, const b2Vec2& p)
+{
+	float distanceSquared = b2_maxFloat;
+	for (int32 i = 0; i < polygon->m_count; ++i)
+	{
+		b2Vec2 v1 = polygon->m_vertices[i];
+		b2Vec2 v2 = polygon->m_vertices[i + 1 < polygon->m_count ? i + 1 : 0];
+		b2Vec2 e = v2 - v1;
+		float t = b2Clamp(b2Dot(p - v1, e) / b2Dot(e, e), 0.0f, 1.0f);
+		distanceSquared = b2Min(distanceSquared, b2DistanceSquared(p, v1 + t * e));
+	}
+
+	return distanceSquared;
 }
 
 bool b2PolygonShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
 {
 	b2Vec2 pLocal = b2MulT(xf.q, p - xf.p);
 
+	float rounding = GetRounding();
+	bool outside = false;
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		float dot = b2Dot(m_normals[i], pLocal - m_vertices[i]);
-		if (dot > 0.0f)
+		if (dot > rounding)
 		{
 			return false;
 		}
+
+		outside = outside || dot > 0.0f;
 	}
 
-	return true;
+	if (outside && rounding > 0.0f)
+	{
+		return b2BoundaryDistanceSquared(this, pLocal) <= rounding * rounding;
+	}
+
+	return outside == false;
+}
+
+// Ray cast against the polygon grown by the rounding radius. The surface is made
+// of the edges pushed out along their normals joined by circular arcs at the vertices.
+static bool b2RayCastRoundedPolygon(b2RayCastOutput* output, const b2PolygonShape* polygon,
+									const b2Vec2& p1, const b2Vec2& d, float maxFraction, float rounding)
+{
+	// Rays that start inside do not hit.
+	bool outside = false;
+	for (int32 i = 0; i < polygon->m_count; ++i)
+	{
+		outside = outside || b2Dot(polygon->m_normals[i], p1 - polygon->m_vertices[i]) > 0.0f;
+	}
+
+	if (outside == false || b2BoundaryDistanceSquared(polygon, p1) <= rounding * rounding)
+	{
+		return false;
+	}
+
+	float dd = b2Dot(d, d);
+	if (dd == 0.0f)
+	{
+		return false;
+	}
+
+	float fraction = maxFraction;
+	b2Vec2 normal = b2Vec2_zero;
+	bool hit = false;
+
+	for (int32 i = 0; i < polygon->m_count; ++i)
+	{
+		b2Vec2 n = polygon->m_normals[i];
+		b2Vec2 v1 = polygon->m_vertices[i];
+		b2Vec2 v2 = polygon->m_vertices[i + 1 < polygon->m_count ? i + 1 : 0];
+
+		// Offset edge, only entered against the normal.
+		float denominator = b2Dot(n, d);
+		if (denominator < 0.0f)
+		{
+			b2Vec2 a = v1 + rounding * n;
+			float t = b2Dot(n, a - p1) / denominator;
+			if (0.0f <= t && t <= fraction)
+			{
+				b2Vec2 e = v2 - v1;
+				float s = b2Dot(p1 + t * d - a, e);
+				if (0.0f <= s && s <= b2Dot(e, e))
+				{
+					fraction = t;
+					normal = n;
+					hit = true;
+				}
+			}
+		}
+
+		// Vertex arc.
+		b2Vec2 f = p1 - v1;
+		float b = b2Dot(f, d);
+		float c = b2Dot(f, f) - rounding * rounding;
+		float sigma = b * b - dd * c;
+		if (b < 0.0f && sigma >= 0.0f)
+		{
+			float t = (-b - b2Sqrt(sigma)) / dd;
+			if (0.0f <= t && t <= fraction)
+			{
+				fraction = t;
+				normal = p1 + t * d - v1;
+				normal.Normalize();
+				hit = true;
+			}
+		}
+	}
+
+	if (hit)
+	{
+		output->fraction = fraction;
+		output->normal = normal;
+	}
+
+	return hit;
 }
 
 bool b2PolygonShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
@@ -273,6 +483,18 @@ bool b2PolygonShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& inpu
 	b2Vec2 p2 = b2MulT(xf.q, input.p2 - xf.p);
 	b2Vec2 d = p2 - p1;
 
+	float rounding = GetRounding();
+	if (rounding > 0.0f)
+	{
+		if (b2RayCastRoundedPolygon(output, this, p1, d, input.maxFraction, rounding))
+		{
+			output->normal = b2Mul(xf.q, output->normal);
+			return true;
+		}
+
+		return false;
+	}
+
 	float lower = 0.0f, upper = input.maxFraction;
 
 	int32 index = -1;
@@ -415,19 +637,65 @@ void b2PolygonShape::ComputeMass(b2MassData* massData, float density) const
 		I += (0.25f * k_inv3 * D) * (intx2 + inty2);
 	}
 
-	// Total mass
-	massData->mass = density * area;
-
 	// Center of mass
 	b2Assert(area > b2_epsilon);
 	center *= 1.0f / area;
-	massData->center = center + s;
+	b2Vec2 centroid = center + s;
 
-	// Inertia tensor relative to the local origin (point s).
+	// Inertia per unit density relative to the local origin (point s),
+	// shifted to center of mass then to original body origin.
+	I += area * (b2Dot(centroid, centroid) - b2Dot(center, center));
+
+	float rounding = GetRounding();
+	if (rounding > 0.0f)
+	{
+		// The rounding adds a rectangle on each edge and a circular sector on each
+		// vertex. The sector angles sum to a full circle.
+		b2Vec2 moment = area * centroid;
+		float rr = rounding * rounding;
+
+		for (int32 i = 0; i < m_count; ++i)
+		{
+			int32 i0 = i > 0 ? i - 1 : m_count - 1;
+			int32 i2 = i + 1 < m_count ? i + 1 : 0;
+			b2Vec2 v1 = m_vertices[i];
+			b2Vec2 v2 = m_vertices[i2];
+			b2Vec2 n = m_normals[i];
+
+			// Edge rectangle.
+			float length = b2Distance(v1, v2);
+			float rectangleArea = length * rounding;
+			b2Vec2 rectangleCenter = 0.5f * (v1 + v2) + (0.5f * rounding) * n;
+			area += rectangleArea;
+			moment += rectangleArea * rectangleCenter;
+			I += rectangleArea * ((length * length + rr) / 12.0f + b2Dot(rectangleCenter, rectangleCenter));
+
+			// Vertex sector between the normals of the adjacent edges.
+			b2Vec2 n0 = m_normals[i0];
+			float angle = b2Atan2(b2Cross(n0, n), b2Dot(n0, n));
+			if (angle <= 0.0f)
+			{
+				continue;
+			}
+
+			float sectorArea = 0.5f * angle * rr;
+			b2Vec2 bisector = n0 + n;
+			bisector.Normalize();
+			b2Vec2 offset = (4.0f * rounding * b2Sin(0.5f * angle) / (3.0f * angle)) * bisector;
+			b2Vec2 sectorCenter = v1 + offset;
+			area += sectorArea;
+			moment += sectorArea * sectorCenter;
+
+			// Polar inertia about the apex shifted to the sector center then to the origin.
+			I += sectorArea * (0.5f * rr - b2Dot(offset, offset) + b2Dot(sectorCenter, sectorCenter));
+		}
+
+		centroid = (1.0f / area) * moment;
+	}
+
+	massData->mass = density * area;
+	massData->center = centroid;
 	massData->I = density * I;
-	
-	// Shift to center of mass then to original body origin.
-	massData->I += massData->mass * (b2Dot(massData->center, massData->center) - b2Dot(center, center));
 }
 
 bool b2PolygonShape::Validate() const
@@ -0,0 +1,476 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef B2_SIMD_H
+#define B2_SIMD_H
+
+#include "box2d/b2_math.h"
+
+#include <string.h>
+
+// Select the SIMD instruction set at build time. Define B2_DISABLE_SIMD to
+// force the scalar fallback.
+#if defined(B2_DISABLE_SIMD)
+#define B2_SIMD_NONE
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define B2_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define B2_SIMD_NEON
+#include <arm_neon.h>
+#else
+#define B2_SIMD_NONE
+#endif
+
+/// The number of lanes in a b2FloatW.
+#define b2_simdWidth 4
+
+/// Polygon arrays used by the SIMD kernels are padded to a multiple of the SIMD width.
+#define b2_simdPolygonCapacity ((b2_maxPolygonVertices + b2_simdWidth - 1) & ~(b2_simdWidth - 1))
+
+#if defined(B2_SIMD_SSE2)
+
+typedef __m128 b2FloatW;
+
+/// Load 4 floats from a 16 byte aligned address.
+inline b2FloatW b2LoadW(const float* p)
+{
+	return _mm_load_ps(p);
+}
+
+inline void b2StoreW(float* p, b2FloatW a)
+{
+	_mm_store_ps(p, a);
+}
+
+/// Load 4 floats from any address.
+inline b2FloatW b2LoadUW(const float* p)
+{
+	return _mm_loadu_ps(p);
+}
+
+inline void b2StoreUW(float* p, b2FloatW a)
+{
+	_mm_storeu_ps(p, a);
+}
+
+/// Load 4 consecutive points and split them into x and y lanes.
+inline void b2LoadPointsW(b2FloatW* x, b2FloatW* y, const b2Vec2* p)
+{
+	__m128 a = _mm_loadu_ps(&p[0].x);
+	__m128 b = _mm_loadu_ps(&p[2].x);
+	*x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+	*y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+inline b2FloatW b2SplatW(float s)
+{
+	return _mm_set1_ps(s);
+}
+
+/// Make a b2FloatW from 4 values, first lane first.
+inline b2FloatW b2MakeW(float a, float b, float c, float d)
+{
+	return _mm_setr_ps(a, b, c, d);
+}
+
+inline b2FloatW b2AddW(b2FloatW a, b2FloatW b)
+{
+	return _mm_add_ps(a, b);
+}
+
+inline b2FloatW b2SubW(b2FloatW a, b2FloatW b)
+{
+	return _mm_sub_ps(a, b);
+}
+
+inline b2FloatW b2MulW(b2FloatW a, b2FloatW b)
+{
+	return _mm_mul_ps(a, b);
+}
+
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b)
+{
+	return _mm_min_ps(a, b);
+}
+
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b)
+{
+	return _mm_max_ps(a, b);
+}
+
+inline b2FloatW b2DivW(b2FloatW a, b2FloatW b)
+{
+	return _mm_div_ps(a, b);
+}
+
+inline b2FloatW b2SqrtW(b2FloatW a)
+{
+	return _mm_sqrt_ps(a);
+}
+
+inline b2FloatW b2AbsW(b2FloatW a)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+}
+
+/// Compare lanes. True lanes have all bits set.
+inline b2FloatW b2GreaterW(b2FloatW a, b2FloatW b)
+{
+	return _mm_cmpgt_ps(a, b);
+}
+
+inline b2FloatW b2AndW(b2FloatW a, b2FloatW b)
+{
+	return _mm_and_ps(a, b);
+}
+
+/// Pick a where the mask is true and b elsewhere.
+inline b2FloatW b2SelectW(b2FloatW mask, b2FloatW a, b2FloatW b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+
+#elif defined(B2_SIMD_NEON)
+
+typedef float32x4_t b2FloatW;
+
+inline b2FloatW b2LoadW(const float* p)
+{
+	return vld1q_f32(p);
+}
+
+inline void b2StoreW(float* p, b2FloatW a)
+{
+	vst1q_f32(p, a);
+}
+
+inline b2FloatW b2LoadUW(const float* p)
+{
+	return vld1q_f32(p);
+}
+
+inline void b2StoreUW(float* p, b2FloatW a)
+{
+	vst1q_f32(p, a);
+}
+
+inline void b2LoadPointsW(b2FloatW* x, b2FloatW* y, const b2Vec2* p)
+{
+	float32x4x2_t a = vld2q_f32(&p[0].x);
+	*x = a.val[0];
+	*y = a.val[1];
+}
+
+inline b2FloatW b2SplatW(float s)
+{
+	return vdupq_n_f32(s);
+}
+
+inline b2FloatW b2MakeW(float a, float b, float c, float d)
+{
+	float v[b2_simdWidth] = {a, b, c, d};
+	return vld1q_f32(v);
+}
+
+inline b2FloatW b2AddW(b2FloatW a, b2FloatW b)
+{
+	return vaddq_f32(a, b);
+}
+
+inline b2FloatW b2SubW(b2FloatW a, b2FloatW b)
+{
+	return vsubq_f32(a, b);
+}
+
+inline b2FloatW b2MulW(b2FloatW a, b2FloatW b)
+{
+	return vmulq_f32(a, b);
+}
+
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b)
+{
+	return vminq_f32(a, b);
+}
+
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b)
+{
+	return vmaxq_f32(a, b);
+}
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+
+inline b2FloatW b2DivW(b2FloatW a, b2FloatW b)
+{
+	return vdivq_f32(a, b);
+}
+
+inline b2FloatW b2SqrtW(b2FloatW a)
+{
+	return vsqrtq_f32(a);
+}
+
+#else
+
+// ARMv7 NEON has no vector divide or square root.
+inline b2FloatW b2DivW(b2FloatW a, b2FloatW b)
+{
+	float x[b2_simdWidth], y[b2_simdWidth];
+	vst1q_f32(x, a);
+	vst1q_f32(y, b);
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		x[i] = x[i] / y[i];
+	}
+	return vld1q_f32(x);
+}
+
+inline b2FloatW b2SqrtW(b2FloatW a)
+{
+	float x[b2_simdWidth];
+	vst1q_f32(x, a);
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		x[i] = sqrtf(x[i]);
+	}
+	return vld1q_f32(x);
+}
+
+#endif
+
+inline b2FloatW b2AbsW(b2FloatW a)
+{
+	return vabsq_f32(a);
+}
+
+inline b2FloatW b2GreaterW(b2FloatW a, b2FloatW b)
+{
+	return vreinterpretq_f32_u32(vcgtq_f32(a, b));
+}
+
+inline b2FloatW b2AndW(b2FloatW a, b2FloatW b)
+{
+	return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+
+inline b2FloatW b2SelectW(b2FloatW mask, b2FloatW a, b2FloatW b)
+{
+	return vbslq_f32(vreinterpretq_u32_f32(mask), a, b);
+}
+
+
+#else
+
+struct b2FloatW
+{
+	float v[b2_simdWidth];
+};
+
+inline b2FloatW b2LoadW(const float* p)
+{
+	b2FloatW a;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		a.v[i] = p[i];
+	}
+	return a;
+}
+
+inline void b2StoreW(float* p, b2FloatW a)
+{
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		p[i] = a.v[i];
+	}
+}
+
+inline b2FloatW b2LoadUW(const float* p)
+{
+	return b2LoadW(p);
+}
+
+inline void b2StoreUW(float* p, b2FloatW a)
+{
+	b2StoreW(p, a);
+}
+
+inline void b2LoadPointsW(b2FloatW* x, b2FloatW* y, const b2Vec2* p)
+{
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		x->v[i] = p[i].x;
+		y->v[i] = p[i].y;
+	}
+}
+
+inline b2FloatW b2SplatW(float s)
+{
+	b2FloatW a;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		a.v[i] = s;
+	}
+	return a;
+}
+
+inline b2FloatW b2MakeW(float a, float b, float c, float d)
+{
+	b2FloatW w;
+	w.v[0] = a;
+	w.v[1] = b;
+	w.v[2] = c;
+	w.v[3] = d;
+	return w;
+}
+
+inline b2FloatW b2AddW(b2FloatW a, b2FloatW b)
+{
+	b2FloatW c;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		c.v[i] = a.v[i] + b.v[i];
+	}
+	return c;
+}
+
+inline b2FloatW b2SubW(b2FloatW a, b2FloatW b)
+{
+	b2FloatW c;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		c.v[i] = a.v[i] - b.v[i];
+	}
+	return c;
+}
+
+inline b2FloatW b2MulW(b2FloatW a, b2FloatW b)
+{
+	b2FloatW c;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		c.v[i] = a.v[i] * b.v[i];
+	}
+	return c;
+}
+
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b)
+{
+	b2FloatW c;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		c.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+	}
+	return c;
+}
+
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b)
+{
+	b2FloatW c;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		c.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+	}
+	return c;
+}
+
+inline b2FloatW b2DivW(b2FloatW a, b2FloatW b)
+{
+	b2FloatW c;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		c.v[i] = a.v[i] / b.v[i];
+	}
+	return c;
+}
+
+inline b2FloatW b2SqrtW(b2FloatW a)
+{
+	b2FloatW c;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		c.v[i] = sqrtf(a.v[i]);
+	}
+	return c;
+}
+
+inline b2FloatW b2AbsW(b2FloatW a)
+{
+	b2FloatW c;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		c.v[i] = b2Abs(a.v[i]);
+	}
+	return c;
+}
+
+// Masks are held as bit patterns, like the SIMD versions.
+inline float b2MaskBits(bool flag)
+{
+	uint32 bits = flag ? 0xFFFFFFFF : 0;
+	float f;
+	memcpy(&f, &bits, sizeof(float));
+	return f;
+}
+
+inline bool b2IsMaskSet(float f)
+{
+	uint32 bits;
+	memcpy(&bits, &f, sizeof(float));
+	return bits != 0;
+}
+
+inline b2FloatW b2GreaterW(b2FloatW a, b2FloatW b)
+{
+	b2FloatW c;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		c.v[i] = b2MaskBits(a.v[i] > b.v[i]);
+	}
+	return c;
+}
+
+inline b2FloatW b2AndW(b2FloatW a, b2FloatW b)
+{
+	b2FloatW c;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		c.v[i] = b2MaskBits(b2IsMaskSet(a.v[i]) && b2IsMaskSet(b.v[i]));
+	}
+	return c;
+}
+
+inline b2FloatW b2SelectW(b2FloatW mask, b2FloatW a, b2FloatW b)
+{
+	b2FloatW c;
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		c.v[i] = b2IsMaskSet(mask.v[i]) ? a.v[i] : b.v[i];
+	}
+	return c;
+}
+
+
+#endif
+
+#endif
@@ -23,15 +23,38 @@
 #include "box2d/b2_collision.h"
 #include "box2d/b2_distance.h"
 #include "box2d/b2_circle_shape.h"
+#include "box2d/b2_compound_shape.h"
 #include "box2d/b2_polygon_shape.h"
 #include "box2d/b2_time_of_impact.h"
 #include "box2d/b2_timer.h"
 
+#include <atomic>
 #include <stdio.h>
 
-B2_API float b2_toiTime, b2_toiMaxTime;
-B2_API int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
-B2_API int32 b2_toiRootIters, b2_toiMaxRootIters;
+// Global statistics. Atomic with relaxed ordering because worlds may be stepped on several threads.
+B2_API std::atomic<float> b2_toiTime, b2_toiMaxTime;
+B2_API std::atomic<int32> b2_toiCalls, b2_toiIters, b2_toiMaxIters;
+B2_API std::atomic<int32> b2_toiRootIters, b2_toiMaxRootIters;
+
+// Per thread count used for the world counters.
+thread_local int32 b2_toiThreadCalls;
+
+template <typename T>
+static void b2AtomicMax(std::atomic<T>& a, T value)
+{
+	T current = a.load(std::memory_order_relaxed);
+	while (value > current && a.compare_exchange_weak(current, value, std::memory_order_relaxed) == false)
+	{
+	}
+}
+
+static void b2AtomicAdd(std::atomic<float>& a, float value)
+{
+	float current = a.load(std::memory_order_relaxed);
+	while (a.compare_exchange_weak(current, current + value, std::memory_order_relaxed) == false)
+	{
+	}
+}
 
 //
 struct b2SeparationFunction
@@ -253,13 +276,21 @@ struct b2SeparationFunction
 	b2Vec2 m_axis;
 };
 
+void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
+{
+	b2SimplexCache cache;
+	cache.count = 0;
+	b2TimeOfImpact(output, input, &cache);
+}
+
 // CCD via the local separating axis method. This seeks progression
 // by computing the largest time at which separation is maintained.
-void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
+void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input, b2SimplexCache* cache)
 {
 	b2Timer timer;
 
-	++b2_toiCalls;
+	b2_toiCalls.fetch_add(1, std::memory_order_relaxed);
+	++b2_toiThreadCalls;
 
 	output->state = b2TOIOutput::e_unknown;
 	output->t = input->tMax;
@@ -287,8 +318,6 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 	int32 iter = 0;
 
 	// Prepare input for distance query.
-	b2SimplexCache cache;
-	cache.count = 0;
 	b2DistanceInput distanceInput;
 	distanceInput.proxyA = input->proxyA;
 	distanceInput.proxyB = input->proxyB;
@@ -307,7 +336,7 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		distanceInput.transformA = xfA;
 		distanceInput.transformB = xfB;
 		b2DistanceOutput distanceOutput;
-		b2Distance(&distanceOutput, &cache, &distanceInput);
+		b2Distance(&distanceOutput, cache, &distanceInput);
 
 		// If the shapes are overlapped, we give up on continuous collision.
 		if (distanceOutput.distance <= 0.0f)
@@ -328,7 +357,7 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 
 		// Initialize the separating axis.
 		b2SeparationFunction fcn;
-		fcn.Initialize(&cache, proxyA, sweepA, proxyB, sweepB, t1);
+		fcn.Initialize(cache, proxyA, sweepA, proxyB, sweepB, t1);
 #if 0
 		// Dump the curve seen by the root finder
 		{
@@ -426,7 +455,6 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 
 				++rootIterCount;
-				++b2_toiRootIters;
 
 				float s = fcn.Evaluate(indexA, indexB, t);
 
@@ -455,7 +483,8 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 			}
 
-			b2_toiMaxRootIters = b2Max(b2_toiMaxRootIters, rootIterCount);
+			b2_toiRootIters.fetch_add(rootIterCount, std::memory_order_relaxed);
+			b2AtomicMax(b2_toiMaxRootIters, rootIterCount);
 
 			++pushBackIter;
 
@@ -466,7 +495,6 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 
 		++iter;
-		++b2_toiIters;
 
 		if (done)
 		{
@@ -482,9 +510,104 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 	}
 
-	b2_toiMaxIters = b2Max(b2_toiMaxIters, iter);
+	b2_toiIters.fetch_add(iter, std::memory_order_relaxed);
+	b2AtomicMax(b2_toiMaxIters, iter);
 
 	float time = timer.GetMilliseconds();
-	b2_toiMaxTime = b2Max(b2_toiMaxTime, time);
-	b2_toiTime += time;
+	b2AtomicMax(b2_toiMaxTime, time);
+	b2AtomicAdd(b2_toiTime, time);
+}
+
+struct b2TOICandidateCallback
+{
+	bool QueryCallback(int32 index)
+	{
+		indices.Push(index);
+		return true;
+	}
+
+	b2GrowableStack<int32, 64> indices;
+};
+
+// Bounds, in the frame of a compound, of a shape child over [0, tMax] of both sweeps.
+static void b2ComputeSweptBounds(b2AABB* aabb, const b2Shape* shape, int32 index, const b2Sweep& sweep,
+								const b2Sweep& compoundSweep, float tMax)
+{
+	b2Transform xfA0, xfA1, xfB0, xfB1;
+	compoundSweep.GetTransform(&xfA0, 0.0f);
+	compoundSweep.GetTransform(&xfA1, tMax);
+	sweep.GetTransform(&xfB0, 0.0f);
+	sweep.GetTransform(&xfB1, tMax);
+
+	b2AABB box0, box1;
+	shape->ComputeAABB(&box0, b2MulT(xfA0, xfB0), index);
+	shape->ComputeAABB(&box1, b2MulT(xfA1, xfB1), index);
+	aabb->Combine(box0, box1);
+
+	// Between the end points the shape moves along arcs. An arc of angle da and
+	// radius r strays at most r * da from the box of its end points.
+	b2Vec2 extentB = 0.5f * (box0.upperBound - box0.lowerBound);
+	b2Vec2 lower = aabb->lowerBound - compoundSweep.localCenter;
+	b2Vec2 upper = aabb->upperBound - compoundSweep.localCenter;
+	float radiusA = b2Max(b2Max(lower.Length(), upper.Length()),
+						b2Max(b2Vec2(lower.x, upper.y).Length(), b2Vec2(upper.x, lower.y).Length()));
+	float daA = tMax * b2Abs(compoundSweep.a - compoundSweep.a0);
+	float daB = tMax * b2Abs(sweep.a - sweep.a0);
+	float extension = daA * radiusA + daB * extentB.Length();
+
+	aabb->lowerBound -= b2Vec2(extension, extension);
+	aabb->upperBound += b2Vec2(extension, extension);
+}
+
+void b2TimeOfImpact(b2TOIOutput* output,
+					const b2Shape* shapeA, int32 indexA, const b2Sweep& sweepA,
+					const b2Shape* shapeB, int32 indexB, const b2Sweep& sweepB,
+					float tMax, b2SimplexCache* cache)
+{
+	if (shapeA->GetType() != b2Shape::e_compound && shapeB->GetType() != b2Shape::e_compound)
+	{
+		b2TOIInput input;
+		input.proxyA.Set(shapeA, indexA);
+		input.proxyB.Set(shapeB, indexB);
+		input.sweepA = sweepA;
+		input.sweepB = sweepB;
+		input.tMax = tMax;
+		b2TimeOfImpact(output, &input, cache);
+		return;
+	}
+
+	if (shapeA->GetType() != b2Shape::e_compound)
+	{
+		b2TimeOfImpact(output, shapeB, indexB, sweepB, shapeA, indexA, sweepA, tMax, cache);
+		return;
+	}
+
+	const b2CompoundShape* compound = (const b2CompoundShape*)shapeA;
+
+	b2AABB aabb;
+	b2ComputeSweptBounds(&aabb, shapeB, indexB, sweepB, sweepA, tMax);
+
+	b2TOICandidateCallback callback;
+	compound->Query(&callback, aabb);
+
+	output->state = b2TOIOutput::e_separated;
+	output->t = tMax;
+
+	// Each impact shortens the interval searched for the next polygon.
+	while (callback.indices.GetCount() > 0)
+	{
+		int32 index = callback.indices.Pop();
+
+		b2SimplexCache polygonCache;
+		polygonCache.count = 0;
+
+		b2TOIOutput polygonOutput;
+		b2TimeOfImpact(&polygonOutput, compound->m_polygons + index, 0, sweepA,
+						shapeB, indexB, sweepB, output->t, &polygonCache);
+
+		if (polygonOutput.state != b2TOIOutput::e_separated && polygonOutput.t <= output->t)
+		{
+			*output = polygonOutput;
+		}
+	}
 }
@@ -96,3 +96,109 @@ void b2Mat33::GetSymInverse33(b2Mat33* M) const
 	M->ez.y = M->ey.z;
 	M->ez.z = det * (a11 * a22 - a12 * a12);
 }
+
+// The trigonometric functions below use the Cephes single precision polynomials.
+// The range reduction uses floorf and a three part split of pi/2 so that the
+// reduction is exact for moderate angles. Nothing here depends on the C runtime.
+static int32 b2ReduceAngle(float x, float* s, float* c)
+{
+	const float twoOverPi = 0.636619772367581f;
+	float k = floorf(twoOverPi * x + 0.5f);
+	float r = ((x - k * 1.5703125f) - k * 4.837512969970703125e-4f) - k * 7.54978995489188216e-8f;
+	float z = r * r;
+
+	*s = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+	*c = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+
+	// Quadrant of the input angle.
+	return int32(k) & 3;
+}
+
+float b2ComputeSin(float x)
+{
+	float s, c;
+	switch (b2ReduceAngle(x, &s, &c))
+	{
+	case 0:
+		return s;
+	case 1:
+		return c;
+	case 2:
+		return -s;
+	default:
+		return -c;
+	}
+}
+
+float b2ComputeCos(float x)
+{
+	float s, c;
+	switch (b2ReduceAngle(x, &s, &c))
+	{
+	case 0:
+		return c;
+	case 1:
+		return -s;
+	case 2:
+		return -c;
+	default:
+		return s;
+	}
+}
+
+float b2ComputeAtan2(float y, float x)
+{
+	float ax = b2Abs(x);
+	float ay = b2Abs(y);
+	float mx = b2Max(ax, ay);
+	float mn = b2Min(ax, ay);
+	if (mx == 0.0f)
+	{
+		return 0.0f;
+	}
+
+	// Reduce to [0, tan(pi/8)] using atan(a) = pi/4 + atan((a - 1) / (a + 1)).
+	float a = mn / mx;
+	float base = 0.0f;
+	if (a > 0.414213562373095f)
+	{
+		a = (a - 1.0f) / (a + 1.0f);
+		base = 0.25f * b2_pi;
+	}
+
+	float z = a * a;
+	float r = base + ((((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * a + a);
+
+	if (ay > ax)
+	{
+		r = 0.5f * b2_pi - r;
+	}
+
+	if (x < 0.0f)
+	{
+		r = b2_pi - r;
+	}
+
+	if (y < 0.0f)
+	{
+		r = -r;
+	}
+
+	return r;
+}
+
+// Cephes single precision exponential. The range reduction uses a two part
+// split of ln(2) and the power of two is applied exactly by ldexpf.
+float b2ComputeExp(float x)
+{
+	// Keep the result normal.
+	x = b2Clamp(x, -87.0f, 88.0f);
+
+	const float log2e = 1.44269504088896341f;
+	float k = floorf(log2e * x + 0.5f);
+	float r = (x - k * 0.693359375f) + k * 2.12194440e-4f;
+	float z = r * r;
+
+	float p = (((((1.9875691500e-4f * r + 1.3981999507e-3f) * r + 8.3334519073e-3f) * r + 4.1665795894e-2f) * r + 1.6666665459e-1f) * r + 5.0000001201e-1f) * z + r + 1.0f;
+	return ldexpf(p, int32(k));
+}
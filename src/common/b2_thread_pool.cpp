@@ -0,0 +1,287 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_math.h"
+#include "box2d/b2_thread_pool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+// The items owned by one thread. The owner takes items from the front and
+// thieves take items from the back. Padded to avoid false sharing.
+struct b2WorkRange
+{
+	std::mutex mutex;
+	int32 begin;
+	int32 end;
+	char padding[64];
+};
+
+struct b2ThreadPoolState
+{
+	std::thread* threads;
+	b2WorkRange* ranges;
+	int32 threadCount;
+
+	// Serializes loops started by different threads.
+	std::mutex loopMutex;
+
+	std::mutex mutex;
+	std::condition_variable wakeCondition;
+	std::condition_variable doneCondition;
+
+	// Guarded by mutex
+	uint32 generation;
+	int32 activeCount;
+	bool jobOpen;
+	bool exit;
+
+	// The current loop
+	b2TaskCallback* callback;
+	void* context;
+	int32 minRange;
+	std::atomic<int32> remaining;
+};
+
+// Take items from our own range, or steal from another thread. Returns false
+// when no work is left anywhere.
+static bool b2TakeWork(b2ThreadPoolState* state, int32 threadIndex, int32* begin, int32* end)
+{
+	b2WorkRange* own = state->ranges + threadIndex;
+
+	{
+		std::lock_guard<std::mutex> lock(own->mutex);
+		if (own->begin < own->end)
+		{
+			*begin = own->begin;
+			*end = b2Min(own->begin + state->minRange, own->end);
+			own->begin = *end;
+			return true;
+		}
+	}
+
+	int32 threadCount = state->threadCount;
+	for (int32 i = 1; i < threadCount; ++i)
+	{
+		b2WorkRange* victim = state->ranges + (threadIndex + i) % threadCount;
+
+		int32 stealBegin, stealEnd;
+		{
+			std::lock_guard<std::mutex> lock(victim->mutex);
+			int32 count = victim->end - victim->begin;
+			if (count <= 0)
+			{
+				continue;
+			}
+
+			// Take the back half, rounded up so a single item can be stolen.
+			int32 take = (count + 1) >> 1;
+			stealEnd = victim->end;
+			stealBegin = stealEnd - take;
+			victim->end = stealBegin;
+		}
+
+		// Keep the first chunk and publish the rest so it can be stolen again.
+		*begin = stealBegin;
+		*end = b2Min(stealBegin + state->minRange, stealEnd);
+
+		std::lock_guard<std::mutex> lock(own->mutex);
+		own->begin = *end;
+		own->end = stealEnd;
+		return true;
+	}
+
+	return false;
+}
+
+static void b2RunTask(b2ThreadPoolState* state, int32 threadIndex)
+{
+	int32 begin, end;
+	while (b2TakeWork(state, threadIndex, &begin, &end))
+	{
+		state->callback(begin, end, threadIndex, state->context);
+
+		if (state->remaining.fetch_sub(end - begin) == end - begin)
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->doneCondition.notify_all();
+		}
+	}
+}
+
+static void b2WorkerMain(b2ThreadPoolState* state, int32 threadIndex)
+{
+	uint32 generation = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(state->mutex);
+			state->wakeCondition.wait(lock, [&]()
+			{
+				return state->exit || (state->jobOpen && state->generation != generation);
+			});
+
+			if (state->exit)
+			{
+				return;
+			}
+
+			generation = state->generation;
+			++state->activeCount;
+		}
+
+		b2RunTask(state, threadIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			--state->activeCount;
+			if (state->activeCount == 0)
+			{
+				state->doneCondition.notify_all();
+			}
+		}
+	}
+}
+
+b2ThreadPool::b2ThreadPool(int32 workerCount)
+{
+	b2Assert(workerCount >= 0);
+	m_workerCount = workerCount;
+
+	m_state = new (b2Alloc(sizeof(b2ThreadPoolState))) b2ThreadPoolState;
+	m_state->threadCount = workerCount + 1;
+	m_state->generation = 0;
+	m_state->activeCount = 0;
+	m_state->jobOpen = false;
+	m_state->exit = false;
+	m_state->callback = nullptr;
+	m_state->context = nullptr;
+	m_state->minRange = 1;
+	m_state->remaining = 0;
+
+	m_state->ranges = (b2WorkRange*)b2Alloc(m_state->threadCount * sizeof(b2WorkRange));
+	for (int32 i = 0; i < m_state->threadCount; ++i)
+	{
+		b2WorkRange* range = new (m_state->ranges + i) b2WorkRange;
+		range->begin = 0;
+		range->end = 0;
+	}
+
+	m_state->threads = (std::thread*)b2Alloc(b2Max(workerCount, 1) * sizeof(std::thread));
+	for (int32 i = 0; i < workerCount; ++i)
+	{
+		// The calling thread is index 0.
+		new (m_state->threads + i) std::thread(b2WorkerMain, m_state, i + 1);
+	}
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_state->mutex);
+		m_state->exit = true;
+	}
+	m_state->wakeCondition.notify_all();
+
+	for (int32 i = 0; i < m_workerCount; ++i)
+	{
+		m_state->threads[i].join();
+		m_state->threads[i].~thread();
+	}
+
+	for (int32 i = 0; i < m_state->threadCount; ++i)
+	{
+		m_state->ranges[i].~b2WorkRange();
+	}
+
+	b2Free(m_state->threads);
+	b2Free(m_state->ranges);
+
+	m_state->~b2ThreadPoolState();
+	b2Free(m_state);
+}
+
+void b2ThreadPool::ParallelFor(int32 itemCount, int32 minRange, b2TaskCallback* callback, void* context)
+{
+	if (itemCount <= 0)
+	{
+		return;
+	}
+
+	minRange = b2Max(minRange, 1);
+
+	// Small loops are not worth waking the workers.
+	if (m_workerCount == 0 || itemCount <= minRange)
+	{
+		callback(0, itemCount, 0, context);
+		return;
+	}
+
+	b2ThreadPoolState* state = m_state;
+
+	// The loop state below is shared, so only one caller may run a loop at a time.
+	std::lock_guard<std::mutex> loopLock(state->loopMutex);
+
+	state->callback = callback;
+	state->context = context;
+	state->minRange = minRange;
+	state->remaining = itemCount;
+
+	// Split the items evenly. The workers are not running so no range lock is
+	// needed, the mutex below publishes these writes.
+	int32 threadCount = state->threadCount;
+	int32 share = itemCount / threadCount;
+	int32 extra = itemCount - share * threadCount;
+	int32 begin = 0;
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		int32 count = share + (i < extra ? 1 : 0);
+		state->ranges[i].begin = begin;
+		state->ranges[i].end = begin + count;
+		begin += count;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(state->mutex);
+		state->generation += 1;
+		state->jobOpen = true;
+	}
+	state->wakeCondition.notify_all();
+
+	b2RunTask(state, 0);
+
+	// Wait for all items to finish, then for all workers to leave the task so
+	// that none of them touches the ranges of the next loop.
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->doneCondition.wait(lock, [&]()
+	{
+		return state->remaining.load() == 0;
+	});
+	state->jobOpen = false;
+	state->doneCondition.wait(lock, [&]()
+	{
+		return state->activeCount == 0;
+	});
+}
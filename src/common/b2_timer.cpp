@@ -38,11 +38,13 @@ b2Timer::b2Timer()
 
 	if (s_invFrequency == 0.0)
 	{
+		// Compute into a local so that timers created on other threads never
+		// see a partially computed value.
 		QueryPerformanceFrequency(&largeInteger);
-		s_invFrequency = double(largeInteger.QuadPart);
-		if (s_invFrequency > 0.0)
+		double frequency = double(largeInteger.QuadPart);
+		if (frequency > 0.0)
 		{
-			s_invFrequency = 1000.0 / s_invFrequency;
+			s_invFrequency = 1000.0 / frequency;
 		}
 	}
 
@@ -59,6 +59,10 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	{
 		m_flags |= e_enabledFlag;
 	}
+	if (bd->allowLOD)
+	{
+		m_flags |= e_lodFlag;
+	}
 
 	m_world = world;
 
@@ -88,6 +92,9 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	m_torque = 0.0f;
 
 	m_sleepTime = 0.0f;
+	m_lodTime = 0.0f;
+	m_lodStep = 0.0f;
+	m_awakeIndex = -1;
 
 	m_type = bd->type;
 
@@ -262,19 +269,14 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 		}
 	}
 
-	b2BlockAllocator* allocator = &m_world->m_blockAllocator;
-
 	if (m_flags & e_enabledFlag)
 	{
 		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 		fixture->DestroyProxies(broadPhase);
 	}
 
-	fixture->m_body = nullptr;
-	fixture->m_next = nullptr;
-	fixture->Destroy(allocator);
-	fixture->~b2Fixture();
-	allocator->Free(fixture, sizeof(b2Fixture));
+	// Snapshot queries may still report this fixture, even if the body is disabled.
+	m_world->RetireFixture(fixture);
 
 	--m_fixtureCount;
 
@@ -463,6 +465,42 @@ void b2Body::SynchronizeFixtures()
 	}
 }
 
+void b2Body::SetAwake(bool flag)
+{
+	if (m_type == b2_staticBody)
+	{
+		return;
+	}
+
+	if (flag)
+	{
+		if (m_flags & e_awakeFlag)
+		{
+			m_sleepTime = 0.0f;
+			return;
+		}
+
+		m_world->WakeIsland(this);
+	}
+	else
+	{
+		m_flags &= ~e_awakeFlag;
+		m_sleepTime = 0.0f;
+		m_lodTime = 0.0f;
+		m_lodStep = 0.0f;
+		m_linearVelocity.SetZero();
+		m_angularVelocity = 0.0f;
+		m_force.SetZero();
+		m_torque = 0.0f;
+
+		// Bodies that fall asleep during a step are removed after the step.
+		if (m_world->IsLocked() == false)
+		{
+			m_world->RemoveAwakeBody(this);
+		}
+	}
+}
+
 void b2Body::SetEnabled(bool flag)
 {
 	b2Assert(m_world->IsLocked() == false);
@@ -552,6 +590,7 @@ void b2Body::Dump()
 	b2Dump("  bd.fixedRotation = bool(%d);\n", m_flags & e_fixedRotationFlag);
 	b2Dump("  bd.bullet = bool(%d);\n", m_flags & e_bulletFlag);
 	b2Dump("  bd.enabled = bool(%d);\n", m_flags & e_enabledFlag);
+	b2Dump("  bd.allowLOD = bool(%d);\n", m_flags & e_lodFlag);
 	b2Dump("  bd.gravityScale = %.9g;\n", m_gravityScale);
 	b2Dump("  bodies[%d] = m_world->CreateBody(&bd);\n", m_islandIndex);
 	b2Dump("\n");
@@ -0,0 +1,287 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "b2_compound_contact.h"
+#include "box2d/b2_block_allocator.h"
+#include "box2d/b2_chain_shape.h"
+#include "box2d/b2_circle_shape.h"
+#include "box2d/b2_compound_shape.h"
+#include "box2d/b2_edge_shape.h"
+#include "box2d/b2_fixture.h"
+
+#include <new>
+#include <string.h>
+
+b2Contact* b2CompoundContact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(b2CompoundContact));
+	return new (mem) b2CompoundContact(fixtureA, indexA, fixtureB, indexB);
+}
+
+void b2CompoundContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+{
+	((b2CompoundContact*)contact)->~b2CompoundContact();
+	allocator->Free(contact, sizeof(b2CompoundContact));
+}
+
+b2CompoundContact::b2CompoundContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB)
+	: b2Contact(fixtureA, indexA, fixtureB, indexB)
+{
+	b2Assert(m_fixtureA->GetType() == b2Shape::e_compound || m_fixtureB->GetType() == b2Shape::e_compound);
+	m_childManifoldCapacity = 0;
+	m_oldManifolds = nullptr;
+	m_oldCount = 0;
+	m_oldCapacity = 0;
+}
+
+b2CompoundContact::~b2CompoundContact()
+{
+	b2Free(m_childManifolds);
+	b2Free(m_oldManifolds);
+}
+
+void b2CompoundContact::AddManifold(int32 childA, int32 childB, const b2Manifold& manifold)
+{
+	if (m_childManifoldCount == m_childManifoldCapacity)
+	{
+		b2ChildManifold* oldManifolds = m_childManifolds;
+		m_childManifoldCapacity = b2Max(2 * m_childManifoldCapacity, 4);
+		m_childManifolds = (b2ChildManifold*)b2Alloc(m_childManifoldCapacity * sizeof(b2ChildManifold));
+		memcpy(m_childManifolds, oldManifolds, m_childManifoldCount * sizeof(b2ChildManifold));
+		b2Free(oldManifolds);
+	}
+
+	b2ChildManifold* cm = m_childManifolds + m_childManifoldCount;
+	cm->manifold = manifold;
+	cm->childA = childA;
+	cm->childB = childB;
+
+	// Match the previous manifold of this pair to warm start the solver. The
+	// traversal order rarely changes, so the search starts at the same slot.
+	const b2Manifold* oldManifold = nullptr;
+	for (int32 k = 0; k < m_oldCount; ++k)
+	{
+		int32 index = m_childManifoldCount + k;
+		if (index >= m_oldCount)
+		{
+			index -= m_oldCount;
+		}
+
+		const b2ChildManifold* old = m_oldManifolds + index;
+		if (old->childA == childA && old->childB == childB)
+		{
+			oldManifold = &old->manifold;
+			break;
+		}
+	}
+
+	for (int32 i = 0; i < cm->manifold.pointCount; ++i)
+	{
+		b2ManifoldPoint* mp2 = cm->manifold.points + i;
+		mp2->normalImpulse = 0.0f;
+		mp2->tangentImpulse = 0.0f;
+
+		if (oldManifold == nullptr)
+		{
+			continue;
+		}
+
+		for (int32 j = 0; j < oldManifold->pointCount; ++j)
+		{
+			const b2ManifoldPoint* mp1 = oldManifold->points + j;
+			if (mp1->id.key == mp2->id.key)
+			{
+				mp2->normalImpulse = mp1->normalImpulse;
+				mp2->tangentImpulse = mp1->tangentImpulse;
+				break;
+			}
+		}
+	}
+
+	++m_childManifoldCount;
+}
+
+// Collides the polygons of compound A with a circle or polygon B.
+struct b2CompoundShapeCallback
+{
+	bool QueryCallback(int32 index)
+	{
+		const b2PolygonShape* polygon = compound->m_polygons + index;
+
+		b2Manifold manifold;
+		if (shape->GetType() == b2Shape::e_circle)
+		{
+			b2CollidePolygonAndCircle(&manifold, polygon, *xfA, (const b2CircleShape*)shape, *xfB);
+		}
+		else
+		{
+			b2CollidePolygons(&manifold, polygon, *xfA, (const b2PolygonShape*)shape, *xfB);
+		}
+
+		if (manifold.pointCount > 0)
+		{
+			contact->AddManifold(index, childB, manifold);
+		}
+
+		return true;
+	}
+
+	b2CompoundContact* contact;
+	const b2CompoundShape* compound;
+	const b2Shape* shape;
+	int32 childB;
+	const b2Transform* xfA;
+	const b2Transform* xfB;
+};
+
+// Collides an edge A with the polygons of compound B.
+struct b2EdgeCompoundCallback
+{
+	bool QueryCallback(int32 index)
+	{
+		b2Manifold manifold;
+		b2CollideEdgeAndPolygon(&manifold, edge, *xfA, compound->m_polygons + index, *xfB);
+
+		if (manifold.pointCount > 0)
+		{
+			contact->AddManifold(childA, index, manifold);
+		}
+
+		return true;
+	}
+
+	b2CompoundContact* contact;
+	const b2EdgeShape* edge;
+	int32 childA;
+	const b2CompoundShape* compound;
+	const b2Transform* xfA;
+	const b2Transform* xfB;
+};
+
+// Finds the polygons of compound B near compound A, then collides each with the
+// polygons of A near it.
+struct b2CompoundPairCallback
+{
+	bool QueryCallback(int32 index)
+	{
+		const b2PolygonShape* polygon = compoundB->m_polygons + index;
+
+		b2AABB aabb;
+		polygon->ComputeAABB(&aabb, relativeTransform, 0);
+
+		callback.shape = polygon;
+		callback.childB = index;
+		callback.compound->Query(&callback, aabb);
+		return true;
+	}
+
+	b2CompoundShapeCallback callback;
+	const b2CompoundShape* compoundB;
+	b2Transform relativeTransform;
+};
+
+void b2CompoundContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
+{
+	// Keep the current manifolds for warm starting.
+	b2ChildManifold* manifolds = m_oldManifolds;
+	int32 capacity = m_oldCapacity;
+	m_oldManifolds = m_childManifolds;
+	m_oldCount = m_childManifoldCount;
+	m_oldCapacity = m_childManifoldCapacity;
+	m_childManifolds = manifolds;
+	m_childManifoldCount = 0;
+	m_childManifoldCapacity = capacity;
+
+	const b2Shape* shapeA = m_fixtureA->GetShape();
+	const b2Shape* shapeB = m_fixtureB->GetShape();
+
+	// Body B relative to body A.
+	b2Transform relativeTransform = b2MulT(xfA, xfB);
+
+	if (shapeA->GetType() == b2Shape::e_compound)
+	{
+		b2CompoundShapeCallback callback;
+		callback.contact = this;
+		callback.compound = (const b2CompoundShape*)shapeA;
+		callback.xfA = &xfA;
+		callback.xfB = &xfB;
+
+		if (shapeB->GetType() == b2Shape::e_compound)
+		{
+			const b2CompoundShape* compoundB = (const b2CompoundShape*)shapeB;
+
+			b2CompoundPairCallback pairCallback;
+			pairCallback.callback = callback;
+			pairCallback.compoundB = compoundB;
+			pairCallback.relativeTransform = relativeTransform;
+
+			// Bounds of compound A in the frame of B.
+			b2AABB aabb;
+			callback.compound->ComputeAABB(&aabb, b2MulT(xfB, xfA), 0);
+			compoundB->Query(&pairCallback, aabb);
+		}
+		else
+		{
+			callback.shape = shapeB;
+			callback.childB = m_indexB;
+
+			b2AABB aabb;
+			shapeB->ComputeAABB(&aabb, relativeTransform, m_indexB);
+			callback.compound->Query(&callback, aabb);
+		}
+	}
+	else
+	{
+		b2EdgeShape edge;
+		if (shapeA->GetType() == b2Shape::e_chain)
+		{
+			((const b2ChainShape*)shapeA)->GetChildEdge(&edge, m_indexA);
+		}
+		else
+		{
+			b2Assert(shapeA->GetType() == b2Shape::e_edge);
+			edge = *(const b2EdgeShape*)shapeA;
+		}
+
+		b2EdgeCompoundCallback callback;
+		callback.contact = this;
+		callback.edge = &edge;
+		callback.childA = m_indexA;
+		callback.compound = (const b2CompoundShape*)shapeB;
+		callback.xfA = &xfA;
+		callback.xfB = &xfB;
+
+		// Bounds of the edge in the frame of B.
+		b2AABB aabb;
+		edge.ComputeAABB(&aabb, b2MulT(xfB, xfA), 0);
+		callback.compound->Query(&callback, aabb);
+	}
+
+	if (m_childManifoldCount > 0)
+	{
+		*manifold = m_childManifolds[0].manifold;
+	}
+	else
+	{
+		manifold->pointCount = 0;
+	}
+}
@@ -23,6 +23,7 @@
 #include "b2_chain_circle_contact.h"
 #include "b2_chain_polygon_contact.h"
 #include "b2_circle_contact.h"
+#include "b2_compound_contact.h"
 #include "b2_contact_solver.h"
 #include "b2_edge_circle_contact.h"
 #include "b2_edge_polygon_contact.h"
@@ -41,7 +42,7 @@
 b2ContactRegister b2Contact::s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 bool b2Contact::s_initialized = false;
 
-void b2Contact::InitializeRegisters()
+bool b2Contact::InitializeRegisters()
 {
 	AddType(b2CircleContact::Create, b2CircleContact::Destroy, b2Shape::e_circle, b2Shape::e_circle);
 	AddType(b2PolygonAndCircleContact::Create, b2PolygonAndCircleContact::Destroy, b2Shape::e_polygon, b2Shape::e_circle);
@@ -50,6 +51,14 @@ void b2Contact::InitializeRegisters()
 	AddType(b2EdgeAndPolygonContact::Create, b2EdgeAndPolygonContact::Destroy, b2Shape::e_edge, b2Shape::e_polygon);
 	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, b2Shape::e_chain, b2Shape::e_circle);
 	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, b2Shape::e_chain, b2Shape::e_polygon);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, b2Shape::e_compound, b2Shape::e_circle);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, b2Shape::e_compound, b2Shape::e_polygon);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, b2Shape::e_compound, b2Shape::e_compound);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, b2Shape::e_edge, b2Shape::e_compound);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, b2Shape::e_chain, b2Shape::e_compound);
+
+	s_initialized = true;
+	return s_initialized;
 }
 
 void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destoryFcn,
@@ -72,11 +81,10 @@ void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* dest
 
 b2Contact* b2Contact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator)
 {
-	if (s_initialized == false)
-	{
-		InitializeRegisters();
-		s_initialized = true;
-	}
+	// A function local static is initialized exactly once, even if worlds on
+	// different threads create their first contact at the same time.
+	static const bool initialized = InitializeRegisters();
+	B2_NOT_USED(initialized);
 
 	b2Shape::Type type1 = fixtureA->GetType();
 	b2Shape::Type type2 = fixtureB->GetType();
@@ -138,6 +146,10 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 	m_indexB = indexB;
 
 	m_manifold.pointCount = 0;
+	m_childManifolds = nullptr;
+	m_childManifoldCount = 0;
+	m_relativeTransform.SetIdentity();
+	m_simplexCache.count = 0;
 
 	m_prev = nullptr;
 	m_next = nullptr;
@@ -163,7 +175,7 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 
 // Update the contact manifold and touching status.
 // Note: do not assume the fixture AABBs are overlapping or are valid.
-void b2Contact::Update(b2ContactListener* listener)
+void b2Contact::Update(b2ContactListener* listener, b2Counters* counters)
 {
 	b2Manifold oldManifold = m_manifold;
 
@@ -173,6 +185,8 @@ void b2Contact::Update(b2ContactListener* listener)
 	bool touching = false;
 	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
 
+	++counters->contactUpdates;
+
 	bool sensorA = m_fixtureA->IsSensor();
 	bool sensorB = m_fixtureB->IsSensor();
 	bool sensor = sensorA || sensorB;
@@ -187,38 +201,61 @@ void b2Contact::Update(b2ContactListener* listener)
 	{
 		const b2Shape* shapeA = m_fixtureA->GetShape();
 		const b2Shape* shapeB = m_fixtureB->GetShape();
-		touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
+		touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB, &m_simplexCache);
 
 		// Sensors don't generate manifolds.
 		m_manifold.pointCount = 0;
+		m_flags &= ~e_manifoldFlag;
 	}
 	else
 	{
-		Evaluate(&m_manifold, xfA, xfB);
-		touching = m_manifold.pointCount > 0;
-
-		// Match old contact ids to new contact ids and copy the
-		// stored impulses to warm start the solver.
-		for (int32 i = 0; i < m_manifold.pointCount; ++i)
+		// Relative motion allowed before the manifold is evaluated again. The solver
+		// computes the contact points and separations from the current transforms,
+		// so the old manifold remains accurate for small motion.
+		const float linearTol = 0.1f * b2_linearSlop;
+		const float angularTol = 0.1f * b2_angularSlop;
+
+		b2Transform relativeTransform = b2MulT(xfA, xfB);
+		b2Vec2 dp = relativeTransform.p - m_relativeTransform.p;
+		b2Rot dq = b2MulT(m_relativeTransform.q, relativeTransform.q);
+
+		if ((m_flags & e_manifoldFlag) == e_manifoldFlag &&
+			b2Dot(dp, dp) < linearTol * linearTol && dq.c > 0.0f && b2Abs(dq.s) < angularTol)
 		{
-			b2ManifoldPoint* mp2 = m_manifold.points + i;
-			mp2->normalImpulse = 0.0f;
-			mp2->tangentImpulse = 0.0f;
-			b2ContactID id2 = mp2->id;
+			// Reuse the manifold. It still holds the impulses for warm starting.
+			++counters->manifoldReuses;
+		}
+		else
+		{
+			Evaluate(&m_manifold, xfA, xfB);
+			m_relativeTransform = relativeTransform;
+			m_flags |= e_manifoldFlag;
 
-			for (int32 j = 0; j < oldManifold.pointCount; ++j)
+			// Match old contact ids to new contact ids and copy the
+			// stored impulses to warm start the solver.
+			for (int32 i = 0; i < m_manifold.pointCount; ++i)
 			{
-				b2ManifoldPoint* mp1 = oldManifold.points + j;
+				b2ManifoldPoint* mp2 = m_manifold.points + i;
+				mp2->normalImpulse = 0.0f;
+				mp2->tangentImpulse = 0.0f;
+				b2ContactID id2 = mp2->id;
 
-				if (mp1->id.key == id2.key)
+				for (int32 j = 0; j < oldManifold.pointCount; ++j)
 				{
-					mp2->normalImpulse = mp1->normalImpulse;
-					mp2->tangentImpulse = mp1->tangentImpulse;
-					break;
+					b2ManifoldPoint* mp1 = oldManifold.points + j;
+
+					if (mp1->id.key == id2.key)
+					{
+						mp2->normalImpulse = mp1->normalImpulse;
+						mp2->tangentImpulse = mp1->tangentImpulse;
+						break;
+					}
 				}
 			}
 		}
 
+		touching = m_manifold.pointCount > 0;
+
 		if (touching != wasTouching)
 		{
 			bodyA->SetAwake(true);
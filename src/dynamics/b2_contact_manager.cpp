@@ -36,6 +36,8 @@ b2ContactManager::b2ContactManager()
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
 	m_allocator = nullptr;
+	m_counters = nullptr;
+	m_filterPending = false;
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -112,65 +114,105 @@ void b2ContactManager::Collide()
 	b2Contact* c = m_contactList;
 	while (c)
 	{
-		b2Fixture* fixtureA = c->GetFixtureA();
-		b2Fixture* fixtureB = c->GetFixtureB();
-		int32 indexA = c->GetChildIndexA();
-		int32 indexB = c->GetChildIndexB();
-		b2Body* bodyA = fixtureA->GetBody();
-		b2Body* bodyB = fixtureB->GetBody();
-		 
-		// Is this contact flagged for filtering?
-		if (c->m_flags & b2Contact::e_filterFlag)
-		{
-			// Should these bodies collide?
-			if (bodyB->ShouldCollide(bodyA) == false)
-			{
-				b2Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
-				continue;
-			}
-
-			// Check user filtering.
-			if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
-			{
-				b2Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
-				continue;
-			}
-
-			// Clear the filtering flag.
-			c->m_flags &= ~b2Contact::e_filterFlag;
-		}
+		b2Contact* next = c->GetNext();
+		b2Body* bodyA = c->GetFixtureA()->GetBody();
+		b2Body* bodyB = c->GetFixtureB()->GetBody();
 
 		bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
 		bool activeB = bodyB->IsAwake() && bodyB->m_type != b2_staticBody;
 
 		// At least one body must be awake and it must be dynamic or kinematic.
-		if (activeA == false && activeB == false)
+		if (activeA || activeB)
 		{
-			c = c->GetNext();
-			continue;
+			Collide(c);
 		}
 
-		int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
-		int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
-		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+		c = next;
+	}
+}
 
-		// Here we destroy contacts that cease to overlap in the broad-phase.
-		if (overlap == false)
-		{
-			b2Contact* cNuke = c;
-			c = cNuke->GetNext();
-			Destroy(cNuke);
-			continue;
-		}
+void b2ContactManager::Collide(b2Contact* c)
+{
+	if (FilterContact(c) == false)
+	{
+		return;
+	}
+
+	b2Fixture* fixtureA = c->GetFixtureA();
+	b2Fixture* fixtureB = c->GetFixtureB();
+	int32 indexA = c->GetChildIndexA();
+	int32 indexB = c->GetChildIndexB();
+
+	int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
+	int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
+	bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+
+	// Here we destroy contacts that cease to overlap in the broad-phase.
+	if (overlap == false)
+	{
+		Destroy(c);
+		return;
+	}
+
+	// The contact persists.
+	c->Update(m_contactListener, m_counters);
+}
+
+void b2ContactManager::FlagForFiltering(b2Contact* c)
+{
+	c->FlagForFiltering();
+	m_filterPending = true;
+}
 
-		// The contact persists.
-		c->Update(m_contactListener);
-		c = c->GetNext();
+void b2ContactManager::FilterContacts()
+{
+	if (m_filterPending == false)
+	{
+		return;
+	}
+
+	// Contacts between sleeping bodies are not collided, so walk them all.
+	b2Contact* c = m_contactList;
+	while (c)
+	{
+		b2Contact* next = c->GetNext();
+		FilterContact(c);
+		c = next;
 	}
+
+	m_filterPending = false;
+}
+
+bool b2ContactManager::FilterContact(b2Contact* c)
+{
+	// Is this contact flagged for filtering?
+	if ((c->m_flags & b2Contact::e_filterFlag) == 0)
+	{
+		return true;
+	}
+
+	b2Fixture* fixtureA = c->GetFixtureA();
+	b2Fixture* fixtureB = c->GetFixtureB();
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+
+	// Should these bodies collide?
+	if (bodyB->ShouldCollide(bodyA) == false)
+	{
+		Destroy(c);
+		return false;
+	}
+
+	// Check user filtering.
+	if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+	{
+		Destroy(c);
+		return false;
+	}
+
+	// Clear the filtering flag.
+	c->m_flags &= ~b2Contact::e_filterFlag;
+	return true;
 }
 
 void b2ContactManager::FindNewContacts()
@@ -52,15 +52,25 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 {
 	m_step = def->step;
 	m_allocator = def->allocator;
-	m_count = def->count;
-	m_positionConstraints = (b2ContactPositionConstraint*)m_allocator->Allocate(m_count * sizeof(b2ContactPositionConstraint));
-	m_velocityConstraints = (b2ContactVelocityConstraint*)m_allocator->Allocate(m_count * sizeof(b2ContactVelocityConstraint));
+	m_contactCount = def->count;
 	m_positions = def->positions;
 	m_velocities = def->velocities;
 	m_contacts = def->contacts;
 
+	// Compound shape contacts have a constraint for each child manifold.
+	m_count = 0;
+	for (int32 i = 0; i < m_contactCount; ++i)
+	{
+		int32 childCount = m_contacts[i]->m_childManifoldCount;
+		m_count += childCount > 0 ? childCount : 1;
+	}
+
+	m_positionConstraints = (b2ContactPositionConstraint*)m_allocator->Allocate(m_count * sizeof(b2ContactPositionConstraint));
+	m_velocityConstraints = (b2ContactVelocityConstraint*)m_allocator->Allocate(m_count * sizeof(b2ContactVelocityConstraint));
+
 	// Initialize position independent portions of the constraints.
-	for (int32 i = 0; i < m_count; ++i)
+	int32 constraintIndex = 0;
+	for (int32 i = 0; i < m_contactCount; ++i)
 	{
 		b2Contact* contact = m_contacts[i];
 
@@ -72,68 +82,80 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 		float radiusB = shapeB->m_radius;
 		b2Body* bodyA = fixtureA->GetBody();
 		b2Body* bodyB = fixtureB->GetBody();
-		b2Manifold* manifold = contact->GetManifold();
 
-		int32 pointCount = manifold->pointCount;
-		b2Assert(pointCount > 0);
+		int32 manifoldCount = contact->m_childManifoldCount > 0 ? contact->m_childManifoldCount : 1;
+		for (int32 k = 0; k < manifoldCount; ++k)
+		{
+			b2Manifold* manifold = contact->m_childManifoldCount > 0 ? &contact->m_childManifolds[k].manifold : &contact->m_manifold;
+
+			int32 pointCount = manifold->pointCount;
+			b2Assert(pointCount > 0);
+
+			b2ContactVelocityConstraint* vc = m_velocityConstraints + constraintIndex;
+			vc->friction = contact->m_friction;
+			vc->restitution = contact->m_restitution;
+			vc->threshold = contact->m_restitutionThreshold;
+			vc->tangentSpeed = contact->m_tangentSpeed;
+			vc->indexA = bodyA->m_islandIndex;
+			vc->indexB = bodyB->m_islandIndex;
+			vc->invMassA = bodyA->m_invMass;
+			vc->invMassB = bodyB->m_invMass;
+			vc->invIA = bodyA->m_invI;
+			vc->invIB = bodyB->m_invI;
+			vc->contactIndex = i;
+			vc->manifold = manifold;
+			vc->pointCount = pointCount;
+			vc->K.SetZero();
+			vc->normalMass.SetZero();
+
+			b2ContactPositionConstraint* pc = m_positionConstraints + constraintIndex;
+			pc->indexA = bodyA->m_islandIndex;
+			pc->indexB = bodyB->m_islandIndex;
+			pc->invMassA = bodyA->m_invMass;
+			pc->invMassB = bodyB->m_invMass;
+			pc->localCenterA = bodyA->m_sweep.localCenter;
+			pc->localCenterB = bodyB->m_sweep.localCenter;
+			pc->invIA = bodyA->m_invI;
+			pc->invIB = bodyB->m_invI;
+			pc->localNormal = manifold->localNormal;
+			pc->localPoint = manifold->localPoint;
+			pc->pointCount = pointCount;
+			pc->radiusA = radiusA;
+			pc->radiusB = radiusB;
+			pc->type = manifold->type;
 
-		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
-		vc->friction = contact->m_friction;
-		vc->restitution = contact->m_restitution;
-		vc->threshold = contact->m_restitutionThreshold;
-		vc->tangentSpeed = contact->m_tangentSpeed;
-		vc->indexA = bodyA->m_islandIndex;
-		vc->indexB = bodyB->m_islandIndex;
-		vc->invMassA = bodyA->m_invMass;
-		vc->invMassB = bodyB->m_invMass;
-		vc->invIA = bodyA->m_invI;
-		vc->invIB = bodyB->m_invI;
-		vc->contactIndex = i;
-		vc->pointCount = pointCount;
-		vc->K.SetZero();
-		vc->normalMass.SetZero();
+			for (int32 j = 0; j < pointCount; ++j)
+			{
+				b2ManifoldPoint* cp = manifold->points + j;
+				b2VelocityConstraintPoint* vcp = vc->points + j;
 
-		b2ContactPositionConstraint* pc = m_positionConstraints + i;
-		pc->indexA = bodyA->m_islandIndex;
-		pc->indexB = bodyB->m_islandIndex;
-		pc->invMassA = bodyA->m_invMass;
-		pc->invMassB = bodyB->m_invMass;
-		pc->localCenterA = bodyA->m_sweep.localCenter;
-		pc->localCenterB = bodyB->m_sweep.localCenter;
-		pc->invIA = bodyA->m_invI;
-		pc->invIB = bodyB->m_invI;
-		pc->localNormal = manifold->localNormal;
-		pc->localPoint = manifold->localPoint;
-		pc->pointCount = pointCount;
-		pc->radiusA = radiusA;
-		pc->radiusB = radiusB;
-		pc->type = manifold->type;
+				if (m_step.warmStarting)
+				{
+					vcp->normalImpulse = m_step.dtRatio * cp->normalImpulse;
+					vcp->tangentImpulse = m_step.dtRatio * cp->tangentImpulse;
+				}
+				else
+				{
+					vcp->normalImpulse = 0.0f;
+					vcp->tangentImpulse = 0.0f;
+				}
 
-		for (int32 j = 0; j < pointCount; ++j)
-		{
-			b2ManifoldPoint* cp = manifold->points + j;
-			b2VelocityConstraintPoint* vcp = vc->points + j;
-	
-			if (m_step.warmStarting)
-			{
-				vcp->normalImpulse = m_step.dtRatio * cp->normalImpulse;
-				vcp->tangentImpulse = m_step.dtRatio * cp->tangentImpulse;
-			}
-			else
-			{
-				vcp->normalImpulse = 0.0f;
-				vcp->tangentImpulse = 0.0f;
-			}
+				vcp->rA.SetZero();
+				vcp->rB.SetZero();
+				vcp->normalMass = 0.0f;
+				vcp->tangentMass = 0.0f;
+				vcp->velocityBias = 0.0f;
+				vcp->adjustedSeparation = 0.0f;
+				vcp->maxNormalImpulse = 0.0f;
 
-			vcp->rA.SetZero();
-			vcp->rB.SetZero();
-			vcp->normalMass = 0.0f;
-			vcp->tangentMass = 0.0f;
-			vcp->velocityBias = 0.0f;
+				pc->localPoints[j] = cp->localPoint;
+			}
 
-			pc->localPoints[j] = cp->localPoint;
+			++constraintIndex;
 		}
 	}
+
+	b2Assert(constraintIndex == m_count);
 }
 
 b2ContactSolver::~b2ContactSolver()
@@ -152,7 +174,7 @@ void b2ContactSolver::InitializeVelocityConstraints()
 
 		float radiusA = pc->radiusA;
 		float radiusB = pc->radiusB;
-		b2Manifold* manifold = m_contacts[vc->contactIndex]->GetManifold();
+		b2Manifold* manifold = vc->manifold;
 
 		int32 indexA = vc->indexA;
 		int32 indexB = vc->indexB;
@@ -195,6 +217,9 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			vcp->rA = worldManifold.points[j] - cA;
 			vcp->rB = worldManifold.points[j] - cB;
 
+			// Separation with the anchor offset removed. Used by the soft step solver.
+			vcp->adjustedSeparation = worldManifold.separations[j] - b2Dot(vcp->rB - vcp->rA, vc->normal);
+
 			float rnA = b2Cross(vcp->rA, vc->normal);
 			float rnB = b2Cross(vcp->rB, vc->normal);
 
@@ -606,12 +631,191 @@ void b2ContactSolver::SolveVelocityConstraints()
 	}
 }
 
+// Soft step solver developed from "Solver2D" (Catto, 2024). The contact is modeled
+// as a stiff, heavily damped spring so that the position error is removed by the
+// velocity solver over several sub-steps. With useBias == false this is the relax
+// pass which removes the velocity added by the position correction.
+void b2ContactSolver::SolveSoftVelocityConstraints(const b2Position* origins, const b2Softness& softness, bool useBias)
+{
+	float inv_h = m_step.inv_dt;
+
+	// This limits the velocity used to push apart overlapping shapes.
+	const float maxBiasVelocity = 3.0f * b2_lengthUnitsPerMeter;
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+
+		int32 indexA = vc->indexA;
+		int32 indexB = vc->indexB;
+		float mA = vc->invMassA;
+		float iA = vc->invIA;
+		float mB = vc->invMassB;
+		float iB = vc->invIB;
+		int32 pointCount = vc->pointCount;
+
+		b2Vec2 vA = m_velocities[indexA].v;
+		float wA = m_velocities[indexA].w;
+		b2Vec2 vB = m_velocities[indexB].v;
+		float wB = m_velocities[indexB].w;
+
+		// Body displacement since the beginning of the step.
+		b2Vec2 dcA = m_positions[indexA].c - origins[indexA].c;
+		float daA = m_positions[indexA].a - origins[indexA].a;
+		b2Vec2 dcB = m_positions[indexB].c - origins[indexB].c;
+		float daB = m_positions[indexB].a - origins[indexB].a;
+
+		b2Vec2 normal = vc->normal;
+		b2Vec2 tangent = b2Cross(normal, 1.0f);
+		float friction = vc->friction;
+
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+
+			// Compute the current separation using a small angle approximation of the anchor rotation.
+			b2Vec2 d = (dcB - dcA) + (vcp->rB + b2Cross(daB, vcp->rB)) - (vcp->rA + b2Cross(daA, vcp->rA));
+			float separation = b2Dot(d, normal) + vcp->adjustedSeparation;
+
+			float bias = 0.0f;
+			float massScale = 1.0f;
+			float impulseScale = 0.0f;
+			if (separation > 0.0f)
+			{
+				// Speculative
+				bias = separation * inv_h;
+			}
+			else if (useBias)
+			{
+				bias = b2Max(softness.biasRate * separation, -maxBiasVelocity);
+				massScale = softness.massScale;
+				impulseScale = softness.impulseScale;
+			}
+
+			// Relative velocity at contact
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+			float vn = b2Dot(dv, normal);
+
+			// Compute normal impulse
+			float lambda = -vcp->normalMass * massScale * (vn + bias) - impulseScale * vcp->normalImpulse;
+
+			// Clamp the accumulated impulse
+			float newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
+			lambda = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
+			vcp->maxNormalImpulse = b2Max(vcp->maxNormalImpulse, lambda);
+
+			// Apply contact impulse
+			b2Vec2 P = lambda * normal;
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+
+			// Relative velocity at contact
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+
+			// Compute tangent force
+			float vt = b2Dot(dv, tangent) - vc->tangentSpeed;
+			float lambda = vcp->tangentMass * (-vt);
+
+			// Clamp the accumulated force
+			float maxFriction = friction * vcp->normalImpulse;
+			float newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
+			lambda = newImpulse - vcp->tangentImpulse;
+			vcp->tangentImpulse = newImpulse;
+
+			// Apply contact impulse
+			b2Vec2 P = lambda * tangent;
+
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		m_velocities[indexA].v = vA;
+		m_velocities[indexA].w = wA;
+		m_velocities[indexB].v = vB;
+		m_velocities[indexB].w = wB;
+	}
+}
+
+// Restitution is applied once after the sub-steps using the relative normal velocity
+// from the beginning of the step. The velocity bias holds the restitution target.
+void b2ContactSolver::ApplyRestitution()
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+
+		if (vc->restitution == 0.0f)
+		{
+			continue;
+		}
+
+		int32 indexA = vc->indexA;
+		int32 indexB = vc->indexB;
+		float mA = vc->invMassA;
+		float iA = vc->invIA;
+		float mB = vc->invMassB;
+		float iB = vc->invIB;
+		int32 pointCount = vc->pointCount;
+
+		b2Vec2 vA = m_velocities[indexA].v;
+		float wA = m_velocities[indexA].w;
+		b2Vec2 vB = m_velocities[indexB].v;
+		float wB = m_velocities[indexB].w;
+
+		b2Vec2 normal = vc->normal;
+
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+
+			// Skip points that were not approaching or did not receive an impulse.
+			if (vcp->velocityBias == 0.0f || vcp->maxNormalImpulse == 0.0f)
+			{
+				continue;
+			}
+
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+			float vn = b2Dot(dv, normal);
+
+			float lambda = -vcp->normalMass * (vn - vcp->velocityBias);
+
+			float newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
+			lambda = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
+
+			b2Vec2 P = lambda * normal;
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		m_velocities[indexA].v = vA;
+		m_velocities[indexA].w = wA;
+		m_velocities[indexB].v = vB;
+		m_velocities[indexB].w = wB;
+	}
+}
+
 void b2ContactSolver::StoreImpulses()
 {
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
-		b2Manifold* manifold = m_contacts[vc->contactIndex]->GetManifold();
+		b2Manifold* manifold = vc->manifold;
 
 		for (int32 j = 0; j < vc->pointCount; ++j)
 		{
@@ -673,7 +877,7 @@ struct b2PositionSolverManifold
 };
 
 // Sequential solver.
-bool b2ContactSolver::SolvePositionConstraints()
+bool b2ContactSolver::SolvePositionConstraints(const int32* bodyIslands, bool* islandOkay)
 {
 	float minSeparation = 0.0f;
 
@@ -697,6 +901,8 @@ bool b2ContactSolver::SolvePositionConstraints()
 		b2Vec2 cB = m_positions[indexB].c;
 		float aB = m_positions[indexB].a;
 
+		float contactMinSeparation = 0.0f;
+
 		// Solve normal constraints
 		for (int32 j = 0; j < pointCount; ++j)
 		{
@@ -717,7 +923,7 @@ bool b2ContactSolver::SolvePositionConstraints()
 			b2Vec2 rB = point - cB;
 
 			// Track max constraint error.
-			minSeparation = b2Min(minSeparation, separation);
+			contactMinSeparation = b2Min(contactMinSeparation, separation);
 
 			// Prevent large corrections and allow slop.
 			float C = b2Clamp(b2_baumgarte * (separation + b2_linearSlop), -b2_maxLinearCorrection, 0.0f);
@@ -744,6 +950,15 @@ bool b2ContactSolver::SolvePositionConstraints()
 
 		m_positions[indexB].c = cB;
 		m_positions[indexB].a = aB;
+
+		minSeparation = b2Min(minSeparation, contactMinSeparation);
+
+		// The dynamic body decides the island. Static and kinematic bodies may be
+		// shared by several islands.
+		if (islandOkay != nullptr && contactMinSeparation < -3.0f * b2_linearSlop)
+		{
+			islandOkay[bodyIslands[mA > 0.0f ? indexA : indexB]] = false;
+		}
 	}
 
 	// We can't expect minSpeparation >= -b2_linearSlop because we don't
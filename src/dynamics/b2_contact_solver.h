@@ -41,6 +41,8 @@ struct b2VelocityConstraintPoint
 	float normalMass;
 	float tangentMass;
 	float velocityBias;
+	float adjustedSeparation;
+	float maxNormalImpulse;
 };
 
 struct b2ContactVelocityConstraint
@@ -59,8 +61,38 @@ struct b2ContactVelocityConstraint
 	float tangentSpeed;
 	int32 pointCount;
 	int32 contactIndex;
+	b2Manifold* manifold;
 };
 
+/// Soft constraint coefficients for a spring with the given stiffness (hertz) and
+/// damping ratio, integrated with the time step h.
+struct b2Softness
+{
+	float biasRate;
+	float massScale;
+	float impulseScale;
+};
+
+inline b2Softness b2MakeSoft(float hertz, float zeta, float h)
+{
+	if (hertz == 0.0f)
+	{
+		b2Softness soft = {0.0f, 1.0f, 0.0f};
+		return soft;
+	}
+
+	float omega = 2.0f * b2_pi * hertz;
+	float a1 = 2.0f * zeta + h * omega;
+	float a2 = h * omega * a1;
+	float a3 = 1.0f / (1.0f + a2);
+
+	b2Softness soft;
+	soft.biasRate = omega / a1;
+	soft.massScale = a2 * a3;
+	soft.impulseScale = a3;
+	return soft;
+}
+
 struct b2ContactSolverDef
 {
 	b2TimeStep step;
@@ -83,7 +115,14 @@ public:
 	void SolveVelocityConstraints();
 	void StoreImpulses();
 
-	bool SolvePositionConstraints();
+	/// Soft step solver. The origins are the body positions at the beginning of the step
+	/// and are used to estimate the current separation without a position solver.
+	void SolveSoftVelocityConstraints(const b2Position* origins, const b2Softness& softness, bool useBias);
+	void ApplyRestitution();
+
+	/// If islandOkay is not null, the entries of islands with a large error are set
+	/// to false. bodyIslands gives the island of each body.
+	bool SolvePositionConstraints(const int32* bodyIslands = nullptr, bool* islandOkay = nullptr);
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
 	b2TimeStep m_step;
@@ -93,6 +132,10 @@ public:
 	b2ContactPositionConstraint* m_positionConstraints;
 	b2ContactVelocityConstraint* m_velocityConstraints;
 	b2Contact** m_contacts;
+	int32 m_contactCount;
+
+	/// The constraint count. This exceeds the contact count when compound shape
+	/// contacts have several child manifolds.
 	int m_count;
 };
 
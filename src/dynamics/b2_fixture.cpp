@@ -26,6 +26,7 @@
 #include "box2d/b2_chain_shape.h"
 #include "box2d/b2_circle_shape.h"
 #include "box2d/b2_collision.h"
+#include "box2d/b2_compound_shape.h"
 #include "box2d/b2_contact.h"
 #include "box2d/b2_edge_shape.h"
 #include "box2d/b2_polygon_shape.h"
@@ -115,6 +116,14 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 		}
 		break;
 
+	case b2Shape::e_compound:
+		{
+			b2CompoundShape* s = (b2CompoundShape*)m_shape;
+			s->~b2CompoundShape();
+			allocator->Free(s, sizeof(b2CompoundShape));
+		}
+		break;
+
 	default:
 		b2Assert(false);
 		break;
@@ -191,6 +200,13 @@ void b2Fixture::Refilter()
 		return;
 	}
 
+	b2World* world = m_body->GetWorld();
+
+	if (world == nullptr)
+	{
+		return;
+	}
+
 	// Flag associated contacts for filtering.
 	b2ContactEdge* edge = m_body->GetContactList();
 	while (edge)
@@ -200,19 +216,12 @@ void b2Fixture::Refilter()
 		b2Fixture* fixtureB = contact->GetFixtureB();
 		if (fixtureA == this || fixtureB == this)
 		{
-			contact->FlagForFiltering();
+			world->m_contactManager.FlagForFiltering(contact);
 		}
 
 		edge = edge->next;
 	}
 
-	b2World* world = m_body->GetWorld();
-
-	if (world == nullptr)
-	{
-		return;
-	}
-
 	// Touch each proxy so that new pairs may be created
 	b2BroadPhase* broadPhase = &world->m_contactManager.m_broadPhase;
 	for (int32 i = 0; i < m_proxyCount; ++i)
@@ -276,6 +285,7 @@ void b2Fixture::Dump(int32 bodyIndex)
 				b2Dump("    vs[%d].Set(%.9g, %.9g);\n", i, s->m_vertices[i].x, s->m_vertices[i].y);
 			}
 			b2Dump("    shape.Set(vs, %d);\n", s->m_count);
+			b2Dump("    shape.m_radius = %.9g;\n", s->m_radius);
 		}
 		break;
 
@@ -294,6 +304,25 @@ void b2Fixture::Dump(int32 bodyIndex)
 		}
 		break;
 
+	case b2Shape::e_compound:
+		{
+			b2CompoundShape* s = (b2CompoundShape*)m_shape;
+			b2Dump("    b2CompoundShape shape;\n");
+			b2Dump("    b2PolygonShape ps[%d];\n", s->m_count);
+			b2Dump("    b2Vec2 vs[%d];\n", b2_maxPolygonVertices);
+			for (int32 i = 0; i < s->m_count; ++i)
+			{
+				const b2PolygonShape* p = s->m_polygons + i;
+				for (int32 j = 0; j < p->m_count; ++j)
+				{
+					b2Dump("    vs[%d].Set(%.9g, %.9g);\n", j, p->m_vertices[j].x, p->m_vertices[j].y);
+				}
+				b2Dump("    ps[%d].Set(vs, %d);\n", i, p->m_count);
+			}
+			b2Dump("    shape.Create(ps, %d);\n", s->m_count);
+		}
+		break;
+
 	default:
 		return;
 	}
@@ -30,8 +30,11 @@
 #include "box2d/b2_world.h"
 
 #include "b2_island.h"
+#include "b2_joint_solver.h"
 #include "dynamics/b2_contact_solver.h"
 
+#include <string.h>
+
 /*
 Position Correction Notes
 =========================
@@ -163,9 +166,12 @@ b2Island::b2Island(
 	m_bodyCount = 0;
 	m_contactCount = 0;
 	m_jointCount = 0;
+	m_islandCount = 0;
 
 	m_allocator = allocator;
 	m_listener = listener;
+	m_hash = nullptr;
+	m_wideJoints = false;
 
 	m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
@@ -173,11 +179,19 @@ b2Island::b2Island(
 
 	m_velocities = (b2Velocity*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Velocity));
 	m_positions = (b2Position*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Position));
+	m_islandStarts = (int32*)m_allocator->Allocate(m_bodyCapacity * sizeof(int32));
+	m_bodyIslands = (int32*)m_allocator->Allocate(m_bodyCapacity * sizeof(int32));
+	m_islandOkay = (bool*)m_allocator->Allocate(m_bodyCapacity * sizeof(bool));
+	m_islandSolved = (bool*)m_allocator->Allocate(m_bodyCapacity * sizeof(bool));
 }
 
 b2Island::~b2Island()
 {
 	// Warning: the order should reverse the constructor order.
+	m_allocator->Free(m_islandSolved);
+	m_allocator->Free(m_islandOkay);
+	m_allocator->Free(m_bodyIslands);
+	m_allocator->Free(m_islandStarts);
 	m_allocator->Free(m_positions);
 	m_allocator->Free(m_velocities);
 	m_allocator->Free(m_joints);
@@ -252,11 +266,9 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	{
 		contactSolver.WarmStart();
 	}
-	
-	for (int32 i = 0; i < m_jointCount; ++i)
-	{
-		m_joints[i]->InitVelocityConstraints(solverData);
-	}
+
+	b2JointSolver jointSolver(m_joints, m_jointCount, m_allocator, m_wideJoints);
+	jointSolver.InitVelocityConstraints(solverData);
 
 	profile->solveInit = timer.GetMilliseconds();
 
@@ -264,15 +276,13 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	timer.Reset();
 	for (int32 i = 0; i < step.velocityIterations; ++i)
 	{
-		for (int32 j = 0; j < m_jointCount; ++j)
-		{
-			m_joints[j]->SolveVelocityConstraints(solverData);
-		}
+		jointSolver.SolveVelocityConstraints(solverData);
 
 		contactSolver.SolveVelocityConstraints();
 	}
 
 	// Store impulses for warm starting
+	jointSolver.StoreImpulses();
 	contactSolver.StoreImpulses();
 	profile->solveVelocity = timer.GetMilliseconds();
 
@@ -311,25 +321,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
 	// Solve position constraints
 	timer.Reset();
-	bool positionSolved = false;
-	for (int32 i = 0; i < step.positionIterations; ++i)
-	{
-		bool contactsOkay = contactSolver.SolvePositionConstraints();
-
-		bool jointsOkay = true;
-		for (int32 j = 0; j < m_jointCount; ++j)
-		{
-			bool jointOkay = m_joints[j]->SolvePositionConstraints(solverData);
-			jointsOkay = jointsOkay && jointOkay;
-		}
-
-		if (contactsOkay && jointsOkay)
-		{
-			// Exit early if the position errors are small.
-			positionSolved = true;
-			break;
-		}
-	}
+	bool positionSolved = SolvePositionConstraints(&contactSolver, &jointSolver, solverData, step.positionIterations);
 
 	// Copy state buffers back to the bodies
 	for (int32 i = 0; i < m_bodyCount; ++i)
@@ -344,16 +336,263 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
 	profile->solvePosition = timer.GetMilliseconds();
 
-	Report(contactSolver.m_velocityConstraints);
+	Report(contactSolver.m_velocityConstraints, contactSolver.m_count);
+	UpdateHash(contactSolver.m_velocityConstraints, contactSolver.m_count);
 
 	if (allowSleep)
 	{
-		float minSleepTime = b2_maxFloat;
+		UpdateSleep(h, positionSolved);
+	}
+}
+
+// Soft step solver. The step is divided into sub-steps. Each sub-step integrates
+// velocities, solves the contacts as soft constraints with a bias, integrates positions,
+// and then relaxes the contacts without the bias to remove the velocity added by
+// the position correction. There is no contact position solver and the velocity
+// iteration count is not used.
+void b2Island::SolveSoft(b2Profile* profile, const b2TimeStep& step, int32 subStepCount,
+						 const b2Vec2& gravity, bool allowSleep)
+{
+	b2Timer timer;
+
+	b2Assert(subStepCount > 0);
+
+	float h = step.dt / subStepCount;
+
+	// Initialize the body state.
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+
+		// Store positions for continuous collision.
+		b->m_sweep.c0 = b->m_sweep.c;
+		b->m_sweep.a0 = b->m_sweep.a;
+
+		m_positions[i].c = b->m_sweep.c;
+		m_positions[i].a = b->m_sweep.a;
+		m_velocities[i].v = b->m_linearVelocity;
+		m_velocities[i].w = b->m_angularVelocity;
+	}
+
+	b2TimeStep subStep;
+	subStep.dt = h;
+	subStep.inv_dt = h > 0.0f ? 1.0f / h : 0.0f;
+	subStep.dtRatio = step.dtRatio;
+	subStep.velocityIterations = 1;
+	subStep.positionIterations = step.positionIterations;
+	subStep.warmStarting = step.warmStarting;
+
+	// Solver data
+	b2SolverData solverData;
+	solverData.step = subStep;
+	solverData.positions = m_positions;
+	solverData.velocities = m_velocities;
+
+	// The contact solver uses the sub-step positions relative to these origins
+	// to update the separation without recomputing the manifolds.
+	b2Position* origins = (b2Position*)m_allocator->Allocate(m_bodyCount * sizeof(b2Position));
+	memcpy(origins, m_positions, m_bodyCount * sizeof(b2Position));
+
+	bool jointsOkay = true;
+
+	{
+		// Initialize velocity constraints. The restitution targets use the velocities
+		// from the beginning of the step.
+		b2ContactSolverDef contactSolverDef;
+		contactSolverDef.step = subStep;
+		contactSolverDef.contacts = m_contacts;
+		contactSolverDef.count = m_contactCount;
+		contactSolverDef.positions = m_positions;
+		contactSolverDef.velocities = m_velocities;
+		contactSolverDef.allocator = m_allocator;
+
+		b2ContactSolver contactSolver(&contactSolverDef);
+		contactSolver.InitializeVelocityConstraints();
+
+		b2JointSolver jointSolver(m_joints, m_jointCount, m_allocator, m_wideJoints);
+
+		// Stiff contact springs. The stiffness is limited by the sub-step rate.
+		const float contactHertz = b2Min(30.0f, 0.25f * subStepCount * step.inv_dt);
+		const float contactDampingRatio = 10.0f;
+		b2Softness softness = b2MakeSoft(contactHertz, contactDampingRatio, h);
+
+		profile->solveInit = timer.GetMilliseconds();
+
+		timer.Reset();
+		for (int32 subStepIndex = 0; subStepIndex < subStepCount; ++subStepIndex)
+		{
+			// Integrate velocities and apply damping.
+			for (int32 i = 0; i < m_bodyCount; ++i)
+			{
+				b2Body* b = m_bodies[i];
+				if (b->m_type != b2_dynamicBody)
+				{
+					continue;
+				}
+
+				b2Vec2 v = m_velocities[i].v;
+				float w = m_velocities[i].w;
+
+				v += h * b->m_invMass * (b->m_gravityScale * b->m_mass * gravity + b->m_force);
+				w += h * b->m_invI * b->m_torque;
+
+				v *= 1.0f / (1.0f + h * b->m_linearDamping);
+				w *= 1.0f / (1.0f + h * b->m_angularDamping);
+
+				m_velocities[i].v = v;
+				m_velocities[i].w = w;
+			}
+
+			// Joints are warm started for every sub-step. The impulses are only scaled
+			// by the step ratio on the first sub-step.
+			solverData.step.dtRatio = subStepIndex == 0 ? step.dtRatio : 1.0f;
+			jointSolver.InitVelocityConstraints(solverData);
+
+			if (step.warmStarting)
+			{
+				contactSolver.WarmStart();
+			}
+
+			jointSolver.SolveVelocityConstraints(solverData);
+			jointSolver.StoreImpulses();
+
+			contactSolver.SolveSoftVelocityConstraints(origins, softness, true);
+
+			// Integrate positions
+			for (int32 i = 0; i < m_bodyCount; ++i)
+			{
+				b2Vec2 v = m_velocities[i].v;
+				float w = m_velocities[i].w;
+
+				// Check for large velocities. The limits apply to the full step.
+				b2Vec2 translation = step.dt * v;
+				if (b2Dot(translation, translation) > b2_maxTranslationSquared)
+				{
+					float ratio = b2_maxTranslation / translation.Length();
+					v *= ratio;
+				}
+
+				float rotation = step.dt * w;
+				if (rotation * rotation > b2_maxRotationSquared)
+				{
+					float ratio = b2_maxRotation / b2Abs(rotation);
+					w *= ratio;
+				}
+
+				m_positions[i].c += h * v;
+				m_positions[i].a += h * w;
+				m_velocities[i].v = v;
+				m_velocities[i].w = w;
+			}
+
+			// Relax
+			contactSolver.SolveSoftVelocityConstraints(origins, softness, false);
+		}
 
-		const float linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
-		const float angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
+		contactSolver.ApplyRestitution();
 
+		// Store impulses for warm starting
+		contactSolver.StoreImpulses();
+		profile->solveVelocity = timer.GetMilliseconds();
+
+		// Joints still use the position solver. Without position iterations the
+		// joints count as solved.
+		timer.Reset();
+		jointsOkay = SolvePositionConstraints(nullptr, &jointSolver, solverData, step.positionIterations);
+		jointsOkay = jointsOkay || step.positionIterations == 0;
+
+		// Copy state buffers back to the bodies
 		for (int32 i = 0; i < m_bodyCount; ++i)
+		{
+			b2Body* body = m_bodies[i];
+			body->m_sweep.c = m_positions[i].c;
+			body->m_sweep.a = m_positions[i].a;
+			body->m_linearVelocity = m_velocities[i].v;
+			body->m_angularVelocity = m_velocities[i].w;
+			body->SynchronizeTransform();
+		}
+
+		profile->solvePosition = timer.GetMilliseconds();
+
+		Report(contactSolver.m_velocityConstraints, contactSolver.m_count);
+		UpdateHash(contactSolver.m_velocityConstraints, contactSolver.m_count);
+	}
+
+	m_allocator->Free(origins);
+
+	if (allowSleep)
+	{
+		UpdateSleep(step.dt, jointsOkay);
+	}
+}
+
+bool b2Island::SolvePositionConstraints(b2ContactSolver* contactSolver, b2JointSolver* jointSolver,
+										const b2SolverData& solverData, int32 iterations)
+{
+	// The islands of a batch are checked one by one, so a settled island can fall
+	// asleep while another island of the batch is still being corrected.
+	const int32* bodyIslands = nullptr;
+	bool* islandOkay = nullptr;
+	if (m_islandCount > 1)
+	{
+		bodyIslands = m_bodyIslands;
+		islandOkay = m_islandOkay;
+		for (int32 k = 0; k < m_islandCount; ++k)
+		{
+			m_islandSolved[k] = false;
+		}
+	}
+
+	for (int32 i = 0; i < iterations; ++i)
+	{
+		if (islandOkay != nullptr)
+		{
+			for (int32 k = 0; k < m_islandCount; ++k)
+			{
+				islandOkay[k] = true;
+			}
+		}
+
+		bool contactsOkay = true;
+		if (contactSolver != nullptr)
+		{
+			contactsOkay = contactSolver->SolvePositionConstraints(bodyIslands, islandOkay);
+		}
+
+		bool jointsOkay = jointSolver->SolvePositionConstraints(solverData, bodyIslands, islandOkay);
+
+		if (islandOkay != nullptr)
+		{
+			for (int32 k = 0; k < m_islandCount; ++k)
+			{
+				m_islandSolved[k] = m_islandSolved[k] || islandOkay[k];
+			}
+		}
+
+		if (contactsOkay && jointsOkay)
+		{
+			// Exit early if the position errors are small.
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void b2Island::UpdateSleep(float h, bool positionSolved)
+{
+	const float linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
+	const float angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
+
+	// Islands in a batch fall asleep separately.
+	int32 islandCount = b2Max(m_islandCount, 1);
+	for (int32 k = 0; k < islandCount; ++k)
+	{
+		int32 begin = m_islandCount > 0 ? m_islandStarts[k] : 0;
+		int32 end = k + 1 < m_islandCount ? m_islandStarts[k + 1] : m_bodyCount;
+
+		float minSleepTime = b2_maxFloat;
+		for (int32 i = begin; i < end; ++i)
 		{
 			b2Body* b = m_bodies[i];
 			if (b->GetType() == b2_staticBody)
@@ -375,9 +614,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 			}
 		}
 
-		if (minSleepTime >= b2_timeToSleep && positionSolved)
+		bool islandSolved = positionSolved || (m_islandCount > 1 && m_islandSolved[k]);
+		if (minSleepTime >= b2_timeToSleep && islandSolved)
 		{
-			for (int32 i = 0; i < m_bodyCount; ++i)
+			for (int32 i = begin; i < end; ++i)
 			{
 				b2Body* b = m_bodies[i];
 				b->SetAwake(false);
@@ -515,22 +755,24 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 		body->SynchronizeTransform();
 	}
 
-	Report(contactSolver.m_velocityConstraints);
+	Report(contactSolver.m_velocityConstraints, contactSolver.m_count);
+	UpdateHash(contactSolver.m_velocityConstraints, contactSolver.m_count);
 }
 
-void b2Island::Report(const b2ContactVelocityConstraint* constraints)
+// Compound shape contacts have one constraint per child manifold and are reported
+// once for each.
+void b2Island::Report(const b2ContactVelocityConstraint* constraints, int32 count)
 {
 	if (m_listener == nullptr)
 	{
 		return;
 	}
 
-	for (int32 i = 0; i < m_contactCount; ++i)
+	for (int32 i = 0; i < count; ++i)
 	{
-		b2Contact* c = m_contacts[i];
-
 		const b2ContactVelocityConstraint* vc = constraints + i;
-		
+		b2Contact* c = m_contacts[vc->contactIndex];
+
 		b2ContactImpulse impulse;
 		impulse.count = vc->pointCount;
 		for (int32 j = 0; j < vc->pointCount; ++j)
@@ -542,3 +784,36 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 		m_listener->PostSolve(c, &impulse);
 	}
 }
+
+// Accumulate the solved state into the world step hash. The island order and the
+// body and contact order within an island are deterministic.
+void b2Island::UpdateHash(const b2ContactVelocityConstraint* constraints, int32 count)
+{
+	if (m_hash == nullptr)
+	{
+		return;
+	}
+
+	uint32 hash = *m_hash;
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		hash = b2HashFloat(hash, m_positions[i].c.x);
+		hash = b2HashFloat(hash, m_positions[i].c.y);
+		hash = b2HashFloat(hash, m_positions[i].a);
+		hash = b2HashFloat(hash, m_velocities[i].v.x);
+		hash = b2HashFloat(hash, m_velocities[i].v.y);
+		hash = b2HashFloat(hash, m_velocities[i].w);
+	}
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		const b2ContactVelocityConstraint* vc = constraints + i;
+		for (int32 j = 0; j < vc->pointCount; ++j)
+		{
+			hash = b2HashFloat(hash, vc->points[j].normalImpulse);
+			hash = b2HashFloat(hash, vc->points[j].tangentImpulse);
+		}
+	}
+
+	*m_hash = hash;
+}
@@ -28,11 +28,14 @@
 #include "box2d/b2_time_step.h"
 
 class b2Contact;
+class b2ContactSolver;
 class b2Joint;
+class b2JointSolver;
 class b2StackAllocator;
 class b2ContactListener;
 struct b2ContactVelocityConstraint;
 struct b2Profile;
+struct b2SolverData;
 
 /// This is an internal class.
 class b2Island
@@ -47,10 +50,22 @@ public:
 		m_bodyCount = 0;
 		m_contactCount = 0;
 		m_jointCount = 0;
+		m_islandCount = 0;
+	}
+
+	/// Start a new island. Several independent islands can be solved together as
+	/// a batch. They share the solvers but each island falls asleep on its own.
+	void BeginIsland()
+	{
+		b2Assert(m_islandCount < m_bodyCapacity);
+		m_islandStarts[m_islandCount++] = m_bodyCount;
 	}
 
 	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
 
+	void SolveSoft(b2Profile* profile, const b2TimeStep& step, int32 subStepCount,
+				   const b2Vec2& gravity, bool allowSleep);
+
 	void SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB);
 
 	void Add(b2Body* body)
@@ -58,6 +73,7 @@ public:
 		b2Assert(m_bodyCount < m_bodyCapacity);
 		body->m_islandIndex = m_bodyCount;
 		m_bodies[m_bodyCount] = body;
+		m_bodyIslands[m_bodyCount] = m_islandCount - 1;
 		++m_bodyCount;
 	}
 
@@ -73,11 +89,26 @@ public:
 		m_joints[m_jointCount++] = joint;
 	}
 
-	void Report(const b2ContactVelocityConstraint* constraints);
+	void Report(const b2ContactVelocityConstraint* constraints, int32 count);
+
+	/// Solve the position constraints. In a batch each island records whether it
+	/// was solved in m_islandSolved.
+	bool SolvePositionConstraints(b2ContactSolver* contactSolver, b2JointSolver* jointSolver,
+								  const b2SolverData& solverData, int32 iterations);
+
+	void UpdateSleep(float h, bool positionSolved);
+
+	void UpdateHash(const b2ContactVelocityConstraint* constraints, int32 count);
 
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
 
+	// The world step hash. The solved state is accumulated into this if not null.
+	uint32* m_hash;
+
+	// Solve revolute and weld joints with the wide joint solver.
+	bool m_wideJoints;
+
 	b2Body** m_bodies;
 	b2Contact** m_contacts;
 	b2Joint** m_joints;
@@ -85,6 +116,16 @@ public:
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
 
+	// The bodies of island i start at m_islandStarts[i]. m_bodyIslands holds the
+	// island of each body.
+	int32* m_islandStarts;
+	int32* m_bodyIslands;
+	int32 m_islandCount;
+
+	// Position solver results of the islands in a batch.
+	bool* m_islandOkay;
+	bool* m_islandSolved;
+
 	int32 m_bodyCount;
 	int32 m_jointCount;
 	int32 m_contactCount;
@@ -0,0 +1,124 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "b2_joint_solver.h"
+#include "b2_wide_joint_solver.h"
+
+#include "box2d/b2_body.h"
+#include "box2d/b2_stack_allocator.h"
+
+#include <new>
+
+b2JointSolver::b2JointSolver(b2Joint** joints, int32 count, b2StackAllocator* allocator, bool wide)
+{
+	m_allocator = allocator;
+	m_joints = joints;
+	m_count = count;
+
+	m_wide = nullptr;
+	if (wide)
+	{
+		for (int32 i = 0; i < count; ++i)
+		{
+			b2JointType type = joints[i]->m_type;
+			if (type == e_revoluteJoint || type == e_weldJoint)
+			{
+				void* mem = m_allocator->Allocate(sizeof(b2WideJointSolver));
+				m_wide = new (mem) b2WideJointSolver(m_joints, m_count, m_allocator);
+				break;
+			}
+		}
+	}
+}
+
+b2JointSolver::~b2JointSolver()
+{
+	if (m_wide)
+	{
+		m_wide->~b2WideJointSolver();
+		m_allocator->Free(m_wide);
+	}
+}
+
+void b2JointSolver::InitVelocityConstraints(const b2SolverData& data)
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_joints[i]->InitVelocityConstraints(data);
+	}
+
+	if (m_wide)
+	{
+		m_wide->Prepare(data);
+	}
+}
+
+void b2JointSolver::SolveVelocityConstraints(const b2SolverData& data)
+{
+	if (m_wide == nullptr)
+	{
+		for (int32 i = 0; i < m_count; ++i)
+		{
+			m_joints[i]->SolveVelocityConstraints(data);
+		}
+		return;
+	}
+
+	m_wide->SolveVelocityConstraints(data);
+
+	// The wide solver handles the revolute and weld joints.
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2Joint* joint = m_joints[i];
+		if (joint->m_type != e_revoluteJoint && joint->m_type != e_weldJoint)
+		{
+			joint->SolveVelocityConstraints(data);
+		}
+	}
+}
+
+void b2JointSolver::StoreImpulses()
+{
+	if (m_wide)
+	{
+		m_wide->StoreImpulses();
+	}
+}
+
+bool b2JointSolver::SolvePositionConstraints(const b2SolverData& data, const int32* bodyIslands, bool* islandOkay)
+{
+	bool okay = true;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2Joint* joint = m_joints[i];
+		bool jointOkay = joint->SolvePositionConstraints(data);
+		okay = okay && jointOkay;
+
+		if (islandOkay != nullptr && jointOkay == false)
+		{
+			// Static bodies may be shared by several islands.
+			b2Body* body = joint->m_bodyA->m_type != b2_staticBody ? joint->m_bodyA : joint->m_bodyB;
+			islandOkay[bodyIslands[body->m_islandIndex]] = false;
+		}
+	}
+	return okay;
+}
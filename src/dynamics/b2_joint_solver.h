@@ -0,0 +1,60 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_JOINT_SOLVER_H
+#define B2_JOINT_SOLVER_H
+
+#include "box2d/b2_joint.h"
+#include "box2d/b2_time_step.h"
+
+class b2StackAllocator;
+class b2WideJointSolver;
+
+/// Solves the joints of an island in island order.
+/// If wide is true the velocity constraints of revolute and weld joints are
+/// solved by a b2WideJointSolver. The other joints keep their island order.
+class b2JointSolver
+{
+public:
+	b2JointSolver(b2Joint** joints, int32 count, b2StackAllocator* allocator, bool wide = false);
+	~b2JointSolver();
+
+	void InitVelocityConstraints(const b2SolverData& data);
+	void SolveVelocityConstraints(const b2SolverData& data);
+
+	/// If islandOkay is not null, the entries of islands with a joint that isn't
+	/// solved are set to false. bodyIslands gives the island of each body.
+	bool SolvePositionConstraints(const b2SolverData& data, const int32* bodyIslands = nullptr, bool* islandOkay = nullptr);
+
+	/// Copy impulses held by the wide solver back to the joints. Call after
+	/// solving the velocity constraints.
+	void StoreImpulses();
+
+private:
+
+	b2StackAllocator* m_allocator;
+	b2Joint** m_joints;
+	int32 m_count;
+	b2WideJointSolver* m_wide;
+};
+
+#endif
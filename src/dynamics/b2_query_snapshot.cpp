@@ -0,0 +1,274 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "b2_query_snapshot.h"
+
+#include "box2d/b2_broad_phase.h"
+#include "box2d/b2_body.h"
+#include "box2d/b2_fixture.h"
+#include "box2d/b2_growable_stack.h"
+#include "box2d/b2_world_callbacks.h"
+
+#include <thread>
+
+b2QuerySnapshot::b2QuerySnapshot()
+{
+	for (int32 i = 0; i < 2; ++i)
+	{
+		m_buffers[i].nodes = nullptr;
+		m_buffers[i].capacity = 0;
+		m_buffers[i].root = b2_nullNode;
+		m_buffers[i].readers.store(0);
+	}
+
+	m_current.store(nullptr);
+}
+
+b2QuerySnapshot::~b2QuerySnapshot()
+{
+	b2Assert(m_buffers[0].readers.load() == 0 && m_buffers[1].readers.load() == 0);
+	b2Free(m_buffers[0].nodes);
+	b2Free(m_buffers[1].nodes);
+}
+
+b2SnapshotBuffer* b2QuerySnapshot::Acquire() const
+{
+	for (;;)
+	{
+		b2SnapshotBuffer* buffer = m_current.load();
+		if (buffer == nullptr)
+		{
+			return nullptr;
+		}
+
+		buffer->readers.fetch_add(1);
+
+		// The publisher may have started rewriting this buffer before the
+		// reference was taken. It only does so after publishing the other one.
+		if (m_current.load() == buffer)
+		{
+			return buffer;
+		}
+
+		buffer->readers.fetch_sub(1);
+	}
+}
+
+void b2QuerySnapshot::Release(b2SnapshotBuffer* buffer) const
+{
+	buffer->readers.fetch_sub(1);
+}
+
+void b2QuerySnapshot::Publish(const b2BroadPhase& broadPhase)
+{
+	b2SnapshotBuffer* current = m_current.load();
+	b2SnapshotBuffer* buffer = current == m_buffers ? m_buffers + 1 : m_buffers;
+
+	// Readers that acquired this buffer before the last publish.
+	while (buffer->readers.load() > 0)
+	{
+		std::this_thread::yield();
+	}
+
+	const b2DynamicTree& tree = broadPhase.m_tree;
+	if (buffer->capacity < tree.m_nodeCapacity)
+	{
+		b2Free(buffer->nodes);
+		buffer->capacity = tree.m_nodeCapacity;
+		buffer->nodes = (b2SnapshotNode*)b2Alloc(buffer->capacity * sizeof(b2SnapshotNode));
+	}
+
+	// Node indices are kept so the children need no remapping. Free nodes are
+	// not reachable from the root and are skipped.
+	for (int32 i = 0; i < tree.m_nodeCapacity; ++i)
+	{
+		const b2TreeNode* node = tree.m_nodes + i;
+		if (node->height < 0)
+		{
+			continue;
+		}
+
+		b2SnapshotNode* copy = buffer->nodes + i;
+		copy->aabb = node->aabb;
+		copy->child1 = node->child1;
+		copy->child2 = node->child2;
+
+		if (node->IsLeaf())
+		{
+			b2FixtureProxy* proxy = (b2FixtureProxy*)node->userData;
+			copy->fixture = proxy->fixture;
+			copy->shape = proxy->fixture->GetShape();
+			copy->childIndex = proxy->childIndex;
+			copy->transform = proxy->fixture->GetBody()->GetTransform();
+		}
+	}
+
+	buffer->root = tree.m_root;
+
+	m_current.store(buffer);
+}
+
+void b2QuerySnapshot::WaitForStaleReaders() const
+{
+	b2SnapshotBuffer* current = m_current.load();
+	const b2SnapshotBuffer* stale = current == m_buffers ? m_buffers + 1 : m_buffers;
+	while (stale->readers.load() > 0)
+	{
+		std::this_thread::yield();
+	}
+}
+
+void b2QuerySnapshot::QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const
+{
+	b2SnapshotBuffer* buffer = Acquire();
+	if (buffer == nullptr)
+	{
+		return;
+	}
+
+	const b2SnapshotNode* nodes = buffer->nodes;
+
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(buffer->root);
+
+	while (stack.GetCount() > 0)
+	{
+		int32 nodeId = stack.Pop();
+		if (nodeId == b2_nullNode)
+		{
+			continue;
+		}
+
+		const b2SnapshotNode* node = nodes + nodeId;
+
+		if (b2TestOverlap(node->aabb, aabb))
+		{
+			if (node->child1 == b2_nullNode)
+			{
+				if (callback->ReportFixture(node->fixture) == false)
+				{
+					break;
+				}
+			}
+			else
+			{
+				stack.Push(node->child1);
+				stack.Push(node->child2);
+			}
+		}
+	}
+
+	Release(buffer);
+}
+
+void b2QuerySnapshot::RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const
+{
+	b2SnapshotBuffer* buffer = Acquire();
+	if (buffer == nullptr)
+	{
+		return;
+	}
+
+	const b2SnapshotNode* nodes = buffer->nodes;
+
+	b2Vec2 r = point2 - point1;
+	b2Assert(r.LengthSquared() > 0.0f);
+	r.Normalize();
+
+	// v is perpendicular to the segment.
+	b2Vec2 v = b2Cross(1.0f, r);
+	b2Vec2 abs_v = b2Abs(v);
+
+	b2RayCastInput input;
+	input.p1 = point1;
+	input.p2 = point2;
+	input.maxFraction = 1.0f;
+
+	// Build a bounding box for the segment.
+	b2AABB segmentAABB;
+	segmentAABB.lowerBound = b2Min(point1, point2);
+	segmentAABB.upperBound = b2Max(point1, point2);
+
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(buffer->root);
+
+	while (stack.GetCount() > 0)
+	{
+		int32 nodeId = stack.Pop();
+		if (nodeId == b2_nullNode)
+		{
+			continue;
+		}
+
+		const b2SnapshotNode* node = nodes + nodeId;
+
+		if (b2TestOverlap(node->aabb, segmentAABB) == false)
+		{
+			continue;
+		}
+
+		// Separating axis for segment (Gino, p80).
+		// |dot(v, p1 - c)| > dot(|v|, h)
+		b2Vec2 c = node->aabb.GetCenter();
+		b2Vec2 h = node->aabb.GetExtents();
+		float separation = b2Abs(b2Dot(v, point1 - c)) - b2Dot(abs_v, h);
+		if (separation > 0.0f)
+		{
+			continue;
+		}
+
+		if (node->child1 != b2_nullNode)
+		{
+			stack.Push(node->child1);
+			stack.Push(node->child2);
+			continue;
+		}
+
+		// The shape is tested at the published transform.
+		b2RayCastOutput output;
+		if (node->shape->RayCast(&output, input, node->transform, node->childIndex) == false)
+		{
+			continue;
+		}
+
+		float fraction = output.fraction;
+		b2Vec2 point = (1.0f - fraction) * point1 + fraction * point2;
+		float value = callback->ReportFixture(node->fixture, point, output.normal, fraction);
+
+		if (value == 0.0f)
+		{
+			// The client has terminated the ray cast.
+			break;
+		}
+
+		if (value > 0.0f)
+		{
+			// Update segment bounding box.
+			input.maxFraction = value;
+			b2Vec2 t = point1 + value * (point2 - point1);
+			segmentAABB.lowerBound = b2Min(point1, t);
+			segmentAABB.upperBound = b2Max(point1, t);
+		}
+	}
+
+	Release(buffer);
+}
@@ -0,0 +1,91 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_QUERY_SNAPSHOT_H
+#define B2_QUERY_SNAPSHOT_H
+
+#include "box2d/b2_collision.h"
+#include "box2d/b2_math.h"
+
+#include <atomic>
+
+class b2BroadPhase;
+class b2Fixture;
+class b2QueryCallback;
+class b2RayCastCallback;
+class b2Shape;
+
+/// A broad-phase tree node copied into a snapshot. Leaves keep the fixture
+/// transform at the time the snapshot was published.
+struct b2SnapshotNode
+{
+	b2AABB aabb;
+	int32 child1;
+	int32 child2;
+	b2Fixture* fixture;
+	const b2Shape* shape;
+	int32 childIndex;
+	b2Transform transform;
+};
+
+struct b2SnapshotBuffer
+{
+	b2SnapshotNode* nodes;
+	int32 capacity;
+	int32 root;
+
+	// Number of threads reading this buffer.
+	std::atomic<int32> readers;
+};
+
+/// A double buffered read only copy of the broad-phase. One thread publishes
+/// while any number of threads query. Readers only touch a reference count so
+/// queries never block. The publisher writes the idle buffer and waits only if
+/// a reader still holds it from two publishes ago.
+class b2QuerySnapshot
+{
+public:
+	b2QuerySnapshot();
+	~b2QuerySnapshot();
+
+	/// Copy the broad-phase into the idle buffer and make it current.
+	void Publish(const b2BroadPhase& broadPhase);
+
+	/// Wait until no reader holds a buffer older than the current one.
+	void WaitForStaleReaders() const;
+
+	/// Thread safe.
+	void QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const;
+
+	/// Thread safe.
+	void RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const;
+
+private:
+
+	b2SnapshotBuffer* Acquire() const;
+	void Release(b2SnapshotBuffer* buffer) const;
+
+	mutable b2SnapshotBuffer m_buffers[2];
+	std::atomic<b2SnapshotBuffer*> m_current;
+};
+
+#endif
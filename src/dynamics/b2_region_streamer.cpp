@@ -0,0 +1,258 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_body.h"
+#include "box2d/b2_fixture.h"
+#include "box2d/b2_region_streamer.h"
+#include "box2d/b2_world.h"
+
+#include <string.h>
+
+// Distance from a point to an AABB. Zero if the point is inside.
+static float b2DistanceToAABB(const b2AABB& aabb, const b2Vec2& p)
+{
+	b2Vec2 d = b2Max(aabb.lowerBound - p, p - aabb.upperBound);
+	d = b2Max(d, b2Vec2_zero);
+	return d.Length();
+}
+
+b2RegionStreamer::b2RegionStreamer(b2World* world)
+{
+	m_world = world;
+	m_origin = world->GetOrigin();
+
+	m_regionCapacity = 16;
+	m_regionCount = 0;
+	m_regions = (b2Region*)b2Alloc(m_regionCapacity * sizeof(b2Region));
+	m_loaded = (int32*)b2Alloc(m_regionCapacity * sizeof(int32));
+	m_loadedCount = 0;
+	m_queue = (int32*)b2Alloc(m_regionCapacity * sizeof(int32));
+	m_queueCount = 0;
+
+	m_queryPoint.SetZero();
+	m_loadDistance = 50.0f * b2_lengthUnitsPerMeter;
+	m_unloadDistance = 60.0f * b2_lengthUnitsPerMeter;
+}
+
+b2RegionStreamer::~b2RegionStreamer()
+{
+	while (m_loadedCount > 0)
+	{
+		Unload(m_loaded[m_loadedCount - 1]);
+	}
+
+	b2Free(m_regions);
+	b2Free(m_loaded);
+	b2Free(m_queue);
+}
+
+int32 b2RegionStreamer::AddRegion(const b2RegionDef* def)
+{
+	if (m_regionCount == m_regionCapacity)
+	{
+		b2Region* oldRegions = m_regions;
+		m_regionCapacity *= 2;
+		m_regions = (b2Region*)b2Alloc(m_regionCapacity * sizeof(b2Region));
+		memcpy(m_regions, oldRegions, m_regionCount * sizeof(b2Region));
+		b2Free(oldRegions);
+
+		int32* oldLoaded = m_loaded;
+		m_loaded = (int32*)b2Alloc(m_regionCapacity * sizeof(int32));
+		memcpy(m_loaded, oldLoaded, m_loadedCount * sizeof(int32));
+		b2Free(oldLoaded);
+
+		b2Free(m_queue);
+		m_queue = (int32*)b2Alloc(m_regionCapacity * sizeof(int32));
+	}
+
+	int32 index = m_regionCount;
+	b2Region* region = m_regions + index;
+	region->def = *def;
+	region->body = nullptr;
+	region->loadedIndex = -1;
+	region->queued = false;
+
+	// Compute the bounds of the region geometry.
+	b2Transform xf(def->position, b2Rot(def->angle));
+	region->bounds.lowerBound.Set(b2_maxFloat, b2_maxFloat);
+	region->bounds.upperBound.Set(-b2_maxFloat, -b2_maxFloat);
+	for (int32 i = 0; i < def->fixtureCount; ++i)
+	{
+		const b2Shape* shape = def->fixtures[i].shape;
+		int32 childCount = shape->GetChildCount();
+		for (int32 j = 0; j < childCount; ++j)
+		{
+			b2AABB aabb;
+			shape->ComputeAABB(&aabb, xf, j);
+			region->bounds.Combine(aabb);
+		}
+	}
+
+	if (def->fixtureCount == 0)
+	{
+		region->bounds.lowerBound = def->position;
+		region->bounds.upperBound = def->position;
+	}
+
+	// The tree proxy id is not needed since regions are never removed.
+	m_tree.CreateProxy(region->bounds, (void*)(intptr_t)index);
+
+	++m_regionCount;
+	return index;
+}
+
+void b2RegionStreamer::SetDistances(float loadDistance, float unloadDistance)
+{
+	b2Assert(0.0f <= loadDistance && loadDistance <= unloadDistance);
+	m_loadDistance = loadDistance;
+	m_unloadDistance = unloadDistance;
+}
+
+bool b2RegionStreamer::QueryCallback(int32 proxyId)
+{
+	int32 index = (int32)(intptr_t)m_tree.GetUserData(proxyId);
+	b2Region* region = m_regions + index;
+	if (region->body != nullptr || region->queued)
+	{
+		return true;
+	}
+
+	if (b2DistanceToAABB(region->bounds, m_queryPoint) <= m_loadDistance)
+	{
+		region->queued = true;
+		m_queue[m_queueCount++] = index;
+	}
+
+	return true;
+}
+
+void b2RegionStreamer::Update(const b2Vec2* points, int32 pointCount)
+{
+	b2Assert(m_world->IsLocked() == false);
+	if (m_world->IsLocked())
+	{
+		return;
+	}
+
+	// Convert the points to the streamer frame in case the world origin moved.
+	b2Vec2d worldOrigin = m_world->GetOrigin();
+	b2Vec2 offset(float(worldOrigin.x - m_origin.x), float(worldOrigin.y - m_origin.y));
+
+	// Unload regions that are far from every point. Walk backwards because
+	// unloading moves the last loaded region into the hole.
+	for (int32 i = m_loadedCount - 1; i >= 0; --i)
+	{
+		int32 index = m_loaded[i];
+		const b2AABB& bounds = m_regions[index].bounds;
+
+		bool keep = false;
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			if (b2DistanceToAABB(bounds, points[j] + offset) <= m_unloadDistance)
+			{
+				keep = true;
+				break;
+			}
+		}
+
+		if (keep == false)
+		{
+			Unload(index);
+		}
+	}
+
+	// Find the regions to load.
+	m_queueCount = 0;
+	for (int32 i = 0; i < pointCount; ++i)
+	{
+		m_queryPoint = points[i] + offset;
+
+		b2Vec2 r(m_loadDistance, m_loadDistance);
+		b2AABB aabb;
+		aabb.lowerBound = m_queryPoint - r;
+		aabb.upperBound = m_queryPoint + r;
+		m_tree.Query(this, aabb);
+	}
+
+	Load(m_queueCount);
+}
+
+void b2RegionStreamer::Load(int32 count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// Region positions are relative to the streamer origin. Convert in double
+	// precision so regions far from the world origin are placed exactly.
+	b2Vec2d worldOrigin = m_world->GetOrigin();
+	double dx = m_origin.x - worldOrigin.x;
+	double dy = m_origin.y - worldOrigin.y;
+
+	// Create the bodies disabled so the fixtures do not create proxies one at a time.
+	b2Body** bodies = (b2Body**)b2Alloc(count * sizeof(b2Body*));
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 index = m_queue[i];
+		b2Region* region = m_regions + index;
+		region->queued = false;
+
+		b2BodyDef bodyDef;
+		bodyDef.type = b2_staticBody;
+		bodyDef.position.x = float(dx + double(region->def.position.x));
+		bodyDef.position.y = float(dy + double(region->def.position.y));
+		bodyDef.angle = region->def.angle;
+		bodyDef.userData = region->def.userData;
+		bodyDef.enabled = false;
+
+		b2Body* body = m_world->CreateBody(&bodyDef);
+		for (int32 j = 0; j < region->def.fixtureCount; ++j)
+		{
+			body->CreateFixture(region->def.fixtures + j);
+		}
+
+		region->body = body;
+		region->loadedIndex = m_loadedCount;
+		m_loaded[m_loadedCount++] = index;
+		bodies[i] = body;
+	}
+
+	m_world->EnableBodies(bodies, count);
+	b2Free(bodies);
+}
+
+void b2RegionStreamer::Unload(int32 index)
+{
+	b2Region* region = m_regions + index;
+	b2Assert(region->body != nullptr);
+
+	m_world->DestroyBody(region->body);
+	region->body = nullptr;
+
+	// Remove from the loaded array.
+	int32 last = m_loaded[m_loadedCount - 1];
+	m_loaded[region->loadedIndex] = last;
+	m_regions[last].loadedIndex = region->loadedIndex;
+	region->loadedIndex = -1;
+	--m_loadedCount;
+}
@@ -0,0 +1,105 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "b2_toi_queue.h"
+
+#include <string.h>
+
+b2TOIQueue::b2TOIQueue()
+{
+	m_capacity = 64;
+	m_count = 0;
+	m_events = (b2TOIEvent*)b2Alloc(m_capacity * sizeof(b2TOIEvent));
+}
+
+b2TOIQueue::~b2TOIQueue()
+{
+	b2Free(m_events);
+}
+
+void b2TOIQueue::Push(b2Contact* contact, float alpha)
+{
+	// Grow the heap as needed.
+	if (m_count == m_capacity)
+	{
+		b2TOIEvent* oldEvents = m_events;
+		m_capacity *= 2;
+		m_events = (b2TOIEvent*)b2Alloc(m_capacity * sizeof(b2TOIEvent));
+		memcpy(m_events, oldEvents, m_count * sizeof(b2TOIEvent));
+		b2Free(oldEvents);
+	}
+
+	// Sift up.
+	int32 index = m_count;
+	++m_count;
+	while (index > 0)
+	{
+		int32 parent = (index - 1) >> 1;
+		if (m_events[parent].alpha <= alpha)
+		{
+			break;
+		}
+
+		m_events[index] = m_events[parent];
+		index = parent;
+	}
+
+	m_events[index].contact = contact;
+	m_events[index].alpha = alpha;
+}
+
+void b2TOIQueue::Pop()
+{
+	b2Assert(m_count > 0);
+	--m_count;
+	if (m_count == 0)
+	{
+		return;
+	}
+
+	// Sift the last event down from the root.
+	b2TOIEvent last = m_events[m_count];
+	int32 index = 0;
+	for (;;)
+	{
+		int32 child = 2 * index + 1;
+		if (child >= m_count)
+		{
+			break;
+		}
+
+		if (child + 1 < m_count && m_events[child + 1].alpha < m_events[child].alpha)
+		{
+			child += 1;
+		}
+
+		if (last.alpha <= m_events[child].alpha)
+		{
+			break;
+		}
+
+		m_events[index] = m_events[child];
+		index = child;
+	}
+
+	m_events[index] = last;
+}
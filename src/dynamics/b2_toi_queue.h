@@ -0,0 +1,73 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_TOI_QUEUE_H
+#define B2_TOI_QUEUE_H
+
+#include "box2d/b2_settings.h"
+
+class b2Contact;
+
+/// A pending time of impact event.
+struct b2TOIEvent
+{
+	b2Contact* contact;
+	float alpha;
+};
+
+/// A binary min-heap of TOI events ordered by alpha. Entries are not removed
+/// when a contact's TOI is invalidated. Instead the world checks each popped entry
+/// against the TOI cached on the contact and discards stale entries.
+class b2TOIQueue
+{
+public:
+	b2TOIQueue();
+	~b2TOIQueue();
+
+	void Clear()
+	{
+		m_count = 0;
+	}
+
+	int32 GetCount() const
+	{
+		return m_count;
+	}
+
+	/// Get the event with the smallest alpha. The queue must not be empty.
+	const b2TOIEvent& Top() const
+	{
+		b2Assert(m_count > 0);
+		return m_events[0];
+	}
+
+	void Push(b2Contact* contact, float alpha);
+
+	void Pop();
+
+private:
+	b2TOIEvent* m_events;
+	int32 m_count;
+	int32 m_capacity;
+};
+
+#endif
@@ -0,0 +1,576 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "b2_wide_joint_solver.h"
+
+#include "box2d/b2_body.h"
+#include "box2d/b2_revolute_joint.h"
+#include "box2d/b2_stack_allocator.h"
+#include "box2d/b2_weld_joint.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// Lane access for gathering and scattering.
+static inline void b2SetLane(b2FloatW& a, int32 lane, float s)
+{
+	((float*)&a)[lane] = s;
+}
+
+static inline float b2GetLane(const b2FloatW& a, int32 lane)
+{
+	return ((const float*)&a)[lane];
+}
+
+// Body velocities for the lanes of a group. Empty lanes are zero.
+struct b2VelocityW
+{
+	b2FloatW vx, vy, w;
+};
+
+static void b2GatherVelocities(b2VelocityW* b, const int32* indices, const b2Velocity* velocities)
+{
+	static const b2Velocity zero = {b2Vec2(0.0f, 0.0f), 0.0f};
+	const b2Velocity& v0 = indices[0] >= 0 ? velocities[indices[0]] : zero;
+	const b2Velocity& v1 = indices[1] >= 0 ? velocities[indices[1]] : zero;
+	const b2Velocity& v2 = indices[2] >= 0 ? velocities[indices[2]] : zero;
+	const b2Velocity& v3 = indices[3] >= 0 ? velocities[indices[3]] : zero;
+	b->vx = b2MakeW(v0.v.x, v1.v.x, v2.v.x, v3.v.x);
+	b->vy = b2MakeW(v0.v.y, v1.v.y, v2.v.y, v3.v.y);
+	b->w = b2MakeW(v0.w, v1.w, v2.w, v3.w);
+}
+
+static void b2ScatterVelocities(b2Velocity* velocities, const int32* indices, const b2VelocityW& b)
+{
+	alignas(16) float vx[b2_simdWidth];
+	alignas(16) float vy[b2_simdWidth];
+	alignas(16) float w[b2_simdWidth];
+	b2StoreW(vx, b.vx);
+	b2StoreW(vy, b.vy);
+	b2StoreW(w, b.w);
+
+	for (int32 lane = 0; lane < b2_simdWidth; ++lane)
+	{
+		int32 index = indices[lane];
+		if (index >= 0)
+		{
+			velocities[index].v.Set(vx[lane], vy[lane]);
+			velocities[index].w = w[lane];
+		}
+	}
+}
+
+// Joint kinds in the order they are laid out in a color.
+enum b2WideJointKind
+{
+	e_wideRevolute,
+	e_wideRigidWeld,
+	e_wideSoftWeld,
+	e_wideKindCount
+};
+
+static b2WideJointKind b2GetWideJointKind(b2Joint* joint)
+{
+	if (joint->GetType() == e_revoluteJoint)
+	{
+		return e_wideRevolute;
+	}
+
+	b2Assert(joint->GetType() == e_weldJoint);
+	return static_cast<b2WeldJoint*>(joint)->GetStiffness() > 0.0f ? e_wideSoftWeld : e_wideRigidWeld;
+}
+
+static inline int32 b2GroupCount(int32 jointCount)
+{
+	return (jointCount + b2_simdWidth - 1) / b2_simdWidth;
+}
+
+b2WideJointSolver::b2WideJointSolver(b2Joint** joints, int32 count, b2StackAllocator* allocator)
+{
+	m_allocator = allocator;
+
+	int32 bodyCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		bodyCount = b2Max(bodyCount, joints[i]->GetBodyA()->m_islandIndex + 1);
+		bodyCount = b2Max(bodyCount, joints[i]->GetBodyB()->m_islandIndex + 1);
+	}
+
+	m_bodyColors = (uint32*)m_allocator->Allocate(bodyCount * sizeof(uint32));
+	m_jointColors = (int32*)m_allocator->Allocate(count * sizeof(int32));
+	m_overflow = (b2Joint**)m_allocator->Allocate(count * sizeof(b2Joint*));
+	m_overflowCount = 0;
+
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		m_bodyColors[i] = 0;
+	}
+
+	// Greedy coloring in joint order. Static and kinematic bodies don't receive
+	// impulses, so they can be shared within a color.
+	int32 counts[b2_maxJointColors][e_wideKindCount] = {};
+	m_colorCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Joint* joint = joints[i];
+		if (joint->m_type != e_revoluteJoint && joint->m_type != e_weldJoint)
+		{
+			m_jointColors[i] = -1;
+			continue;
+		}
+
+		b2Body* bodyA = joint->GetBodyA();
+		b2Body* bodyB = joint->GetBodyB();
+		bool dynamicA = bodyA->GetType() == b2_dynamicBody;
+		bool dynamicB = bodyB->GetType() == b2_dynamicBody;
+
+		uint32 used = 0;
+		if (dynamicA)
+		{
+			used |= m_bodyColors[bodyA->m_islandIndex];
+		}
+		if (dynamicB)
+		{
+			used |= m_bodyColors[bodyB->m_islandIndex];
+		}
+
+		int32 color = 0;
+		while (color < b2_maxJointColors && (used & (1u << color)) != 0)
+		{
+			++color;
+		}
+
+		if (color == b2_maxJointColors)
+		{
+			m_jointColors[i] = -1;
+			m_overflow[m_overflowCount++] = joint;
+			continue;
+		}
+
+		if (dynamicA)
+		{
+			m_bodyColors[bodyA->m_islandIndex] |= 1u << color;
+		}
+		if (dynamicB)
+		{
+			m_bodyColors[bodyB->m_islandIndex] |= 1u << color;
+		}
+
+		m_jointColors[i] = color;
+		counts[color][b2GetWideJointKind(joint)] += 1;
+		m_colorCount = b2Max(m_colorCount, color + 1);
+	}
+
+	// Lay out the groups color by color. Rigid welds come before soft welds.
+	int32 softWeldStarts[b2_maxJointColors];
+	m_revoluteStarts[0] = 0;
+	m_weldStarts[0] = 0;
+	for (int32 c = 0; c < b2_maxJointColors; ++c)
+	{
+		m_revoluteStarts[c + 1] = m_revoluteStarts[c] + b2GroupCount(counts[c][e_wideRevolute]);
+		softWeldStarts[c] = m_weldStarts[c] + b2GroupCount(counts[c][e_wideRigidWeld]);
+		m_weldStarts[c + 1] = softWeldStarts[c] + b2GroupCount(counts[c][e_wideSoftWeld]);
+	}
+
+	int32 revoluteCount = m_revoluteStarts[b2_maxJointColors];
+	int32 weldCount = m_weldStarts[b2_maxJointColors];
+
+	// The groups hold SIMD registers, so align the buffer to 16 bytes.
+	int32 size = revoluteCount * sizeof(b2WideRevolute) + weldCount * sizeof(b2WideWeld) + 16;
+	m_buffer = m_allocator->Allocate(size);
+	uintptr_t aligned = ((uintptr_t)m_buffer + 15) & ~(uintptr_t)15;
+
+	// Empty lanes stay zero. They have no mass so they never produce an impulse.
+	memset((void*)aligned, 0, size - 16);
+	m_revolutes = (b2WideRevolute*)aligned;
+	m_welds = (b2WideWeld*)(m_revolutes + revoluteCount);
+
+	for (int32 i = 0; i < revoluteCount; ++i)
+	{
+		b2WideRevolute* c = m_revolutes + i;
+		for (int32 lane = 0; lane < b2_simdWidth; ++lane)
+		{
+			c->indexA[lane] = -1;
+			c->indexB[lane] = -1;
+			c->joints[lane] = nullptr;
+		}
+	}
+
+	for (int32 c = 0; c < b2_maxJointColors; ++c)
+	{
+		for (int32 i = m_weldStarts[c]; i < m_weldStarts[c + 1]; ++i)
+		{
+			b2WideWeld* w = m_welds + i;
+			for (int32 lane = 0; lane < b2_simdWidth; ++lane)
+			{
+				w->indexA[lane] = -1;
+				w->indexB[lane] = -1;
+				w->joints[lane] = nullptr;
+			}
+			w->soft = i >= softWeldStarts[c];
+		}
+	}
+
+	// Assign the lanes.
+	int32 fill[b2_maxJointColors][e_wideKindCount] = {};
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 color = m_jointColors[i];
+		if (color < 0)
+		{
+			continue;
+		}
+
+		b2Joint* joint = joints[i];
+		b2WideJointKind kind = b2GetWideJointKind(joint);
+		int32 slot = fill[color][kind]++;
+		int32 lane = slot % b2_simdWidth;
+		int32 indexA = joint->GetBodyA()->m_islandIndex;
+		int32 indexB = joint->GetBodyB()->m_islandIndex;
+
+		if (kind == e_wideRevolute)
+		{
+			b2WideRevolute* c = m_revolutes + m_revoluteStarts[color] + slot / b2_simdWidth;
+			c->indexA[lane] = indexA;
+			c->indexB[lane] = indexB;
+			c->joints[lane] = static_cast<b2RevoluteJoint*>(joint);
+		}
+		else
+		{
+			int32 start = kind == e_wideSoftWeld ? softWeldStarts[color] : m_weldStarts[color];
+			b2WideWeld* c = m_welds + start + slot / b2_simdWidth;
+			c->indexA[lane] = indexA;
+			c->indexB[lane] = indexB;
+			c->joints[lane] = static_cast<b2WeldJoint*>(joint);
+		}
+	}
+}
+
+b2WideJointSolver::~b2WideJointSolver()
+{
+	m_allocator->Free(m_buffer);
+	m_allocator->Free(m_overflow);
+	m_allocator->Free(m_jointColors);
+	m_allocator->Free(m_bodyColors);
+}
+
+void b2WideJointSolver::Prepare(const b2SolverData& data)
+{
+	int32 revoluteCount = m_revoluteStarts[m_colorCount];
+	for (int32 i = 0; i < revoluteCount; ++i)
+	{
+		b2WideRevolute* c = m_revolutes + i;
+		for (int32 lane = 0; lane < b2_simdWidth; ++lane)
+		{
+			b2RevoluteJoint* joint = c->joints[lane];
+			if (joint == nullptr)
+			{
+				continue;
+			}
+
+			float iA = joint->m_invIA, iB = joint->m_invIB;
+			bool fixedRotation = (iA + iB == 0.0f);
+
+			const b2Mat22& K = joint->m_K;
+			float det = K.ex.x * K.ey.y - K.ey.x * K.ex.y;
+			if (det != 0.0f)
+			{
+				det = 1.0f / det;
+			}
+
+			b2SetLane(c->rAx, lane, joint->m_rA.x);
+			b2SetLane(c->rAy, lane, joint->m_rA.y);
+			b2SetLane(c->rBx, lane, joint->m_rB.x);
+			b2SetLane(c->rBy, lane, joint->m_rB.y);
+			b2SetLane(c->mA, lane, joint->m_invMassA);
+			b2SetLane(c->mB, lane, joint->m_invMassB);
+			b2SetLane(c->iA, lane, iA);
+			b2SetLane(c->iB, lane, iB);
+			b2SetLane(c->k11, lane, det * K.ey.y);
+			b2SetLane(c->k12, lane, -det * K.ey.x);
+			b2SetLane(c->k22, lane, det * K.ex.x);
+
+			bool limit = joint->m_enableLimit && fixedRotation == false;
+			bool motor = joint->m_enableMotor && fixedRotation == false;
+			b2SetLane(c->axialMass, lane, joint->m_axialMass);
+			b2SetLane(c->limitMass, lane, limit ? joint->m_axialMass : 0.0f);
+			b2SetLane(c->motorSpeed, lane, joint->m_motorSpeed);
+			b2SetLane(c->maxMotorImpulse, lane, motor ? data.step.dt * joint->m_maxMotorTorque : 0.0f);
+			b2SetLane(c->lowerBias, lane, b2Max(joint->m_angle - joint->m_lowerAngle, 0.0f) * data.step.inv_dt);
+			b2SetLane(c->upperBias, lane, b2Max(joint->m_upperAngle - joint->m_angle, 0.0f) * data.step.inv_dt);
+
+			b2SetLane(c->impulseX, lane, joint->m_impulse.x);
+			b2SetLane(c->impulseY, lane, joint->m_impulse.y);
+			b2SetLane(c->motorImpulse, lane, joint->m_motorImpulse);
+			b2SetLane(c->lowerImpulse, lane, joint->m_lowerImpulse);
+			b2SetLane(c->upperImpulse, lane, joint->m_upperImpulse);
+		}
+	}
+
+	int32 weldCount = m_weldStarts[m_colorCount];
+	for (int32 i = 0; i < weldCount; ++i)
+	{
+		b2WideWeld* c = m_welds + i;
+		for (int32 lane = 0; lane < b2_simdWidth; ++lane)
+		{
+			b2WeldJoint* joint = c->joints[lane];
+			if (joint == nullptr)
+			{
+				continue;
+			}
+
+			const b2Mat33& M = joint->m_mass;
+
+			b2SetLane(c->rAx, lane, joint->m_rA.x);
+			b2SetLane(c->rAy, lane, joint->m_rA.y);
+			b2SetLane(c->rBx, lane, joint->m_rB.x);
+			b2SetLane(c->rBy, lane, joint->m_rB.y);
+			b2SetLane(c->mA, lane, joint->m_invMassA);
+			b2SetLane(c->mB, lane, joint->m_invMassB);
+			b2SetLane(c->iA, lane, joint->m_invIA);
+			b2SetLane(c->iB, lane, joint->m_invIB);
+			b2SetLane(c->m11, lane, M.ex.x);
+			b2SetLane(c->m12, lane, M.ey.x);
+			b2SetLane(c->m13, lane, M.ez.x);
+			b2SetLane(c->m22, lane, M.ey.y);
+			b2SetLane(c->m23, lane, M.ez.y);
+			b2SetLane(c->m33, lane, M.ez.z);
+			b2SetLane(c->bias, lane, joint->m_bias);
+			b2SetLane(c->gamma, lane, joint->m_gamma);
+
+			b2SetLane(c->impulseX, lane, joint->m_impulse.x);
+			b2SetLane(c->impulseY, lane, joint->m_impulse.y);
+			b2SetLane(c->impulseZ, lane, joint->m_impulse.z);
+		}
+	}
+}
+
+void b2WideJointSolver::SolveRevolute(b2WideRevolute* c, b2Velocity* velocities)
+{
+	b2VelocityW bA, bB;
+	b2GatherVelocities(&bA, c->indexA, velocities);
+	b2GatherVelocities(&bB, c->indexB, velocities);
+
+	b2FloatW zero = b2SplatW(0.0f);
+	b2FloatW mA = c->mA, mB = c->mB;
+	b2FloatW iA = c->iA, iB = c->iB;
+	b2FloatW wA = bA.w, wB = bB.w;
+
+	// Solve motor constraint.
+	{
+		b2FloatW Cdot = b2SubW(b2SubW(wB, wA), c->motorSpeed);
+		b2FloatW impulse = b2SubW(zero, b2MulW(c->axialMass, Cdot));
+		b2FloatW oldImpulse = c->motorImpulse;
+		b2FloatW maxImpulse = c->maxMotorImpulse;
+		c->motorImpulse = b2MinW(b2MaxW(b2AddW(oldImpulse, impulse), b2SubW(zero, maxImpulse)), maxImpulse);
+		impulse = b2SubW(c->motorImpulse, oldImpulse);
+
+		wA = b2SubW(wA, b2MulW(iA, impulse));
+		wB = b2AddW(wB, b2MulW(iB, impulse));
+	}
+
+	// Lower limit
+	{
+		b2FloatW Cdot = b2SubW(wB, wA);
+		b2FloatW impulse = b2SubW(zero, b2MulW(c->limitMass, b2AddW(Cdot, c->lowerBias)));
+		b2FloatW oldImpulse = c->lowerImpulse;
+		c->lowerImpulse = b2MaxW(b2AddW(oldImpulse, impulse), zero);
+		impulse = b2SubW(c->lowerImpulse, oldImpulse);
+
+		wA = b2SubW(wA, b2MulW(iA, impulse));
+		wB = b2AddW(wB, b2MulW(iB, impulse));
+	}
+
+	// Upper limit
+	{
+		b2FloatW Cdot = b2SubW(wA, wB);
+		b2FloatW impulse = b2SubW(zero, b2MulW(c->limitMass, b2AddW(Cdot, c->upperBias)));
+		b2FloatW oldImpulse = c->upperImpulse;
+		c->upperImpulse = b2MaxW(b2AddW(oldImpulse, impulse), zero);
+		impulse = b2SubW(c->upperImpulse, oldImpulse);
+
+		wA = b2AddW(wA, b2MulW(iA, impulse));
+		wB = b2SubW(wB, b2MulW(iB, impulse));
+	}
+
+	// Solve point-to-point constraint
+	{
+		b2FloatW rAx = c->rAx, rAy = c->rAy;
+		b2FloatW rBx = c->rBx, rBy = c->rBy;
+
+		// Cdot = vB + b2Cross(wB, rB) - vA - b2Cross(wA, rA)
+		b2FloatW Cdotx = b2AddW(b2SubW(b2SubW(bB.vx, b2MulW(wB, rBy)), bA.vx), b2MulW(wA, rAy));
+		b2FloatW Cdoty = b2SubW(b2SubW(b2AddW(bB.vy, b2MulW(wB, rBx)), bA.vy), b2MulW(wA, rAx));
+
+		b2FloatW impulsex = b2SubW(zero, b2AddW(b2MulW(c->k11, Cdotx), b2MulW(c->k12, Cdoty)));
+		b2FloatW impulsey = b2SubW(zero, b2AddW(b2MulW(c->k12, Cdotx), b2MulW(c->k22, Cdoty)));
+
+		c->impulseX = b2AddW(c->impulseX, impulsex);
+		c->impulseY = b2AddW(c->impulseY, impulsey);
+
+		bA.vx = b2SubW(bA.vx, b2MulW(mA, impulsex));
+		bA.vy = b2SubW(bA.vy, b2MulW(mA, impulsey));
+		wA = b2SubW(wA, b2MulW(iA, b2SubW(b2MulW(rAx, impulsey), b2MulW(rAy, impulsex))));
+
+		bB.vx = b2AddW(bB.vx, b2MulW(mB, impulsex));
+		bB.vy = b2AddW(bB.vy, b2MulW(mB, impulsey));
+		wB = b2AddW(wB, b2MulW(iB, b2SubW(b2MulW(rBx, impulsey), b2MulW(rBy, impulsex))));
+	}
+
+	bA.w = wA;
+	bB.w = wB;
+	b2ScatterVelocities(velocities, c->indexA, bA);
+	b2ScatterVelocities(velocities, c->indexB, bB);
+}
+
+void b2WideJointSolver::SolveWeld(b2WideWeld* c, b2Velocity* velocities)
+{
+	b2VelocityW bA, bB;
+	b2GatherVelocities(&bA, c->indexA, velocities);
+	b2GatherVelocities(&bB, c->indexB, velocities);
+
+	b2FloatW zero = b2SplatW(0.0f);
+	b2FloatW mA = c->mA, mB = c->mB;
+	b2FloatW iA = c->iA, iB = c->iB;
+	b2FloatW rAx = c->rAx, rAy = c->rAy;
+	b2FloatW rBx = c->rBx, rBy = c->rBy;
+	b2FloatW wA = bA.w, wB = bB.w;
+
+	b2FloatW impulsex, impulsey, impulsez;
+	if (c->soft)
+	{
+		b2FloatW Cdot2 = b2SubW(wB, wA);
+
+		b2FloatW impulse2 = b2AddW(b2AddW(Cdot2, c->bias), b2MulW(c->gamma, c->impulseZ));
+		impulse2 = b2SubW(zero, b2MulW(c->m33, impulse2));
+		c->impulseZ = b2AddW(c->impulseZ, impulse2);
+
+		wA = b2SubW(wA, b2MulW(iA, impulse2));
+		wB = b2AddW(wB, b2MulW(iB, impulse2));
+
+		b2FloatW Cdotx = b2AddW(b2SubW(b2SubW(bB.vx, b2MulW(wB, rBy)), bA.vx), b2MulW(wA, rAy));
+		b2FloatW Cdoty = b2SubW(b2SubW(b2AddW(bB.vy, b2MulW(wB, rBx)), bA.vy), b2MulW(wA, rAx));
+
+		impulsex = b2SubW(zero, b2AddW(b2MulW(c->m11, Cdotx), b2MulW(c->m12, Cdoty)));
+		impulsey = b2SubW(zero, b2AddW(b2MulW(c->m12, Cdotx), b2MulW(c->m22, Cdoty)));
+		impulsez = zero;
+	}
+	else
+	{
+		b2FloatW Cdotx = b2AddW(b2SubW(b2SubW(bB.vx, b2MulW(wB, rBy)), bA.vx), b2MulW(wA, rAy));
+		b2FloatW Cdoty = b2SubW(b2SubW(b2AddW(bB.vy, b2MulW(wB, rBx)), bA.vy), b2MulW(wA, rAx));
+		b2FloatW Cdotz = b2SubW(wB, wA);
+
+		impulsex = b2AddW(b2AddW(b2MulW(c->m11, Cdotx), b2MulW(c->m12, Cdoty)), b2MulW(c->m13, Cdotz));
+		impulsey = b2AddW(b2AddW(b2MulW(c->m12, Cdotx), b2MulW(c->m22, Cdoty)), b2MulW(c->m23, Cdotz));
+		impulsez = b2AddW(b2AddW(b2MulW(c->m13, Cdotx), b2MulW(c->m23, Cdoty)), b2MulW(c->m33, Cdotz));
+		impulsex = b2SubW(zero, impulsex);
+		impulsey = b2SubW(zero, impulsey);
+		impulsez = b2SubW(zero, impulsez);
+
+		c->impulseZ = b2AddW(c->impulseZ, impulsez);
+	}
+
+	c->impulseX = b2AddW(c->impulseX, impulsex);
+	c->impulseY = b2AddW(c->impulseY, impulsey);
+
+	bA.vx = b2SubW(bA.vx, b2MulW(mA, impulsex));
+	bA.vy = b2SubW(bA.vy, b2MulW(mA, impulsey));
+	wA = b2SubW(wA, b2MulW(iA, b2AddW(b2SubW(b2MulW(rAx, impulsey), b2MulW(rAy, impulsex)), impulsez)));
+
+	bB.vx = b2AddW(bB.vx, b2MulW(mB, impulsex));
+	bB.vy = b2AddW(bB.vy, b2MulW(mB, impulsey));
+	wB = b2AddW(wB, b2MulW(iB, b2AddW(b2SubW(b2MulW(rBx, impulsey), b2MulW(rBy, impulsex)), impulsez)));
+
+	bA.w = wA;
+	bB.w = wB;
+	b2ScatterVelocities(velocities, c->indexA, bA);
+	b2ScatterVelocities(velocities, c->indexB, bB);
+}
+
+void b2WideJointSolver::SolveVelocityConstraints(const b2SolverData& data)
+{
+	for (int32 color = 0; color < m_colorCount; ++color)
+	{
+		for (int32 i = m_revoluteStarts[color]; i < m_revoluteStarts[color + 1]; ++i)
+		{
+			SolveRevolute(m_revolutes + i, data.velocities);
+		}
+
+		for (int32 i = m_weldStarts[color]; i < m_weldStarts[color + 1]; ++i)
+		{
+			SolveWeld(m_welds + i, data.velocities);
+		}
+	}
+
+	for (int32 i = 0; i < m_overflowCount; ++i)
+	{
+		b2Joint* joint = m_overflow[i];
+		if (joint->m_type == e_revoluteJoint)
+		{
+			static_cast<b2RevoluteJoint*>(joint)->b2RevoluteJoint::SolveVelocityConstraints(data);
+		}
+		else
+		{
+			static_cast<b2WeldJoint*>(joint)->b2WeldJoint::SolveVelocityConstraints(data);
+		}
+	}
+}
+
+void b2WideJointSolver::StoreImpulses()
+{
+	int32 revoluteCount = m_revoluteStarts[m_colorCount];
+	for (int32 i = 0; i < revoluteCount; ++i)
+	{
+		const b2WideRevolute* c = m_revolutes + i;
+		for (int32 lane = 0; lane < b2_simdWidth; ++lane)
+		{
+			b2RevoluteJoint* joint = c->joints[lane];
+			if (joint == nullptr)
+			{
+				continue;
+			}
+
+			joint->m_impulse.Set(b2GetLane(c->impulseX, lane), b2GetLane(c->impulseY, lane));
+			joint->m_motorImpulse = b2GetLane(c->motorImpulse, lane);
+			joint->m_lowerImpulse = b2GetLane(c->lowerImpulse, lane);
+			joint->m_upperImpulse = b2GetLane(c->upperImpulse, lane);
+		}
+	}
+
+	int32 weldCount = m_weldStarts[m_colorCount];
+	for (int32 i = 0; i < weldCount; ++i)
+	{
+		const b2WideWeld* c = m_welds + i;
+		for (int32 lane = 0; lane < b2_simdWidth; ++lane)
+		{
+			b2WeldJoint* joint = c->joints[lane];
+			if (joint == nullptr)
+			{
+				continue;
+			}
+
+			joint->m_impulse.Set(b2GetLane(c->impulseX, lane), b2GetLane(c->impulseY, lane), b2GetLane(c->impulseZ, lane));
+		}
+	}
+}
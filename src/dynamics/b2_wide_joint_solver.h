@@ -0,0 +1,130 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef B2_WIDE_JOINT_SOLVER_H
+#define B2_WIDE_JOINT_SOLVER_H
+
+#include "box2d/b2_joint.h"
+#include "box2d/b2_time_step.h"
+
+#include "collision/b2_simd.h"
+
+class b2RevoluteJoint;
+class b2StackAllocator;
+class b2WeldJoint;
+
+/// The number of graph colors used by the wide joint solver. Joints that don't
+/// fit in a color are solved one at a time after the colors.
+#define b2_maxJointColors 32
+
+/// Revolute joints solved in the lanes of a b2FloatW.
+struct b2WideRevolute
+{
+	b2FloatW rAx, rAy, rBx, rBy;
+	b2FloatW mA, mB, iA, iB;
+
+	// Inverse of the point constraint mass matrix.
+	b2FloatW k11, k12, k22;
+
+	// The limit mass is zero for lanes without a limit. The maximum motor
+	// impulse is zero for lanes without a motor.
+	b2FloatW axialMass, limitMass;
+	b2FloatW motorSpeed, maxMotorImpulse;
+	b2FloatW lowerBias, upperBias;
+
+	b2FloatW impulseX, impulseY;
+	b2FloatW motorImpulse, lowerImpulse, upperImpulse;
+
+	int32 indexA[b2_simdWidth];
+	int32 indexB[b2_simdWidth];
+	b2RevoluteJoint* joints[b2_simdWidth];
+};
+
+/// Weld joints solved in the lanes of a b2FloatW. All lanes are either soft
+/// or rigid.
+struct b2WideWeld
+{
+	b2FloatW rAx, rAy, rBx, rBy;
+	b2FloatW mA, mB, iA, iB;
+
+	// Symmetric effective mass.
+	b2FloatW m11, m12, m13, m22, m23, m33;
+	b2FloatW bias, gamma;
+
+	b2FloatW impulseX, impulseY, impulseZ;
+
+	int32 indexA[b2_simdWidth];
+	int32 indexB[b2_simdWidth];
+	b2WeldJoint* joints[b2_simdWidth];
+	bool soft;
+};
+
+/// Solves the velocity constraints of revolute and weld joints b2_simdWidth joints
+/// at a time. The joints are graph colored so no two joints in a color share a
+/// dynamic body. Each color is split into groups that fill the lanes, so the lanes
+/// can update body velocities without conflicts.
+/// The joints are still initialized and position solved by the joint classes.
+/// Joints of other types are ignored.
+class b2WideJointSolver
+{
+public:
+	b2WideJointSolver(b2Joint** joints, int32 count, b2StackAllocator* allocator);
+	~b2WideJointSolver();
+
+	/// Gather the joint data. Call after the joints initialized their velocity constraints.
+	void Prepare(const b2SolverData& data);
+
+	void SolveVelocityConstraints(const b2SolverData& data);
+
+	/// Copy the accumulated impulses back to the joints for warm starting.
+	void StoreImpulses();
+
+	int32 GetColorCount() const
+	{
+		return m_colorCount;
+	}
+
+private:
+
+	static void SolveRevolute(b2WideRevolute* c, b2Velocity* velocities);
+	static void SolveWeld(b2WideWeld* c, b2Velocity* velocities);
+
+	b2StackAllocator* m_allocator;
+
+	uint32* m_bodyColors;
+	int32* m_jointColors;
+	void* m_buffer;
+
+	b2WideRevolute* m_revolutes;
+	b2WideWeld* m_welds;
+
+	// Groups of color c are in [m_revoluteStarts[c], m_revoluteStarts[c + 1]).
+	int32 m_revoluteStarts[b2_maxJointColors + 1];
+	int32 m_weldStarts[b2_maxJointColors + 1];
+	int32 m_colorCount;
+
+	b2Joint** m_overflow;
+	int32 m_overflowCount;
+};
+
+#endif
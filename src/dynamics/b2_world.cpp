@@ -22,27 +22,37 @@
 
 #include "b2_contact_solver.h"
 #include "b2_island.h"
+#include "b2_query_snapshot.h"
+#include "b2_toi_queue.h"
 
 #include "box2d/b2_body.h"
 #include "box2d/b2_broad_phase.h"
 #include "box2d/b2_chain_shape.h"
 #include "box2d/b2_circle_shape.h"
 #include "box2d/b2_collision.h"
+#include "box2d/b2_compound_shape.h"
 #include "box2d/b2_contact.h"
 #include "box2d/b2_draw.h"
 #include "box2d/b2_edge_shape.h"
 #include "box2d/b2_fixture.h"
+#include "box2d/b2_growable_stack.h"
 #include "box2d/b2_polygon_shape.h"
 #include "box2d/b2_pulley_joint.h"
+#include "box2d/b2_thread_pool.h"
 #include "box2d/b2_time_of_impact.h"
 #include "box2d/b2_timer.h"
 #include "box2d/b2_world.h"
 
 #include <new>
 
+// Per thread GJK and TOI counters from b2_distance.cpp and b2_time_of_impact.cpp.
+extern thread_local int32 b2_gjkThreadCalls, b2_gjkThreadIters;
+extern thread_local int32 b2_toiThreadCalls;
+
 b2World::b2World(const b2Vec2& gravity)
 {
 	m_destructionListener = nullptr;
+	m_originListener = nullptr;
 	m_debugDraw = nullptr;
 
 	m_bodyList = nullptr;
@@ -51,9 +61,21 @@ b2World::b2World(const b2Vec2& gravity)
 	m_bodyCount = 0;
 	m_jointCount = 0;
 
+	m_awakeCapacity = 64;
+	m_awakeCount = 0;
+	m_awakeBodies = (b2Body**)b2Alloc(m_awakeCapacity * sizeof(b2Body*));
+
 	m_warmStarting = true;
 	m_continuousPhysics = true;
 	m_subStepping = false;
+	m_softStep = false;
+	m_wideJointSolver = false;
+	m_subStepCount = 4;
+
+	m_threadPool = nullptr;
+	m_querySnapshot = nullptr;
+	m_retiredFixtures = nullptr;
+	m_retiredBodies = nullptr;
 
 	m_stepComplete = true;
 
@@ -67,8 +89,18 @@ b2World::b2World(const b2Vec2& gravity)
 	m_inv_dt0 = 0.0f;
 
 	m_contactManager.m_allocator = &m_blockAllocator;
+	m_contactManager.m_counters = &m_counters;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
+	memset(&m_counters, 0, sizeof(b2Counters));
+	m_stepHash = b2_hashInit;
+
+	m_origin = b2Vec2d(0.0, 0.0);
+	m_focus.SetZero();
+	m_recenterDistance = 0.0f;
+
+	m_lodLevelCount = 0;
+	m_lodPointCount = 0;
 }
 
 b2World::~b2World()
@@ -90,6 +122,10 @@ b2World::~b2World()
 
 		b = bNext;
 	}
+
+	b2Free(m_awakeBodies);
+
+	SetQuerySnapshots(false);
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -97,6 +133,11 @@ void b2World::SetDestructionListener(b2DestructionListener* listener)
 	m_destructionListener = listener;
 }
 
+void b2World::SetOriginListener(b2OriginListener* listener)
+{
+	m_originListener = listener;
+}
+
 void b2World::SetContactFilter(b2ContactFilter* filter)
 {
 	m_contactManager.m_contactFilter = filter;
@@ -133,6 +174,11 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 	m_bodyList = b;
 	++m_bodyCount;
 
+	if (b->m_flags & b2Body::e_awakeFlag)
+	{
+		AddAwakeBody(b);
+	}
+
 	return b;
 }
 
@@ -186,9 +232,15 @@ void b2World::DestroyBody(b2Body* b)
 		}
 
 		f0->DestroyProxies(&m_contactManager.m_broadPhase);
-		f0->Destroy(&m_blockAllocator);
-		f0->~b2Fixture();
-		m_blockAllocator.Free(f0, sizeof(b2Fixture));
+	}
+
+	f = b->m_fixtureList;
+	while (f)
+	{
+		b2Fixture* f0 = f;
+		f = f->m_next;
+
+		RetireFixture(f0);
 
 		b->m_fixtureList = f;
 		b->m_fixtureCount -= 1;
@@ -212,9 +264,11 @@ void b2World::DestroyBody(b2Body* b)
 		m_bodyList = b->m_next;
 	}
 
+	// Destroying contacts may have woken the body.
+	RemoveAwakeBody(b);
+
 	--m_bodyCount;
-	b->~b2Body();
-	m_blockAllocator.Free(b, sizeof(b2Body));
+	RetireBody(b);
 }
 
 b2Joint* b2World::CreateJoint(const b2JointDef* def)
@@ -265,7 +319,7 @@ b2Joint* b2World::CreateJoint(const b2JointDef* def)
 			{
 				// Flag the contact for filtering at the next time step (where either
 				// body is awake).
-				edge->contact->FlagForFiltering();
+				m_contactManager.FlagForFiltering(edge->contact);
 			}
 
 			edge = edge->next;
@@ -364,7 +418,7 @@ void b2World::DestroyJoint(b2Joint* j)
 			{
 				// Flag the contact for filtering at the next time step (where either
 				// body is awake).
-				edge->contact->FlagForFiltering();
+				m_contactManager.FlagForFiltering(edge->contact);
 			}
 
 			edge = edge->next;
@@ -390,6 +444,9 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
+// Islands are batched for the wide joint solver until they have this many constraints.
+static const int32 b2_islandBatchSize = 128;
+
 // Find islands, integrate and solve constraints, solve position constraints
 void b2World::Solve(const b2TimeStep& step)
 {
@@ -403,26 +460,38 @@ void b2World::Solve(const b2TimeStep& step)
 					m_jointCount,
 					&m_stackAllocator,
 					m_contactManager.m_contactListener);
+	island.m_hash = &m_stepHash;
+	island.m_wideJoints = m_wideJointSolver;
 
-	// Clear all the island flags.
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	// Clear the island flags of the awake set. Sleeping islands had their
+	// flags cleared when they fell asleep.
+	for (int32 i = 0; i < m_awakeCount; ++i)
 	{
+		b2Body* b = m_awakeBodies[i];
 		b->m_flags &= ~b2Body::e_islandFlag;
-	}
-	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
-	{
-		c->m_flags &= ~b2Contact::e_islandFlag;
-	}
-	for (b2Joint* j = m_jointList; j; j = j->m_next)
-	{
-		j->m_islandFlag = false;
+
+		for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+		{
+			ce->contact->m_flags &= ~b2Contact::e_islandFlag;
+		}
+
+		for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+		{
+			je->joint->m_islandFlag = false;
+		}
 	}
 
+	// The wide joint solver needs many joints to fill its lanes, so small islands
+	// are solved together in batches. Each island still falls asleep on its own.
+	// Level of detail is decided per island, so it turns batching off.
+	bool batchIslands = m_wideJointSolver && (m_lodLevelCount == 0 || m_lodPointCount == 0);
+
 	// Build and simulate all awake islands.
 	int32 stackSize = m_bodyCount;
 	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
-	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	for (int32 seedIndex = 0; seedIndex < m_awakeCount; ++seedIndex)
 	{
+		b2Body* seed = m_awakeBodies[seedIndex];
 		if (seed->m_flags & b2Body::e_islandFlag)
 		{
 			continue;
@@ -439,8 +508,8 @@ void b2World::Solve(const b2TimeStep& step)
 			continue;
 		}
 
-		// Reset island and stack.
-		island.Clear();
+		// Reset the stack and start a new island.
+		island.BeginIsland();
 		int32 stackCount = 0;
 		stack[stackCount++] = seed;
 		seed->m_flags |= b2Body::e_islandFlag;
@@ -462,6 +531,10 @@ void b2World::Solve(const b2TimeStep& step)
 
 			// Make sure the body is awake (without resetting sleep timer).
 			b->m_flags |= b2Body::e_awakeFlag;
+			if (b->m_awakeIndex == -1)
+			{
+				AddAwakeBody(b);
+			}
 
 			// Search all contacts connected to this body.
 			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
@@ -535,22 +608,20 @@ void b2World::Solve(const b2TimeStep& step)
 			}
 		}
 
-		b2Profile profile;
-		island.Solve(&profile, step, m_gravity, m_allowSleep);
-		m_profile.solveInit += profile.solveInit;
-		m_profile.solveVelocity += profile.solveVelocity;
-		m_profile.solvePosition += profile.solvePosition;
-
-		// Post solve cleanup.
-		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		if (batchIslands && island.m_jointCount + island.m_contactCount < b2_islandBatchSize)
 		{
-			// Allow static bodies to participate in other islands.
-			b2Body* b = island.m_bodies[i];
-			if (b->GetType() == b2_staticBody)
-			{
-				b->m_flags &= ~b2Body::e_islandFlag;
-			}
+			// Keep adding islands to the batch.
+			continue;
 		}
+
+		SolveIsland(&island, step);
+		island.Clear();
+	}
+
+	if (island.m_bodyCount > 0)
+	{
+		SolveIsland(&island, step);
+		island.Clear();
 	}
 
 	m_stackAllocator.Free(stack);
@@ -558,166 +629,438 @@ void b2World::Solve(const b2TimeStep& step)
 	{
 		b2Timer timer;
 		// Synchronize fixtures, check for out of range bodies.
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		SynchronizeFixtures();
+
+		// Look for new contacts.
+		m_contactManager.FindNewContacts();
+		m_profile.broadphase = timer.GetMilliseconds();
+	}
+}
+
+// Solve an island or a batch of islands and release its static bodies.
+void b2World::SolveIsland(b2Island* island, const b2TimeStep& step)
+{
+	b2TimeStep islandStep = step;
+	bool skip = false;
+	int32 level = ComputeLODLevel(*island);
+	if (level >= 0)
+	{
+		const b2LODLevel& lod = m_lodLevels[level];
+
+		// Accumulate the time since this island was last stepped. Bodies that just
+		// joined the island may have a different history, so use the largest.
+		float elapsed = 0.0f;
+		for (int32 i = 0; i < island->m_bodyCount; ++i)
+		{
+			elapsed = b2Max(elapsed, island->m_bodies[i]->m_lodTime);
+		}
+		elapsed += step.dt;
+
+		if (elapsed < (lod.stepInterval - 0.5f) * step.dt)
 		{
-			// If a body was not in an island then it did not move.
-			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			skip = true;
+			for (int32 i = 0; i < island->m_bodyCount; ++i)
 			{
-				continue;
+				b2Body* b = island->m_bodies[i];
+				if (b->GetType() == b2_staticBody)
+				{
+					continue;
+				}
+
+				// The body does not move this step.
+				b->m_lodTime = elapsed;
+				b->m_sweep.c0 = b->m_sweep.c;
+				b->m_sweep.a0 = b->m_sweep.a;
+				b->m_flags |= b2Body::e_lodSkipFlag;
+			}
+		}
+		else
+		{
+			islandStep.dt = elapsed;
+			islandStep.inv_dt = 1.0f / elapsed;
+			if (lod.velocityIterations > 0)
+			{
+				islandStep.velocityIterations = lod.velocityIterations;
+			}
+			if (lod.positionIterations > 0)
+			{
+				islandStep.positionIterations = lod.positionIterations;
 			}
+		}
+	}
 
-			if (b->GetType() == b2_staticBody)
+	if (skip == false)
+	{
+		// The warm starting impulses were found with the time step of the last solve
+		// of this island, which differs from the world time step under level of detail.
+		float lastStep = 0.0f;
+		for (int32 i = 0; i < island->m_bodyCount; ++i)
+		{
+			b2Body* b = island->m_bodies[i];
+			b->m_lodTime = 0.0f;
+
+			// Static bodies can be shared with other islands.
+			if (b->GetType() != b2_staticBody)
 			{
-				continue;
+				lastStep = b2Max(lastStep, b->m_lodStep);
+				b->m_lodStep = level >= 0 ? islandStep.dt : 0.0f;
 			}
+		}
 
-			// Update fixtures (for broad-phase).
-			b->SynchronizeFixtures();
+		if (lastStep > 0.0f)
+		{
+			islandStep.dtRatio = islandStep.dt / lastStep;
+		}
+		else if (level >= 0)
+		{
+			// Last solved with the world time step.
+			islandStep.dtRatio = islandStep.dt * m_inv_dt0;
 		}
 
-		// Look for new contacts.
-		m_contactManager.FindNewContacts();
-		m_profile.broadphase = timer.GetMilliseconds();
+		b2Profile profile;
+		if (m_softStep)
+		{
+			island->SolveSoft(&profile, islandStep, m_subStepCount, m_gravity, m_allowSleep);
+		}
+		else
+		{
+			island->Solve(&profile, islandStep, m_gravity, m_allowSleep);
+		}
+		m_profile.solveInit += profile.solveInit;
+		m_profile.solveVelocity += profile.solveVelocity;
+		m_profile.solvePosition += profile.solvePosition;
+	}
+
+	// Post solve cleanup.
+	for (int32 i = 0; i < island->m_bodyCount; ++i)
+	{
+		// Allow static bodies to participate in other islands.
+		b2Body* b = island->m_bodies[i];
+		if (b->GetType() == b2_staticBody)
+		{
+			b->m_flags &= ~b2Body::e_islandFlag;
+		}
 	}
 }
 
-// Find TOI contacts and solve them.
-void b2World::SolveTOI(const b2TimeStep& step)
+// A proxy waiting for its swept AABB.
+struct b2SyncProxy
 {
-	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+	b2FixtureProxy* proxy;
+	const b2Shape* shape;
+	int32 bodyIndex;
+};
 
-	if (m_stepComplete)
+struct b2SyncContext
+{
+	const b2SyncProxy* proxies;
+	const b2Transform* transforms;
+	b2AABB* aabbs;
+	b2Vec2* displacements;
+};
+
+// Compute the swept AABBs for a range of proxies. The transforms hold the
+// start and end transform of each body.
+static void b2SynchronizeProxies(int32 begin, int32 end, int32 threadIndex, void* context)
+{
+	B2_NOT_USED(threadIndex);
+
+	b2SyncContext* sync = (b2SyncContext*)context;
+	for (int32 i = begin; i < end; ++i)
 	{
-		for (b2Body* b = m_bodyList; b; b = b->m_next)
+		const b2SyncProxy& item = sync->proxies[i];
+		const b2Transform& transform1 = sync->transforms[2 * item.bodyIndex];
+		const b2Transform& transform2 = sync->transforms[2 * item.bodyIndex + 1];
+		b2FixtureProxy* proxy = item.proxy;
+
+		// Compute an AABB that covers the swept shape (may miss some rotation effect).
+		b2AABB aabb1, aabb2;
+		item.shape->ComputeAABB(&aabb1, transform1, proxy->childIndex);
+		item.shape->ComputeAABB(&aabb2, transform2, proxy->childIndex);
+
+		proxy->aabb.Combine(aabb1, aabb2);
+
+		sync->aabbs[i] = proxy->aabb;
+		sync->displacements[i] = aabb2.GetCenter() - aabb1.GetCenter();
+	}
+}
+
+// The smallest number of proxies given to a thread.
+static const int32 b2_syncProxyRange = 128;
+
+// Update the broad-phase proxies of the bodies that moved in the island solve.
+// This does the same work as b2Body::SynchronizeFixtures, but the swept AABBs
+// are computed in one tight loop (on the thread pool if there is one) and the
+// escaped proxies are re-inserted in one pass.
+void b2World::SynchronizeFixtures()
+{
+	b2Body** bodies = (b2Body**)m_stackAllocator.Allocate(m_awakeCount * sizeof(b2Body*));
+	int32 bodyCount = 0;
+	int32 proxyCount = 0;
+	for (int32 i = 0; i < m_awakeCount; ++i)
+	{
+		b2Body* b = m_awakeBodies[i];
+
+		// If a body was not in an island then it did not move.
+		if ((b->m_flags & b2Body::e_islandFlag) == 0)
 		{
-			b->m_flags &= ~b2Body::e_islandFlag;
-			b->m_sweep.alpha0 = 0.0f;
+			continue;
 		}
 
-		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		if (b->GetType() == b2_staticBody)
 		{
-			// Invalidate TOI
-			c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
-			c->m_toiCount = 0;
-			c->m_toi = 1.0f;
+			continue;
+		}
+
+		// Bodies in islands skipped by level of detail did not move.
+		if (b->m_flags & b2Body::e_lodSkipFlag)
+		{
+			b->m_flags &= ~b2Body::e_lodSkipFlag;
+			continue;
+		}
+
+		bodies[bodyCount++] = b;
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			proxyCount += f->m_proxyCount;
 		}
 	}
 
-	// Find TOI events and solve them.
-	for (;;)
+	b2Transform* transforms = (b2Transform*)m_stackAllocator.Allocate(2 * bodyCount * sizeof(b2Transform));
+	b2SyncProxy* proxies = (b2SyncProxy*)m_stackAllocator.Allocate(proxyCount * sizeof(b2SyncProxy));
+	int32* proxyIds = (int32*)m_stackAllocator.Allocate(proxyCount * sizeof(int32));
+	b2AABB* aabbs = (b2AABB*)m_stackAllocator.Allocate(proxyCount * sizeof(b2AABB));
+	b2Vec2* displacements = (b2Vec2*)m_stackAllocator.Allocate(proxyCount * sizeof(b2Vec2));
+
+	int32 proxyIndex = 0;
+	for (int32 i = 0; i < bodyCount; ++i)
 	{
-		// Find the first TOI.
-		b2Contact* minContact = nullptr;
-		float minAlpha = 1.0f;
+		b2Body* b = bodies[i];
+		b2Transform& xf1 = transforms[2 * i];
+		b2Transform& xf2 = transforms[2 * i + 1];
 
-		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		xf2 = b->m_xf;
+		if (b->m_flags & b2Body::e_awakeFlag)
 		{
-			// Is this contact disabled?
-			if (c->IsEnabled() == false)
-			{
-				continue;
-			}
+			xf1.q.Set(b->m_sweep.a0);
+			xf1.p = b->m_sweep.c0 - b2Mul(xf1.q, b->m_sweep.localCenter);
+		}
+		else
+		{
+			xf1 = xf2;
+		}
 
-			// Prevent excessive sub-stepping.
-			if (c->m_toiCount > b2_maxSubSteps)
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			for (int32 j = 0; j < f->m_proxyCount; ++j)
 			{
-				continue;
+				b2SyncProxy& item = proxies[proxyIndex];
+				item.proxy = f->m_proxies + j;
+				item.shape = f->m_shape;
+				item.bodyIndex = i;
+				proxyIds[proxyIndex] = f->m_proxies[j].proxyId;
+				++proxyIndex;
 			}
+		}
+	}
 
-			float alpha = 1.0f;
-			if (c->m_flags & b2Contact::e_toiFlag)
-			{
-				// This contact has a valid cached TOI.
-				alpha = c->m_toi;
-			}
-			else
-			{
-				b2Fixture* fA = c->GetFixtureA();
-				b2Fixture* fB = c->GetFixtureB();
+	b2SyncContext context;
+	context.proxies = proxies;
+	context.transforms = transforms;
+	context.aabbs = aabbs;
+	context.displacements = displacements;
 
-				// Is there a sensor?
-				if (fA->IsSensor() || fB->IsSensor())
-				{
-					continue;
-				}
+	if (m_threadPool != nullptr && proxyCount > b2_syncProxyRange)
+	{
+		m_threadPool->ParallelFor(proxyCount, b2_syncProxyRange, b2SynchronizeProxies, &context);
+	}
+	else
+	{
+		b2SynchronizeProxies(0, proxyCount, 0, &context);
+	}
 
-				b2Body* bA = fA->GetBody();
-				b2Body* bB = fB->GetBody();
+	m_contactManager.m_broadPhase.MoveProxies(proxyCount, proxyIds, aabbs, displacements);
 
-				b2BodyType typeA = bA->m_type;
-				b2BodyType typeB = bB->m_type;
-				b2Assert(typeA == b2_dynamicBody || typeB == b2_dynamicBody);
+	m_stackAllocator.Free(displacements);
+	m_stackAllocator.Free(aabbs);
+	m_stackAllocator.Free(proxyIds);
+	m_stackAllocator.Free(proxies);
+	m_stackAllocator.Free(transforms);
+	m_stackAllocator.Free(bodies);
+}
 
-				bool activeA = bA->IsAwake() && typeA != b2_staticBody;
-				bool activeB = bB->IsAwake() && typeB != b2_staticBody;
+// Compute the TOI for a contact and cache it. Returns false if the contact
+// cannot generate a TOI event.
+bool b2World::ComputeTOI(b2Contact* c)
+{
+	// Is this contact disabled?
+	if (c->IsEnabled() == false)
+	{
+		return false;
+	}
 
-				// Is at least one body active (awake and dynamic or kinematic)?
-				if (activeA == false && activeB == false)
-				{
-					continue;
-				}
+	// Prevent excessive sub-stepping.
+	if (c->m_toiCount > b2_maxSubSteps)
+	{
+		return false;
+	}
 
-				bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
-				bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
+	if (c->m_flags & b2Contact::e_toiFlag)
+	{
+		// This contact has a valid cached TOI.
+		return true;
+	}
 
-				// Are these two non-bullet dynamic bodies?
-				if (collideA == false && collideB == false)
-				{
-					continue;
-				}
+	b2Fixture* fA = c->GetFixtureA();
+	b2Fixture* fB = c->GetFixtureB();
 
-				// Compute the TOI for this contact.
-				// Put the sweeps onto the same time interval.
-				float alpha0 = bA->m_sweep.alpha0;
+	// Is there a sensor?
+	if (fA->IsSensor() || fB->IsSensor())
+	{
+		return false;
+	}
 
-				if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
-				{
-					alpha0 = bB->m_sweep.alpha0;
-					bA->m_sweep.Advance(alpha0);
-				}
-				else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
-				{
-					alpha0 = bA->m_sweep.alpha0;
-					bB->m_sweep.Advance(alpha0);
-				}
+	b2Body* bA = fA->GetBody();
+	b2Body* bB = fB->GetBody();
+
+	b2BodyType typeA = bA->m_type;
+	b2BodyType typeB = bB->m_type;
+	b2Assert(typeA == b2_dynamicBody || typeB == b2_dynamicBody);
 
-				b2Assert(alpha0 < 1.0f);
+	bool activeA = bA->IsAwake() && typeA != b2_staticBody;
+	bool activeB = bB->IsAwake() && typeB != b2_staticBody;
 
-				int32 indexA = c->GetChildIndexA();
-				int32 indexB = c->GetChildIndexB();
+	// Is at least one body active (awake and dynamic or kinematic)?
+	if (activeA == false && activeB == false)
+	{
+		return false;
+	}
 
-				// Compute the time of impact in interval [0, minTOI]
-				b2TOIInput input;
-				input.proxyA.Set(fA->GetShape(), indexA);
-				input.proxyB.Set(fB->GetShape(), indexB);
-				input.sweepA = bA->m_sweep;
-				input.sweepB = bB->m_sweep;
-				input.tMax = 1.0f;
+	bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
+	bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
 
-				b2TOIOutput output;
-				b2TimeOfImpact(&output, &input);
+	// Are these two non-bullet dynamic bodies?
+	if (collideA == false && collideB == false)
+	{
+		return false;
+	}
 
-				// Beta is the fraction of the remaining portion of the .
-				float beta = output.t;
-				if (output.state == b2TOIOutput::e_touching)
-				{
-					alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
-				}
-				else
-				{
-					alpha = 1.0f;
-				}
+	// Compute the TOI for this contact.
+	// Put the sweeps onto the same time interval.
+	float alpha0 = bA->m_sweep.alpha0;
+
+	if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
+	{
+		alpha0 = bB->m_sweep.alpha0;
+		bA->m_sweep.Advance(alpha0);
+	}
+	else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
+	{
+		alpha0 = bA->m_sweep.alpha0;
+		bB->m_sweep.Advance(alpha0);
+	}
+
+	b2Assert(alpha0 < 1.0f);
+
+	int32 indexA = c->GetChildIndexA();
+	int32 indexB = c->GetChildIndexB();
+
+	// Compute the time of impact in interval [0, minTOI]
+	b2TOIOutput output;
+	b2TimeOfImpact(&output, fA->GetShape(), indexA, bA->m_sweep, fB->GetShape(), indexB, bB->m_sweep, 1.0f, &c->m_simplexCache);
+
+	// Beta is the fraction of the remaining portion of the .
+	float beta = output.t;
+	float alpha;
+	if (output.state == b2TOIOutput::e_touching)
+	{
+		alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
+	}
+	else
+	{
+		alpha = 1.0f;
+	}
+
+	c->m_toi = alpha;
+	c->m_flags |= b2Contact::e_toiFlag;
+	return true;
+}
+
+// Find TOI contacts and solve them.
+// Candidate events are kept in a priority queue. Resolving an event only displaces
+// the bodies in the TOI island, so only the contacts of those bodies (and contacts
+// created by the broad-phase update) need a new TOI.
+void b2World::SolveTOI(const b2TimeStep& step)
+{
+	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+	island.m_hash = &m_stepHash;
+
+	if (m_stepComplete)
+	{
+		for (int32 i = 0; i < m_awakeCount; ++i)
+		{
+			b2Body* b = m_awakeBodies[i];
+			b->m_flags &= ~b2Body::e_islandFlag;
+			b->m_sweep.alpha0 = 0.0f;
+
+			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+			{
+				// Invalidate TOI
+				b2Contact* c = ce->contact;
+				c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+				c->m_toiCount = 0;
+				c->m_toi = 1.0f;
+			}
+		}
+	}
+
+	// Gather the initial TOI events. Only contacts with an awake body can
+	// generate events and each contact is visited once.
+	b2TOIQueue queue;
+	for (int32 i = 0; i < m_awakeCount; ++i)
+	{
+		b2Body* b = m_awakeBodies[i];
+		for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+		{
+			b2Body* other = ce->other;
+			if (other->IsAwake() && other->m_awakeIndex < i)
+			{
+				continue;
+			}
 
-				c->m_toi = alpha;
-				c->m_flags |= b2Contact::e_toiFlag;
+			b2Contact* c = ce->contact;
+			if (ComputeTOI(c) && c->m_toi < 1.0f)
+			{
+				queue.Push(c, c->m_toi);
+			}
+		}
+	}
+
+	// Solve TOI events in order.
+	for (;;)
+	{
+		// Find the first TOI. Discard events that were invalidated or superseded.
+		b2Contact* minContact = nullptr;
+		float minAlpha = 1.0f;
+		while (queue.GetCount() > 0)
+		{
+			b2TOIEvent event = queue.Top();
+			queue.Pop();
+
+			b2Contact* c = event.contact;
+			if ((c->m_flags & b2Contact::e_toiFlag) == 0 || c->m_toi != event.alpha)
+			{
+				continue;
 			}
 
-			if (alpha < minAlpha)
+			if (c->IsEnabled() == false || c->m_toiCount > b2_maxSubSteps)
 			{
-				// This is the minimum TOI found so far.
-				minContact = c;
-				minAlpha = alpha;
+				continue;
 			}
+
+			minContact = c;
+			minAlpha = event.alpha;
+			break;
 		}
 
 		if (minContact == nullptr || 1.0f - 10.0f * b2_epsilon < minAlpha)
@@ -740,7 +1083,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		bB->Advance(minAlpha);
 
 		// The TOI contact likely has some new contact points.
-		minContact->Update(m_contactManager.m_contactListener);
+		minContact->Update(m_contactManager.m_contactListener, &m_counters);
 		minContact->m_flags &= ~b2Contact::e_toiFlag;
 		++minContact->m_toiCount;
 
@@ -820,7 +1163,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					}
 
 					// Update the contact points
-					contact->Update(m_contactManager.m_contactListener);
+					contact->Update(m_contactManager.m_contactListener, &m_counters);
 
 					// Was the contact disabled by the user?
 					if (contact->IsEnabled() == false)
@@ -892,8 +1235,43 @@ void b2World::SolveTOI(const b2TimeStep& step)
 
 		// Commit fixture proxy movements to the broad-phase so that new contacts are created.
 		// Also, some contacts can be destroyed.
+		b2Contact* oldHead = m_contactManager.m_contactList;
 		m_contactManager.FindNewContacts();
 
+		// New contacts are added to the head of the contact list.
+		for (b2Contact* c = m_contactManager.m_contactList; c != oldHead; c = c->m_next)
+		{
+			if (ComputeTOI(c) && c->m_toi < 1.0f)
+			{
+				queue.Push(c, c->m_toi);
+			}
+		}
+
+		// Queue the new TOI events of the displaced bodies. The island also holds
+		// kinematic bodies that may have just been woken.
+		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			b2Body* body = island.m_bodies[i];
+			if (body->m_type == b2_staticBody)
+			{
+				continue;
+			}
+
+			for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+			{
+				b2Contact* c = ce->contact;
+				if (c->m_flags & b2Contact::e_toiFlag)
+				{
+					continue;
+				}
+
+				if (ComputeTOI(c) && c->m_toi < 1.0f)
+				{
+					queue.Push(c, c->m_toi);
+				}
+			}
+		}
+
 		if (m_subStepping)
 		{
 			m_stepComplete = false;
@@ -906,6 +1284,13 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 {
 	b2Timer stepTimer;
 
+	memset(&m_counters, 0, sizeof(b2Counters));
+	m_stepHash = b2_hashInit;
+	int32 gjkCalls = b2_gjkThreadCalls;
+	int32 gjkIters = b2_gjkThreadIters;
+	int32 toiCalls = b2_toiThreadCalls;
+	int32 reinserts = m_contactManager.m_broadPhase.GetReinsertCount();
+
 	// If new fixtures were added, we need to find the new contacts.
 	if (m_newContacts)
 	{
@@ -913,6 +1298,11 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 		m_newContacts = false;
 	}
 
+	if (m_recenterDistance > 0.0f)
+	{
+		Recenter();
+	}
+
 	m_locked = true;
 
 	b2TimeStep step;
@@ -935,7 +1325,7 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 	// Update contacts. This is where some contacts are destroyed.
 	{
 		b2Timer timer;
-		m_contactManager.Collide();
+		Collide();
 		m_profile.collide = timer.GetMilliseconds();
 	}
 
@@ -965,20 +1355,199 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 		ClearForces();
 	}
 
+	RemoveSleepingBodies();
+
+	if (m_querySnapshot)
+	{
+		m_querySnapshot->Publish(m_contactManager.m_broadPhase);
+		FreeRetired();
+	}
+
 	m_locked = false;
 
+	m_counters.gjkCalls = b2_gjkThreadCalls - gjkCalls;
+	m_counters.gjkIters = b2_gjkThreadIters - gjkIters;
+	m_counters.toiCalls = b2_toiThreadCalls - toiCalls;
+	m_counters.proxyReinserts = m_contactManager.m_broadPhase.GetReinsertCount() - reinserts;
+
 	m_profile.step = stepTimer.GetMilliseconds();
 }
 
+// Sleeping bodies have no forces.
 void b2World::ClearForces()
 {
-	for (b2Body* body = m_bodyList; body; body = body->GetNext())
+	for (int32 i = 0; i < m_awakeCount; ++i)
 	{
+		b2Body* body = m_awakeBodies[i];
 		body->m_force.SetZero();
 		body->m_torque = 0.0f;
 	}
 }
 
+void b2World::AddAwakeBody(b2Body* body)
+{
+	b2Assert(body->m_awakeIndex == -1);
+
+	// Grow the array as needed.
+	if (m_awakeCount == m_awakeCapacity)
+	{
+		b2Body** oldBodies = m_awakeBodies;
+		m_awakeCapacity *= 2;
+		m_awakeBodies = (b2Body**)b2Alloc(m_awakeCapacity * sizeof(b2Body*));
+		memcpy(m_awakeBodies, oldBodies, m_awakeCount * sizeof(b2Body*));
+		b2Free(oldBodies);
+	}
+
+	body->m_awakeIndex = m_awakeCount;
+	m_awakeBodies[m_awakeCount] = body;
+	++m_awakeCount;
+}
+
+void b2World::RemoveAwakeBody(b2Body* body)
+{
+	int32 index = body->m_awakeIndex;
+	if (index == -1)
+	{
+		return;
+	}
+
+	b2Assert(m_awakeBodies[index] == body);
+	--m_awakeCount;
+	m_awakeBodies[index] = m_awakeBodies[m_awakeCount];
+	m_awakeBodies[index]->m_awakeIndex = index;
+	body->m_awakeIndex = -1;
+}
+
+// Wake a sleeping body and everything it is connected to. The connections
+// match those used to build islands, so this wakes the whole sleeping island
+// at once instead of waiting for the next island search.
+void b2World::WakeIsland(b2Body* seed)
+{
+	b2GrowableStack<b2Body*, 256> stack;
+	stack.Push(seed);
+
+	while (stack.GetCount() > 0)
+	{
+		b2Body* b = stack.Pop();
+		if (b->m_flags & b2Body::e_awakeFlag)
+		{
+			continue;
+		}
+
+		b->m_flags |= b2Body::e_awakeFlag;
+		b->m_sleepTime = 0.0f;
+		if (b->m_awakeIndex == -1)
+		{
+			AddAwakeBody(b);
+		}
+
+		for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+		{
+			b2Contact* contact = ce->contact;
+			b2Body* other = ce->other;
+			if (other->m_type == b2_staticBody || (other->m_flags & b2Body::e_awakeFlag))
+			{
+				continue;
+			}
+
+			if (contact->IsEnabled() == false || contact->IsTouching() == false)
+			{
+				continue;
+			}
+
+			if (contact->m_fixtureA->m_isSensor || contact->m_fixtureB->m_isSensor)
+			{
+				continue;
+			}
+
+			stack.Push(other);
+		}
+
+		for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+		{
+			b2Body* other = je->other;
+			if (other->m_type == b2_staticBody || (other->m_flags & b2Body::e_awakeFlag))
+			{
+				continue;
+			}
+
+			if (other->IsEnabled() == false)
+			{
+				continue;
+			}
+
+			stack.Push(other);
+		}
+	}
+}
+
+// Remove the bodies that fell asleep during the step. Their island and TOI
+// state is reset now so that sleeping islands are never visited again until
+// they wake.
+void b2World::RemoveSleepingBodies()
+{
+	int32 i = 0;
+	while (i < m_awakeCount)
+	{
+		b2Body* b = m_awakeBodies[i];
+		if (b->m_flags & b2Body::e_awakeFlag)
+		{
+			++i;
+			continue;
+		}
+
+		b->m_flags &= ~b2Body::e_islandFlag;
+		for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+		{
+			b2Contact* c = ce->contact;
+			c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+			c->m_toiCount = 0;
+			c->m_toi = 1.0f;
+		}
+
+		for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+		{
+			je->joint->m_islandFlag = false;
+		}
+
+		// The last body moves into this slot, so don't advance.
+		RemoveAwakeBody(b);
+	}
+}
+
+// Update the contacts of awake bodies. Contacts between sleeping bodies are
+// not visited, except to filter them. A contact between two awake bodies is
+// visited from the body with the lower index. Bodies woken by contact updates
+// are appended and visited in the same pass.
+void b2World::Collide()
+{
+	m_contactManager.FilterContacts();
+
+	for (int32 i = 0; i < m_awakeCount; ++i)
+	{
+		b2Body* b = m_awakeBodies[i];
+		if ((b->m_flags & b2Body::e_awakeFlag) == 0)
+		{
+			continue;
+		}
+
+		b2ContactEdge* ce = b->m_contactList;
+		while (ce)
+		{
+			// The contact may be destroyed.
+			b2ContactEdge* next = ce->next;
+
+			b2Body* other = ce->other;
+			if ((other->m_flags & b2Body::e_awakeFlag) == 0 || other->m_awakeIndex > i)
+			{
+				m_contactManager.Collide(ce->contact);
+			}
+
+			ce = next;
+		}
+	}
+}
+
 struct b2WorldQueryWrapper
 {
 	bool QueryCallback(int32 proxyId)
@@ -999,6 +1568,179 @@ void b2World::QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const
 	m_contactManager.m_broadPhase.Query(&wrapper, aabb);
 }
 
+struct b2WorldOverlapWrapper
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		b2Fixture* fixture = proxy->fixture;
+		const b2Shape* fixtureShape = fixture->GetShape();
+		const b2Transform& xf = fixture->GetBody()->GetTransform();
+
+		// Circles against circles and polygons have a closed form test that is
+		// cheaper than the distance solver.
+		b2Shape::Type typeA = fixtureShape->GetType();
+		b2Shape::Type typeB = shape->GetType();
+		bool overlap;
+		if (typeA == b2Shape::e_circle && typeB == b2Shape::e_circle)
+		{
+			b2Manifold manifold;
+			b2CollideCircles(&manifold, (const b2CircleShape*)fixtureShape, xf, (const b2CircleShape*)shape, transform);
+			overlap = manifold.pointCount > 0;
+		}
+		else if (typeA == b2Shape::e_polygon && typeB == b2Shape::e_circle)
+		{
+			b2Manifold manifold;
+			b2CollidePolygonAndCircle(&manifold, (const b2PolygonShape*)fixtureShape, xf, (const b2CircleShape*)shape, transform);
+			overlap = manifold.pointCount > 0;
+		}
+		else if (typeA == b2Shape::e_circle && typeB == b2Shape::e_polygon)
+		{
+			b2Manifold manifold;
+			b2CollidePolygonAndCircle(&manifold, (const b2PolygonShape*)shape, transform, (const b2CircleShape*)fixtureShape, xf);
+			overlap = manifold.pointCount > 0;
+		}
+		else
+		{
+			overlap = b2TestOverlap(fixtureShape, proxy->childIndex, shape, 0, xf, transform);
+		}
+
+		if (overlap)
+		{
+			return callback->ReportFixture(fixture);
+		}
+
+		return true;
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2QueryCallback* callback;
+	const b2Shape* shape;
+	b2Transform transform;
+};
+
+void b2World::QueryShape(b2QueryCallback* callback, const b2Shape* shape, const b2Transform& transform) const
+{
+	b2Assert(shape->GetType() != b2Shape::e_chain);
+
+	b2WorldOverlapWrapper wrapper;
+	wrapper.broadPhase = &m_contactManager.m_broadPhase;
+	wrapper.callback = callback;
+	wrapper.shape = shape;
+	wrapper.transform = transform;
+
+	b2AABB aabb;
+	shape->ComputeAABB(&aabb, transform, 0);
+	m_contactManager.m_broadPhase.Query(&wrapper, aabb);
+}
+
+void b2World::SetQuerySnapshots(bool flag)
+{
+	if (flag == (m_querySnapshot != nullptr))
+	{
+		return;
+	}
+
+	if (flag)
+	{
+		void* mem = b2Alloc(sizeof(b2QuerySnapshot));
+		m_querySnapshot = new (mem) b2QuerySnapshot;
+		m_querySnapshot->Publish(m_contactManager.m_broadPhase);
+	}
+	else
+	{
+		// No queries are running.
+		FreeRetired();
+
+		m_querySnapshot->~b2QuerySnapshot();
+		b2Free(m_querySnapshot);
+		m_querySnapshot = nullptr;
+	}
+}
+
+void b2World::PublishQuerySnapshot()
+{
+	b2Assert(m_querySnapshot != nullptr);
+	b2Assert(IsLocked() == false);
+	m_querySnapshot->Publish(m_contactManager.m_broadPhase);
+	FreeRetired();
+}
+
+void b2World::RetireFixture(b2Fixture* fixture)
+{
+	if (m_querySnapshot)
+	{
+		// The published snapshot may still report this fixture and its body.
+		fixture->m_next = m_retiredFixtures;
+		m_retiredFixtures = fixture;
+		return;
+	}
+
+	fixture->Destroy(&m_blockAllocator);
+	fixture->~b2Fixture();
+	m_blockAllocator.Free(fixture, sizeof(b2Fixture));
+}
+
+void b2World::RetireBody(b2Body* body)
+{
+	if (m_querySnapshot)
+	{
+		body->m_next = m_retiredBodies;
+		m_retiredBodies = body;
+		return;
+	}
+
+	body->~b2Body();
+	m_blockAllocator.Free(body, sizeof(b2Body));
+}
+
+void b2World::FreeRetired()
+{
+	if (m_retiredFixtures == nullptr && m_retiredBodies == nullptr)
+	{
+		return;
+	}
+
+	// The current snapshot no longer holds these. Wait out queries reading the
+	// previous one, so each publish waits once however many were destroyed.
+	m_querySnapshot->WaitForStaleReaders();
+
+	b2Fixture* f = m_retiredFixtures;
+	while (f)
+	{
+		b2Fixture* f0 = f;
+		f = f->m_next;
+
+		f0->Destroy(&m_blockAllocator);
+		f0->~b2Fixture();
+		m_blockAllocator.Free(f0, sizeof(b2Fixture));
+	}
+	m_retiredFixtures = nullptr;
+
+	b2Body* b = m_retiredBodies;
+	while (b)
+	{
+		b2Body* b0 = b;
+		b = b->m_next;
+
+		b0->~b2Body();
+		m_blockAllocator.Free(b0, sizeof(b2Body));
+	}
+	m_retiredBodies = nullptr;
+}
+
+void b2World::QuerySnapshotAABB(b2QueryCallback* callback, const b2AABB& aabb) const
+{
+	b2Assert(m_querySnapshot != nullptr);
+	m_querySnapshot->QueryAABB(callback, aabb);
+}
+
+void b2World::RayCastSnapshot(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const
+{
+	b2Assert(m_querySnapshot != nullptr);
+	m_querySnapshot->RayCast(callback, point1, point2);
+}
+
 struct b2WorldRayCastWrapper
 {
 	float RayCastCallback(const b2RayCastInput& input, int32 proxyId)
@@ -1036,6 +1778,119 @@ void b2World::RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b
 	m_contactManager.m_broadPhase.RayCast(&wrapper, input);
 }
 
+// Casts the shape against the polygons of a compound near the sweep.
+struct b2CompoundShapeCastCallback
+{
+	bool QueryCallback(int32 index)
+	{
+		b2ShapeCastInput subInput = *input;
+		subInput.proxyA.Set(compound->m_polygons + index, 0);
+		subInput.translationB = fraction * input->translationB;
+
+		b2ShapeCastOutput subOutput;
+		if (b2ShapeCast(&subOutput, &subInput))
+		{
+			// Each hit shortens the cast for the remaining polygons.
+			fraction *= subOutput.lambda;
+			output->point = subOutput.point;
+			output->normal = subOutput.normal;
+			output->lambda = fraction;
+			hit = true;
+		}
+
+		return true;
+	}
+
+	const b2CompoundShape* compound;
+	const b2ShapeCastInput* input;
+	b2ShapeCastOutput* output;
+	float fraction;
+	bool hit;
+};
+
+struct b2WorldShapeCastWrapper
+{
+	float ShapeCastCallback(const b2AABBCastInput& input, int32 proxyId)
+	{
+		void* userData = broadPhase->GetUserData(proxyId);
+		b2FixtureProxy* proxy = (b2FixtureProxy*)userData;
+		b2Fixture* fixture = proxy->fixture;
+		int32 index = proxy->childIndex;
+		const b2Shape* fixtureShape = fixture->GetShape();
+		const b2Transform& xf = fixture->GetBody()->GetTransform();
+
+		b2ShapeCastInput castInput;
+		castInput.proxyB.Set(shape, 0);
+		castInput.transformA = xf;
+		castInput.transformB = transform;
+		castInput.translationB = input.maxFraction * translation;
+
+		b2ShapeCastOutput output;
+		bool hit;
+		if (fixtureShape->GetType() == b2Shape::e_compound)
+		{
+			const b2CompoundShape* compound = (const b2CompoundShape*)fixtureShape;
+
+			// Swept bounds of the shape in the frame of the compound.
+			b2Transform xf0 = b2MulT(xf, transform);
+			b2Transform xf1 = xf0;
+			xf1.p += b2MulT(xf.q, castInput.translationB);
+			b2AABB aabb0, aabb1, aabb;
+			shape->ComputeAABB(&aabb0, xf0, 0);
+			shape->ComputeAABB(&aabb1, xf1, 0);
+			aabb.Combine(aabb0, aabb1);
+
+			b2CompoundShapeCastCallback callback;
+			callback.compound = compound;
+			callback.input = &castInput;
+			callback.output = &output;
+			callback.fraction = 1.0f;
+			callback.hit = false;
+			compound->Query(&callback, aabb);
+			hit = callback.hit;
+		}
+		else
+		{
+			castInput.proxyA.Set(fixtureShape, index);
+			hit = b2ShapeCast(&output, &castInput);
+		}
+
+		// A zero fraction means the shapes overlap at the start.
+		if (hit && output.lambda > 0.0f)
+		{
+			float fraction = input.maxFraction * output.lambda;
+			return callback->ReportFixture(fixture, output.point, output.normal, fraction);
+		}
+
+		return input.maxFraction;
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2ShapeCastCallback* callback;
+	const b2Shape* shape;
+	b2Transform transform;
+	b2Vec2 translation;
+};
+
+void b2World::ShapeCast(b2ShapeCastCallback* callback, const b2Shape* shape,
+						const b2Transform& transform, const b2Vec2& translation) const
+{
+	b2Assert(shape->GetType() != b2Shape::e_chain && shape->GetType() != b2Shape::e_compound);
+
+	b2WorldShapeCastWrapper wrapper;
+	wrapper.broadPhase = &m_contactManager.m_broadPhase;
+	wrapper.callback = callback;
+	wrapper.shape = shape;
+	wrapper.transform = transform;
+	wrapper.translation = translation;
+
+	b2AABBCastInput input;
+	shape->ComputeAABB(&input.aabb, transform, 0);
+	input.translation = translation;
+	input.maxFraction = 1.0f;
+	m_contactManager.m_broadPhase.ShapeCast(&wrapper, input);
+}
+
 void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color& color)
 {
 	switch (fixture->GetType())
@@ -1096,6 +1951,37 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 			}
 
 			m_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
+
+			// Outline the rounded surface.
+			float rounding = poly->GetRounding();
+			if (rounding > 0.0f)
+			{
+				for (int32 i = 0; i < vertexCount; ++i)
+				{
+					int32 i2 = i + 1 < vertexCount ? i + 1 : 0;
+					b2Vec2 offset = rounding * b2Mul(xf.q, poly->m_normals[i]);
+					m_debugDraw->DrawSegment(vertices[i] + offset, vertices[i2] + offset, color);
+					m_debugDraw->DrawCircle(vertices[i], rounding, color);
+				}
+			}
+		}
+		break;
+
+	case b2Shape::e_compound:
+		{
+			b2CompoundShape* compound = (b2CompoundShape*)fixture->GetShape();
+			b2Vec2 vertices[b2_maxPolygonVertices];
+
+			for (int32 i = 0; i < compound->m_count; ++i)
+			{
+				const b2PolygonShape* poly = compound->m_polygons + i;
+				for (int32 j = 0; j < poly->m_count; ++j)
+				{
+					vertices[j] = b2Mul(xf, poly->m_vertices[j]);
+				}
+
+				m_debugDraw->DrawSolidPolygon(vertices, poly->m_count, color);
+			}
 		}
 		break;
 
@@ -1214,6 +2100,67 @@ void b2World::DebugDraw()
 	}
 }
 
+// Enable disabled bodies and insert the proxies of all their fixtures into the
+// broad-phase with one bulk tree insertion.
+void b2World::EnableBodies(b2Body* const* bodies, int32 count)
+{
+	b2Assert(m_locked == false);
+
+	int32 proxyCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Assert(bodies[i]->IsEnabled() == false);
+		for (b2Fixture* f = bodies[i]->m_fixtureList; f; f = f->m_next)
+		{
+			proxyCount += f->m_shape->GetChildCount();
+		}
+	}
+
+	b2AABB* aabbs = (b2AABB*)m_stackAllocator.Allocate(proxyCount * sizeof(b2AABB));
+	void** userData = (void**)m_stackAllocator.Allocate(proxyCount * sizeof(void*));
+	int32* proxyIds = (int32*)m_stackAllocator.Allocate(proxyCount * sizeof(int32));
+
+	int32 index = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Body* b = bodies[i];
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			f->m_proxyCount = f->m_shape->GetChildCount();
+			for (int32 j = 0; j < f->m_proxyCount; ++j)
+			{
+				b2FixtureProxy* proxy = f->m_proxies + j;
+				f->m_shape->ComputeAABB(&proxy->aabb, b->m_xf, j);
+				proxy->fixture = f;
+				proxy->childIndex = j;
+				aabbs[index] = proxy->aabb;
+				userData[index] = proxy;
+				++index;
+			}
+		}
+	}
+
+	m_contactManager.m_broadPhase.CreateProxies(proxyCount, aabbs, userData, proxyIds);
+
+	for (int32 i = 0; i < proxyCount; ++i)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)userData[i];
+		proxy->proxyId = proxyIds[i];
+	}
+
+	m_stackAllocator.Free(proxyIds);
+	m_stackAllocator.Free(userData);
+	m_stackAllocator.Free(aabbs);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		bodies[i]->m_flags |= b2Body::e_enabledFlag;
+	}
+
+	// Contacts are created at the beginning of the next step.
+	m_newContacts = true;
+}
+
 int32 b2World::GetProxyCount() const
 {
 	return m_contactManager.m_broadPhase.GetProxyCount();
@@ -1242,6 +2189,39 @@ void b2World::ShiftOrigin(const b2Vec2& newOrigin)
 		return;
 	}
 
+	MoveOrigin(newOrigin);
+	m_origin.x += double(newOrigin.x);
+	m_origin.y += double(newOrigin.y);
+
+	if (m_originListener)
+	{
+		m_originListener->ShiftOrigin(this, newOrigin);
+	}
+}
+
+void b2World::SetOrigin(const b2Vec2d& origin)
+{
+	b2Assert(m_locked == false);
+	if (m_locked)
+	{
+		return;
+	}
+
+	b2Vec2 shift(float(origin.x - m_origin.x), float(origin.y - m_origin.y));
+	MoveOrigin(shift);
+
+	// Store the exact origin rather than the rounded sum of shifts.
+	m_origin = origin;
+
+	if (m_originListener)
+	{
+		m_originListener->ShiftOrigin(this, shift);
+	}
+}
+
+// Move everything in the world by the shift. This walks every body, joint and proxy.
+void b2World::MoveOrigin(const b2Vec2& newOrigin)
+{
 	for (b2Body* b = m_bodyList; b; b = b->m_next)
 	{
 		b->m_xf.p -= newOrigin;
@@ -1255,6 +2235,138 @@ void b2World::ShiftOrigin(const b2Vec2& newOrigin)
 	}
 
 	m_contactManager.m_broadPhase.ShiftOrigin(newOrigin);
+
+	m_focus -= newOrigin;
+	for (int32 i = 0; i < m_lodPointCount; ++i)
+	{
+		m_lodPoints[i] -= newOrigin;
+	}
+}
+
+void b2World::SetRecenterDistance(float distance)
+{
+	b2Assert(distance >= 0.0f);
+	m_recenterDistance = distance;
+}
+
+// Shift the origin if the focus moved too far from it. The shift is snapped to a
+// grid so that repeated recentering lands on the same origins.
+void b2World::Recenter()
+{
+	if (b2Abs(m_focus.x) <= m_recenterDistance && b2Abs(m_focus.y) <= m_recenterDistance)
+	{
+		return;
+	}
+
+	float inv = 1.0f / m_recenterDistance;
+	b2Vec2 shift;
+	shift.x = m_recenterDistance * floorf(m_focus.x * inv + 0.5f);
+	shift.y = m_recenterDistance * floorf(m_focus.y * inv + 0.5f);
+	ShiftOrigin(shift);
+}
+
+void b2World::SetLODLevels(const b2LODLevel* levels, int32 count)
+{
+	b2Assert(0 <= count && count <= b2_maxLODLevels);
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Assert(levels[i].stepInterval >= 1);
+		b2Assert(i == 0 || levels[i - 1].distance <= levels[i].distance);
+		m_lodLevels[i] = levels[i];
+	}
+	m_lodLevelCount = count;
+}
+
+void b2World::SetLODFocusPoints(const b2Vec2* points, int32 count)
+{
+	b2Assert(0 <= count && count <= b2_maxFocusPoints);
+	for (int32 i = 0; i < count; ++i)
+	{
+		m_lodPoints[i] = points[i];
+	}
+	m_lodPointCount = count;
+}
+
+// Find the coarsest level of detail allowed for an island. Returns -1 for full detail.
+int32 b2World::ComputeLODLevel(const b2Island& island) const
+{
+	if (m_lodLevelCount == 0 || m_lodPointCount == 0)
+	{
+		return -1;
+	}
+
+	float minDistanceSquared = b2_maxFloat;
+	for (int32 i = 0; i < island.m_bodyCount; ++i)
+	{
+		const b2Body* b = island.m_bodies[i];
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		if ((b->m_flags & b2Body::e_lodFlag) == 0)
+		{
+			return -1;
+		}
+
+		for (int32 j = 0; j < m_lodPointCount; ++j)
+		{
+			minDistanceSquared = b2Min(minDistanceSquared, b2DistanceSquared(b->m_sweep.c, m_lodPoints[j]));
+		}
+	}
+
+	int32 level = -1;
+	for (int32 i = 0; i < m_lodLevelCount; ++i)
+	{
+		float distance = m_lodLevels[i].distance;
+		if (minDistanceSquared < distance * distance)
+		{
+			break;
+		}
+		level = i;
+	}
+
+	return level;
+}
+
+uint32 b2World::ComputeStateHash() const
+{
+	b2Assert(m_locked == false);
+
+	uint32 hash = b2_hashInit;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		hash = b2HashFloat(hash, b->m_xf.p.x);
+		hash = b2HashFloat(hash, b->m_xf.p.y);
+		hash = b2HashFloat(hash, b->m_xf.q.s);
+		hash = b2HashFloat(hash, b->m_xf.q.c);
+		hash = b2HashFloat(hash, b->m_sweep.a);
+		hash = b2HashFloat(hash, b->m_linearVelocity.x);
+		hash = b2HashFloat(hash, b->m_linearVelocity.y);
+		hash = b2HashFloat(hash, b->m_angularVelocity);
+	}
+
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		const b2Manifold& manifold = c->m_manifold;
+		for (int32 i = 0; i < manifold.pointCount; ++i)
+		{
+			hash = b2HashFloat(hash, manifold.points[i].normalImpulse);
+			hash = b2HashFloat(hash, manifold.points[i].tangentImpulse);
+		}
+
+		for (int32 i = 0; i < c->m_childManifoldCount; ++i)
+		{
+			const b2Manifold& childManifold = c->m_childManifolds[i].manifold;
+			for (int32 j = 0; j < childManifold.pointCount; ++j)
+			{
+				hash = b2HashFloat(hash, childManifold.points[j].normalImpulse);
+				hash = b2HashFloat(hash, childManifold.points[j].tangentImpulse);
+			}
+		}
+	}
+
+	return hash;
 }
 
 void b2World::Dump()
@@ -0,0 +1,135 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_thread_pool.h"
+#include "box2d/b2_timer.h"
+#include "box2d/b2_world.h"
+#include "box2d/b2_world_group.h"
+
+#include <string.h>
+
+struct b2WorldGroupTask
+{
+	static void Step(int32 begin, int32 end, int32 threadIndex, void* context)
+	{
+		B2_NOT_USED(threadIndex);
+
+		b2WorldGroupTask* task = (b2WorldGroupTask*)context;
+		b2WorldGroup* group = task->group;
+		for (int32 i = begin; i < end; ++i)
+		{
+			b2Timer timer;
+			group->m_worlds[i]->Step(task->timeStep, task->velocityIterations, task->positionIterations);
+			group->m_stepTimes[i] = timer.GetMilliseconds();
+		}
+	}
+
+	b2WorldGroup* group;
+	float timeStep;
+	int32 velocityIterations;
+	int32 positionIterations;
+};
+
+b2WorldGroup::b2WorldGroup(b2ThreadPool* pool)
+{
+	m_pool = pool;
+	m_capacity = 16;
+	m_count = 0;
+	m_worlds = (b2World**)b2Alloc(m_capacity * sizeof(b2World*));
+	m_stepTimes = (float*)b2Alloc(m_capacity * sizeof(float));
+}
+
+b2WorldGroup::~b2WorldGroup()
+{
+	b2Free(m_worlds);
+	b2Free(m_stepTimes);
+}
+
+int32 b2WorldGroup::AddWorld(b2World* world)
+{
+	if (m_count == m_capacity)
+	{
+		b2World** oldWorlds = m_worlds;
+		float* oldStepTimes = m_stepTimes;
+		m_capacity *= 2;
+		m_worlds = (b2World**)b2Alloc(m_capacity * sizeof(b2World*));
+		m_stepTimes = (float*)b2Alloc(m_capacity * sizeof(float));
+		memcpy(m_worlds, oldWorlds, m_count * sizeof(b2World*));
+		memcpy(m_stepTimes, oldStepTimes, m_count * sizeof(float));
+		b2Free(oldWorlds);
+		b2Free(oldStepTimes);
+	}
+
+	m_worlds[m_count] = world;
+	m_stepTimes[m_count] = 0.0f;
+	return m_count++;
+}
+
+void b2WorldGroup::RemoveWorld(b2World* world)
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		if (m_worlds[i] == world)
+		{
+			--m_count;
+			m_worlds[i] = m_worlds[m_count];
+			m_stepTimes[i] = m_stepTimes[m_count];
+			return;
+		}
+	}
+
+	b2Assert(false);
+}
+
+void b2WorldGroup::Step(float timeStep, int32 velocityIterations, int32 positionIterations)
+{
+	b2WorldGroupTask task;
+	task.group = this;
+	task.timeStep = timeStep;
+	task.velocityIterations = velocityIterations;
+	task.positionIterations = positionIterations;
+
+	if (m_pool == nullptr)
+	{
+		b2WorldGroupTask::Step(0, m_count, 0, &task);
+		return;
+	}
+
+	// One world per task so busy worlds spread across the threads by stealing.
+	m_pool->ParallelFor(m_count, 1, b2WorldGroupTask::Step, &task);
+}
+
+int32 b2WorldGroup::GetSlowestWorld() const
+{
+	int32 index = -1;
+	float maxTime = -1.0f;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		if (m_stepTimes[i] > maxTime)
+		{
+			maxTime = m_stepTimes[i];
+			index = i;
+		}
+	}
+
+	return index;
+}
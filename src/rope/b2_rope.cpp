@@ -249,7 +249,7 @@ void b2Rope::Step(float dt, int32 iterations, const b2Vec2& position)
 	}
 
 	const float inv_dt = 1.0f / dt;
-	float d = expf(- dt * m_tuning.damping);
+	float d = b2Exp(- dt * m_tuning.damping);
 
 	// Apply gravity and damping
 	for (int32 i = 0; i < m_count; ++i)
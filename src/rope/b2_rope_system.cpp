@@ -0,0 +1,1893 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "box2d/b2_body.h"
+#include "box2d/b2_broad_phase.h"
+#include "box2d/b2_compound_shape.h"
+#include "box2d/b2_contact_manager.h"
+#include "box2d/b2_distance.h"
+#include "box2d/b2_draw.h"
+#include "box2d/b2_growable_stack.h"
+#include "box2d/b2_rope_system.h"
+#include "box2d/b2_thread_pool.h"
+#include "box2d/b2_world.h"
+
+#include "collision/b2_simd.h"
+
+#include <string.h>
+
+// Vertex fields
+enum
+{
+	e_vertexX,
+	e_vertexY,
+	e_vertexX0,
+	e_vertexY0,
+	e_vertexVX,
+	e_vertexVY,
+	e_vertexInvMass,
+	e_vertexBindX,
+	e_vertexBindY,
+	e_vertexFloatCount
+};
+
+// Stretch constraint fields
+enum
+{
+	e_stretchInvMass1,
+	e_stretchInvMass2,
+	e_stretchLength,
+	e_stretchLambda,
+	e_stretchSpring,
+	e_stretchDamper,
+	e_stretchFloatCount
+};
+
+enum
+{
+	e_stretchIndex1,
+	e_stretchIndex2,
+	e_stretchIntCount
+};
+
+// Bend constraint fields
+enum
+{
+	e_bendInvMass1,
+	e_bendInvMass2,
+	e_bendInvMass3,
+	e_bendInvEffectiveMass,
+	e_bendLength1,
+	e_bendLength2,
+	e_bendAlpha1,
+	e_bendAlpha2,
+	e_bendSpring,
+	e_bendDamper,
+	e_bendLambda,
+	e_bendFloatCount
+};
+
+enum
+{
+	e_bendIndex1,
+	e_bendIndex2,
+	e_bendIndex3,
+	e_bendIntCount
+};
+
+// Stretch constraints use two colors and bend constraints use three.
+#define b2_stretchColorCount 2
+#define b2_bendColorCount 3
+
+// The smallest number of ropes given to a thread.
+static const int32 b2_ropeRange = 4;
+
+static void b2CreateBuffer(b2RopeBuffer* buffer, int32 floatFieldCount, int32 intFieldCount)
+{
+	buffer->floatFieldCount = floatFieldCount;
+	buffer->intFieldCount = intFieldCount;
+	buffer->count = 0;
+	buffer->capacity = 64;
+	buffer->floats = (float*)b2Alloc(floatFieldCount * buffer->capacity * sizeof(float));
+	buffer->ints = intFieldCount > 0 ? (int32*)b2Alloc(intFieldCount * buffer->capacity * sizeof(int32)) : nullptr;
+}
+
+static void b2DestroyBuffer(b2RopeBuffer* buffer)
+{
+	b2Free(buffer->floats);
+	b2Free(buffer->ints);
+}
+
+// Add count elements at the end of the buffer and return the index of the first.
+static int32 b2GrowBuffer(b2RopeBuffer* buffer, int32 count)
+{
+	int32 start = buffer->count;
+	if (start + count > buffer->capacity)
+	{
+		int32 capacity = buffer->capacity;
+		while (start + count > capacity)
+		{
+			capacity *= 2;
+		}
+
+		float* floats = (float*)b2Alloc(buffer->floatFieldCount * capacity * sizeof(float));
+		for (int32 i = 0; i < buffer->floatFieldCount; ++i)
+		{
+			memcpy(floats + i * capacity, buffer->floats + i * buffer->capacity, start * sizeof(float));
+		}
+
+		int32* ints = nullptr;
+		if (buffer->intFieldCount > 0)
+		{
+			ints = (int32*)b2Alloc(buffer->intFieldCount * capacity * sizeof(int32));
+			for (int32 i = 0; i < buffer->intFieldCount; ++i)
+			{
+				memcpy(ints + i * capacity, buffer->ints + i * buffer->capacity, start * sizeof(int32));
+			}
+		}
+
+		b2Free(buffer->floats);
+		b2Free(buffer->ints);
+		buffer->floats = floats;
+		buffer->ints = ints;
+		buffer->capacity = capacity;
+	}
+
+	buffer->count += count;
+	return start;
+}
+
+// Remove a range of elements and move the following elements down.
+static void b2RemoveFromBuffer(b2RopeBuffer* buffer, int32 start, int32 count)
+{
+	int32 tail = buffer->count - (start + count);
+	for (int32 i = 0; i < buffer->floatFieldCount; ++i)
+	{
+		float* field = buffer->GetFloats(i);
+		memmove(field + start, field + start + count, tail * sizeof(float));
+	}
+
+	for (int32 i = 0; i < buffer->intFieldCount; ++i)
+	{
+		int32* field = buffer->GetInts(i);
+		memmove(field + start, field + start + count, tail * sizeof(int32));
+	}
+
+	buffer->count -= count;
+}
+
+// Make room for one more element in a growable array.
+template <typename T>
+static void b2GrowArray(T** array, int32* capacity, int32 count)
+{
+	if (count < *capacity)
+	{
+		return;
+	}
+
+	T* oldArray = *array;
+	*capacity = b2Max(2 * *capacity, 8);
+	*array = (T*)b2Alloc(*capacity * sizeof(T));
+	if (oldArray != nullptr)
+	{
+		memcpy(*array, oldArray, count * sizeof(T));
+		b2Free(oldArray);
+	}
+}
+
+static inline int32 b2PadToWidth(int32 count)
+{
+	return (count + b2_simdWidth - 1) & ~(b2_simdWidth - 1);
+}
+
+// Gather a vertex value for each lane. Padding lanes have a negative index.
+// They read the first vertex and are never written.
+static inline b2FloatW b2GatherW(const float* values, const int32* indices)
+{
+	return b2MakeW(values[b2Max(indices[0], 0)], values[b2Max(indices[1], 0)],
+				   values[b2Max(indices[2], 0)], values[b2Max(indices[3], 0)]);
+}
+
+static inline void b2ScatterW(float* values, const int32* indices, b2FloatW a)
+{
+	alignas(16) float lanes[b2_simdWidth];
+	b2StoreW(lanes, a);
+	for (int32 i = 0; i < b2_simdWidth; ++i)
+	{
+		if (indices[i] >= 0)
+		{
+			values[indices[i]] = lanes[i];
+		}
+	}
+}
+
+// The lanes of b2ComputeAtan2.
+static b2FloatW b2Atan2W(b2FloatW y, b2FloatW x)
+{
+	b2FloatW zero = b2SplatW(0.0f);
+	b2FloatW one = b2SplatW(1.0f);
+	b2FloatW ax = b2AbsW(x);
+	b2FloatW ay = b2AbsW(y);
+	b2FloatW mx = b2MaxW(ax, ay);
+	b2FloatW mn = b2MinW(ax, ay);
+	b2FloatW nonZero = b2GreaterW(mx, zero);
+
+	// Reduce to [0, tan(pi/8)] using atan(a) = pi/4 + atan((a - 1) / (a + 1)).
+	b2FloatW a = b2DivW(mn, b2SelectW(nonZero, mx, one));
+	b2FloatW big = b2GreaterW(a, b2SplatW(0.414213562373095f));
+	a = b2SelectW(big, b2DivW(b2SubW(a, one), b2AddW(a, one)), a);
+	b2FloatW base = b2SelectW(big, b2SplatW(0.25f * b2_pi), zero);
+
+	b2FloatW z = b2MulW(a, a);
+	b2FloatW r = b2SubW(b2MulW(b2SplatW(8.05374449538e-2f), z), b2SplatW(1.38776856032e-1f));
+	r = b2AddW(b2MulW(r, z), b2SplatW(1.99777106478e-1f));
+	r = b2SubW(b2MulW(r, z), b2SplatW(3.33329491539e-1f));
+	r = b2AddW(base, b2AddW(b2MulW(b2MulW(r, z), a), a));
+
+	r = b2SelectW(b2GreaterW(ay, ax), b2SubW(b2SplatW(0.5f * b2_pi), r), r);
+	r = b2SelectW(b2GreaterW(zero, x), b2SubW(b2SplatW(b2_pi), r), r);
+	r = b2SelectW(b2GreaterW(zero, y), b2SubW(zero, r), r);
+	return b2SelectW(nonZero, r, zero);
+}
+
+struct b2RopeSystemTask
+{
+	static void Step(int32 begin, int32 end, int32 threadIndex, void* context)
+	{
+		B2_NOT_USED(threadIndex);
+
+		b2RopeSystemTask* task = (b2RopeSystemTask*)context;
+		for (int32 i = begin; i < end; ++i)
+		{
+			task->system->StepRope(i, task->timeStep, task->iterations);
+		}
+	}
+
+	b2RopeSystem* system;
+	float timeStep;
+	int32 iterations;
+};
+
+b2RopeSystem::b2RopeSystem(b2ThreadPool* pool)
+{
+	m_pool = pool;
+	m_world = nullptr;
+	m_ropeCapacity = 16;
+	m_ropeCount = 0;
+	m_ropes = (b2RopeRecord*)b2Alloc(m_ropeCapacity * sizeof(b2RopeRecord));
+
+	b2CreateBuffer(&m_vertices, e_vertexFloatCount, 0);
+	b2CreateBuffer(&m_stretches, e_stretchFloatCount, e_stretchIntCount);
+	b2CreateBuffer(&m_bends, e_bendFloatCount, e_bendIntCount);
+}
+
+b2RopeSystem::~b2RopeSystem()
+{
+	for (int32 i = 0; i < m_ropeCount; ++i)
+	{
+		b2Free(m_ropes[i].attachments);
+		b2Free(m_ropes[i].contacts);
+	}
+
+	b2Free(m_ropes);
+	b2DestroyBuffer(&m_vertices);
+	b2DestroyBuffer(&m_stretches);
+	b2DestroyBuffer(&m_bends);
+}
+
+int32 b2RopeSystem::CreateRope(const b2RopeDef& def)
+{
+	b2Assert(def.count >= 3);
+
+	if (m_ropeCount == m_ropeCapacity)
+	{
+		b2RopeRecord* oldRopes = m_ropes;
+		m_ropeCapacity *= 2;
+		m_ropes = (b2RopeRecord*)b2Alloc(m_ropeCapacity * sizeof(b2RopeRecord));
+		memcpy(m_ropes, oldRopes, m_ropeCount * sizeof(b2RopeRecord));
+		b2Free(oldRopes);
+	}
+
+	int32 index = m_ropeCount++;
+	b2RopeRecord* rope = m_ropes + index;
+	rope->tuning = def.tuning;
+	rope->position = def.position;
+	rope->gravity = def.gravity;
+	rope->radius = 0.0f;
+	rope->filter = b2Filter();
+	rope->attachments = nullptr;
+	rope->attachmentCount = 0;
+	rope->attachmentCapacity = 0;
+	rope->contacts = nullptr;
+	rope->contactCount = 0;
+	rope->contactCapacity = 0;
+
+	int32 count = def.count;
+	rope->vertexCount = count;
+	rope->vertexStart = b2GrowBuffer(&m_vertices, count);
+
+	{
+		float* px = m_vertices.GetFloats(e_vertexX) + rope->vertexStart;
+		float* py = m_vertices.GetFloats(e_vertexY) + rope->vertexStart;
+		float* p0x = m_vertices.GetFloats(e_vertexX0) + rope->vertexStart;
+		float* p0y = m_vertices.GetFloats(e_vertexY0) + rope->vertexStart;
+		float* vx = m_vertices.GetFloats(e_vertexVX) + rope->vertexStart;
+		float* vy = m_vertices.GetFloats(e_vertexVY) + rope->vertexStart;
+		float* invMasses = m_vertices.GetFloats(e_vertexInvMass) + rope->vertexStart;
+		float* bindX = m_vertices.GetFloats(e_vertexBindX) + rope->vertexStart;
+		float* bindY = m_vertices.GetFloats(e_vertexBindY) + rope->vertexStart;
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			b2Vec2 p = def.vertices[i] + def.position;
+			bindX[i] = def.vertices[i].x;
+			bindY[i] = def.vertices[i].y;
+			px[i] = p.x;
+			py[i] = p.y;
+			p0x[i] = p.x;
+			p0y[i] = p.y;
+			vx[i] = 0.0f;
+			vy[i] = 0.0f;
+
+			float m = def.masses[i];
+			invMasses[i] = m > 0.0f ? 1.0f / m : 0.0f;
+		}
+	}
+
+	const float* invMasses = m_vertices.GetFloats(e_vertexInvMass) + rope->vertexStart;
+
+	// Stretch constraint i joins vertices i and i + 1, so the constraints with the
+	// same parity don't share vertices.
+	int32 stretchCount = count - 1;
+	rope->stretchStarts[0] = m_stretches.count;
+	for (int32 c = 0; c < b2_stretchColorCount; ++c)
+	{
+		int32 colorCount = (stretchCount - c + b2_stretchColorCount - 1) / b2_stretchColorCount;
+		rope->stretchStarts[c + 1] = rope->stretchStarts[c] + b2PadToWidth(colorCount);
+	}
+
+	b2GrowBuffer(&m_stretches, rope->stretchStarts[b2_stretchColorCount] - rope->stretchStarts[0]);
+
+	for (int32 c = 0; c < b2_stretchColorCount; ++c)
+	{
+		int32 slot = rope->stretchStarts[c];
+		int32 i = c;
+		for (; slot < rope->stretchStarts[c + 1]; ++slot, i += b2_stretchColorCount)
+		{
+			float* floats[e_stretchFloatCount];
+			for (int32 f = 0; f < e_stretchFloatCount; ++f)
+			{
+				floats[f] = m_stretches.GetFloats(f) + slot;
+				*floats[f] = 0.0f;
+			}
+
+			int32* i1 = m_stretches.GetInts(e_stretchIndex1) + slot;
+			int32* i2 = m_stretches.GetInts(e_stretchIndex2) + slot;
+
+			if (i >= stretchCount)
+			{
+				// Padding
+				*i1 = -1;
+				*i2 = -1;
+				continue;
+			}
+
+			*i1 = i;
+			*i2 = i + 1;
+			*floats[e_stretchInvMass1] = invMasses[i];
+			*floats[e_stretchInvMass2] = invMasses[i + 1];
+			*floats[e_stretchLength] = b2Distance(def.vertices[i], def.vertices[i + 1]);
+		}
+	}
+
+	// Bend constraint i spans vertices i, i + 1 and i + 2.
+	int32 bendCount = count - 2;
+	rope->bendStarts[0] = m_bends.count;
+	for (int32 c = 0; c < b2_bendColorCount; ++c)
+	{
+		int32 colorCount = (bendCount - c + b2_bendColorCount - 1) / b2_bendColorCount;
+		rope->bendStarts[c + 1] = rope->bendStarts[c] + b2PadToWidth(colorCount);
+	}
+
+	b2GrowBuffer(&m_bends, rope->bendStarts[b2_bendColorCount] - rope->bendStarts[0]);
+
+	for (int32 c = 0; c < b2_bendColorCount; ++c)
+	{
+		int32 slot = rope->bendStarts[c];
+		int32 i = c;
+		for (; slot < rope->bendStarts[c + 1]; ++slot, i += b2_bendColorCount)
+		{
+			float* floats[e_bendFloatCount];
+			for (int32 f = 0; f < e_bendFloatCount; ++f)
+			{
+				floats[f] = m_bends.GetFloats(f) + slot;
+				*floats[f] = 0.0f;
+			}
+
+			int32* i1 = m_bends.GetInts(e_bendIndex1) + slot;
+			int32* i2 = m_bends.GetInts(e_bendIndex2) + slot;
+			int32* i3 = m_bends.GetInts(e_bendIndex3) + slot;
+
+			if (i >= bendCount)
+			{
+				// Padding
+				*i1 = -1;
+				*i2 = -1;
+				*i3 = -1;
+				continue;
+			}
+
+			*i1 = i;
+			*i2 = i + 1;
+			*i3 = i + 2;
+
+			float invMass1 = invMasses[i];
+			float invMass2 = invMasses[i + 1];
+			float invMass3 = invMasses[i + 2];
+			*floats[e_bendInvMass1] = invMass1;
+			*floats[e_bendInvMass2] = invMass2;
+			*floats[e_bendInvMass3] = invMass3;
+
+			b2Vec2 p1 = def.vertices[i];
+			b2Vec2 p2 = def.vertices[i + 1];
+			b2Vec2 p3 = def.vertices[i + 2];
+
+			*floats[e_bendLength1] = b2Distance(p1, p2);
+			*floats[e_bendLength2] = b2Distance(p2, p3);
+
+			// Pre-compute effective mass
+			b2Vec2 e1 = p2 - p1;
+			b2Vec2 e2 = p3 - p2;
+			float L1sqr = e1.LengthSquared();
+			float L2sqr = e2.LengthSquared();
+
+			if (L1sqr * L2sqr == 0.0f)
+			{
+				continue;
+			}
+
+			b2Vec2 Jd1 = (-1.0f / L1sqr) * e1.Skew();
+			b2Vec2 Jd2 = (1.0f / L2sqr) * e2.Skew();
+
+			b2Vec2 J1 = -Jd1;
+			b2Vec2 J2 = Jd1 - Jd2;
+			b2Vec2 J3 = Jd2;
+
+			*floats[e_bendInvEffectiveMass] = invMass1 * b2Dot(J1, J1) + invMass2 * b2Dot(J2, J2) + invMass3 * b2Dot(J3, J3);
+
+			b2Vec2 r = p3 - p1;
+
+			float rr = r.LengthSquared();
+			if (rr == 0.0f)
+			{
+				continue;
+			}
+
+			// a1 = h2 / (h1 + h2)
+			// a2 = h1 / (h1 + h2)
+			*floats[e_bendAlpha1] = b2Dot(e2, r) / rr;
+			*floats[e_bendAlpha2] = b2Dot(e1, r) / rr;
+		}
+	}
+
+	ComputeSprings(index);
+
+	return index;
+}
+
+void b2RopeSystem::DestroyRope(int32 index)
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	b2RopeRecord rope = m_ropes[index];
+	b2Free(rope.attachments);
+	b2Free(rope.contacts);
+
+	int32 stretchStart = rope.stretchStarts[0];
+	int32 stretchCount = rope.stretchStarts[b2_stretchColorCount] - stretchStart;
+	int32 bendStart = rope.bendStarts[0];
+	int32 bendCount = rope.bendStarts[b2_bendColorCount] - bendStart;
+
+	b2RemoveFromBuffer(&m_vertices, rope.vertexStart, rope.vertexCount);
+	b2RemoveFromBuffer(&m_stretches, stretchStart, stretchCount);
+	b2RemoveFromBuffer(&m_bends, bendStart, bendCount);
+
+	// Constraints refer to vertices relative to the rope, so only the ranges move.
+	for (int32 i = 0; i < m_ropeCount; ++i)
+	{
+		b2RopeRecord* other = m_ropes + i;
+		if (other->vertexStart > rope.vertexStart)
+		{
+			other->vertexStart -= rope.vertexCount;
+		}
+
+		if (other->stretchStarts[0] > stretchStart)
+		{
+			for (int32 c = 0; c <= b2_stretchColorCount; ++c)
+			{
+				other->stretchStarts[c] -= stretchCount;
+			}
+		}
+
+		if (other->bendStarts[0] > bendStart)
+		{
+			for (int32 c = 0; c <= b2_bendColorCount; ++c)
+			{
+				other->bendStarts[c] -= bendCount;
+			}
+		}
+	}
+
+	--m_ropeCount;
+	m_ropes[index] = m_ropes[m_ropeCount];
+}
+
+void b2RopeSystem::SetTuning(int32 index, const b2RopeTuning& tuning)
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	m_ropes[index].tuning = tuning;
+	ComputeSprings(index);
+}
+
+// Pre-compute spring and damper values based on tuning
+void b2RopeSystem::ComputeSprings(int32 index)
+{
+	const b2RopeRecord& rope = m_ropes[index];
+	const b2RopeTuning& tuning = rope.tuning;
+
+	const float bendOmega = 2.0f * b2_pi * tuning.bendHertz;
+
+	for (int32 i = rope.bendStarts[0]; i < rope.bendStarts[b2_bendColorCount]; ++i)
+	{
+		float L1 = m_bends.GetFloats(e_bendLength1)[i];
+		float L2 = m_bends.GetFloats(e_bendLength2)[i];
+		float invMass1 = m_bends.GetFloats(e_bendInvMass1)[i];
+		float invMass2 = m_bends.GetFloats(e_bendInvMass2)[i];
+		float invMass3 = m_bends.GetFloats(e_bendInvMass3)[i];
+		float* spring = m_bends.GetFloats(e_bendSpring) + i;
+		float* damper = m_bends.GetFloats(e_bendDamper) + i;
+
+		float L1sqr = L1 * L1;
+		float L2sqr = L2 * L2;
+
+		if (L1sqr * L2sqr == 0.0f)
+		{
+			*spring = 0.0f;
+			*damper = 0.0f;
+			continue;
+		}
+
+		// Flatten the triangle formed by the two edges
+		float J2 = 1.0f / L1 + 1.0f / L2;
+		float sum = invMass1 / L1sqr + invMass2 * J2 * J2 + invMass3 / L2sqr;
+		if (sum == 0.0f)
+		{
+			*spring = 0.0f;
+			*damper = 0.0f;
+			continue;
+		}
+
+		float mass = 1.0f / sum;
+
+		*spring = mass * bendOmega * bendOmega;
+		*damper = 2.0f * mass * tuning.bendDamping * bendOmega;
+	}
+
+	const float stretchOmega = 2.0f * b2_pi * tuning.stretchHertz;
+
+	for (int32 i = rope.stretchStarts[0]; i < rope.stretchStarts[b2_stretchColorCount]; ++i)
+	{
+		float sum = m_stretches.GetFloats(e_stretchInvMass1)[i] + m_stretches.GetFloats(e_stretchInvMass2)[i];
+		if (sum == 0.0f)
+		{
+			continue;
+		}
+
+		float mass = 1.0f / sum;
+
+		m_stretches.GetFloats(e_stretchSpring)[i] = mass * stretchOmega * stretchOmega;
+		m_stretches.GetFloats(e_stretchDamper)[i] = 2.0f * mass * tuning.stretchDamping * stretchOmega;
+	}
+}
+
+void b2RopeSystem::SetPosition(int32 index, const b2Vec2& position)
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	m_ropes[index].position = position;
+}
+
+void b2RopeSystem::Reset(int32 index, const b2Vec2& position)
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	b2RopeRecord& rope = m_ropes[index];
+	rope.position = position;
+
+	int32 start = rope.vertexStart;
+	for (int32 i = start; i < start + rope.vertexCount; ++i)
+	{
+		float x = m_vertices.GetFloats(e_vertexBindX)[i] + position.x;
+		float y = m_vertices.GetFloats(e_vertexBindY)[i] + position.y;
+		m_vertices.GetFloats(e_vertexX)[i] = x;
+		m_vertices.GetFloats(e_vertexY)[i] = y;
+		m_vertices.GetFloats(e_vertexX0)[i] = x;
+		m_vertices.GetFloats(e_vertexY0)[i] = y;
+		m_vertices.GetFloats(e_vertexVX)[i] = 0.0f;
+		m_vertices.GetFloats(e_vertexVY)[i] = 0.0f;
+	}
+
+	for (int32 i = rope.stretchStarts[0]; i < rope.stretchStarts[b2_stretchColorCount]; ++i)
+	{
+		m_stretches.GetFloats(e_stretchLambda)[i] = 0.0f;
+	}
+
+	for (int32 i = rope.bendStarts[0]; i < rope.bendStarts[b2_bendColorCount]; ++i)
+	{
+		m_bends.GetFloats(e_bendLambda)[i] = 0.0f;
+	}
+}
+
+void b2RopeSystem::SetWorld(b2World* world)
+{
+	m_world = world;
+}
+
+void b2RopeSystem::SetRadius(int32 index, float radius)
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	b2Assert(b2IsValid(radius) && radius >= 0.0f);
+	m_ropes[index].radius = radius;
+}
+
+void b2RopeSystem::SetFilterData(int32 index, const b2Filter& filter)
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	m_ropes[index].filter = filter;
+}
+
+void b2RopeSystem::Attach(int32 index, int32 vertexIndex, b2Body* body, const b2Vec2& localAnchor)
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	b2RopeRecord* rope = m_ropes + index;
+	b2Assert(0 <= vertexIndex && vertexIndex < rope->vertexCount);
+	b2Assert(body != nullptr);
+
+	Detach(index, vertexIndex);
+
+	b2GrowArray(&rope->attachments, &rope->attachmentCapacity, rope->attachmentCount);
+	b2RopeAttachment* attachment = rope->attachments + rope->attachmentCount;
+	++rope->attachmentCount;
+
+	attachment->body = body;
+	attachment->localAnchor = localAnchor;
+	attachment->vertexIndex = vertexIndex;
+}
+
+void b2RopeSystem::Detach(int32 index, int32 vertexIndex)
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	b2RopeRecord* rope = m_ropes + index;
+
+	for (int32 i = 0; i < rope->attachmentCount; ++i)
+	{
+		if (rope->attachments[i].vertexIndex == vertexIndex)
+		{
+			--rope->attachmentCount;
+			rope->attachments[i] = rope->attachments[rope->attachmentCount];
+			return;
+		}
+	}
+}
+
+void b2RopeSystem::DetachBody(b2Body* body)
+{
+	for (int32 i = 0; i < m_ropeCount; ++i)
+	{
+		b2RopeRecord* rope = m_ropes + i;
+		int32 j = 0;
+		while (j < rope->attachmentCount)
+		{
+			if (rope->attachments[j].body == body)
+			{
+				--rope->attachmentCount;
+				rope->attachments[j] = rope->attachments[rope->attachmentCount];
+				continue;
+			}
+
+			++j;
+		}
+	}
+}
+
+int32 b2RopeSystem::GetContactCount() const
+{
+	int32 count = 0;
+	for (int32 i = 0; i < m_ropeCount; ++i)
+	{
+		count += m_ropes[i].contactCount;
+	}
+	return count;
+}
+
+void b2RopeSystem::ShiftOrigin(const b2Vec2& newOrigin)
+{
+	for (int32 i = 0; i < m_ropeCount; ++i)
+	{
+		m_ropes[i].position -= newOrigin;
+	}
+
+	int32 count = m_vertices.count;
+	float* px = m_vertices.GetFloats(e_vertexX);
+	float* py = m_vertices.GetFloats(e_vertexY);
+	float* p0x = m_vertices.GetFloats(e_vertexX0);
+	float* p0y = m_vertices.GetFloats(e_vertexY0);
+	for (int32 i = 0; i < count; ++i)
+	{
+		px[i] -= newOrigin.x;
+		py[i] -= newOrigin.y;
+		p0x[i] -= newOrigin.x;
+		p0y[i] -= newOrigin.y;
+	}
+}
+
+b2Vec2 b2RopeSystem::GetVertex(int32 index, int32 vertexIndex) const
+{
+	b2Assert(0 <= index && index < m_ropeCount);
+	const b2RopeRecord& rope = m_ropes[index];
+	b2Assert(0 <= vertexIndex && vertexIndex < rope.vertexCount);
+	int32 i = rope.vertexStart + vertexIndex;
+	return b2Vec2(m_vertices.GetFloats(e_vertexX)[i], m_vertices.GetFloats(e_vertexY)[i]);
+}
+
+void b2RopeSystem::Step(float dt, int32 iterations)
+{
+	if (dt == 0.0f)
+	{
+		return;
+	}
+
+	b2RopeSystemTask task;
+	task.system = this;
+	task.timeStep = dt;
+	task.iterations = iterations;
+
+	if (m_pool == nullptr)
+	{
+		b2RopeSystemTask::Step(0, m_ropeCount, 0, &task);
+	}
+	else
+	{
+		m_pool->ParallelFor(m_ropeCount, b2_ropeRange, b2RopeSystemTask::Step, &task);
+	}
+
+	// Bodies may be shared by ropes on different threads, so the ropes push on them here.
+	ApplyImpulses(dt);
+}
+
+void b2RopeSystem::StepRope(int32 index, float dt, int32 iterations)
+{
+	b2RopeRecord& rope = m_ropes[index];
+	const b2RopeTuning& tuning = rope.tuning;
+
+	int32 start = rope.vertexStart;
+	int32 count = rope.vertexCount;
+	float* px = m_vertices.GetFloats(e_vertexX) + start;
+	float* py = m_vertices.GetFloats(e_vertexY) + start;
+	float* p0x = m_vertices.GetFloats(e_vertexX0) + start;
+	float* p0y = m_vertices.GetFloats(e_vertexY0) + start;
+	float* vx = m_vertices.GetFloats(e_vertexVX) + start;
+	float* vy = m_vertices.GetFloats(e_vertexVY) + start;
+	const float* invMasses = m_vertices.GetFloats(e_vertexInvMass) + start;
+	const float* bindX = m_vertices.GetFloats(e_vertexBindX) + start;
+	const float* bindY = m_vertices.GetFloats(e_vertexBindY) + start;
+
+	const float inv_dt = 1.0f / dt;
+	float d = b2Exp(- dt * tuning.damping);
+
+	// Apply gravity and damping
+	for (int32 i = 0; i < count; ++i)
+	{
+		if (invMasses[i] > 0.0f)
+		{
+			vx[i] = d * vx[i] + dt * rope.gravity.x;
+			vy[i] = d * vy[i] + dt * rope.gravity.y;
+		}
+		else
+		{
+			vx[i] = inv_dt * (bindX[i] + rope.position.x - p0x[i]);
+			vy[i] = inv_dt * (bindY[i] + rope.position.y - p0y[i]);
+		}
+	}
+
+	PrepareAttachments(&rope, dt);
+
+	// Apply bending spring
+	if (tuning.bendingModel == b2_springAngleBendingModel)
+	{
+		ApplyBendForces(rope, dt);
+	}
+
+	float* bendLambdas = m_bends.GetFloats(e_bendLambda);
+	for (int32 i = rope.bendStarts[0]; i < rope.bendStarts[b2_bendColorCount]; ++i)
+	{
+		bendLambdas[i] = 0.0f;
+	}
+
+	float* stretchLambdas = m_stretches.GetFloats(e_stretchLambda);
+	for (int32 i = rope.stretchStarts[0]; i < rope.stretchStarts[b2_stretchColorCount]; ++i)
+	{
+		stretchLambdas[i] = 0.0f;
+	}
+
+	// Update position
+	for (int32 i = 0; i < count; ++i)
+	{
+		px[i] += dt * vx[i];
+		py[i] += dt * vy[i];
+	}
+
+	rope.contactCount = 0;
+	if (m_world != nullptr && rope.radius > 0.0f)
+	{
+		FindContacts(&rope, dt);
+	}
+
+	// Solve constraints
+	for (int32 i = 0; i < iterations; ++i)
+	{
+		if (tuning.bendingModel == b2_pbdAngleBendingModel)
+		{
+			SolveBend_PBD_Angle(rope);
+		}
+		else if (tuning.bendingModel == b2_xpbdAngleBendingModel)
+		{
+			SolveBend_XPBD_Angle(rope, dt);
+		}
+		else if (tuning.bendingModel == b2_pbdDistanceBendingModel)
+		{
+			SolveBend_PBD_Distance(rope);
+		}
+		else if (tuning.bendingModel == b2_pbdHeightBendingModel)
+		{
+			SolveBend_PBD_Height(rope);
+		}
+		else if (tuning.bendingModel == b2_pbdTriangleBendingModel)
+		{
+			SolveBend_PBD_Triangle(rope);
+		}
+
+		if (tuning.stretchingModel == b2_pbdStretchingModel)
+		{
+			SolveStretch_PBD(rope);
+		}
+		else if (tuning.stretchingModel == b2_xpbdStretchingModel)
+		{
+			SolveStretch_XPBD(rope, dt);
+		}
+
+		SolveAttachments(&rope);
+		SolveContacts(&rope);
+	}
+
+	// Constrain velocity
+	for (int32 i = 0; i < count; ++i)
+	{
+		vx[i] = inv_dt * (px[i] - p0x[i]);
+		vy[i] = inv_dt * (py[i] - p0y[i]);
+		p0x[i] = px[i];
+		p0y[i] = py[i];
+	}
+}
+
+void b2RopeSystem::SolveStretch_PBD(const b2RopeRecord& rope)
+{
+	float* px = m_vertices.GetFloats(e_vertexX) + rope.vertexStart;
+	float* py = m_vertices.GetFloats(e_vertexY) + rope.vertexStart;
+
+	const int32* indices1 = m_stretches.GetInts(e_stretchIndex1);
+	const int32* indices2 = m_stretches.GetInts(e_stretchIndex2);
+	const float* invMasses1 = m_stretches.GetFloats(e_stretchInvMass1);
+	const float* invMasses2 = m_stretches.GetFloats(e_stretchInvMass2);
+	const float* lengths = m_stretches.GetFloats(e_stretchLength);
+
+	const b2FloatW stiffness = b2SplatW(rope.tuning.stretchStiffness);
+	const b2FloatW zero = b2SplatW(0.0f);
+	const b2FloatW one = b2SplatW(1.0f);
+	const b2FloatW epsilon = b2SplatW(b2_epsilon);
+
+	// The colors are stored one after the other so this is red-black order.
+	for (int32 i = rope.stretchStarts[0]; i < rope.stretchStarts[b2_stretchColorCount]; i += b2_simdWidth)
+	{
+		const int32* i1 = indices1 + i;
+		const int32* i2 = indices2 + i;
+
+		b2FloatW p1x = b2GatherW(px, i1), p1y = b2GatherW(py, i1);
+		b2FloatW p2x = b2GatherW(px, i2), p2y = b2GatherW(py, i2);
+
+		// Normalize like b2Vec2::Normalize
+		b2FloatW dx = b2SubW(p2x, p1x);
+		b2FloatW dy = b2SubW(p2y, p1y);
+		b2FloatW L = b2SqrtW(b2AddW(b2MulW(dx, dx), b2MulW(dy, dy)));
+		b2FloatW valid = b2GreaterW(L, epsilon);
+		b2FloatW invL = b2SelectW(valid, b2DivW(one, b2SelectW(valid, L, one)), one);
+		dx = b2MulW(dx, invL);
+		dy = b2MulW(dy, invL);
+		L = b2SelectW(valid, L, zero);
+
+		b2FloatW invMass1 = b2LoadUW(invMasses1 + i);
+		b2FloatW invMass2 = b2LoadUW(invMasses2 + i);
+		b2FloatW sum = b2AddW(invMass1, invMass2);
+		b2FloatW safeSum = b2SelectW(b2GreaterW(sum, zero), sum, one);
+
+		b2FloatW s1 = b2DivW(invMass1, safeSum);
+		b2FloatW s2 = b2DivW(invMass2, safeSum);
+		b2FloatW C = b2MulW(stiffness, b2SubW(b2LoadUW(lengths + i), L));
+
+		p1x = b2SubW(p1x, b2MulW(b2MulW(s1, C), dx));
+		p1y = b2SubW(p1y, b2MulW(b2MulW(s1, C), dy));
+		p2x = b2AddW(p2x, b2MulW(b2MulW(s2, C), dx));
+		p2y = b2AddW(p2y, b2MulW(b2MulW(s2, C), dy));
+
+		b2ScatterW(px, i1, p1x);
+		b2ScatterW(py, i1, p1y);
+		b2ScatterW(px, i2, p2x);
+		b2ScatterW(py, i2, p2y);
+	}
+}
+
+void b2RopeSystem::SolveStretch_XPBD(const b2RopeRecord& rope, float dt)
+{
+	b2Assert(dt > 0.0f);
+
+	float* px = m_vertices.GetFloats(e_vertexX) + rope.vertexStart;
+	float* py = m_vertices.GetFloats(e_vertexY) + rope.vertexStart;
+	const float* p0x = m_vertices.GetFloats(e_vertexX0) + rope.vertexStart;
+	const float* p0y = m_vertices.GetFloats(e_vertexY0) + rope.vertexStart;
+
+	const int32* indices1 = m_stretches.GetInts(e_stretchIndex1);
+	const int32* indices2 = m_stretches.GetInts(e_stretchIndex2);
+	const float* invMasses1 = m_stretches.GetFloats(e_stretchInvMass1);
+	const float* invMasses2 = m_stretches.GetFloats(e_stretchInvMass2);
+	const float* lengths = m_stretches.GetFloats(e_stretchLength);
+	const float* springs = m_stretches.GetFloats(e_stretchSpring);
+	const float* dampers = m_stretches.GetFloats(e_stretchDamper);
+	float* lambdas = m_stretches.GetFloats(e_stretchLambda);
+
+	const b2FloatW zero = b2SplatW(0.0f);
+	const b2FloatW one = b2SplatW(1.0f);
+	const b2FloatW epsilon = b2SplatW(b2_epsilon);
+	const b2FloatW h = b2SplatW(dt);
+	const b2FloatW h2 = b2SplatW(dt * dt);
+
+	for (int32 i = rope.stretchStarts[0]; i < rope.stretchStarts[b2_stretchColorCount]; i += b2_simdWidth)
+	{
+		const int32* i1 = indices1 + i;
+		const int32* i2 = indices2 + i;
+
+		b2FloatW p1x = b2GatherW(px, i1), p1y = b2GatherW(py, i1);
+		b2FloatW p2x = b2GatherW(px, i2), p2y = b2GatherW(py, i2);
+
+		b2FloatW dp1x = b2SubW(p1x, b2GatherW(p0x, i1));
+		b2FloatW dp1y = b2SubW(p1y, b2GatherW(p0y, i1));
+		b2FloatW dp2x = b2SubW(p2x, b2GatherW(p0x, i2));
+		b2FloatW dp2y = b2SubW(p2y, b2GatherW(p0y, i2));
+
+		b2FloatW ux = b2SubW(p2x, p1x);
+		b2FloatW uy = b2SubW(p2y, p1y);
+		b2FloatW L = b2SqrtW(b2AddW(b2MulW(ux, ux), b2MulW(uy, uy)));
+		b2FloatW valid = b2GreaterW(L, epsilon);
+		b2FloatW invL = b2SelectW(valid, b2DivW(one, b2SelectW(valid, L, one)), one);
+		ux = b2MulW(ux, invL);
+		uy = b2MulW(uy, invL);
+		L = b2SelectW(valid, L, zero);
+
+		b2FloatW invMass1 = b2LoadUW(invMasses1 + i);
+		b2FloatW invMass2 = b2LoadUW(invMasses2 + i);
+		b2FloatW sum = b2AddW(invMass1, invMass2);
+		b2FloatW hasMass = b2GreaterW(sum, zero);
+
+		b2FloatW alpha = b2DivW(one, b2MulW(b2LoadUW(springs + i), h2));
+		b2FloatW beta = b2MulW(h2, b2LoadUW(dampers + i));
+		b2FloatW sigma = b2DivW(b2MulW(alpha, beta), h);
+		b2FloatW C = b2SubW(L, b2LoadUW(lengths + i));
+
+		// This is using the initial velocities
+		// J1 = -u, J2 = u
+		b2FloatW Cdot = b2SubW(b2AddW(b2MulW(ux, dp2x), b2MulW(uy, dp2y)), b2AddW(b2MulW(ux, dp1x), b2MulW(uy, dp1y)));
+
+		b2FloatW lambda = b2LoadUW(lambdas + i);
+		b2FloatW B = b2AddW(b2AddW(C, b2MulW(alpha, lambda)), b2MulW(sigma, Cdot));
+		b2FloatW sum2 = b2AddW(b2MulW(b2AddW(one, sigma), sum), alpha);
+
+		b2FloatW impulse = b2SelectW(hasMass, b2SubW(zero, b2DivW(B, sum2)), zero);
+
+		p1x = b2SubW(p1x, b2MulW(b2MulW(invMass1, impulse), ux));
+		p1y = b2SubW(p1y, b2MulW(b2MulW(invMass1, impulse), uy));
+		p2x = b2AddW(p2x, b2MulW(b2MulW(invMass2, impulse), ux));
+		p2y = b2AddW(p2y, b2MulW(b2MulW(invMass2, impulse), uy));
+
+		b2ScatterW(px, i1, p1x);
+		b2ScatterW(py, i1, p1y);
+		b2ScatterW(px, i2, p2x);
+		b2ScatterW(py, i2, p2y);
+		b2StoreUW(lambdas + i, b2AddW(lambda, impulse));
+	}
+}
+
+// Angle bending terms shared by the angle bending models.
+struct b2BendAngleW
+{
+	b2FloatW angle;
+	b2FloatW J1x, J1y, J2x, J2y, J3x, J3y;
+	b2FloatW sum;
+	b2FloatW valid;
+};
+
+static b2BendAngleW b2ComputeBendAngle(const b2RopeTuning& tuning, b2FloatW p1x, b2FloatW p1y,
+									   b2FloatW p2x, b2FloatW p2y, b2FloatW p3x, b2FloatW p3y,
+									   b2FloatW L1, b2FloatW L2, b2FloatW invMass1, b2FloatW invMass2,
+									   b2FloatW invMass3, b2FloatW invEffectiveMass)
+{
+	const b2FloatW zero = b2SplatW(0.0f);
+	const b2FloatW one = b2SplatW(1.0f);
+
+	b2FloatW d1x = b2SubW(p2x, p1x);
+	b2FloatW d1y = b2SubW(p2y, p1y);
+	b2FloatW d2x = b2SubW(p3x, p2x);
+	b2FloatW d2y = b2SubW(p3y, p2y);
+
+	b2FloatW L1sqr, L2sqr;
+	if (tuning.isometric)
+	{
+		L1sqr = b2MulW(L1, L1);
+		L2sqr = b2MulW(L2, L2);
+	}
+	else
+	{
+		L1sqr = b2AddW(b2MulW(d1x, d1x), b2MulW(d1y, d1y));
+		L2sqr = b2AddW(b2MulW(d2x, d2x), b2MulW(d2y, d2y));
+	}
+
+	b2BendAngleW r;
+	r.valid = b2GreaterW(b2MulW(L1sqr, L2sqr), zero);
+	L1sqr = b2SelectW(r.valid, L1sqr, one);
+	L2sqr = b2SelectW(r.valid, L2sqr, one);
+
+	b2FloatW a = b2SubW(b2MulW(d1x, d2y), b2MulW(d1y, d2x));
+	b2FloatW b = b2AddW(b2MulW(d1x, d2x), b2MulW(d1y, d2y));
+	r.angle = b2Atan2W(a, b);
+
+	// Jd1 = (-1 / L1sqr) * d1.Skew(), Jd2 = (1 / L2sqr) * d2.Skew()
+	b2FloatW s1 = b2DivW(one, L1sqr);
+	b2FloatW s2 = b2DivW(one, L2sqr);
+	b2FloatW Jd1x = b2MulW(s1, d1y);
+	b2FloatW Jd1y = b2SubW(zero, b2MulW(s1, d1x));
+	b2FloatW Jd2x = b2SubW(zero, b2MulW(s2, d2y));
+	b2FloatW Jd2y = b2MulW(s2, d2x);
+
+	r.J1x = b2SubW(zero, Jd1x);
+	r.J1y = b2SubW(zero, Jd1y);
+	r.J2x = b2SubW(Jd1x, Jd2x);
+	r.J2y = b2SubW(Jd1y, Jd2y);
+	r.J3x = Jd2x;
+	r.J3y = Jd2y;
+
+	if (tuning.fixedEffectiveMass)
+	{
+		r.sum = invEffectiveMass;
+	}
+	else
+	{
+		b2FloatW JJ1 = b2AddW(b2MulW(r.J1x, r.J1x), b2MulW(r.J1y, r.J1y));
+		b2FloatW JJ2 = b2AddW(b2MulW(r.J2x, r.J2x), b2MulW(r.J2y, r.J2y));
+		b2FloatW JJ3 = b2AddW(b2MulW(r.J3x, r.J3x), b2MulW(r.J3y, r.J3y));
+		r.sum = b2AddW(b2AddW(b2MulW(invMass1, JJ1), b2MulW(invMass2, JJ2)), b2MulW(invMass3, JJ3));
+	}
+
+	return r;
+}
+
+void b2RopeSystem::SolveBend_PBD_Angle(const b2RopeRecord& rope)
+{
+	float* px = m_vertices.GetFloats(e_vertexX) + rope.vertexStart;
+	float* py = m_vertices.GetFloats(e_vertexY) + rope.vertexStart;
+
+	const int32* indices1 = m_bends.GetInts(e_bendIndex1);
+	const int32* indices2 = m_bends.GetInts(e_bendIndex2);
+	const int32* indices3 = m_bends.GetInts(e_bendIndex3);
+	const float* invMasses1 = m_bends.GetFloats(e_bendInvMass1);
+	const float* invMasses2 = m_bends.GetFloats(e_bendInvMass2);
+	const float* invMasses3 = m_bends.GetFloats(e_bendInvMass3);
+	const float* invEffectiveMasses = m_bends.GetFloats(e_bendInvEffectiveMass);
+	const float* lengths1 = m_bends.GetFloats(e_bendLength1);
+	const float* lengths2 = m_bends.GetFloats(e_bendLength2);
+
+	const b2FloatW stiffness = b2SplatW(rope.tuning.bendStiffness);
+	const b2FloatW zero = b2SplatW(0.0f);
+	const b2FloatW one = b2SplatW(1.0f);
+
+	for (int32 i = rope.bendStarts[0]; i < rope.bendStarts[b2_bendColorCount]; i += b2_simdWidth)
+	{
+		const int32* i1 = indices1 + i;
+		const int32* i2 = indices2 + i;
+		const int32* i3 = indices3 + i;
+
+		b2FloatW p1x = b2GatherW(px, i1), p1y = b2GatherW(py, i1);
+		b2FloatW p2x = b2GatherW(px, i2), p2y = b2GatherW(py, i2);
+		b2FloatW p3x = b2GatherW(px, i3), p3y = b2GatherW(py, i3);
+
+		b2FloatW invMass1 = b2LoadUW(invMasses1 + i);
+		b2FloatW invMass2 = b2LoadUW(invMasses2 + i);
+		b2FloatW invMass3 = b2LoadUW(invMasses3 + i);
+		b2FloatW invEffectiveMass = b2LoadUW(invEffectiveMasses + i);
+
+		b2BendAngleW c = b2ComputeBendAngle(rope.tuning, p1x, p1y, p2x, p2y, p3x, p3y,
+											b2LoadUW(lengths1 + i), b2LoadUW(lengths2 + i),
+											invMass1, invMass2, invMass3, invEffectiveMass);
+
+		b2FloatW sum = b2SelectW(b2GreaterW(c.sum, zero), c.sum, invEffectiveMass);
+		b2FloatW valid = b2AndW(c.valid, b2GreaterW(sum, zero));
+		sum = b2SelectW(valid, sum, one);
+
+		b2FloatW impulse = b2SubW(zero, b2DivW(b2MulW(stiffness, c.angle), sum));
+		impulse = b2SelectW(valid, impulse, zero);
+
+		b2FloatW s1 = b2MulW(invMass1, impulse);
+		b2FloatW s2 = b2MulW(invMass2, impulse);
+		b2FloatW s3 = b2MulW(invMass3, impulse);
+
+		b2ScatterW(px, i1, b2AddW(p1x, b2MulW(s1, c.J1x)));
+		b2ScatterW(py, i1, b2AddW(p1y, b2MulW(s1, c.J1y)));
+		b2ScatterW(px, i2, b2AddW(p2x, b2MulW(s2, c.J2x)));
+		b2ScatterW(py, i2, b2AddW(p2y, b2MulW(s2, c.J2y)));
+		b2ScatterW(px, i3, b2AddW(p3x, b2MulW(s3, c.J3x)));
+		b2ScatterW(py, i3, b2AddW(p3y, b2MulW(s3, c.J3y)));
+	}
+}
+
+void b2RopeSystem::SolveBend_XPBD_Angle(const b2RopeRecord& rope, float dt)
+{
+	b2Assert(dt > 0.0f);
+
+	float* px = m_vertices.GetFloats(e_vertexX) + rope.vertexStart;
+	float* py = m_vertices.GetFloats(e_vertexY) + rope.vertexStart;
+	const float* p0x = m_vertices.GetFloats(e_vertexX0) + rope.vertexStart;
+	const float* p0y = m_vertices.GetFloats(e_vertexY0) + rope.vertexStart;
+
+	const int32* indices1 = m_bends.GetInts(e_bendIndex1);
+	const int32* indices2 = m_bends.GetInts(e_bendIndex2);
+	const int32* indices3 = m_bends.GetInts(e_bendIndex3);
+	const float* invMasses1 = m_bends.GetFloats(e_bendInvMass1);
+	const float* invMasses2 = m_bends.GetFloats(e_bendInvMass2);
+	const float* invMasses3 = m_bends.GetFloats(e_bendInvMass3);
+	const float* invEffectiveMasses = m_bends.GetFloats(e_bendInvEffectiveMass);
+	const float* lengths1 = m_bends.GetFloats(e_bendLength1);
+	const float* lengths2 = m_bends.GetFloats(e_bendLength2);
+	const float* springs = m_bends.GetFloats(e_bendSpring);
+	const float* dampers = m_bends.GetFloats(e_bendDamper);
+	float* lambdas = m_bends.GetFloats(e_bendLambda);
+
+	const b2FloatW zero = b2SplatW(0.0f);
+	const b2FloatW one = b2SplatW(1.0f);
+	const b2FloatW h = b2SplatW(dt);
+	const b2FloatW h2 = b2SplatW(dt * dt);
+
+	for (int32 i = rope.bendStarts[0]; i < rope.bendStarts[b2_bendColorCount]; i += b2_simdWidth)
+	{
+		const int32* i1 = indices1 + i;
+		const int32* i2 = indices2 + i;
+		const int32* i3 = indices3 + i;
+
+		b2FloatW p1x = b2GatherW(px, i1), p1y = b2GatherW(py, i1);
+		b2FloatW p2x = b2GatherW(px, i2), p2y = b2GatherW(py, i2);
+		b2FloatW p3x = b2GatherW(px, i3), p3y = b2GatherW(py, i3);
+
+		b2FloatW dp1x = b2SubW(p1x, b2GatherW(p0x, i1));
+		b2FloatW dp1y = b2SubW(p1y, b2GatherW(p0y, i1));
+		b2FloatW dp2x = b2SubW(p2x, b2GatherW(p0x, i2));
+		b2FloatW dp2y = b2SubW(p2y, b2GatherW(p0y, i2));
+		b2FloatW dp3x = b2SubW(p3x, b2GatherW(p0x, i3));
+		b2FloatW dp3y = b2SubW(p3y, b2GatherW(p0y, i3));
+
+		b2FloatW invMass1 = b2LoadUW(invMasses1 + i);
+		b2FloatW invMass2 = b2LoadUW(invMasses2 + i);
+		b2FloatW invMass3 = b2LoadUW(invMasses3 + i);
+
+		b2BendAngleW c = b2ComputeBendAngle(rope.tuning, p1x, p1y, p2x, p2y, p3x, p3y,
+											b2LoadUW(lengths1 + i), b2LoadUW(lengths2 + i),
+											invMass1, invMass2, invMass3, b2LoadUW(invEffectiveMasses + i));
+
+		b2FloatW valid = b2AndW(c.valid, b2GreaterW(c.sum, zero));
+		b2FloatW sum = b2SelectW(valid, c.sum, one);
+
+		b2FloatW alpha = b2DivW(one, b2MulW(b2LoadUW(springs + i), h2));
+		b2FloatW beta = b2MulW(h2, b2LoadUW(dampers + i));
+		b2FloatW sigma = b2DivW(b2MulW(alpha, beta), h);
+		b2FloatW C = c.angle;
+
+		// This is using the initial velocities
+		b2FloatW Cdot = b2AddW(b2MulW(c.J1x, dp1x), b2MulW(c.J1y, dp1y));
+		Cdot = b2AddW(Cdot, b2AddW(b2MulW(c.J2x, dp2x), b2MulW(c.J2y, dp2y)));
+		Cdot = b2AddW(Cdot, b2AddW(b2MulW(c.J3x, dp3x), b2MulW(c.J3y, dp3y)));
+
+		b2FloatW lambda = b2LoadUW(lambdas + i);
+		b2FloatW B = b2AddW(b2AddW(C, b2MulW(alpha, lambda)), b2MulW(sigma, Cdot));
+		b2FloatW sum2 = b2AddW(b2MulW(b2AddW(one, sigma), sum), alpha);
+
+		b2FloatW impulse = b2SelectW(valid, b2SubW(zero, b2DivW(B, sum2)), zero);
+
+		b2FloatW s1 = b2MulW(invMass1, impulse);
+		b2FloatW s2 = b2MulW(invMass2, impulse);
+		b2FloatW s3 = b2MulW(invMass3, impulse);
+
+		b2ScatterW(px, i1, b2AddW(p1x, b2MulW(s1, c.J1x)));
+		b2ScatterW(py, i1, b2AddW(p1y, b2MulW(s1, c.J1y)));
+		b2ScatterW(px, i2, b2AddW(p2x, b2MulW(s2, c.J2x)));
+		b2ScatterW(py, i2, b2AddW(p2y, b2MulW(s2, c.J2y)));
+		b2ScatterW(px, i3, b2AddW(p3x, b2MulW(s3, c.J3x)));
+		b2ScatterW(py, i3, b2AddW(p3y, b2MulW(s3, c.J3y)));
+		b2StoreUW(lambdas + i, b2AddW(lambda, impulse));
+	}
+}
+
+void b2RopeSystem::ApplyBendForces(const b2RopeRecord& rope, float dt)
+{
+	const float* px = m_vertices.GetFloats(e_vertexX) + rope.vertexStart;
+	const float* py = m_vertices.GetFloats(e_vertexY) + rope.vertexStart;
+	float* vx = m_vertices.GetFloats(e_vertexVX) + rope.vertexStart;
+	float* vy = m_vertices.GetFloats(e_vertexVY) + rope.vertexStart;
+
+	const int32* indices1 = m_bends.GetInts(e_bendIndex1);
+	const int32* indices2 = m_bends.GetInts(e_bendIndex2);
+	const int32* indices3 = m_bends.GetInts(e_bendIndex3);
+	const float* invMasses1 = m_bends.GetFloats(e_bendInvMass1);
+	const float* invMasses2 = m_bends.GetFloats(e_bendInvMass2);
+	const float* invMasses3 = m_bends.GetFloats(e_bendInvMass3);
+	const float* invEffectiveMasses = m_bends.GetFloats(e_bendInvEffectiveMass);
+	const float* lengths1 = m_bends.GetFloats(e_bendLength1);
+	const float* lengths2 = m_bends.GetFloats(e_bendLength2);
+
+	// omega = 2 * pi * hz
+	const float omega = 2.0f * b2_pi * rope.tuning.bendHertz;
+	const b2FloatW zero = b2SplatW(0.0f);
+	const b2FloatW one = b2SplatW(1.0f);
+	const b2FloatW h = b2SplatW(dt);
+	const b2FloatW springScale = b2SplatW(omega * omega);
+	const b2FloatW damperScale = b2SplatW(2.0f * rope.tuning.bendDamping * omega);
+
+	for (int32 i = rope.bendStarts[0]; i < rope.bendStarts[b2_bendColorCount]; i += b2_simdWidth)
+	{
+		const int32* i1 = indices1 + i;
+		const int32* i2 = indices2 + i;
+		const int32* i3 = indices3 + i;
+
+		b2FloatW invMass1 = b2LoadUW(invMasses1 + i);
+		b2FloatW invMass2 = b2LoadUW(invMasses2 + i);
+		b2FloatW invMass3 = b2LoadUW(invMasses3 + i);
+
+		b2BendAngleW c = b2ComputeBendAngle(rope.tuning, b2GatherW(px, i1), b2GatherW(py, i1),
+											b2GatherW(px, i2), b2GatherW(py, i2), b2GatherW(px, i3), b2GatherW(py, i3),
+											b2LoadUW(lengths1 + i), b2LoadUW(lengths2 + i),
+											invMass1, invMass2, invMass3, b2LoadUW(invEffectiveMasses + i));
+
+		b2FloatW valid = b2AndW(c.valid, b2GreaterW(c.sum, zero));
+		b2FloatW mass = b2DivW(one, b2SelectW(valid, c.sum, one));
+
+		b2FloatW spring = b2MulW(mass, springScale);
+		b2FloatW damper = b2MulW(mass, damperScale);
+
+		b2FloatW v1x = b2GatherW(vx, i1), v1y = b2GatherW(vy, i1);
+		b2FloatW v2x = b2GatherW(vx, i2), v2y = b2GatherW(vy, i2);
+		b2FloatW v3x = b2GatherW(vx, i3), v3y = b2GatherW(vy, i3);
+
+		b2FloatW C = c.angle;
+		b2FloatW Cdot = b2AddW(b2MulW(c.J1x, v1x), b2MulW(c.J1y, v1y));
+		Cdot = b2AddW(Cdot, b2AddW(b2MulW(c.J2x, v2x), b2MulW(c.J2y, v2y)));
+		Cdot = b2AddW(Cdot, b2AddW(b2MulW(c.J3x, v3x), b2MulW(c.J3y, v3y)));
+
+		b2FloatW impulse = b2SubW(zero, b2MulW(h, b2AddW(b2MulW(spring, C), b2MulW(damper, Cdot))));
+		impulse = b2SelectW(valid, impulse, zero);
+
+		b2FloatW s1 = b2MulW(invMass1, impulse);
+		b2FloatW s2 = b2MulW(invMass2, impulse);
+		b2FloatW s3 = b2MulW(invMass3, impulse);
+
+		b2ScatterW(vx, i1, b2AddW(v1x, b2MulW(s1, c.J1x)));
+		b2ScatterW(vy, i1, b2AddW(v1y, b2MulW(s1, c.J1y)));
+		b2ScatterW(vx, i2, b2AddW(v2x, b2MulW(s2, c.J2x)));
+		b2ScatterW(vy, i2, b2AddW(v2y, b2MulW(s2, c.J2y)));
+		b2ScatterW(vx, i3, b2AddW(v3x, b2MulW(s3, c.J3x)));
+		b2ScatterW(vy, i3, b2AddW(v3y, b2MulW(s3, c.J3y)));
+	}
+}
+
+void b2RopeSystem::SolveBend_PBD_Distance(const b2RopeRecord& rope)
+{
+	float* px = m_vertices.GetFloats(e_vertexX) + rope.vertexStart;
+	float* py = m_vertices.GetFloats(e_vertexY) + rope.vertexStart;
+
+	const int32* indices1 = m_bends.GetInts(e_bendIndex1);
+	const int32* indices3 = m_bends.GetInts(e_bendIndex3);
+	const float* invMasses1 = m_bends.GetFloats(e_bendInvMass1);
+	const float* invMasses3 = m_bends.GetFloats(e_bendInvMass3);
+	const float* lengths1 = m_bends.GetFloats(e_bendLength1);
+	const float* lengths2 = m_bends.GetFloats(e_bendLength2);
+
+	const b2FloatW stiffness = b2SplatW(rope.tuning.bendStiffness);
+	const b2FloatW zero = b2SplatW(0.0f);
+	const b2FloatW one = b2SplatW(1.0f);
+	const b2FloatW epsilon = b2SplatW(b2_epsilon);
+
+	for (int32 i = rope.bendStarts[0]; i < rope.bendStarts[b2_bendColorCount]; i += b2_simdWidth)
+	{
+		const int32* i1 = indices1 + i;
+		const int32* i2 = indices3 + i;
+
+		b2FloatW p1x = b2GatherW(px, i1), p1y = b2GatherW(py, i1);
+		b2FloatW p2x = b2GatherW(px, i2), p2y = b2GatherW(py, i2);
+
+		b2FloatW dx = b2SubW(p2x, p1x);
+		b2FloatW dy = b2SubW(p2y, p1y);
+		b2FloatW L = b2SqrtW(b2AddW(b2MulW(dx, dx), b2MulW(dy, dy)));
+		b2FloatW valid = b2GreaterW(L, epsilon);
+		b2FloatW invL = b2SelectW(valid, b2DivW(one, b2SelectW(valid, L, one)), one);
+		dx = b2MulW(dx, invL);
+		dy = b2MulW(dy, invL);
+		L = b2SelectW(valid, L, zero);
+
+		b2FloatW invMass1 = b2LoadUW(invMasses1 + i);
+		b2FloatW invMass2 = b2LoadUW(invMasses3 + i);
+		b2FloatW sum = b2AddW(invMass1, invMass2);
+		b2FloatW safeSum = b2SelectW(b2GreaterW(sum, zero), sum, one);
+
+		b2FloatW s1 = b2DivW(invMass1, safeSum);
+		b2FloatW s2 = b2DivW(invMass2, safeSum);
+		b2FloatW restLength = b2AddW(b2LoadUW(lengths1 + i), b2LoadUW(lengths2 + i));
+		b2FloatW C = b2MulW(stiffness, b2SubW(restLength, L));
+
+		b2ScatterW(px, i1, b2SubW(p1x, b2MulW(b2MulW(s1, C), dx)));
+		b2ScatterW(py, i1, b2SubW(p1y, b2MulW(b2MulW(s1, C), dy)));
+		b2ScatterW(px, i2, b2AddW(p2x, b2MulW(b2MulW(s2, C), dx)));
+		b2ScatterW(py, i2, b2AddW(p2y, b2MulW(b2MulW(s2, C), dy)));
+	}
+}
+
+// Constraint based implementation of:
+// P. Volino: Simple Linear Bending Stiffness in Particle Systems
+void b2RopeSystem::SolveBend_PBD_Height(const b2RopeRecord& rope)
+{
+	float* px = m_vertices.GetFloats(e_vertexX) + rope.vertexStart;
+	float* py = m_vertices.GetFloats(e_vertexY) + rope.vertexStart;
+
+	const int32* indices1 = m_bends.GetInts(e_bendIndex1);
+	const int32* indices2 = m_bends.GetInts(e_bendIndex2);
+	const int32* indices3 = m_bends.GetInts(e_bendIndex3);
+	const float* invMasses1 = m_bends.GetFloats(e_bendInvMass1);
+	const float* invMasses2 = m_bends.GetFloats(e_bendInvMass2);
+	const float* invMasses3 = m_bends.GetFloats(e_bendInvMass3);
+	const float* alphas1 = m_bends.GetFloats(e_bendAlpha1);
+	const float* alphas2 = m_bends.GetFloats(e_bendAlpha2);
+
+	const b2FloatW stiffness = b2SplatW(rope.tuning.bendStiffness);
+	const b2FloatW zero = b2SplatW(0.0f);
+	const b2FloatW one = b2SplatW(1.0f);
+
+	for (int32 i = rope.bendStarts[0]; i < rope.bendStarts[b2_bendColorCount]; i += b2_simdWidth)
+	{
+		const int32* i1 = indices1 + i;
+		const int32* i2 = indices2 + i;
+		const int32* i3 = indices3 + i;
+
+		b2FloatW p1x = b2GatherW(px, i1), p1y = b2GatherW(py, i1);
+		b2FloatW p2x = b2GatherW(px, i2), p2y = b2GatherW(py, i2);
+		b2FloatW p3x = b2GatherW(px, i3), p3y = b2GatherW(py, i3);
+
+		b2FloatW alpha1 = b2LoadUW(alphas1 + i);
+		b2FloatW alpha2 = b2LoadUW(alphas2 + i);
+
+		// Barycentric coordinates are held constant
+		b2FloatW dx = b2SubW(b2AddW(b2MulW(alpha1, p1x), b2MulW(alpha2, p3x)), p2x);
+		b2FloatW dy = b2SubW(b2AddW(b2MulW(alpha1, p1y), b2MulW(alpha2, p3y)), p2y);
+		b2FloatW dLen = b2SqrtW(b2AddW(b2MulW(dx, dx), b2MulW(dy, dy)));
+
+		b2FloatW invMass1 = b2LoadUW(invMasses1 + i);
+		b2FloatW invMass2 = b2LoadUW(invMasses2 + i);
+		b2FloatW invMass3 = b2LoadUW(invMasses3 + i);
+
+		b2FloatW sum = b2AddW(b2AddW(b2MulW(b2MulW(invMass1, alpha1), alpha1), invMass2), b2MulW(b2MulW(invMass3, alpha2), alpha2));
+		b2FloatW valid = b2AndW(b2GreaterW(dLen, zero), b2GreaterW(sum, zero));
+
+		b2FloatW invLen = b2DivW(one, b2SelectW(valid, dLen, one));
+		b2FloatW dHatx = b2MulW(invLen, dx);
+		b2FloatW dHaty = b2MulW(invLen, dy);
+
+		// J1 = alpha1 * dHat, J2 = -dHat, J3 = alpha2 * dHat
+		b2FloatW mass = b2DivW(one, b2SelectW(valid, sum, one));
+		b2FloatW impulse = b2SubW(zero, b2MulW(b2MulW(stiffness, mass), dLen));
+		impulse = b2SelectW(valid, impulse, zero);
+
+		b2FloatW s1 = b2MulW(b2MulW(invMass1, impulse), alpha1);
+		b2FloatW s2 = b2MulW(invMass2, impulse);
+		b2FloatW s3 = b2MulW(b2MulW(invMass3, impulse), alpha2);
+
+		b2ScatterW(px, i1, b2AddW(p1x, b2MulW(s1, dHatx)));
+		b2ScatterW(py, i1, b2AddW(p1y, b2MulW(s1, dHaty)));
+		b2ScatterW(px, i2, b2SubW(p2x, b2MulW(s2, dHatx)));
+		b2ScatterW(py, i2, b2SubW(p2y, b2MulW(s2, dHaty)));
+		b2ScatterW(px, i3, b2AddW(p3x, b2MulW(s3, dHatx)));
+		b2ScatterW(py, i3, b2AddW(p3y, b2MulW(s3, dHaty)));
+	}
+}
+
+// M. Kelager: A Triangle Bending Constraint Model for PBD
+void b2RopeSystem::SolveBend_PBD_Triangle(const b2RopeRecord& rope)
+{
+	float* px = m_vertices.GetFloats(e_vertexX) + rope.vertexStart;
+	float* py = m_vertices.GetFloats(e_vertexY) + rope.vertexStart;
+
+	const int32* indices1 = m_bends.GetInts(e_bendIndex1);
+	const int32* indices2 = m_bends.GetInts(e_bendIndex2);
+	const int32* indices3 = m_bends.GetInts(e_bendIndex3);
+	const float* invMasses1 = m_bends.GetFloats(e_bendInvMass1);
+	const float* invMasses2 = m_bends.GetFloats(e_bendInvMass2);
+	const float* invMasses3 = m_bends.GetFloats(e_bendInvMass3);
+
+	const b2FloatW stiffness = b2SplatW(rope.tuning.bendStiffness);
+	const b2FloatW zero = b2SplatW(0.0f);
+	const b2FloatW one = b2SplatW(1.0f);
+	const b2FloatW two = b2SplatW(2.0f);
+	const b2FloatW third = b2SplatW(1.0f / 3.0f);
+
+	for (int32 i = rope.bendStarts[0]; i < rope.bendStarts[b2_bendColorCount]; i += b2_simdWidth)
+	{
+		const int32* i1 = indices1 + i;
+		const int32* i2 = indices2 + i;
+		const int32* i3 = indices3 + i;
+
+		b2FloatW b0x = b2GatherW(px, i1), b0y = b2GatherW(py, i1);
+		b2FloatW vx = b2GatherW(px, i2), vy = b2GatherW(py, i2);
+		b2FloatW b1x = b2GatherW(px, i3), b1y = b2GatherW(py, i3);
+
+		b2FloatW wb0 = b2LoadUW(invMasses1 + i);
+		b2FloatW wv = b2LoadUW(invMasses2 + i);
+		b2FloatW wb1 = b2LoadUW(invMasses3 + i);
+
+		b2FloatW W = b2AddW(b2AddW(wb0, wb1), b2MulW(two, wv));
+		b2FloatW valid = b2GreaterW(W, zero);
+		b2FloatW invW = b2SelectW(valid, b2DivW(stiffness, b2SelectW(valid, W, one)), zero);
+
+		b2FloatW dx = b2SubW(vx, b2MulW(third, b2AddW(b2AddW(b0x, vx), b1x)));
+		b2FloatW dy = b2SubW(vy, b2MulW(third, b2AddW(b2AddW(b0y, vy), b1y)));
+
+		b2FloatW s0 = b2MulW(b2MulW(two, wb0), invW);
+		b2FloatW sv = b2MulW(b2MulW(b2SplatW(-4.0f), wv), invW);
+		b2FloatW s1 = b2MulW(b2MulW(two, wb1), invW);
+
+		b2ScatterW(px, i1, b2AddW(b0x, b2MulW(s0, dx)));
+		b2ScatterW(py, i1, b2AddW(b0y, b2MulW(s0, dy)));
+		b2ScatterW(px, i2, b2AddW(vx, b2MulW(sv, dx)));
+		b2ScatterW(py, i2, b2AddW(vy, b2MulW(sv, dy)));
+		b2ScatterW(px, i3, b2AddW(b1x, b2MulW(s1, dx)));
+		b2ScatterW(py, i3, b2AddW(b1y, b2MulW(s1, dy)));
+	}
+}
+
+void b2RopeSystem::PrepareAttachments(b2RopeRecord* rope, float dt)
+{
+	float* vx = m_vertices.GetFloats(e_vertexVX) + rope->vertexStart;
+	float* vy = m_vertices.GetFloats(e_vertexVY) + rope->vertexStart;
+	const float* p0x = m_vertices.GetFloats(e_vertexX0) + rope->vertexStart;
+	const float* p0y = m_vertices.GetFloats(e_vertexY0) + rope->vertexStart;
+	const float* invMasses = m_vertices.GetFloats(e_vertexInvMass) + rope->vertexStart;
+
+	const float inv_dt = 1.0f / dt;
+
+	for (int32 i = 0; i < rope->attachmentCount; ++i)
+	{
+		b2RopeAttachment* attachment = rope->attachments + i;
+		b2Body* body = attachment->body;
+
+		attachment->center = body->m_sweep.c;
+		attachment->rA = b2Mul(body->m_xf.q, attachment->localAnchor - body->m_sweep.localCenter);
+		attachment->deltaPosition.SetZero();
+		attachment->deltaAngle = 0.0f;
+		attachment->invMass = body->m_invMass;
+		attachment->invI = body->m_invI;
+		attachment->impulse.SetZero();
+
+		int32 index = attachment->vertexIndex;
+		if (invMasses[index] == 0.0f)
+		{
+			// A vertex without mass follows the body like a pinned vertex follows the rope.
+			b2Vec2 anchor = attachment->center + attachment->rA;
+			vx[index] = inv_dt * (anchor.x - p0x[index]);
+			vy[index] = inv_dt * (anchor.y - p0y[index]);
+		}
+	}
+}
+
+void b2RopeSystem::SolveAttachments(b2RopeRecord* rope)
+{
+	float* px = m_vertices.GetFloats(e_vertexX) + rope->vertexStart;
+	float* py = m_vertices.GetFloats(e_vertexY) + rope->vertexStart;
+	const float* invMasses = m_vertices.GetFloats(e_vertexInvMass) + rope->vertexStart;
+
+	for (int32 i = 0; i < rope->attachmentCount; ++i)
+	{
+		b2RopeAttachment* attachment = rope->attachments + i;
+		int32 index = attachment->vertexIndex;
+		float invMass = invMasses[index];
+		if (invMass == 0.0f)
+		{
+			continue;
+		}
+
+		b2Vec2 r = b2Mul(b2Rot(attachment->deltaAngle), attachment->rA);
+		b2Vec2 anchor = attachment->center + attachment->deltaPosition + r;
+
+		b2Vec2 p(px[index], py[index]);
+		b2Vec2 d = p - anchor;
+		float length = d.Normalize();
+		if (length < b2_epsilon)
+		{
+			continue;
+		}
+
+		float rn = b2Cross(r, d);
+		float sum = invMass + attachment->invMass + attachment->invI * rn * rn;
+		float impulse = -length / sum;
+
+		p += (invMass * impulse) * d;
+		px[index] = p.x;
+		py[index] = p.y;
+
+		// The body moves toward the vertex.
+		b2Vec2 P = -impulse * d;
+		attachment->deltaPosition += attachment->invMass * P;
+		attachment->deltaAngle += attachment->invI * b2Cross(r, P);
+		attachment->impulse += P;
+	}
+}
+
+static bool b2ShouldCollide(const b2Filter& filterA, const b2Filter& filterB)
+{
+	if (filterA.groupIndex == filterB.groupIndex && filterA.groupIndex != 0)
+	{
+		return filterA.groupIndex > 0;
+	}
+
+	return (filterA.maskBits & filterB.categoryBits) != 0 && (filterA.categoryBits & filterB.maskBits) != 0;
+}
+
+struct b2RopeQueryCallback
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		proxyIds.Push(proxyId);
+		return true;
+	}
+
+	b2GrowableStack<int32, 256> proxyIds;
+};
+
+// Find the fixtures near each vertex with one broad-phase query per rope. Each contact
+// is a plane through the closest point on the fixture, found from the vertex position
+// at the start of the step so fast vertices don't end up on the far side of thin shapes.
+void b2RopeSystem::FindContacts(b2RopeRecord* rope, float dt)
+{
+	int32 count = rope->vertexCount;
+	const float* px = m_vertices.GetFloats(e_vertexX) + rope->vertexStart;
+	const float* py = m_vertices.GetFloats(e_vertexY) + rope->vertexStart;
+	const float* p0x = m_vertices.GetFloats(e_vertexX0) + rope->vertexStart;
+	const float* p0y = m_vertices.GetFloats(e_vertexY0) + rope->vertexStart;
+
+	const float margin = rope->radius + b2_linearSlop;
+
+	b2AABB aabb;
+	aabb.lowerBound.Set(b2Min(px[0], p0x[0]), b2Min(py[0], p0y[0]));
+	aabb.upperBound.Set(b2Max(px[0], p0x[0]), b2Max(py[0], p0y[0]));
+	for (int32 i = 1; i < count; ++i)
+	{
+		aabb.lowerBound = b2Min(aabb.lowerBound, b2Vec2(b2Min(px[i], p0x[i]), b2Min(py[i], p0y[i])));
+		aabb.upperBound = b2Max(aabb.upperBound, b2Vec2(b2Max(px[i], p0x[i]), b2Max(py[i], p0y[i])));
+	}
+	aabb.lowerBound -= b2Vec2(margin, margin);
+	aabb.upperBound += b2Vec2(margin, margin);
+
+	const b2BroadPhase* broadPhase = &m_world->GetContactManager().m_broadPhase;
+
+	b2RopeQueryCallback callback;
+	broadPhase->Query(&callback, aabb);
+
+	while (callback.proxyIds.GetCount() > 0)
+	{
+		int32 proxyId = callback.proxyIds.Pop();
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		b2Fixture* fixture = proxy->fixture;
+		b2Body* body = fixture->GetBody();
+
+		if (fixture->IsSensor() || b2ShouldCollide(rope->filter, fixture->GetFilterData()) == false)
+		{
+			continue;
+		}
+
+		bool attached = false;
+		for (int32 i = 0; i < rope->attachmentCount; ++i)
+		{
+			attached = attached || rope->attachments[i].body == body;
+		}
+
+		if (attached)
+		{
+			continue;
+		}
+
+		const b2Shape* shape = fixture->GetShape();
+		if (shape->GetType() == b2Shape::e_compound)
+		{
+			// Each polygon near the rope acts as a separate convex shape.
+			const b2CompoundShape* compound = (const b2CompoundShape*)shape;
+			const b2Transform& xf = body->GetTransform();
+
+			b2Vec2 corners[4] =
+			{
+				aabb.lowerBound, b2Vec2(aabb.upperBound.x, aabb.lowerBound.y),
+				aabb.upperBound, b2Vec2(aabb.lowerBound.x, aabb.upperBound.y)
+			};
+
+			b2AABB localAABB;
+			localAABB.lowerBound = b2MulT(xf, corners[0]);
+			localAABB.upperBound = localAABB.lowerBound;
+			for (int32 i = 1; i < 4; ++i)
+			{
+				b2Vec2 v = b2MulT(xf, corners[i]);
+				localAABB.lowerBound = b2Min(localAABB.lowerBound, v);
+				localAABB.upperBound = b2Max(localAABB.upperBound, v);
+			}
+
+			b2RopeQueryCallback polygonCallback;
+			compound->Query(&polygonCallback, localAABB);
+
+			while (polygonCallback.proxyIds.GetCount() > 0)
+			{
+				const b2PolygonShape* polygon = compound->GetPolygon(polygonCallback.proxyIds.Pop());
+				b2AABB polygonAABB;
+				polygon->ComputeAABB(&polygonAABB, xf, 0);
+				AddContacts(rope, fixture, polygon, 0, polygonAABB, dt);
+			}
+		}
+		else
+		{
+			AddContacts(rope, fixture, shape, proxy->childIndex, proxy->aabb, dt);
+		}
+	}
+}
+
+// Add the contacts of the rope vertices with a convex shape child of a fixture.
+void b2RopeSystem::AddContacts(b2RopeRecord* rope, b2Fixture* fixture, const b2Shape* shape, int32 childIndex,
+								const b2AABB& shapeAABB, float dt)
+{
+	int32 count = rope->vertexCount;
+	const float* px = m_vertices.GetFloats(e_vertexX) + rope->vertexStart;
+	const float* py = m_vertices.GetFloats(e_vertexY) + rope->vertexStart;
+	const float* p0x = m_vertices.GetFloats(e_vertexX0) + rope->vertexStart;
+	const float* p0y = m_vertices.GetFloats(e_vertexY0) + rope->vertexStart;
+
+	const float margin = rope->radius + b2_linearSlop;
+	b2Body* body = fixture->GetBody();
+
+	b2DistanceInput input;
+	input.proxyA.Set(shape, childIndex);
+	input.transformA = body->GetTransform();
+	input.transformB.SetIdentity();
+	input.useRadii = false;
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Vec2 p(px[i], py[i]);
+		b2Vec2 p0(p0x[i], p0y[i]);
+
+		b2AABB box;
+		box.lowerBound = b2Min(p, p0) - b2Vec2(margin, margin);
+		box.upperBound = b2Max(p, p0) + b2Vec2(margin, margin);
+		if (b2TestOverlap(box, shapeAABB) == false)
+		{
+			continue;
+		}
+
+		b2SimplexCache cache;
+		cache.count = 0;
+		b2DistanceOutput output;
+		input.proxyB.Set(&p0, 1, 0.0f);
+		b2Distance(&output, &cache, &input);
+
+		if (output.distance < b2_epsilon)
+		{
+			// The vertex started inside the shape core, so use the new position.
+			cache.count = 0;
+			input.proxyB.Set(&p, 1, 0.0f);
+			b2Distance(&output, &cache, &input);
+
+			if (output.distance < b2_epsilon)
+			{
+				continue;
+			}
+		}
+
+		b2Vec2 normal = output.pointB - output.pointA;
+		normal.Normalize();
+		b2Vec2 point = output.pointA + shape->m_radius * normal;
+
+		// Keep contacts the vertex may reach during the step.
+		if (b2Dot(p - point, normal) > margin)
+		{
+			continue;
+		}
+
+		b2GrowArray(&rope->contacts, &rope->contactCapacity, rope->contactCount);
+		b2RopeContact* contact = rope->contacts + rope->contactCount;
+		++rope->contactCount;
+
+		b2Vec2 tangent = b2Cross(normal, 1.0f);
+		b2Vec2 rA = point - body->m_sweep.c;
+		b2Vec2 surfaceVelocity = body->m_linearVelocity + b2Cross(body->m_angularVelocity, rA);
+
+		contact->body = body;
+		contact->point = point;
+		contact->normal = normal;
+		contact->rA = rA;
+		contact->friction = fixture->GetFriction();
+		contact->tangentMotion = dt * b2Dot(surfaceVelocity, tangent);
+		contact->invMass = body->m_invMass;
+		contact->invI = body->m_invI;
+		contact->vertexIndex = i;
+		contact->separation = 0.0f;
+		contact->normalImpulse = 0.0f;
+		contact->tangentImpulse = 0.0f;
+	}
+}
+
+void b2RopeSystem::SolveContacts(b2RopeRecord* rope)
+{
+	float* px = m_vertices.GetFloats(e_vertexX) + rope->vertexStart;
+	float* py = m_vertices.GetFloats(e_vertexY) + rope->vertexStart;
+	const float* p0x = m_vertices.GetFloats(e_vertexX0) + rope->vertexStart;
+	const float* p0y = m_vertices.GetFloats(e_vertexY0) + rope->vertexStart;
+	const float* invMasses = m_vertices.GetFloats(e_vertexInvMass) + rope->vertexStart;
+
+	for (int32 i = 0; i < rope->contactCount; ++i)
+	{
+		b2RopeContact* contact = rope->contacts + i;
+		int32 index = contact->vertexIndex;
+		float invMass = invMasses[index];
+		if (invMass == 0.0f)
+		{
+			continue;
+		}
+
+		b2Vec2 p(px[index], py[index]);
+		b2Vec2 normal = contact->normal;
+
+		// Non-penetration
+		float C = b2Dot(p - contact->point, normal) + contact->separation - rope->radius;
+		if (C < 0.0f)
+		{
+			float rn = b2Cross(contact->rA, normal);
+			float bodyInvMass = contact->invMass + contact->invI * rn * rn;
+			float impulse = -C / (invMass + bodyInvMass);
+
+			p += (invMass * impulse) * normal;
+			contact->separation += bodyInvMass * impulse;
+			contact->normalImpulse += impulse;
+		}
+
+		// Friction removes the sliding along the surface during the step.
+		if (contact->normalImpulse > 0.0f)
+		{
+			b2Vec2 tangent = b2Cross(normal, 1.0f);
+			b2Vec2 p0(p0x[index], p0y[index]);
+			float slide = b2Dot(p - p0, tangent) - contact->tangentMotion;
+
+			float rt = b2Cross(contact->rA, tangent);
+			float impulse = -slide / (invMass + contact->invMass + contact->invI * rt * rt);
+
+			float maxFriction = contact->friction * contact->normalImpulse;
+			float newImpulse = b2Clamp(contact->tangentImpulse + impulse, -maxFriction, maxFriction);
+			impulse = newImpulse - contact->tangentImpulse;
+			contact->tangentImpulse = newImpulse;
+
+			p += (invMass * impulse) * tangent;
+		}
+
+		px[index] = p.x;
+		py[index] = p.y;
+	}
+}
+
+static void b2ApplyRopeImpulse(b2Body* body, float invMass, const b2Vec2& impulse, const b2Vec2& point)
+{
+	// Wake the body only when the impulse would keep it awake anyway.
+	bool wake = invMass * impulse.Length() > b2_linearSleepTolerance;
+	body->ApplyLinearImpulse(impulse, point, wake);
+}
+
+void b2RopeSystem::ApplyImpulses(float dt)
+{
+	const float inv_dt = 1.0f / dt;
+
+	for (int32 i = 0; i < m_ropeCount; ++i)
+	{
+		const b2RopeRecord& rope = m_ropes[i];
+
+		for (int32 j = 0; j < rope.attachmentCount; ++j)
+		{
+			const b2RopeAttachment& attachment = rope.attachments[j];
+			if (attachment.invMass == 0.0f || attachment.impulse.LengthSquared() == 0.0f)
+			{
+				continue;
+			}
+
+			b2ApplyRopeImpulse(attachment.body, attachment.invMass, inv_dt * attachment.impulse, attachment.center + attachment.rA);
+		}
+
+		for (int32 j = 0; j < rope.contactCount; ++j)
+		{
+			const b2RopeContact& contact = rope.contacts[j];
+			if (contact.invMass == 0.0f || (contact.normalImpulse == 0.0f && contact.tangentImpulse == 0.0f))
+			{
+				continue;
+			}
+
+			b2Vec2 tangent = b2Cross(contact.normal, 1.0f);
+			b2Vec2 P = contact.normalImpulse * contact.normal + contact.tangentImpulse * tangent;
+			b2ApplyRopeImpulse(contact.body, contact.invMass, -inv_dt * P, contact.point);
+		}
+	}
+}
+
+void b2RopeSystem::Draw(b2Draw* draw) const
+{
+	b2Color c(0.4f, 0.5f, 0.7f);
+	b2Color pg(0.1f, 0.8f, 0.1f);
+	b2Color pd(0.7f, 0.2f, 0.4f);
+
+	const float* px = m_vertices.GetFloats(e_vertexX);
+	const float* py = m_vertices.GetFloats(e_vertexY);
+	const float* invMasses = m_vertices.GetFloats(e_vertexInvMass);
+
+	for (int32 r = 0; r < m_ropeCount; ++r)
+	{
+		const b2RopeRecord& rope = m_ropes[r];
+		int32 start = rope.vertexStart;
+		int32 end = start + rope.vertexCount;
+		for (int32 i = start; i < end; ++i)
+		{
+			b2Vec2 p(px[i], py[i]);
+			if (i + 1 < end)
+			{
+				draw->DrawSegment(p, b2Vec2(px[i + 1], py[i + 1]), c);
+			}
+
+			const b2Color& pc = invMasses[i] > 0.0f ? pd : pg;
+			draw->DrawPoint(p, 5.0f, pc);
+		}
+	}
+}
@@ -368,6 +368,7 @@ static void UpdateUI()
 			{
 				ImGui::SliderInt("Vel Iters", &s_settings.m_velocityIterations, 0, 50);
 				ImGui::SliderInt("Pos Iters", &s_settings.m_positionIterations, 0, 50);
+				ImGui::SliderInt("Sub-Steps", &s_settings.m_subStepCount, 1, 16);
 				ImGui::SliderFloat("Hertz", &s_settings.m_hertz, 5.0f, 120.0f, "%.0f hz");
 				
 				ImGui::Separator();
@@ -376,6 +377,8 @@ static void UpdateUI()
 				ImGui::Checkbox("Warm Starting", &s_settings.m_enableWarmStarting);
 				ImGui::Checkbox("Time of Impact", &s_settings.m_enableContinuous);
 				ImGui::Checkbox("Sub-Stepping", &s_settings.m_enableSubStepping);
+				ImGui::Checkbox("Soft Step", &s_settings.m_enableSoftStep);
+				ImGui::Checkbox("Wide Joints", &s_settings.m_enableWideJoints);
 
 				ImGui::Separator();
 
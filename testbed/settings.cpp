@@ -63,6 +63,7 @@ void Settings::Save()
 	fprintf(file, "  \"hertz\": %.9g,\n", m_hertz);
 	fprintf(file, "  \"velocityIterations\": %d,\n", m_velocityIterations);
 	fprintf(file, "  \"positionIterations\": %d,\n", m_positionIterations);
+	fprintf(file, "  \"subStepCount\": %d,\n", m_subStepCount);
 	fprintf(file, "  \"drawShapes\": %s,\n", m_drawShapes ? "true" : "false");
 	fprintf(file, "  \"drawJoints\": %s,\n", m_drawJoints ? "true" : "false");
 	fprintf(file, "  \"drawAABBs\": %s,\n", m_drawAABBs ? "true" : "false");
@@ -76,6 +77,8 @@ void Settings::Save()
 	fprintf(file, "  \"enableWarmStarting\": %s,\n", m_enableWarmStarting ? "true" : "false");
 	fprintf(file, "  \"enableContinuous\": %s,\n", m_enableContinuous ? "true" : "false");
 	fprintf(file, "  \"enableSubStepping\": %s,\n", m_enableSubStepping ? "true" : "false");
+	fprintf(file, "  \"enableSoftStep\": %s,\n", m_enableSoftStep ? "true" : "false");
+	fprintf(file, "  \"enableWideJoints\": %s,\n", m_enableWideJoints ? "true" : "false");
 	fprintf(file, "  \"enableSleep\": %s\n", m_enableSleep ? "true" : "false");
 	fprintf(file, "}\n");
 	fclose(file);
@@ -158,6 +161,41 @@ void Settings::Load()
 			continue;
 		}
 
+		if (strncmp(fieldName.data(), "subStepCount", fieldName.length()) == 0)
+		{
+			if (fieldValue.get_type() == sajson::TYPE_INTEGER)
+			{
+				m_subStepCount = fieldValue.get_integer_value();
+			}
+			continue;
+		}
+
+		if (strncmp(fieldName.data(), "enableSoftStep", fieldName.length()) == 0)
+		{
+			if (fieldValue.get_type() == sajson::TYPE_FALSE)
+			{
+				m_enableSoftStep = false;
+			}
+			else if (fieldValue.get_type() == sajson::TYPE_TRUE)
+			{
+				m_enableSoftStep = true;
+			}
+			continue;
+		}
+
+		if (strncmp(fieldName.data(), "enableWideJoints", fieldName.length()) == 0)
+		{
+			if (fieldValue.get_type() == sajson::TYPE_FALSE)
+			{
+				m_enableWideJoints = false;
+			}
+			else if (fieldValue.get_type() == sajson::TYPE_TRUE)
+			{
+				m_enableWideJoints = true;
+			}
+			continue;
+		}
+
 		if (strncmp(fieldName.data(), "drawShapes", fieldName.length()) == 0)
 		{
 			if (fieldValue.get_type() == sajson::TYPE_FALSE)
@@ -37,6 +37,7 @@ struct Settings
 		m_hertz = 60.0f;
 		m_velocityIterations = 8;
 		m_positionIterations = 3;
+		m_subStepCount = 4;
 		m_drawShapes = true;
 		m_drawJoints = true;
 		m_drawAABBs = false;
@@ -50,6 +51,8 @@ struct Settings
 		m_enableWarmStarting = true;
 		m_enableContinuous = true;
 		m_enableSubStepping = false;
+		m_enableSoftStep = false;
+		m_enableWideJoints = false;
 		m_enableSleep = true;
 		m_pause = false;
 		m_singleStep = false;
@@ -64,6 +67,7 @@ struct Settings
 	float m_hertz;
 	int m_velocityIterations;
 	int m_positionIterations;
+	int m_subStepCount;
 	bool m_drawShapes;
 	bool m_drawJoints;
 	bool m_drawAABBs;
@@ -77,6 +81,8 @@ struct Settings
 	bool m_enableWarmStarting;
 	bool m_enableContinuous;
 	bool m_enableSubStepping;
+	bool m_enableSoftStep;
+	bool m_enableWideJoints;
 	bool m_enableSleep;
 	bool m_pause;
 	bool m_singleStep;
@@ -305,6 +305,9 @@ void Test::Step(Settings& settings)
 	m_world->SetWarmStarting(settings.m_enableWarmStarting);
 	m_world->SetContinuousPhysics(settings.m_enableContinuous);
 	m_world->SetSubStepping(settings.m_enableSubStepping);
+	m_world->SetSoftStep(settings.m_enableSoftStep);
+	m_world->SetWideJointSolver(settings.m_enableWideJoints);
+	m_world->SetSubStepCount(settings.m_subStepCount);
 
 	m_pointCount = 0;
 
@@ -332,6 +335,16 @@ void Test::Step(Settings& settings)
 		float quality = m_world->GetTreeQuality();
 		g_debugDraw.DrawString(5, m_textLine, "proxies/height/balance/quality = %d/%d/%d/%g", proxyCount, height, balance, quality);
 		m_textLine += m_textIncrement;
+
+		const b2Counters& counters = m_world->GetCounters();
+		g_debugDraw.DrawString(5, m_textLine, "contact updates/manifold reuses = %d/%d", counters.contactUpdates, counters.manifoldReuses);
+		m_textLine += m_textIncrement;
+
+		g_debugDraw.DrawString(5, m_textLine, "gjk calls/iters, toi calls = %d/%d, %d", counters.gjkCalls, counters.gjkIters, counters.toiCalls);
+		m_textLine += m_textIncrement;
+
+		g_debugDraw.DrawString(5, m_textLine, "proxy reinserts = %d", counters.proxyReinserts);
+		m_textLine += m_textIncrement;
 	}
 
 	// Track maximum profile times
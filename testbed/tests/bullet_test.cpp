@@ -22,6 +22,8 @@
 
 #include "test.h"
 
+#include <atomic>
+
 class BulletTest : public Test
 {
 public:
@@ -79,9 +81,9 @@ public:
 		m_bullet->SetLinearVelocity(b2Vec2(0.0f, -50.0f));
 		m_bullet->SetAngularVelocity(0.0f);
 
-		extern B2_API int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
-		extern B2_API int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
-		extern B2_API int32 b2_toiRootIters, b2_toiMaxRootIters;
+		extern B2_API std::atomic<int32> b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+		extern B2_API std::atomic<int32> b2_toiCalls, b2_toiIters, b2_toiMaxIters;
+		extern B2_API std::atomic<int32> b2_toiRootIters, b2_toiMaxRootIters;
 
 		b2_gjkCalls = 0;
 		b2_gjkIters = 0;
@@ -98,25 +100,25 @@ public:
 	{
 		Test::Step(settings);
 
-		extern B2_API int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
-		extern B2_API int32 b2_toiCalls, b2_toiIters;
-		extern B2_API int32 b2_toiRootIters, b2_toiMaxRootIters;
+		extern B2_API std::atomic<int32> b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+		extern B2_API std::atomic<int32> b2_toiCalls, b2_toiIters;
+		extern B2_API std::atomic<int32> b2_toiRootIters, b2_toiMaxRootIters;
 
 		if (b2_gjkCalls > 0)
 		{
 			g_debugDraw.DrawString(5, m_textLine, "gjk calls = %d, ave gjk iters = %3.1f, max gjk iters = %d",
-				b2_gjkCalls, b2_gjkIters / float(b2_gjkCalls), b2_gjkMaxIters);
+				b2_gjkCalls.load(), b2_gjkIters / float(b2_gjkCalls), b2_gjkMaxIters.load());
 			m_textLine += m_textIncrement;
 		}
 
 		if (b2_toiCalls > 0)
 		{
 			g_debugDraw.DrawString(5, m_textLine, "toi calls = %d, ave toi iters = %3.1f, max toi iters = %d",
-				b2_toiCalls, b2_toiIters / float(b2_toiCalls), b2_toiMaxRootIters);
+				b2_toiCalls.load(), b2_toiIters / float(b2_toiCalls), b2_toiMaxRootIters.load());
 			m_textLine += m_textIncrement;
 
 			g_debugDraw.DrawString(5, m_textLine, "ave toi root iters = %3.1f, max toi root iters = %d",
-				b2_toiRootIters / float(b2_toiCalls), b2_toiMaxRootIters);
+				b2_toiRootIters / float(b2_toiCalls), b2_toiMaxRootIters.load());
 			m_textLine += m_textIncrement;
 		}
 
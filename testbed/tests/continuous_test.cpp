@@ -22,6 +22,8 @@
 
 #include "test.h"
 
+#include <atomic>
+
 class ContinuousTest : public Test
 {
 public:
@@ -81,10 +83,10 @@ public:
 		}
 #endif
 
-		extern B2_API int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
-		extern B2_API int32 b2_toiCalls, b2_toiIters;
-		extern B2_API int32 b2_toiRootIters, b2_toiMaxRootIters;
-		extern B2_API float b2_toiTime, b2_toiMaxTime;
+		extern B2_API std::atomic<int32> b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+		extern B2_API std::atomic<int32> b2_toiCalls, b2_toiIters;
+		extern B2_API std::atomic<int32> b2_toiRootIters, b2_toiMaxRootIters;
+		extern B2_API std::atomic<float> b2_toiTime, b2_toiMaxTime;
 
 		b2_gjkCalls = 0; b2_gjkIters = 0; b2_gjkMaxIters = 0;
 		b2_toiCalls = 0; b2_toiIters = 0;
@@ -94,10 +96,10 @@ public:
 
 	void Launch()
 	{
-		extern B2_API int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
-		extern B2_API int32 b2_toiCalls, b2_toiIters;
-		extern B2_API int32 b2_toiRootIters, b2_toiMaxRootIters;
-		extern B2_API float b2_toiTime, b2_toiMaxTime;
+		extern B2_API std::atomic<int32> b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+		extern B2_API std::atomic<int32> b2_toiCalls, b2_toiIters;
+		extern B2_API std::atomic<int32> b2_toiRootIters, b2_toiMaxRootIters;
+		extern B2_API std::atomic<float> b2_toiTime, b2_toiMaxTime;
 
 		b2_gjkCalls = 0; b2_gjkIters = 0; b2_gjkMaxIters = 0;
 		b2_toiCalls = 0; b2_toiIters = 0;
@@ -114,27 +116,27 @@ public:
 	{
 		Test::Step(settings);
 
-		extern B2_API int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+		extern B2_API std::atomic<int32> b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
 
 		if (b2_gjkCalls > 0)
 		{
 			g_debugDraw.DrawString(5, m_textLine, "gjk calls = %d, ave gjk iters = %3.1f, max gjk iters = %d",
-				b2_gjkCalls, b2_gjkIters / float(b2_gjkCalls), b2_gjkMaxIters);
+				b2_gjkCalls.load(), b2_gjkIters / float(b2_gjkCalls), b2_gjkMaxIters.load());
 			m_textLine += m_textIncrement;
 		}
 
-		extern B2_API int32 b2_toiCalls, b2_toiIters;
-		extern B2_API int32 b2_toiRootIters, b2_toiMaxRootIters;
-		extern B2_API float b2_toiTime, b2_toiMaxTime;
+		extern B2_API std::atomic<int32> b2_toiCalls, b2_toiIters;
+		extern B2_API std::atomic<int32> b2_toiRootIters, b2_toiMaxRootIters;
+		extern B2_API std::atomic<float> b2_toiTime, b2_toiMaxTime;
 
 		if (b2_toiCalls > 0)
 		{
 			g_debugDraw.DrawString(5, m_textLine, "toi calls = %d, ave [max] toi iters = %3.1f [%d]",
-								b2_toiCalls, b2_toiIters / float(b2_toiCalls), b2_toiMaxRootIters);
+								b2_toiCalls.load(), b2_toiIters / float(b2_toiCalls), b2_toiMaxRootIters.load());
 			m_textLine += m_textIncrement;
 			
 			g_debugDraw.DrawString(5, m_textLine, "ave [max] toi root iters = %3.1f [%d]",
-				b2_toiRootIters / float(b2_toiCalls), b2_toiMaxRootIters);
+				b2_toiRootIters / float(b2_toiCalls), b2_toiMaxRootIters.load());
 			m_textLine += m_textIncrement;
 
 			g_debugDraw.DrawString(5, m_textLine, "ave [max] toi time = %.1f [%.1f] (microseconds)",
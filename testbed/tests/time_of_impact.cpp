@@ -23,6 +23,8 @@
 #include "test.h"
 #include "box2d/b2_time_of_impact.h"
 
+#include <atomic>
+
 class TimeOfImpact : public Test
 {
 public:
@@ -72,8 +74,8 @@ public:
 		g_debugDraw.DrawString(5, m_textLine, "toi = %g", output.t);
 		m_textLine += m_textIncrement;
 
-		extern B2_API int32 b2_toiMaxIters, b2_toiMaxRootIters;
-		g_debugDraw.DrawString(5, m_textLine, "max toi iters = %d, max root iters = %d", b2_toiMaxIters, b2_toiMaxRootIters);
+		extern B2_API std::atomic<int32> b2_toiMaxIters, b2_toiMaxRootIters;
+		g_debugDraw.DrawString(5, m_textLine, "max toi iters = %d, max root iters = %d", b2_toiMaxIters.load(), b2_toiMaxRootIters.load());
 		m_textLine += m_textIncrement;
 
 		b2Vec2 vertices[b2_maxPolygonVertices];
@@ -22,7 +22,9 @@
 
 #include "box2d/box2d.h"
 #include "doctest.h"
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 // Unit tests for collision algorithms
 DOCTEST_TEST_CASE("collision test")
@@ -78,4 +80,578 @@ DOCTEST_TEST_CASE("collision test")
 		CHECK(b2Abs(massData2.mass - mass) < 20.0f * (absTol + relTol * mass));
 		CHECK(b2Abs(massData2.I - inertia) < 40.0f * (absTol + relTol * inertia));
 	}
+
+	SUBCASE("polygon manifold")
+	{
+		b2PolygonShape ground;
+		ground.SetAsBox(5.0f, 0.5f);
+
+		b2PolygonShape box;
+		box.SetAsBox(0.5f, 0.5f);
+
+		b2Transform xfA;
+		xfA.SetIdentity();
+
+		b2Transform xfB;
+		xfB.Set(b2Vec2(1.0f, 0.99f), 0.0f);
+
+		b2Manifold manifold;
+		b2CollidePolygons(&manifold, &ground, xfA, &box, xfB);
+
+		CHECK(manifold.pointCount == 2);
+		CHECK(manifold.type == b2Manifold::e_faceA);
+		CHECK(manifold.localNormal.x == 0.0f);
+		CHECK(manifold.localNormal.y == 1.0f);
+
+		// A hexagon uses a partially filled SIMD lane group.
+		b2Vec2 points[6];
+		for (int32 i = 0; i < 6; ++i)
+		{
+			float angle = i * b2_pi / 3.0f;
+			points[i].Set(cosf(angle), sinf(angle));
+		}
+
+		b2PolygonShape hexagon;
+		hexagon.Set(points, 6);
+
+		xfB.Set(b2Vec2(0.0f, 1.6f), 0.1f);
+		b2CollidePolygons(&manifold, &ground, xfA, &hexagon, xfB);
+		CHECK(manifold.pointCount == 0);
+
+		xfB.Set(b2Vec2(0.0f, 1.36f), 0.0f);
+		b2CollidePolygons(&manifold, &ground, xfA, &hexagon, xfB);
+		CHECK(manifold.pointCount == 2);
+		CHECK(b2Abs(manifold.localNormal.y - 1.0f) < b2_epsilon);
+	}
+
+	SUBCASE("polygon cache")
+	{
+		b2PolygonShape boxA;
+		boxA.SetAsBox(2.0f, 0.5f);
+
+		b2PolygonShape boxB;
+		boxB.SetAsBox(0.5f, 0.5f);
+
+		b2Transform xfA;
+		xfA.SetIdentity();
+
+		b2PolygonCache cache;
+		cache.count = 0;
+
+		// The cached result must match a full search while the box moves down onto the ground.
+		for (int32 i = 0; i < 40; ++i)
+		{
+			b2Transform xfB;
+			xfB.Set(b2Vec2(0.25f, 1.1f - 0.0025f * i), 0.0001f * i);
+
+			b2Manifold manifold1, manifold2;
+			b2CollidePolygons(&manifold1, &boxA, xfA, &boxB, xfB);
+			b2CollidePolygons(&manifold2, &boxA, xfA, &boxB, xfB, &cache);
+
+			CHECK(manifold1.pointCount == manifold2.pointCount);
+			for (int32 j = 0; j < manifold1.pointCount; ++j)
+			{
+				CHECK(manifold1.points[j].id.key == manifold2.points[j].id.key);
+				CHECK(b2Distance(manifold1.points[j].localPoint, manifold2.points[j].localPoint) < b2_linearSlop);
+			}
+		}
+
+		CHECK(cache.count == 1);
+		CHECK(cache.touching == 1);
+
+		// A large jump falls back to the full search.
+		b2Transform xfB;
+		xfB.Set(b2Vec2(2.0f, 0.5f), 0.5f * b2_pi);
+
+		b2Manifold manifold1, manifold2;
+		b2CollidePolygons(&manifold1, &boxA, xfA, &boxB, xfB);
+		b2CollidePolygons(&manifold2, &boxA, xfA, &boxB, xfB, &cache);
+		CHECK(manifold1.pointCount == manifold2.pointCount);
+		CHECK(manifold1.type == manifold2.type);
+	}
+
+	SUBCASE("rounded polygon")
+	{
+		const float rounding = 0.25f;
+
+		b2PolygonShape box;
+		box.SetAsBox(1.0f, 0.5f, b2Vec2(1.0f, 2.0f), 0.0f);
+		box.SetRounding(rounding);
+		b2Transform identity;
+		identity.SetIdentity();
+		CHECK(b2Abs(box.GetRounding() - rounding) < b2_epsilon);
+
+		// Core rectangle, edge rectangles and a full circle at the corners.
+		b2MassData massData;
+		box.ComputeMass(&massData, 1.0f);
+		float area = 2.0f + 6.0f * rounding + b2_pi * rounding * rounding;
+		CHECK(b2Abs(massData.mass - area) < 1.0e-4f);
+		CHECK(b2Abs(massData.center.x - 1.0f) < 1.0e-4f);
+		CHECK(b2Abs(massData.center.y - 2.0f) < 1.0e-4f);
+		CHECK(b2Abs(massData.I - (2.553655f + 5.0f * area)) < 1.0e-3f);
+
+		b2AABB aabb;
+		box.ComputeAABB(&aabb, identity, 0);
+		CHECK(b2Abs(aabb.upperBound.x - (2.0f + box.m_radius)) < b2_epsilon);
+
+		CHECK(box.TestPoint(identity, b2Vec2(2.15f, 2.65f)));
+		CHECK(box.TestPoint(identity, b2Vec2(2.2f, 2.0f)));
+		CHECK_FALSE(box.TestPoint(identity, b2Vec2(2.2f, 2.7f)));
+		CHECK_FALSE(box.TestPoint(identity, b2Vec2(1.0f, 2.8f)));
+
+		// The face is pushed out by the rounding.
+		b2RayCastInput input;
+		input.p1.Set(1.0f, 5.0f);
+		input.p2.Set(1.0f, -1.0f);
+		input.maxFraction = 1.0f;
+		b2RayCastOutput output;
+		bool hit = box.RayCast(&output, input, identity, 0);
+		CHECK(hit);
+		CHECK(b2Abs(output.fraction - 2.25f / 6.0f) < 1.0e-5f);
+		CHECK(b2Abs(output.normal.y - 1.0f) < 1.0e-5f);
+
+		// Passing the corner hits the arc.
+		input.p1.Set(-3.0f, 2.6f);
+		input.p2.Set(3.0f, 2.6f);
+		hit = box.RayCast(&output, input, identity, 0);
+		CHECK(hit);
+		float x = -b2Sqrt(rounding * rounding - 0.01f);
+		CHECK(b2Abs(output.fraction - (3.0f + x) / 6.0f) < 1.0e-5f);
+		CHECK(b2Abs(output.normal.x - x / rounding) < 1.0e-4f);
+		CHECK(b2Abs(output.normal.y - 0.4f) < 1.0e-4f);
+
+		// Rays starting inside the rounding do not hit.
+		input.p1.Set(2.1f, 2.0f);
+		CHECK_FALSE(box.RayCast(&output, input, identity, 0));
+
+		// Corner to corner contact has a single point along the line between the corners.
+		b2PolygonShape polygonA, polygonB;
+		polygonA.SetAsBox(0.5f, 0.5f);
+		polygonA.SetRounding(rounding);
+		polygonB = polygonA;
+
+		b2Transform transformA = identity;
+		b2Transform transformB(b2Vec2(1.3f, 1.3f), b2Rot(0.0f));
+
+		b2Manifold manifold;
+		b2CollidePolygons(&manifold, &polygonA, transformA, &polygonB, transformB);
+		CHECK(manifold.pointCount == 1);
+		CHECK(manifold.type == b2Manifold::e_circles);
+
+		b2WorldManifold worldManifold;
+		worldManifold.Initialize(&manifold, transformA, polygonA.m_radius, transformB, polygonB.m_radius);
+		CHECK(b2Abs(worldManifold.normal.x - 0.70710678f) < 1.0e-5f);
+		CHECK(b2Abs(worldManifold.normal.y - 0.70710678f) < 1.0e-5f);
+		float separation = 0.42426407f - polygonA.m_radius - polygonB.m_radius;
+		CHECK(b2Abs(worldManifold.separations[0] - separation) < 1.0e-5f);
+
+		// The faces are within the radius but the corners are not touching.
+		transformB.p.Set(1.45f, 1.45f);
+		b2CollidePolygons(&manifold, &polygonA, transformA, &polygonB, transformB);
+		CHECK(manifold.pointCount == 0);
+
+		// Polygons without rounding keep the face manifold.
+		b2PolygonShape square;
+		square.SetAsBox(0.5f, 0.5f);
+		transformB.p.Set(1.0f + b2_linearSlop, 1.0f + b2_linearSlop);
+		b2CollidePolygons(&manifold, &square, transformA, &square, transformB);
+		CHECK(manifold.type != b2Manifold::e_circles);
+
+		// Edge vertex against a rounded corner.
+		b2EdgeShape edge;
+		edge.SetTwoSided(b2Vec2(-1.0f, 0.0f), b2Vec2(0.0f, 0.0f));
+		polygonB.SetAsBox(0.25f, 0.25f);
+		polygonB.SetRounding(0.3f);
+		transformB.p.Set(0.45f, 0.45f);
+		b2CollideEdgeAndPolygon(&manifold, &edge, transformA, &polygonB, transformB);
+		CHECK(manifold.pointCount == 1);
+		CHECK(manifold.type == b2Manifold::e_circles);
+		CHECK(manifold.points[0].id.cf.indexA == 1);
+		CHECK(manifold.points[0].id.cf.typeB == b2ContactFeature::e_vertex);
+	}
+
+	SUBCASE("polygon hull")
+	{
+		srand(888);
+
+		for (int32 i = 0; i < 200; ++i)
+		{
+			b2Vec2 points[b2_maxPolygonVertices];
+			int32 count = 3 + rand() % (b2_maxPolygonVertices - 2);
+			for (int32 j = 0; j < count; ++j)
+			{
+				// A coarse grid gives duplicate x values and collinear points.
+				points[j].Set(0.25f * (rand() % 9), 0.25f * (rand() % 9));
+			}
+
+			// Skip point sets that weld or hull down to a line.
+			b2Vec2 origin = points[0];
+			bool degenerate = true;
+			for (int32 j = 1; j < count && degenerate; ++j)
+			{
+				for (int32 k = j + 1; k < count && degenerate; ++k)
+				{
+					degenerate = b2Cross(points[j] - origin, points[k] - origin) == 0.0f;
+				}
+			}
+
+			if (degenerate)
+			{
+				continue;
+			}
+
+			b2PolygonShape polygon;
+			polygon.Set(points, count);
+			CHECK(polygon.Validate());
+
+			// The hull starts at the lowest of the right most points.
+			for (int32 j = 0; j < count; ++j)
+			{
+				b2Vec2 v = polygon.m_vertices[0];
+				CHECK((points[j].x < v.x || (points[j].x == v.x && points[j].y >= v.y)));
+			}
+
+			// Every point is inside and no hull vertex is collinear with its neighbors.
+			for (int32 j = 0; j < polygon.m_count; ++j)
+			{
+				b2Vec2 v1 = polygon.m_vertices[j];
+				b2Vec2 v2 = polygon.m_vertices[j + 1 < polygon.m_count ? j + 1 : 0];
+				b2Vec2 v3 = polygon.m_vertices[j + 2 < polygon.m_count ? j + 2 : j + 2 - polygon.m_count];
+				CHECK(b2Cross(v2 - v1, v3 - v2) > 0.0f);
+
+				for (int32 k = 0; k < count; ++k)
+				{
+					CHECK(b2Cross(v2 - v1, points[k] - v1) >= 0.0f);
+				}
+			}
+
+			// A hull is accepted as is by the fast path.
+			b2PolygonShape convex;
+			convex.SetConvex(polygon.m_vertices, polygon.m_count);
+			CHECK(convex.m_count == polygon.m_count);
+			CHECK(convex.m_centroid.x == polygon.m_centroid.x);
+			CHECK(convex.m_centroid.y == polygon.m_centroid.y);
+			for (int32 j = 0; j < polygon.m_count; ++j)
+			{
+				CHECK(convex.m_vertices[j].x == polygon.m_vertices[j].x);
+				CHECK(convex.m_vertices[j].y == polygon.m_vertices[j].y);
+				CHECK(convex.m_normals[j].x == polygon.m_normals[j].x);
+				CHECK(convex.m_normals[j].y == polygon.m_normals[j].y);
+			}
+		}
+
+		// Convex points in either winding give the same polygon and so does a star
+		// through the same points.
+		b2Vec2 pentagon[5], reversed[5], star[5];
+		for (int32 i = 0; i < 5; ++i)
+		{
+			float angle = 0.4f * b2_pi * i + 0.1f;
+			pentagon[i].Set(cosf(angle), sinf(angle));
+			reversed[4 - i] = pentagon[i];
+		}
+
+		for (int32 i = 0; i < 5; ++i)
+		{
+			star[i] = pentagon[(2 * i) % 5];
+		}
+
+		b2PolygonShape polygon1, polygon2, polygon3;
+		polygon1.Set(pentagon, 5);
+		polygon2.Set(reversed, 5);
+		polygon3.Set(star, 5);
+		CHECK(polygon1.m_count == 5);
+		CHECK(polygon2.m_count == 5);
+		CHECK(polygon3.m_count == 5);
+		for (int32 i = 0; i < 5; ++i)
+		{
+			CHECK(polygon1.m_vertices[i].x == polygon2.m_vertices[i].x);
+			CHECK(polygon1.m_vertices[i].y == polygon2.m_vertices[i].y);
+			CHECK(polygon1.m_vertices[i].x == polygon3.m_vertices[i].x);
+			CHECK(polygon1.m_vertices[i].y == polygon3.m_vertices[i].y);
+		}
+
+		// Bulk creation
+		b2Vec2 points[] =
+		{
+			b2Vec2(0.0f, 0.0f), b2Vec2(1.0f, 0.0f), b2Vec2(0.0f, 1.0f),
+			b2Vec2(0.0f, 0.0f), b2Vec2(2.0f, 0.0f), b2Vec2(2.0f, 2.0f), b2Vec2(0.0f, 2.0f)
+		};
+		int32 counts[] = {3, 4};
+
+		b2PolygonShape polygons[2];
+		b2SetPolygons(polygons, points, counts, 2, true);
+		CHECK(polygons[0].m_count == 3);
+		CHECK(polygons[1].m_count == 4);
+		CHECK(polygons[1].m_centroid.x == doctest::Approx(1.0f));
+
+		b2SetPolygons(polygons, points, counts, 2, false);
+		CHECK(polygons[0].m_vertices[0].x == 1.0f);
+		CHECK(polygons[1].m_vertices[0].x == 2.0f);
+		CHECK(polygons[1].m_vertices[0].y == 0.0f);
+	}
+
+	SUBCASE("compound shape")
+	{
+		// A U shape from three boxes.
+		b2PolygonShape polygons[3];
+		polygons[0].SetAsBox(2.0f, 0.25f, b2Vec2(0.0f, 0.25f), 0.0f);
+		polygons[1].SetAsBox(0.25f, 1.0f, b2Vec2(-1.75f, 1.5f), 0.0f);
+		polygons[2].SetAsBox(0.25f, 1.0f, b2Vec2(1.75f, 1.5f), 0.0f);
+
+		b2CompoundShape compound;
+		compound.Create(polygons, 3);
+		CHECK(compound.GetChildCount() == 1);
+		CHECK(compound.m_nodeCount == 5);
+
+		b2MassData massData;
+		compound.ComputeMass(&massData, 2.0f);
+		CHECK(massData.mass == doctest::Approx(2.0f * (2.0f + 1.0f + 1.0f)));
+		CHECK(massData.center.x == doctest::Approx(0.0f));
+
+		b2Transform xf;
+		xf.Set(b2Vec2(1.0f, 2.0f), 0.5f);
+
+		b2AABB aabb;
+		compound.ComputeAABB(&aabb, xf, 0);
+		for (int32 i = 0; i < 3; ++i)
+		{
+			b2AABB polygonAABB;
+			polygons[i].ComputeAABB(&polygonAABB, xf, 0);
+			CHECK(aabb.Contains(polygonAABB));
+		}
+
+		CHECK(compound.TestPoint(xf, b2Mul(xf, b2Vec2(-1.75f, 2.0f))));
+		CHECK(compound.TestPoint(xf, b2Mul(xf, b2Vec2(0.0f, 1.5f))) == false);
+
+		// A circle in the cup touches nothing, but it overlaps once it drops to the floor.
+		b2CircleShape circle;
+		circle.m_radius = 0.5f;
+		b2Transform circleXf;
+		circleXf.Set(b2Mul(xf, b2Vec2(0.0f, 1.5f)), 0.0f);
+		CHECK(b2TestOverlap(&compound, 0, &circle, 0, xf, circleXf) == false);
+		circleXf.Set(b2Mul(xf, b2Vec2(0.0f, 0.75f)), 0.0f);
+		CHECK(b2TestOverlap(&circle, 0, &compound, 0, circleXf, xf));
+
+		// A ray down through the cup hits the floor, not the far wall.
+		b2RayCastInput input;
+		input.p1 = b2Mul(xf, b2Vec2(0.0f, 3.0f));
+		input.p2 = b2Mul(xf, b2Vec2(0.0f, -1.0f));
+		input.maxFraction = 1.0f;
+		b2RayCastOutput output;
+		int32 polygonIndex;
+		CHECK(compound.RayCast(&output, &polygonIndex, input, xf));
+		CHECK(polygonIndex == 0);
+		CHECK(output.fraction == doctest::Approx(2.5f / 4.0f));
+
+		// The hierarchy finds the same polygons as a brute force search.
+		srand(46);
+		const int32 count = 100;
+		b2PolygonShape pieces[count];
+		for (int32 i = 0; i < count; ++i)
+		{
+			b2Vec2 center(0.1f * (rand() % 200), 0.1f * (rand() % 200));
+			pieces[i].SetAsBox(0.2f + 0.01f * (rand() % 50), 0.2f, center, 0.01f * (rand() % 300));
+		}
+
+		b2CompoundShape cloud;
+		cloud.Create(pieces, count);
+		CHECK(cloud.m_nodeCount == 2 * count - 1);
+
+		struct PolygonCounter
+		{
+			bool QueryCallback(int32 index)
+			{
+				B2_NOT_USED(index);
+				++count;
+				return true;
+			}
+
+			int32 count = 0;
+		};
+
+		b2Transform identity;
+		identity.SetIdentity();
+		for (int32 i = 0; i < 50; ++i)
+		{
+			b2AABB box;
+			box.lowerBound.Set(0.1f * (rand() % 200), 0.1f * (rand() % 200));
+			box.upperBound = box.lowerBound + b2Vec2(0.1f * (rand() % 40), 0.1f * (rand() % 40));
+
+			int32 expected = 0;
+			for (int32 j = 0; j < count; ++j)
+			{
+				b2AABB polygonAABB;
+				pieces[j].ComputeAABB(&polygonAABB, identity, 0);
+				expected += b2TestOverlap(box, polygonAABB) ? 1 : 0;
+			}
+
+			PolygonCounter counter;
+			cloud.Query(&counter, box);
+			CHECK(counter.count == expected);
+		}
+
+		// Compound against compound.
+		CHECK(b2TestOverlap(&compound, 0, &cloud, 0, identity, b2Transform(b2Vec2(100.0f, 0.0f), b2Rot(0.0f))) == false);
+		CHECK(b2TestOverlap(&compound, 0, &cloud, 0, b2Transform(pieces[7].m_centroid, b2Rot(0.0f)), identity));
+	}
+
+	SUBCASE("dynamic tree bulk insertion")
+	{
+		struct QueryCounter
+		{
+			bool QueryCallback(int32 proxyId)
+			{
+				B2_NOT_USED(proxyId);
+				++count;
+				return true;
+			}
+
+			int32 count = 0;
+		};
+
+		b2DynamicTree tree;
+		const int32 count = 500;
+		b2AABB aabbs[count];
+		void* userData[count];
+		int32 proxyIds[count];
+
+		// A few proxies exist before the bulk insertion.
+		for (int32 i = 0; i < 10; ++i)
+		{
+			b2AABB aabb;
+			aabb.lowerBound.Set(3.0f * i, -1.0f);
+			aabb.upperBound.Set(3.0f * i + 1.0f, 0.0f);
+			tree.CreateProxy(aabb, nullptr);
+		}
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			float x = float((i * 37) % 101);
+			float y = float((i * 53) % 97);
+			aabbs[i].lowerBound.Set(x, y);
+			aabbs[i].upperBound.Set(x + 1.0f, y + 1.0f);
+			userData[i] = aabbs + i;
+		}
+
+		tree.CreateProxies(count, aabbs, userData, proxyIds);
+		tree.Validate();
+		CHECK(tree.GetHeight() < 20);
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			CHECK(tree.GetUserData(proxyIds[i]) == aabbs + i);
+		}
+
+		// Query results match a brute force test.
+		b2AABB query;
+		query.lowerBound.Set(20.0f, 20.0f);
+		query.upperBound.Set(40.0f, 30.0f);
+
+		int32 expected = 0;
+		for (int32 i = 0; i < count; ++i)
+		{
+			if (b2TestOverlap(tree.GetFatAABB(proxyIds[i]), query))
+			{
+				++expected;
+			}
+		}
+
+		QueryCounter counter;
+		tree.Query(&counter, query);
+		CHECK(counter.count == expected);
+
+		for (int32 i = 0; i < count; i += 2)
+		{
+			tree.DestroyProxy(proxyIds[i]);
+		}
+		tree.Validate();
+	}
+
+	SUBCASE("dynamic tree batched moves")
+	{
+		b2DynamicTree tree1;
+		b2DynamicTree tree2;
+		const int32 count = 200;
+		int32 proxyIds[count];
+		b2AABB aabbs[count];
+		b2Vec2 displacements[count];
+		int32 movedIds[count];
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			float x = float((i * 37) % 101);
+			float y = float((i * 53) % 97);
+			aabbs[i].lowerBound.Set(x, y);
+			aabbs[i].upperBound.Set(x + 1.0f, y + 1.0f);
+			proxyIds[i] = tree1.CreateProxy(aabbs[i], nullptr);
+			tree2.CreateProxy(aabbs[i], nullptr);
+		}
+
+		// Every third proxy moves out of its fat AABB.
+		for (int32 i = 0; i < count; ++i)
+		{
+			displacements[i].Set(i % 3 == 0 ? 2.0f : 0.01f, 0.0f);
+			aabbs[i].lowerBound += displacements[i];
+			aabbs[i].upperBound += displacements[i];
+		}
+
+		int32 movedCount = tree1.MoveProxies(count, proxyIds, aabbs, displacements, movedIds);
+		tree1.Validate();
+
+		int32 expected = 0;
+		for (int32 i = 0; i < count; ++i)
+		{
+			if (tree2.MoveProxy(proxyIds[i], aabbs[i], displacements[i]))
+			{
+				CHECK(movedIds[expected] == proxyIds[i]);
+				++expected;
+			}
+		}
+
+		CHECK(movedCount == expected);
+		CHECK(movedCount == (count + 2) / 3);
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			CHECK(tree1.GetFatAABB(proxyIds[i]).Contains(aabbs[i]));
+			CHECK(tree1.WasMoved(proxyIds[i]) == tree2.WasMoved(proxyIds[i]));
+		}
+	}
+
+	SUBCASE("dynamic tree adaptive margin")
+	{
+		b2DynamicTree tree;
+		b2AABB aabb;
+		aabb.lowerBound.Set(0.0f, 0.0f);
+		aabb.upperBound.Set(1.0f, 1.0f);
+		int32 slowId = tree.CreateProxy(aabb, nullptr);
+		int32 fastId = tree.CreateProxy(aabb, nullptr);
+
+		b2AABB slowAABB = aabb;
+		b2AABB fastAABB = aabb;
+		b2Vec2 slowStep(0.001f, 0.0f);
+		b2Vec2 fastStep(0.5f, 0.0f);
+		for (int32 i = 0; i < 1000; ++i)
+		{
+			slowAABB.lowerBound += slowStep;
+			slowAABB.upperBound += slowStep;
+			tree.MoveProxy(slowId, slowAABB, slowStep);
+
+			fastAABB.lowerBound += fastStep;
+			fastAABB.upperBound += fastStep;
+			tree.MoveProxy(fastId, fastAABB, fastStep);
+
+			CHECK(tree.GetFatAABB(slowId).Contains(slowAABB));
+			CHECK(tree.GetFatAABB(fastId).Contains(fastAABB));
+		}
+
+		tree.Validate();
+
+		// The slow proxy has a tighter margin than the fixed extension and the fast
+		// proxy has a wider one.
+		b2AABB slowFat = tree.GetFatAABB(slowId);
+		b2AABB fastFat = tree.GetFatAABB(fastId);
+		CHECK(slowAABB.lowerBound.y - slowFat.lowerBound.y < b2_aabbExtension);
+		CHECK(fastAABB.lowerBound.y - fastFat.lowerBound.y > b2_aabbExtension);
+	}
 }
@@ -104,3 +104,305 @@ DOCTEST_TEST_CASE("joint reactions")
 		CHECK(T == 0.0f);
 	}
 }
+
+DOCTEST_TEST_CASE("mixed joint chain")
+{
+	// A chain that alternates joint types. The wide solver takes the revolute and
+	// weld joints out of the island order and leaves the prismatic joints in it.
+	for (int32 mode = 0; mode < 4; ++mode)
+	{
+		b2World world(b2Vec2(0.0f, -10.0f));
+		world.SetSoftStep((mode & 1) != 0);
+		world.SetWideJointSolver((mode & 2) != 0);
+
+		b2BodyDef bodyDef;
+		b2Body* ground = world.CreateBody(&bodyDef);
+
+		b2PolygonShape box;
+		box.SetAsBox(0.5f, 0.125f);
+
+		b2FixtureDef fixtureDef;
+		fixtureDef.shape = &box;
+		fixtureDef.density = 1.0f;
+		fixtureDef.filter.maskBits = 0;
+
+		const int32 count = 12;
+		b2Joint* joints[count];
+		b2Body* prevBody = ground;
+		for (int32 i = 0; i < count; ++i)
+		{
+			bodyDef.type = b2_dynamicBody;
+			bodyDef.position.Set(0.5f + i, 20.0f);
+			b2Body* body = world.CreateBody(&bodyDef);
+			body->CreateFixture(&fixtureDef);
+
+			b2Vec2 anchor(float(i), 20.0f);
+			switch (i % 3)
+			{
+			case 0:
+			{
+				b2RevoluteJointDef jd;
+				jd.Initialize(prevBody, body, anchor);
+				joints[i] = world.CreateJoint(&jd);
+			}
+			break;
+
+			case 1:
+			{
+				b2WeldJointDef jd;
+				jd.Initialize(prevBody, body, anchor);
+				joints[i] = world.CreateJoint(&jd);
+			}
+			break;
+
+			default:
+			{
+				b2PrismaticJointDef jd;
+				jd.Initialize(prevBody, body, anchor, b2Vec2(1.0f, 0.0f));
+				jd.enableLimit = true;
+				jd.lowerTranslation = 0.0f;
+				jd.upperTranslation = 0.0f;
+				joints[i] = world.CreateJoint(&jd);
+			}
+			break;
+			}
+
+			prevBody = body;
+		}
+
+		for (int32 i = 0; i < 600; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+
+		// The chain hangs down and the joints hold together.
+		CHECK(prevBody->GetPosition().y < 19.0f);
+		for (int32 i = 0; i < count; ++i)
+		{
+			b2Vec2 d = joints[i]->GetAnchorB() - joints[i]->GetAnchorA();
+			CHECK(d.Length() < 0.1f);
+		}
+	}
+}
+
+// Chains that hang from the ground with limited and motorized revolute joints
+// and soft and rigid weld joints.
+static void CreateLimbs(b2World* world, b2Body** tips, int32 limbCount)
+{
+	b2BodyDef bodyDef;
+	b2Body* ground = world->CreateBody(&bodyDef);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.125f);
+
+	b2FixtureDef fixtureDef;
+	fixtureDef.shape = &box;
+	fixtureDef.density = 1.0f;
+	fixtureDef.filter.maskBits = 0;
+
+	const int32 count = 8;
+	for (int32 k = 0; k < limbCount; ++k)
+	{
+		float x = 10.0f * k;
+		b2Body* prevBody = ground;
+		for (int32 i = 0; i < count; ++i)
+		{
+			bodyDef.type = b2_dynamicBody;
+			bodyDef.position.Set(x + 0.5f + i, 20.0f);
+			b2Body* body = world->CreateBody(&bodyDef);
+			body->CreateFixture(&fixtureDef);
+
+			b2Vec2 anchor(x + i, 20.0f);
+			if (i % 4 == 1)
+			{
+				b2WeldJointDef jd;
+				jd.Initialize(prevBody, body, anchor);
+				b2AngularStiffness(jd.stiffness, jd.damping, 5.0f, 0.7f, prevBody, body);
+				world->CreateJoint(&jd);
+			}
+			else if (i % 4 == 3)
+			{
+				b2WeldJointDef jd;
+				jd.Initialize(prevBody, body, anchor);
+				world->CreateJoint(&jd);
+			}
+			else
+			{
+				b2RevoluteJointDef jd;
+				jd.Initialize(prevBody, body, anchor);
+				jd.enableLimit = i > 0;
+				jd.lowerAngle = -0.25f * b2_pi;
+				jd.upperAngle = 0.25f * b2_pi;
+				jd.enableMotor = true;
+				jd.maxMotorTorque = 1.0f;
+				world->CreateJoint(&jd);
+			}
+
+			prevBody = body;
+		}
+
+		tips[k] = prevBody;
+	}
+}
+
+DOCTEST_TEST_CASE("wide joint solver")
+{
+	for (int32 soft = 0; soft < 2; ++soft)
+	{
+		const int32 limbCount = 10;
+		b2Body* scalarTips[limbCount];
+		b2Body* wideTips[limbCount];
+
+		b2World scalarWorld(b2Vec2(0.0f, -10.0f));
+		scalarWorld.SetSoftStep(soft == 1);
+		CreateLimbs(&scalarWorld, scalarTips, limbCount);
+
+		b2World wideWorld(b2Vec2(0.0f, -10.0f));
+		wideWorld.SetSoftStep(soft == 1);
+		wideWorld.SetWideJointSolver(true);
+		CHECK(wideWorld.GetWideJointSolver());
+		CreateLimbs(&wideWorld, wideTips, limbCount);
+
+		for (int32 i = 0; i < 600; ++i)
+		{
+			scalarWorld.Step(1.0f / 60.0f, 8, 3);
+			wideWorld.Step(1.0f / 60.0f, 8, 3);
+		}
+
+		// The limbs hang down with the joints holding together and within their limits.
+		for (b2Joint* j = wideWorld.GetJointList(); j; j = j->GetNext())
+		{
+			b2Vec2 d = j->GetAnchorB() - j->GetAnchorA();
+			CHECK(d.Length() < 0.1f);
+
+			if (j->GetType() == e_revoluteJoint)
+			{
+				b2RevoluteJoint* rj = static_cast<b2RevoluteJoint*>(j);
+				if (rj->IsLimitEnabled())
+				{
+					CHECK(rj->GetJointAngle() > rj->GetLowerLimit() - 0.05f);
+					CHECK(rj->GetJointAngle() < rj->GetUpperLimit() + 0.05f);
+				}
+			}
+		}
+
+		// The solver order differs but both solvers come to rest in the same pose.
+		for (int32 k = 0; k < limbCount; ++k)
+		{
+			CHECK(wideTips[k]->GetPosition().y < 19.0f);
+			b2Vec2 d = wideTips[k]->GetPosition() - scalarTips[k]->GetPosition();
+			CHECK(d.Length() < 0.05f);
+		}
+	}
+
+	// A motor drives a wheel to the motor speed. Small islands are solved in batches
+	// but a box resting on the ground still falls asleep.
+	{
+		b2World world(b2Vec2(0.0f, -10.0f));
+		world.SetWideJointSolver(true);
+
+		b2BodyDef bodyDef;
+		b2Body* ground = world.CreateBody(&bodyDef);
+
+		b2EdgeShape edge;
+		edge.SetTwoSided(b2Vec2(-20.0f, 0.0f), b2Vec2(20.0f, 0.0f));
+		ground->CreateFixture(&edge, 0.0f);
+
+		b2PolygonShape box;
+		box.SetAsBox(0.5f, 0.5f);
+
+		bodyDef.type = b2_dynamicBody;
+		bodyDef.position.Set(10.0f, 0.5f);
+		b2Body* crate = world.CreateBody(&bodyDef);
+		crate->CreateFixture(&box, 1.0f);
+
+		bodyDef.type = b2_dynamicBody;
+		bodyDef.position.Set(0.0f, 5.0f);
+		b2Body* wheel = world.CreateBody(&bodyDef);
+
+		b2CircleShape circle;
+		circle.m_radius = 1.0f;
+		wheel->CreateFixture(&circle, 1.0f);
+
+		b2RevoluteJointDef jd;
+		jd.Initialize(ground, wheel, wheel->GetPosition());
+		jd.enableMotor = true;
+		jd.motorSpeed = 2.0f;
+		jd.maxMotorTorque = 1000.0f;
+		b2RevoluteJoint* joint = (b2RevoluteJoint*)world.CreateJoint(&jd);
+
+		// The motor impulse is copied back to the joint.
+		world.Step(1.0f / 60.0f, 8, 3);
+		CHECK(joint->GetMotorTorque(60.0f) > 0.0f);
+
+		for (int32 i = 0; i < 60; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+
+		CHECK(b2Abs(wheel->GetAngularVelocity() - 2.0f) < 1.0e-3f);
+		CHECK(b2Abs(wheel->GetPosition().y - 5.0f) < 1.0e-3f);
+		CHECK(wheel->IsAwake());
+		CHECK(crate->IsAwake() == false);
+	}
+
+	// A body held by two joints that can't both be satisfied is at rest but its
+	// position error stays large. Its island stays awake while the boxes solved in
+	// the same batch fall asleep.
+	for (int32 soft = 0; soft < 2; ++soft)
+	{
+		b2World world(b2Vec2(0.0f, -10.0f));
+		world.SetSoftStep(soft == 1);
+		world.SetWideJointSolver(true);
+
+		b2BodyDef bodyDef;
+		b2Body* ground = world.CreateBody(&bodyDef);
+
+		b2EdgeShape edge;
+		edge.SetTwoSided(b2Vec2(-20.0f, 0.0f), b2Vec2(20.0f, 0.0f));
+		ground->CreateFixture(&edge, 0.0f);
+
+		b2PolygonShape box;
+		box.SetAsBox(0.5f, 0.5f);
+
+		const int32 crateCount = 4;
+		b2Body* crates[crateCount];
+		bodyDef.type = b2_dynamicBody;
+		for (int32 i = 0; i < crateCount; ++i)
+		{
+			bodyDef.position.Set(-10.0f + 2.0f * i, 0.5f);
+			crates[i] = world.CreateBody(&bodyDef);
+			crates[i]->CreateFixture(&box, 1.0f);
+		}
+
+		bodyDef.position.Set(10.0f, 10.0f);
+		b2Body* strained = world.CreateBody(&bodyDef);
+		b2FixtureDef fixtureDef;
+		fixtureDef.shape = &box;
+		fixtureDef.density = 1.0f;
+		fixtureDef.filter.maskBits = 0;
+		strained->CreateFixture(&fixtureDef);
+
+		for (int32 i = 0; i < 2; ++i)
+		{
+			b2RevoluteJointDef jd;
+			jd.bodyA = ground;
+			jd.bodyB = strained;
+			jd.localAnchorA.Set(9.0f + 2.0f * i, 10.0f);
+			jd.localAnchorB.SetZero();
+			world.CreateJoint(&jd);
+		}
+
+		for (int32 i = 0; i < 120; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+
+		CHECK(strained->IsAwake());
+		CHECK(strained->GetLinearVelocity().Length() < b2_linearSleepTolerance);
+		for (int32 i = 0; i < crateCount; ++i)
+		{
+			CHECK(crates[i]->IsAwake() == false);
+		}
+	}
+}
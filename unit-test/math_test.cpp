@@ -42,13 +42,41 @@ DOCTEST_TEST_CASE("math test")
 		sweep.GetTransform(&transform, 0.0f);
 		DOCTEST_REQUIRE_EQ(transform.p.x, sweep.c0.x);
 		DOCTEST_REQUIRE_EQ(transform.p.y, sweep.c0.y);
-		DOCTEST_REQUIRE_EQ(transform.q.c, cosf(sweep.a0));
-		DOCTEST_REQUIRE_EQ(transform.q.s, sinf(sweep.a0));
+		DOCTEST_REQUIRE_EQ(transform.q.c, b2Cos(sweep.a0));
+		DOCTEST_REQUIRE_EQ(transform.q.s, b2Sin(sweep.a0));
 
 		sweep.GetTransform(&transform, 1.0f);
 		DOCTEST_REQUIRE_EQ(transform.p.x, sweep.c.x);
 		DOCTEST_REQUIRE_EQ(transform.p.y, sweep.c.y);
-		DOCTEST_REQUIRE_EQ(transform.q.c, cosf(sweep.a));
-		DOCTEST_REQUIRE_EQ(transform.q.s, sinf(sweep.a));
+		DOCTEST_REQUIRE_EQ(transform.q.c, b2Cos(sweep.a));
+		DOCTEST_REQUIRE_EQ(transform.q.s, b2Sin(sweep.a));
+	}
+
+	SUBCASE("portable trig")
+	{
+		for (int32 i = -1000; i <= 1000; ++i)
+		{
+			float angle = 0.01f * i;
+			CHECK(b2Abs(b2ComputeSin(angle) - sinf(angle)) < 1e-6f);
+			CHECK(b2Abs(b2ComputeCos(angle) - cosf(angle)) < 1e-6f);
+
+			float x = cosf(1.7f * angle) * (1.0f + 0.1f * i);
+			float y = sinf(1.3f * angle) * (2.0f - 0.01f * i);
+			CHECK(b2Abs(b2ComputeAtan2(y, x) - atan2f(y, x)) < 1e-6f);
+		}
+
+		CHECK(b2ComputeAtan2(0.0f, 0.0f) == 0.0f);
+		CHECK(b2ComputeAtan2(0.0f, -1.0f) == b2_pi);
+	}
+
+	SUBCASE("portable exp")
+	{
+		for (int32 i = -2000; i <= 1000; ++i)
+		{
+			float x = 0.01f * i;
+			CHECK(b2Abs(b2ComputeExp(x) - expf(x)) <= 1e-6f * expf(x));
+		}
+
+		CHECK(b2ComputeExp(0.0f) == 1.0f);
 	}
 }
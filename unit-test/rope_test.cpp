@@ -0,0 +1,455 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "box2d/box2d.h"
+#include "box2d/b2_rope_system.h"
+#include "doctest.h"
+
+#include <math.h>
+
+// A horizontal rope with the first vertex pinned.
+static int32 CreateRope(b2RopeSystem* system, const b2Vec2& position, int32 count, const b2RopeTuning& tuning)
+{
+	b2Vec2 vertices[40];
+	float masses[40];
+	b2Assert(count <= 40);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		vertices[i].Set(0.25f * i, 0.0f);
+		masses[i] = i == 0 ? 0.0f : 1.0f;
+	}
+
+	b2RopeDef def;
+	def.position = position;
+	def.vertices = vertices;
+	def.count = count;
+	def.masses = masses;
+	def.gravity.Set(0.0f, -10.0f);
+	def.tuning = tuning;
+
+	// b2RopeTuning doesn't initialize these.
+	def.tuning.stretchHertz = 30.0f;
+	def.tuning.stretchDamping = 4.0f;
+	return system->CreateRope(def);
+}
+
+DOCTEST_TEST_CASE("rope system hangs")
+{
+	b2RopeTuning tuning;
+	tuning.bendingModel = b2_pbdTriangleBendingModel;
+	tuning.stretchingModel = b2_pbdStretchingModel;
+	tuning.stretchStiffness = 1.0f;
+	tuning.bendStiffness = 0.1f;
+	tuning.damping = 2.0f;
+
+	b2RopeSystem system(nullptr);
+	int32 index = CreateRope(&system, b2Vec2(1.0f, 10.0f), 21, tuning);
+	CHECK(system.GetRopeCount() == 1);
+	CHECK(system.GetVertexCount(index) == 21);
+
+	for (int32 i = 0; i < 600; ++i)
+	{
+		system.Step(1.0f / 60.0f, 8);
+	}
+
+	// The pinned vertex doesn't move and the rope hangs below it at about its rest length.
+	b2Vec2 anchor = system.GetVertex(index, 0);
+	CHECK(anchor.x == doctest::Approx(1.0f));
+	CHECK(anchor.y == doctest::Approx(10.0f));
+
+	b2Vec2 end = system.GetVertex(index, 20);
+	CHECK(b2Abs(end.x - 1.0f) < 0.5f);
+	CHECK(end.y < 5.5f);
+	CHECK(end.y > 4.5f);
+
+	for (int32 i = 0; i < 20; ++i)
+	{
+		float length = b2Distance(system.GetVertex(index, i), system.GetVertex(index, i + 1));
+		CHECK(length == doctest::Approx(0.25f).epsilon(0.05f));
+	}
+
+	// Moving the rope moves the pinned vertex.
+	system.SetPosition(index, b2Vec2(3.0f, 10.0f));
+	system.Step(1.0f / 60.0f, 8);
+	CHECK(system.GetVertex(index, 0).x == doctest::Approx(3.0f));
+
+	system.Reset(index, b2Vec2(0.0f, 0.0f));
+	CHECK(system.GetVertex(index, 20).x == doctest::Approx(5.0f));
+	CHECK(system.GetVertex(index, 20).y == 0.0f);
+}
+
+DOCTEST_TEST_CASE("rope system bending models")
+{
+	b2BendingModel models[] =
+	{
+		b2_springAngleBendingModel,
+		b2_pbdAngleBendingModel,
+		b2_xpbdAngleBendingModel,
+		b2_pbdDistanceBendingModel,
+		b2_pbdHeightBendingModel,
+		b2_pbdTriangleBendingModel
+	};
+
+	b2RopeSystem system(nullptr);
+
+	int32 modelCount = sizeof(models) / sizeof(models[0]);
+	for (int32 i = 0; i < modelCount; ++i)
+	{
+		for (int32 j = 0; j < 2; ++j)
+		{
+			b2RopeTuning tuning;
+			tuning.bendingModel = models[i];
+			tuning.stretchingModel = j == 0 ? b2_pbdStretchingModel : b2_xpbdStretchingModel;
+			tuning.isometric = (i % 2) == 0;
+			tuning.fixedEffectiveMass = j == 1;
+
+			// Vary the vertex count so the colors have padding.
+			CreateRope(&system, b2Vec2(10.0f * i, 5.0f * j), 9 + i + j, tuning);
+		}
+	}
+
+	for (int32 i = 0; i < 120; ++i)
+	{
+		system.Step(1.0f / 60.0f, 4);
+	}
+
+	for (int32 i = 0; i < system.GetRopeCount(); ++i)
+	{
+		for (int32 j = 0; j < system.GetVertexCount(i); ++j)
+		{
+			b2Vec2 p = system.GetVertex(i, j);
+			CHECK(p.IsValid());
+			CHECK(b2Distance(p, system.GetVertex(i, 0)) < 0.25f * system.GetVertexCount(i) + 0.5f);
+		}
+	}
+}
+
+DOCTEST_TEST_CASE("rope system destroy")
+{
+	b2RopeTuning tuning;
+	tuning.bendingModel = b2_xpbdAngleBendingModel;
+	tuning.stretchingModel = b2_xpbdStretchingModel;
+
+	b2RopeSystem system(nullptr);
+	b2RopeSystem reference(nullptr);
+
+	for (int32 i = 0; i < 4; ++i)
+	{
+		CreateRope(&system, b2Vec2(0.0f, 2.0f * i), 10 + i, tuning);
+	}
+
+	CreateRope(&reference, b2Vec2(0.0f, 6.0f), 13, tuning);
+	CreateRope(&reference, b2Vec2(0.0f, 2.0f), 11, tuning);
+
+	for (int32 i = 0; i < 30; ++i)
+	{
+		system.Step(1.0f / 60.0f, 6);
+		reference.Step(1.0f / 60.0f, 6);
+	}
+
+	// Rope 3 takes index 0, then rope 2 takes index 2.
+	system.DestroyRope(0);
+	system.DestroyRope(2);
+	REQUIRE(system.GetRopeCount() == 2);
+
+	// Ropes are independent so the survivors match ropes stepped without the others.
+	for (int32 i = 0; i < 30; ++i)
+	{
+		system.Step(1.0f / 60.0f, 6);
+		reference.Step(1.0f / 60.0f, 6);
+	}
+
+	for (int32 i = 0; i < 2; ++i)
+	{
+		REQUIRE(system.GetVertexCount(i) == reference.GetVertexCount(i));
+		for (int32 j = 0; j < system.GetVertexCount(i); ++j)
+		{
+			b2Vec2 p1 = system.GetVertex(i, j);
+			b2Vec2 p2 = reference.GetVertex(i, j);
+			CHECK(p1.x == p2.x);
+			CHECK(p1.y == p2.y);
+		}
+	}
+
+	// A new rope reuses the space.
+	int32 index = CreateRope(&system, b2Vec2(5.0f, 5.0f), 12, tuning);
+	CHECK(index == 2);
+	CHECK(system.GetVertex(index, 0).x == 5.0f);
+}
+
+DOCTEST_TEST_CASE("rope system threads")
+{
+	b2ThreadPool pool(3);
+	b2RopeSystem threaded(&pool);
+	b2RopeSystem serial(nullptr);
+
+	b2RopeTuning tuning;
+	tuning.bendingModel = b2_springAngleBendingModel;
+	tuning.stretchingModel = b2_xpbdStretchingModel;
+	tuning.damping = 0.1f;
+
+	for (int32 i = 0; i < 64; ++i)
+	{
+		b2Vec2 position(2.0f * (i % 8), 2.0f * (i / 8));
+		CreateRope(&threaded, position, 8 + i % 13, tuning);
+		CreateRope(&serial, position, 8 + i % 13, tuning);
+	}
+
+	for (int32 i = 0; i < 60; ++i)
+	{
+		threaded.Step(1.0f / 60.0f, 6);
+		serial.Step(1.0f / 60.0f, 6);
+	}
+
+	// Each rope is stepped by one thread so the results are identical.
+	bool same = true;
+	for (int32 i = 0; i < threaded.GetRopeCount(); ++i)
+	{
+		for (int32 j = 0; j < threaded.GetVertexCount(i); ++j)
+		{
+			b2Vec2 p1 = threaded.GetVertex(i, j);
+			b2Vec2 p2 = serial.GetVertex(i, j);
+			same = same && p1.x == p2.x && p1.y == p2.y;
+		}
+	}
+
+	CHECK(same);
+}
+
+DOCTEST_TEST_CASE("rope system attachments")
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+
+	b2BodyDef bodyDef;
+	b2Body* ground = world.CreateBody(&bodyDef);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.position.Set(2.25f, 10.0f);
+	b2Body* crate = world.CreateBody(&bodyDef);
+	crate->CreateFixture(&box, 1.0f);
+
+	b2RopeTuning tuning;
+	tuning.bendingModel = b2_pbdTriangleBendingModel;
+	tuning.damping = 1.0f;
+
+	b2RopeSystem system(nullptr);
+	system.SetWorld(&world);
+	int32 index = CreateRope(&system, b2Vec2(0.0f, 10.0f), 10, tuning);
+
+	// The pinned vertex follows the ground and the last vertex holds up the crate.
+	system.Attach(index, 0, ground, b2Vec2(0.0f, 10.0f));
+	system.Attach(index, 9, crate, b2Vec2_zero);
+	system.Attach(index, 9, crate, b2Vec2_zero);
+	CHECK(system.GetAttachmentCount(index) == 2);
+
+	for (int32 i = 0; i < 300; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+		system.Step(1.0f / 60.0f, 8);
+	}
+
+	// The crate hangs below the anchor instead of falling away.
+	b2Vec2 position = crate->GetPosition();
+	CHECK(position.y < 8.5f);
+	CHECK(position.y > 6.0f);
+	CHECK(b2Abs(position.x) < 1.0f);
+	CHECK(b2Distance(system.GetVertex(index, 9), position) < 0.1f);
+	CHECK(b2Distance(system.GetVertex(index, 0), b2Vec2(0.0f, 10.0f)) < 0.01f);
+
+	// Without the rope the crate falls.
+	system.DetachBody(crate);
+	CHECK(system.GetAttachmentCount(index) == 1);
+
+	for (int32 i = 0; i < 60; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+		system.Step(1.0f / 60.0f, 8);
+	}
+
+	CHECK(crate->GetPosition().y < position.y - 3.0f);
+
+	// Shifting the origin moves the ropes with the world.
+	b2Vec2 vertex = system.GetVertex(index, 5);
+	world.ShiftOrigin(b2Vec2(1.0f, 2.0f));
+	system.ShiftOrigin(b2Vec2(1.0f, 2.0f));
+	CHECK(system.GetVertex(index, 5).x == doctest::Approx(vertex.x - 1.0f));
+	CHECK(system.GetVertex(index, 5).y == doctest::Approx(vertex.y - 2.0f));
+}
+
+// Moves a rope system with the world origin.
+class RopeOriginListener : public b2OriginListener
+{
+public:
+	void ShiftOrigin(b2World* world, const b2Vec2& newOrigin) override
+	{
+		B2_NOT_USED(world);
+		system->ShiftOrigin(newOrigin);
+		++shiftCount;
+	}
+
+	b2RopeSystem* system;
+	int32 shiftCount;
+};
+
+DOCTEST_TEST_CASE("rope system recentering")
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	world.SetRecenterDistance(16.0f);
+
+	b2BodyDef bodyDef;
+	b2Body* ground = world.CreateBody(&bodyDef);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.position.Set(2.25f, 10.0f);
+	b2Body* crate = world.CreateBody(&bodyDef);
+	crate->CreateFixture(&box, 1.0f);
+
+	b2RopeTuning tuning;
+	tuning.bendingModel = b2_pbdTriangleBendingModel;
+	tuning.damping = 1.0f;
+
+	b2RopeSystem system(nullptr);
+	system.SetWorld(&world);
+	int32 index = CreateRope(&system, b2Vec2(0.0f, 10.0f), 10, tuning);
+	system.Attach(index, 0, ground, b2Vec2(0.0f, 10.0f));
+	system.Attach(index, 9, crate, b2Vec2_zero);
+
+	RopeOriginListener listener;
+	listener.system = &system;
+	listener.shiftCount = 0;
+	world.SetOriginListener(&listener);
+
+	for (int32 i = 0; i < 120; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+		system.Step(1.0f / 60.0f, 8);
+	}
+
+	CHECK(listener.shiftCount == 0);
+	b2Vec2d vertex = world.GetAbsolutePoint(system.GetVertex(index, 9));
+
+	// The focus is past the distance, so the next step recenters the world and the
+	// listener moves the ropes along.
+	world.SetFocus(b2Vec2(40.0f, 0.0f));
+	world.Step(1.0f / 60.0f, 8, 3);
+	system.Step(1.0f / 60.0f, 8);
+
+	CHECK(listener.shiftCount == 1);
+	CHECK(world.GetOrigin().x == 48.0);
+	CHECK(world.GetFocus().x == -8.0f);
+
+	b2Vec2d shifted = world.GetAbsolutePoint(system.GetVertex(index, 9));
+	CHECK(b2Abs(float(shifted.x - vertex.x)) < 0.1f);
+	CHECK(b2Abs(float(shifted.y - vertex.y)) < 0.1f);
+	CHECK(b2Distance(system.GetVertex(index, 9), crate->GetPosition()) < 0.1f);
+}
+
+DOCTEST_TEST_CASE("rope system collision")
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+
+	b2BodyDef bodyDef;
+	b2Body* ground = world.CreateBody(&bodyDef);
+
+	b2EdgeShape edge;
+	edge.SetTwoSided(b2Vec2(-20.0f, 0.0f), b2Vec2(20.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2RopeTuning tuning;
+	tuning.bendingModel = b2_pbdTriangleBendingModel;
+	tuning.damping = 0.5f;
+
+	b2RopeSystem system(nullptr);
+	system.SetWorld(&world);
+
+	// A rope that drapes on the ground and one that ignores the ground.
+	int32 draped = CreateRope(&system, b2Vec2(0.0f, 2.0f), 30, tuning);
+	system.SetRadius(draped, 0.1f);
+	CHECK(system.GetRadius(draped) == 0.1f);
+
+	int32 filtered = CreateRope(&system, b2Vec2(0.0f, 2.0f), 30, tuning);
+	system.SetRadius(filtered, 0.1f);
+	b2Filter filter;
+	filter.maskBits = 0;
+	system.SetFilterData(filtered, filter);
+
+	for (int32 i = 0; i < 180; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+		system.Step(1.0f / 60.0f, 8);
+	}
+
+	CHECK(system.GetContactCount() > 0);
+
+	float minY1 = FLT_MAX;
+	float minY2 = FLT_MAX;
+	for (int32 i = 0; i < 30; ++i)
+	{
+		minY1 = b2Min(minY1, system.GetVertex(draped, i).y);
+		minY2 = b2Min(minY2, system.GetVertex(filtered, i).y);
+	}
+
+	CHECK(minY1 > 0.1f - 2.0f * b2_linearSlop);
+	CHECK(minY1 < 0.2f);
+	CHECK(minY2 < -1.0f);
+}
+
+DOCTEST_TEST_CASE("rope system pushes bodies")
+{
+	// No world gravity, so only the rope moves the ball.
+	b2World world(b2Vec2(0.0f, 0.0f));
+
+	b2BodyDef bodyDef;
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.position.Set(1.0f, -1.0f);
+	b2Body* ball = world.CreateBody(&bodyDef);
+
+	b2CircleShape circle;
+	circle.m_radius = 0.5f;
+	ball->CreateFixture(&circle, 1.0f);
+
+	b2RopeTuning tuning;
+	tuning.bendingModel = b2_pbdTriangleBendingModel;
+
+	b2RopeSystem system(nullptr);
+	system.SetWorld(&world);
+	int32 index = CreateRope(&system, b2Vec2(0.0f, 0.0f), 12, tuning);
+	system.SetRadius(index, 0.05f);
+
+	for (int32 i = 0; i < 30; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+		system.Step(1.0f / 60.0f, 8);
+	}
+
+	// The falling rope hits the ball and pushes it down.
+	CHECK(ball->GetLinearVelocity().y < 0.0f);
+	CHECK(ball->GetPosition().y < -1.0f);
+}
@@ -0,0 +1,169 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/box2d.h"
+#include "doctest.h"
+
+#include <atomic>
+#include <thread>
+
+static void CreateScene(b2World* world, int32 seed)
+{
+	b2BodyDef groundDef;
+	b2Body* ground = world->CreateBody(&groundDef);
+
+	b2EdgeShape edge;
+	edge.SetTwoSided(b2Vec2(-20.0f, 0.0f), b2Vec2(20.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	b2CircleShape circle;
+	circle.m_radius = 0.5f;
+
+	// Vary the scenes so the worlds take different amounts of time.
+	int32 count = 4 + 3 * (seed % 5);
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2BodyDef bodyDef;
+		bodyDef.type = b2_dynamicBody;
+		bodyDef.position.Set(0.2f * (i % 3) - 0.1f * seed, 0.5f + 1.1f * i);
+		b2Body* body = world->CreateBody(&bodyDef);
+
+		if ((i + seed) % 2 == 0)
+		{
+			body->CreateFixture(&box, 1.0f);
+		}
+		else
+		{
+			body->CreateFixture(&circle, 1.0f);
+		}
+	}
+}
+
+static void SumTask(int32 begin, int32 end, int32 threadIndex, void* context)
+{
+	B2_NOT_USED(threadIndex);
+
+	std::atomic<int32>* sum = (std::atomic<int32>*)context;
+	for (int32 i = begin; i < end; ++i)
+	{
+		sum->fetch_add(i);
+	}
+}
+
+DOCTEST_TEST_CASE("thread pool")
+{
+	b2ThreadPool pool(3);
+	CHECK(pool.GetThreadCount() == 4);
+
+	for (int32 pass = 0; pass < 50; ++pass)
+	{
+		std::atomic<int32> sum(0);
+		int32 count = 1000 + 37 * pass;
+		pool.ParallelFor(count, 7, SumTask, &sum);
+		REQUIRE(sum.load() == count * (count - 1) / 2);
+	}
+}
+
+DOCTEST_TEST_CASE("thread pool shared by threads")
+{
+	b2ThreadPool pool(3);
+
+	// Loops started from several threads at once run one after the other.
+	std::atomic<int32> failures(0);
+	auto user = [&](int32 seed)
+	{
+		for (int32 pass = 0; pass < 50; ++pass)
+		{
+			std::atomic<int32> sum(0);
+			int32 count = 1000 + 37 * pass + seed;
+			pool.ParallelFor(count, 7, SumTask, &sum);
+			if (sum.load() != count * (count - 1) / 2)
+			{
+				failures.fetch_add(1);
+			}
+		}
+	};
+
+	std::thread thread1(user, 1);
+	std::thread thread2(user, 2);
+	user(3);
+	thread1.join();
+	thread2.join();
+
+	CHECK(failures.load() == 0);
+}
+
+DOCTEST_TEST_CASE("world group")
+{
+	const int32 worldCount = 16;
+
+	b2World* worlds[worldCount];
+	b2World* references[worldCount];
+	for (int32 i = 0; i < worldCount; ++i)
+	{
+		worlds[i] = new b2World(b2Vec2(0.0f, -10.0f));
+		references[i] = new b2World(b2Vec2(0.0f, -10.0f));
+		CreateScene(worlds[i], i);
+		CreateScene(references[i], i);
+	}
+
+	b2ThreadPool pool(3);
+	b2WorldGroup group(&pool);
+	for (int32 i = 0; i < worldCount; ++i)
+	{
+		CHECK(group.AddWorld(worlds[i]) == i);
+	}
+
+	for (int32 step = 0; step < 60; ++step)
+	{
+		group.Step(1.0f / 60.0f, 8, 3);
+		for (int32 i = 0; i < worldCount; ++i)
+		{
+			references[i]->Step(1.0f / 60.0f, 8, 3);
+		}
+	}
+
+	// Stepping on the pool gives the same result as stepping one at a time.
+	for (int32 i = 0; i < worldCount; ++i)
+	{
+		CHECK(worlds[i]->ComputeStateHash() == references[i]->ComputeStateHash());
+		CHECK(worlds[i]->GetCounters().contactUpdates == references[i]->GetCounters().contactUpdates);
+		CHECK(group.GetStepTime(i) >= 0.0f);
+	}
+
+	int32 slowest = group.GetSlowestWorld();
+	CHECK(0 <= slowest);
+	CHECK(slowest < worldCount);
+
+	group.RemoveWorld(worlds[0]);
+	CHECK(group.GetWorldCount() == worldCount - 1);
+	CHECK(group.GetWorld(0) == worlds[worldCount - 1]);
+
+	for (int32 i = 0; i < worldCount; ++i)
+	{
+		delete worlds[i];
+		delete references[i];
+	}
+}
@@ -22,7 +22,10 @@
 
 #include "box2d/box2d.h"
 #include "doctest.h"
+#include <atomic>
+#include <chrono>
 #include <stdio.h>
+#include <thread>
 
 static bool begin_contact = false;
 
@@ -71,3 +74,1353 @@ DOCTEST_TEST_CASE("begin contact")
 	CHECK(world.GetContactList() != nullptr);
 	CHECK(begin_contact == true);
 }
+
+DOCTEST_TEST_CASE("bullets do not tunnel")
+{
+	b2World world(b2Vec2(0.0f, 0.0f));
+
+	{
+		b2BodyDef bodyDef;
+		b2Body* ground = world.CreateBody(&bodyDef);
+
+		b2EdgeShape wall;
+		wall.SetTwoSided(b2Vec2(10.0f, -20.0f), b2Vec2(10.0f, 20.0f));
+		ground->CreateFixture(&wall, 0.0f);
+	}
+
+	b2PolygonShape box;
+	box.SetAsBox(0.1f, 0.1f);
+
+	const int32 bulletCount = 20;
+	b2Body* bullets[bulletCount];
+	for (int32 i = 0; i < bulletCount; ++i)
+	{
+		b2BodyDef bodyDef;
+		bodyDef.type = b2_dynamicBody;
+		bodyDef.bullet = true;
+		bodyDef.position.Set(0.0f, -10.0f + 1.0f * i);
+		bodyDef.linearVelocity.Set(300.0f + 10.0f * i, 0.0f);
+		bullets[i] = world.CreateBody(&bodyDef);
+		bullets[i]->CreateFixture(&box, 1.0f);
+	}
+
+	for (int32 i = 0; i < 30; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+
+	for (int32 i = 0; i < bulletCount; ++i)
+	{
+		CHECK(bullets[i]->GetPosition().x < 10.0f);
+	}
+}
+
+DOCTEST_TEST_CASE("soft step pyramid")
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	world.SetSoftStep(true);
+	world.SetSubStepCount(4);
+	world.SetAllowSleeping(false);
+
+	{
+		b2BodyDef bodyDef;
+		b2Body* ground = world.CreateBody(&bodyDef);
+
+		b2EdgeShape shape;
+		shape.SetTwoSided(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+		ground->CreateFixture(&shape, 0.0f);
+	}
+
+	const float a = 0.5f;
+	b2PolygonShape box;
+	box.SetAsBox(a, a);
+
+	const int32 baseCount = 10;
+	b2Body* bodies[baseCount * (baseCount + 1) / 2];
+	b2Vec2 positions[baseCount * (baseCount + 1) / 2];
+	int32 bodyCount = 0;
+
+	for (int32 i = 0; i < baseCount; ++i)
+	{
+		float y = (2.0f * i + 1.0f) * a;
+		for (int32 j = i; j < baseCount; ++j)
+		{
+			float x = (i + 1.0f) * a + 2.0f * (j - i) * a - baseCount * a;
+
+			b2BodyDef bodyDef;
+			bodyDef.type = b2_dynamicBody;
+			bodyDef.position.Set(x, y);
+			b2Body* body = world.CreateBody(&bodyDef);
+			body->CreateFixture(&box, 5.0f);
+
+			bodies[bodyCount] = body;
+			positions[bodyCount] = bodyDef.position;
+			++bodyCount;
+		}
+	}
+
+	// The velocity iterations are ignored by the soft step solver.
+	for (int32 i = 0; i < 300; ++i)
+	{
+		world.Step(1.0f / 60.0f, 1, 1);
+	}
+
+	// Each layer rests on the polygon skin, so the upper layers rise slightly.
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Vec2 d = bodies[i]->GetPosition() - positions[i];
+		CHECK(b2Abs(d.x) < 0.15f);
+		CHECK(b2Abs(d.y) < 0.25f);
+		CHECK(b2Abs(bodies[i]->GetAngle()) < 0.02f);
+		CHECK(bodies[i]->GetLinearVelocity().Length() < 0.01f);
+	}
+}
+
+DOCTEST_TEST_CASE("manifold reuse")
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	world.SetAllowSleeping(false);
+
+	{
+		b2BodyDef bodyDef;
+		b2Body* ground = world.CreateBody(&bodyDef);
+
+		b2PolygonShape shape;
+		shape.SetAsBox(10.0f, 0.5f);
+		ground->CreateFixture(&shape, 0.0f);
+	}
+
+	b2BodyDef bodyDef;
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.position.Set(0.0f, 1.0f);
+	b2Body* body = world.CreateBody(&bodyDef);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+	body->CreateFixture(&box, 1.0f);
+
+	for (int32 i = 0; i < 120; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+
+	// The box is at rest so the manifold is reused.
+	world.Step(1.0f / 60.0f, 8, 3);
+	const b2Counters& counters = world.GetCounters();
+	CHECK(counters.contactUpdates == 1);
+	CHECK(counters.manifoldReuses == 1);
+	CHECK(world.GetContactList()->IsTouching());
+	CHECK(b2Abs(body->GetPosition().y - 1.0f) < 2.0f * b2_polygonRadius);
+
+	// Moving the box forces a new evaluation.
+	body->SetTransform(body->GetPosition() + b2Vec2(1.0f, 0.0f), 0.0f);
+	world.Step(1.0f / 60.0f, 8, 3);
+	CHECK(counters.contactUpdates == 1);
+	CHECK(counters.manifoldReuses == 0);
+	CHECK(world.GetContactList()->IsTouching());
+}
+
+DOCTEST_TEST_CASE("gjk warm starting")
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	world.SetAllowSleeping(false);
+
+	b2BodyDef groundDef;
+	b2Body* ground = world.CreateBody(&groundDef);
+
+	b2EdgeShape edge;
+	edge.SetTwoSided(b2Vec2(-10.0f, 0.0f), b2Vec2(10.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2CircleShape circle;
+	circle.m_radius = 4.0f;
+	b2FixtureDef sensorDef;
+	sensorDef.shape = &circle;
+	sensorDef.isSensor = true;
+	ground->CreateFixture(&sensorDef);
+
+	b2BodyDef bodyDef;
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.position.Set(0.0f, 0.5f);
+	b2Body* body = world.CreateBody(&bodyDef);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+	body->CreateFixture(&box, 1.0f);
+
+	for (int32 i = 0; i < 60; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+
+	// The sensor overlap test and the time of impact reuse the simplex from
+	// the previous step and converge right away.
+	world.Step(1.0f / 60.0f, 8, 3);
+	const b2Counters& counters = world.GetCounters();
+	CHECK(counters.toiCalls == 1);
+	CHECK(counters.gjkCalls >= 2);
+	CHECK(counters.gjkIters <= counters.gjkCalls);
+}
+
+static void CreateStack(b2World* world)
+{
+	b2BodyDef groundDef;
+	b2Body* ground = world->CreateBody(&groundDef);
+
+	b2EdgeShape edge;
+	edge.SetTwoSided(b2Vec2(-20.0f, 0.0f), b2Vec2(20.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	for (int32 i = 0; i < 10; ++i)
+	{
+		b2BodyDef bodyDef;
+		bodyDef.type = b2_dynamicBody;
+		bodyDef.position.Set(0.1f * i, 0.5f + 1.0f * i);
+		bodyDef.angle = 0.05f * i;
+		b2Body* body = world->CreateBody(&bodyDef);
+		body->CreateFixture(&box, 1.0f);
+	}
+}
+
+DOCTEST_TEST_CASE("state hash")
+{
+	b2World world1(b2Vec2(0.0f, -10.0f));
+	b2World world2(b2Vec2(0.0f, -10.0f));
+	CreateStack(&world1);
+	CreateStack(&world2);
+
+	for (int32 i = 0; i < 120; ++i)
+	{
+		world1.Step(1.0f / 60.0f, 8, 3);
+		world2.Step(1.0f / 60.0f, 8, 3);
+		REQUIRE(world1.ComputeStateHash() == world2.ComputeStateHash());
+		REQUIRE(world1.GetStepHash() == world2.GetStepHash());
+	}
+
+	// A tiny change is detected.
+	b2Body* body = world2.GetBodyList();
+	body->SetLinearVelocity(body->GetLinearVelocity() + b2Vec2(1e-6f, 0.0f));
+	CHECK(world1.ComputeStateHash() != world2.ComputeStateHash());
+
+	world1.Step(1.0f / 60.0f, 8, 3);
+	world2.Step(1.0f / 60.0f, 8, 3);
+	CHECK(world1.GetStepHash() != world2.GetStepHash());
+}
+
+DOCTEST_TEST_CASE("region streaming")
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+
+	// A long strip of ground tiles, each with a floor and a few bumps.
+	const int32 regionCount = 200;
+	const float tileWidth = 10.0f;
+
+	b2EdgeShape floor;
+	floor.SetTwoSided(b2Vec2(-0.5f * tileWidth, 0.0f), b2Vec2(0.5f * tileWidth, 0.0f));
+
+	b2PolygonShape bump;
+	bump.SetAsBox(0.25f, 0.25f, b2Vec2(2.0f, 0.25f), 0.0f);
+
+	b2FixtureDef fixtureDefs[2];
+	fixtureDefs[0].shape = &floor;
+	fixtureDefs[1].shape = &bump;
+
+	b2RegionStreamer streamer(&world);
+	streamer.SetDistances(20.0f, 30.0f);
+	for (int32 i = 0; i < regionCount; ++i)
+	{
+		b2RegionDef def;
+		def.position.Set(tileWidth * i, 0.0f);
+		def.fixtures = fixtureDefs;
+		def.fixtureCount = 2;
+		CHECK(streamer.AddRegion(&def) == i);
+	}
+
+	CHECK(world.GetBodyCount() == 0);
+
+	b2BodyDef bodyDef;
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.position.Set(0.0f, 2.0f);
+	b2Body* body = world.CreateBody(&bodyDef);
+	b2CircleShape circle;
+	circle.m_radius = 0.5f;
+	body->CreateFixture(&circle, 1.0f);
+
+	b2Vec2 point = body->GetPosition();
+	streamer.Update(&point, 1);
+
+	// Only the regions near the body are loaded.
+	CHECK(streamer.GetLoadedCount() == 3);
+	CHECK(streamer.IsLoaded(0));
+	CHECK(streamer.IsLoaded(2));
+	CHECK(streamer.IsLoaded(3) == false);
+	CHECK(world.GetProxyCount() == 1 + 2 * 3);
+
+	// The body lands on the streamed ground.
+	for (int32 i = 0; i < 120; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+
+	CHECK(b2Abs(body->GetPosition().y - 0.5f) < 0.05f);
+	CHECK(world.GetContactCount() > 0);
+
+	// Moving the point of interest far away streams the old regions out.
+	body->SetTransform(b2Vec2(1000.0f, 2.0f), 0.0f);
+	point = body->GetPosition();
+	streamer.Update(&point, 1);
+
+	CHECK(streamer.IsLoaded(0) == false);
+	CHECK(streamer.IsLoaded(100));
+	CHECK(streamer.GetLoadedCount() == 5);
+	CHECK(world.GetBodyCount() == 1 + 5);
+	CHECK(world.GetProxyCount() == 1 + 2 * 5);
+
+	for (int32 i = 0; i < 120; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+
+	CHECK(b2Abs(body->GetPosition().y - 0.5f) < 0.05f);
+}
+
+DOCTEST_TEST_CASE("large world recentering")
+{
+	b2World world(b2Vec2(0.0f, 0.0f));
+	world.SetOrigin(b2Vec2d(1.0e7, -3.0e6));
+	world.SetRecenterDistance(256.0f);
+
+	b2CircleShape circle;
+	circle.m_radius = 0.5f;
+
+	b2BodyDef bodyDef;
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.position = world.GetLocalPoint(b2Vec2d(1.0e7 + 1.0, -3.0e6 + 2.0));
+	bodyDef.linearVelocity.Set(100.0f, 0.0f);
+	b2Body* bodyA = world.CreateBody(&bodyDef);
+	bodyA->CreateFixture(&circle, 1.0f);
+
+	bodyDef.position.x += 2.0f;
+	b2Body* bodyB = world.CreateBody(&bodyDef);
+	bodyB->CreateFixture(&circle, 1.0f);
+
+	b2DistanceJointDef jointDef;
+	jointDef.Initialize(bodyA, bodyB, bodyA->GetPosition(), bodyB->GetPosition());
+	b2DistanceJoint* joint = (b2DistanceJoint*)world.CreateJoint(&jointDef);
+
+	for (int32 i = 0; i < 600; ++i)
+	{
+		world.SetFocus(bodyA->GetPosition());
+		world.Step(1.0f / 60.0f, 8, 3);
+
+		// The world stays near the origin.
+		REQUIRE(b2Abs(bodyA->GetPosition().x) < 256.0f + 2.0f);
+	}
+
+	// 10 seconds at 100 meters per second with no loss of precision.
+	b2Vec2d p = world.GetAbsolutePoint(bodyA->GetPosition());
+	CHECK(b2Abs(float(p.x - (1.0e7 + 1001.0))) < 0.01f);
+	CHECK(b2Abs(float(p.y - (-3.0e6 + 2.0))) < 0.01f);
+	CHECK(world.GetOrigin().x > 1.0e7 + 512.0);
+
+	// The joint anchors moved with the bodies.
+	b2Vec2 d = joint->GetAnchorB() - joint->GetAnchorA();
+	CHECK(b2Abs(d.Length() - 2.0f) < 0.01f);
+}
+
+DOCTEST_TEST_CASE("level of detail")
+{
+	b2World world(b2Vec2(0.0f, 0.0f));
+
+	b2LODLevel level;
+	level.distance = 100.0f;
+	level.stepInterval = 4;
+	level.velocityIterations = 2;
+	world.SetLODLevels(&level, 1);
+
+	b2Vec2 focus(0.0f, 0.0f);
+	world.SetLODFocusPoints(&focus, 1);
+
+	b2CircleShape circle;
+	circle.m_radius = 0.5f;
+
+	b2BodyDef bodyDef;
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.linearVelocity.Set(6.0f, 0.0f);
+
+	bodyDef.position.Set(0.0f, 0.0f);
+	b2Body* nearBody = world.CreateBody(&bodyDef);
+	nearBody->CreateFixture(&circle, 1.0f);
+
+	bodyDef.position.Set(200.0f, 0.0f);
+	b2Body* farBody = world.CreateBody(&bodyDef);
+	farBody->CreateFixture(&circle, 1.0f);
+
+	bodyDef.position.Set(0.0f, 200.0f);
+	bodyDef.allowLOD = false;
+	b2Body* fullBody = world.CreateBody(&bodyDef);
+	fullBody->CreateFixture(&circle, 1.0f);
+
+	float timeStep = 1.0f / 60.0f;
+	int32 farMoves = 0;
+	for (int32 i = 0; i < 60; ++i)
+	{
+		float nearX = nearBody->GetPosition().x;
+		float farX = farBody->GetPosition().x;
+		float fullX = fullBody->GetPosition().x;
+
+		world.Step(timeStep, 8, 3);
+
+		CHECK(nearBody->GetPosition().x > nearX);
+		CHECK(fullBody->GetPosition().x > fullX);
+		if (farBody->GetPosition().x > farX)
+		{
+			++farMoves;
+		}
+	}
+
+	// The far body is stepped every fourth step and still covers the full distance.
+	CHECK(farMoves == 15);
+	CHECK(b2Abs(farBody->GetPosition().x - 206.0f) < 0.01f);
+	CHECK(b2Abs(nearBody->GetPosition().x - 6.0f) < 0.01f);
+
+	// Disabling level of detail steps every island.
+	world.SetLODLevels(nullptr, 0);
+	float farX = farBody->GetPosition().x;
+	world.Step(timeStep, 8, 3);
+	CHECK(farBody->GetPosition().x > farX);
+}
+
+DOCTEST_TEST_CASE("level of detail warm starting")
+{
+	// A stack solved with one velocity iteration relies on warm starting. The impulses
+	// must be scaled by the time step change when the stack enters and leaves level
+	// of detail stepping.
+	b2World world(b2Vec2(0.0f, -10.0f));
+	world.SetAllowSleeping(false);
+
+	b2LODLevel level;
+	level.distance = 100.0f;
+	level.stepInterval = 4;
+	level.velocityIterations = 1;
+	level.positionIterations = 1;
+	world.SetLODLevels(&level, 1);
+
+	b2BodyDef bodyDef;
+	b2Body* ground = world.CreateBody(&bodyDef);
+
+	b2EdgeShape edge;
+	edge.SetTwoSided(b2Vec2(150.0f, 0.0f), b2Vec2(250.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	const int32 count = 10;
+	b2Body* boxes[count];
+	bodyDef.type = b2_dynamicBody;
+	for (int32 i = 0; i < count; ++i)
+	{
+		bodyDef.position.Set(200.0f, 0.5f + i);
+		boxes[i] = world.CreateBody(&bodyDef);
+		boxes[i]->CreateFixture(&box, 1.0f);
+	}
+
+	float timeStep = 1.0f / 60.0f;
+	for (int32 i = 0; i < 120; ++i)
+	{
+		world.Step(timeStep, 1, 1);
+	}
+
+	float maxSpeed = 0.0f;
+	for (int32 round = 0; round < 4; ++round)
+	{
+		b2Vec2 focus = round % 2 == 0 ? b2Vec2(0.0f, 0.0f) : b2Vec2(200.0f, 0.0f);
+		world.SetLODFocusPoints(&focus, 1);
+
+		for (int32 i = 0; i < 8; ++i)
+		{
+			world.Step(timeStep, 1, 1);
+
+			for (int32 j = 0; j < count; ++j)
+			{
+				maxSpeed = b2Max(maxSpeed, boxes[j]->GetLinearVelocity().Length());
+			}
+		}
+	}
+
+	CHECK(maxSpeed < 0.6f);
+	CHECK(boxes[count - 1]->GetPosition().y > 9.3f);
+}
+
+DOCTEST_TEST_CASE("island sleeping")
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+
+	b2BodyDef groundDef;
+	b2Body* ground = world.CreateBody(&groundDef);
+
+	b2EdgeShape edge;
+	edge.SetTwoSided(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	// Two separate stacks.
+	b2Body* topA = nullptr;
+	b2Body* bottomB = nullptr;
+	for (int32 i = 0; i < 5; ++i)
+	{
+		b2BodyDef bodyDef;
+		bodyDef.type = b2_dynamicBody;
+		bodyDef.position.Set(-10.0f, 0.5f + 1.0f * i);
+		topA = world.CreateBody(&bodyDef);
+		topA->CreateFixture(&box, 1.0f);
+
+		bodyDef.position.Set(10.0f, 0.5f + 1.0f * i);
+		b2Body* body = world.CreateBody(&bodyDef);
+		body->CreateFixture(&box, 1.0f);
+		if (i == 0)
+		{
+			bottomB = body;
+		}
+	}
+
+	CHECK(world.GetAwakeBodyCount() == 10);
+
+	for (int32 i = 0; i < 300 && world.GetAwakeBodyCount() > 0; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+
+	REQUIRE(world.GetAwakeBodyCount() == 0);
+
+	// Stepping a sleeping world visits no contacts.
+	world.Step(1.0f / 60.0f, 8, 3);
+	CHECK(world.GetAwakeBodyCount() == 0);
+
+	// Waking the top of one stack wakes that whole stack right away.
+	topA->SetAwake(true);
+	CHECK(world.GetAwakeBodyCount() == 5);
+	CHECK(bottomB->IsAwake() == false);
+	for (b2ContactEdge* ce = topA->GetContactList(); ce; ce = ce->next)
+	{
+		CHECK(ce->other->IsAwake());
+	}
+
+	// Putting a body to sleep outside the step removes it immediately.
+	topA->SetAwake(false);
+	CHECK(world.GetAwakeBodyCount() == 4);
+
+	// The stack falls back asleep as a unit.
+	for (int32 i = 0; i < 300 && world.GetAwakeBodyCount() > 0; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+		CHECK(bottomB->IsAwake() == false);
+	}
+
+	CHECK(world.GetAwakeBodyCount() == 0);
+
+	// Destroying an awake body keeps the awake set consistent.
+	bottomB->SetAwake(true);
+	CHECK(world.GetAwakeBodyCount() == 5);
+	world.DestroyBody(bottomB);
+	CHECK(world.GetAwakeBodyCount() == 4);
+	world.Step(1.0f / 60.0f, 8, 3);
+	CHECK(world.GetAwakeBodyCount() == 4);
+}
+
+DOCTEST_TEST_CASE("filtering sleeping contacts")
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+
+	class EndContactCounter : public b2ContactListener
+	{
+	public:
+		void EndContact(b2Contact* contact) override
+		{
+			B2_NOT_USED(contact);
+			++count;
+		}
+
+		int32 count = 0;
+	};
+
+	EndContactCounter listener;
+	world.SetContactListener(&listener);
+
+	b2BodyDef groundDef;
+	b2Body* ground = world.CreateBody(&groundDef);
+
+	b2EdgeShape edge;
+	edge.SetTwoSided(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	b2Body* bodies[5];
+	for (int32 i = 0; i < 5; ++i)
+	{
+		b2BodyDef bodyDef;
+		bodyDef.type = b2_dynamicBody;
+		bodyDef.position.Set(0.0f, 0.5f + 1.0f * i);
+		bodies[i] = world.CreateBody(&bodyDef);
+		bodies[i]->CreateFixture(&box, 1.0f);
+	}
+
+	for (int32 i = 0; i < 300 && world.GetAwakeBodyCount() > 0; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+
+	REQUIRE(world.GetAwakeBodyCount() == 0);
+	REQUIRE(world.GetContactCount() == 5);
+	REQUIRE(listener.count == 0);
+
+	// The middle box stops colliding with its neighbors.
+	b2Filter filter;
+	filter.maskBits = 0;
+	bodies[2]->GetFixtureList()->SetFilterData(filter);
+
+	// The top two boxes are joined without colliding.
+	b2RevoluteJointDef jointDef;
+	jointDef.Initialize(bodies[3], bodies[4], bodies[4]->GetPosition());
+	world.CreateJoint(&jointDef);
+
+	world.Step(1.0f / 60.0f, 8, 3);
+
+	CHECK(listener.count == 3);
+	CHECK(world.GetContactCount() == 2);
+}
+
+DOCTEST_TEST_CASE("threaded fixture synchronization")
+{
+	b2ThreadPool pool(3);
+	b2World world1(b2Vec2(0.0f, -10.0f));
+	b2World world2(b2Vec2(0.0f, -10.0f));
+	world2.SetThreadPool(&pool);
+
+	b2World* worlds[2] = {&world1, &world2};
+	for (int32 k = 0; k < 2; ++k)
+	{
+		b2World* world = worlds[k];
+
+		b2BodyDef groundDef;
+		b2Body* ground = world->CreateBody(&groundDef);
+
+		b2EdgeShape edge;
+		edge.SetTwoSided(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+		ground->CreateFixture(&edge, 0.0f);
+
+		b2CircleShape circle;
+		circle.m_radius = 0.4f;
+
+		for (int32 i = 0; i < 400; ++i)
+		{
+			b2BodyDef bodyDef;
+			bodyDef.type = b2_dynamicBody;
+			bodyDef.position.Set(-20.0f + (i % 40), 1.0f + (i / 40));
+			bodyDef.linearVelocity.Set(float(i % 7) - 3.0f, 0.0f);
+			b2Body* body = world->CreateBody(&bodyDef);
+			body->CreateFixture(&circle, 1.0f);
+		}
+	}
+
+	for (int32 i = 0; i < 60; ++i)
+	{
+		world1.Step(1.0f / 60.0f, 8, 3);
+		world2.Step(1.0f / 60.0f, 8, 3);
+		REQUIRE(world1.ComputeStateHash() == world2.ComputeStateHash());
+	}
+
+	// The broad-phase still finds every fixture at its current position.
+	class FixtureFinder : public b2QueryCallback
+	{
+	public:
+		bool ReportFixture(b2Fixture* fixture) override
+		{
+			found = found || fixture == target;
+			return found == false;
+		}
+
+		b2Fixture* target = nullptr;
+		bool found = false;
+	};
+
+	for (b2Body* b = world2.GetBodyList(); b; b = b->GetNext())
+	{
+		for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
+		{
+			b2AABB aabb;
+			f->GetShape()->ComputeAABB(&aabb, b->GetTransform(), 0);
+			CHECK(f->GetAABB(0).Contains(aabb));
+
+			FixtureFinder finder;
+			finder.target = f;
+			world2.QueryAABB(&finder, aabb);
+			CHECK(finder.found);
+		}
+	}
+}
+
+DOCTEST_TEST_CASE("adaptive fat AABB")
+{
+	b2World world(b2Vec2(0.0f, 0.0f));
+
+	b2CircleShape circle;
+	circle.m_radius = 0.5f;
+
+	b2BodyDef bodyDef;
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.position.Set(0.0f, 0.0f);
+	bodyDef.linearVelocity.Set(30.0f, 0.0f);
+	bodyDef.allowSleep = false;
+	b2Body* fastBody = world.CreateBody(&bodyDef);
+	fastBody->CreateFixture(&circle, 1.0f);
+
+	// Count re-insertions with the margin given by the first moves.
+	int32 firstReinserts = 0;
+	for (int32 i = 0; i < 30; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+		firstReinserts += world.GetCounters().proxyReinserts;
+	}
+
+	// The margin of the fast body has grown, so it is re-inserted less often.
+	int32 laterReinserts = 0;
+	for (int32 i = 0; i < 30; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+		laterReinserts += world.GetCounters().proxyReinserts;
+	}
+
+	CHECK(firstReinserts > 0);
+	CHECK(laterReinserts < firstReinserts);
+}
+
+DOCTEST_TEST_CASE("compound shape")
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+
+	b2Body* ground;
+	{
+		b2BodyDef bodyDef;
+		ground = world.CreateBody(&bodyDef);
+
+		b2EdgeShape shape;
+		shape.SetTwoSided(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+		ground->CreateFixture(&shape, 0.0f);
+	}
+
+	// A cup made of three boxes in one fixture.
+	b2PolygonShape polygons[3];
+	polygons[0].SetAsBox(2.0f, 0.25f, b2Vec2(0.0f, 0.25f), 0.0f);
+	polygons[1].SetAsBox(0.25f, 1.0f, b2Vec2(-1.75f, 1.5f), 0.0f);
+	polygons[2].SetAsBox(0.25f, 1.0f, b2Vec2(1.75f, 1.5f), 0.0f);
+
+	b2CompoundShape cup;
+	cup.Create(polygons, 3);
+
+	b2BodyDef bodyDef;
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.position.Set(0.0f, 1.0f);
+	b2Body* cupBody = world.CreateBody(&bodyDef);
+	cupBody->CreateFixture(&cup, 1.0f);
+	CHECK(cupBody->GetMass() == doctest::Approx(4.0f));
+
+	// A second cup stacked on the first collides compound against compound.
+	bodyDef.position.Set(0.0f, 3.5f);
+	b2Body* topBody = world.CreateBody(&bodyDef);
+	topBody->CreateFixture(&cup, 1.0f);
+
+	// A box dropped into the top cup.
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+	bodyDef.position.Set(0.0f, 6.0f);
+	b2Body* boxBody = world.CreateBody(&bodyDef);
+	boxBody->CreateFixture(&box, 1.0f);
+
+	for (int32 i = 0; i < 300; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+
+	CHECK(cupBody->GetPosition().y == doctest::Approx(0.0f).epsilon(0.02f));
+	CHECK(topBody->GetPosition().y == doctest::Approx(2.5f).epsilon(0.02f));
+	CHECK(boxBody->GetPosition().y == doctest::Approx(3.5f).epsilon(0.02f));
+	CHECK(b2Abs(topBody->GetAngle()) < 0.01f);
+
+	// Each fixture has a single proxy and each touching body pair a single contact.
+	// The cups touch at both walls.
+	CHECK(world.GetProxyCount() == 4);
+	int32 touchingCount = 0;
+	for (b2Contact* c = world.GetContactList(); c; c = c->GetNext())
+	{
+		if (c->IsTouching() == false)
+		{
+			continue;
+		}
+
+		++touchingCount;
+		b2Body* bodyA = c->GetFixtureA()->GetBody();
+		b2Body* bodyB = c->GetFixtureB()->GetBody();
+		if ((bodyA == cupBody && bodyB == topBody) || (bodyA == topBody && bodyB == cupBody))
+		{
+			CHECK(c->GetChildManifoldCount() == 2);
+		}
+	}
+
+	CHECK(touchingCount == 3);
+
+	// A fast circle does not tunnel through the walls of a static cup. Without
+	// continuous collision it would pass through both.
+	bodyDef.type = b2_staticBody;
+	bodyDef.position.Set(10.0f, 0.0f);
+	b2Body* staticCup = world.CreateBody(&bodyDef);
+	staticCup->CreateFixture(&cup, 0.0f);
+
+	b2CircleShape circle;
+	circle.m_radius = 0.1f;
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.bullet = true;
+	bodyDef.position.Set(4.9f, 1.5f);
+	bodyDef.linearVelocity.Set(400.0f, 0.0f);
+	bodyDef.gravityScale = 0.0f;
+	b2Body* bullet = world.CreateBody(&bodyDef);
+	bullet->CreateFixture(&circle, 1.0f);
+
+	for (int32 i = 0; i < 10; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+
+	CHECK(bullet->GetPosition().x < 10.0f - 1.5f);
+}
+
+DOCTEST_TEST_CASE("shape cast")
+{
+	b2World world(b2Vec2(0.0f, 0.0f));
+
+	b2BodyDef bodyDef;
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	// A row of boxes and one overlapping the start of the cast.
+	b2Fixture* first = nullptr;
+	for (int32 i = 0; i <= 10; ++i)
+	{
+		bodyDef.position.Set(2.0f * i, 0.0f);
+		b2Body* body = world.CreateBody(&bodyDef);
+		b2Fixture* fixture = body->CreateFixture(&box, 0.0f);
+		if (i == 1)
+		{
+			first = fixture;
+		}
+	}
+
+	b2PolygonShape polygons[2];
+	polygons[0].SetAsBox(0.5f, 0.5f, b2Vec2(-1.0f, 0.0f), 0.0f);
+	polygons[1].SetAsBox(0.5f, 0.5f, b2Vec2(1.0f, 0.0f), 0.0f);
+	b2CompoundShape compound;
+	compound.Create(polygons, 2);
+	bodyDef.position.Set(24.0f, 0.0f);
+	b2Fixture* compoundFixture = world.CreateBody(&bodyDef)->CreateFixture(&compound, 0.0f);
+
+	class ShapeCastCallback : public b2ShapeCastCallback
+	{
+	public:
+		float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override
+		{
+			++count;
+			this->fixture = fixture;
+			this->point = point;
+			this->normal = normal;
+			this->fraction = fraction;
+			return closest ? fraction : 1.0f;
+		}
+
+		bool closest = true;
+		int32 count = 0;
+		b2Fixture* fixture = nullptr;
+		b2Vec2 point = b2Vec2_zero;
+		b2Vec2 normal = b2Vec2_zero;
+		float fraction = 1.0f;
+	};
+
+	b2CircleShape circle;
+	circle.m_radius = 0.25f;
+	b2Transform transform;
+	transform.SetIdentity();
+	b2Vec2 translation(30.0f, 0.0f);
+
+	// The cast stops short of the first box past the start.
+	ShapeCastCallback closest;
+	world.ShapeCast(&closest, &circle, transform, translation);
+	CHECK(closest.fixture == first);
+	CHECK(b2Abs(30.0f * closest.fraction - 1.25f) < b2_linearSlop);
+	CHECK(b2Abs(closest.point.x - 1.49f) < b2_linearSlop);
+	CHECK(b2Abs(closest.normal.x + 1.0f) < 1.0e-4f);
+
+	// The boxes in the path and the compound are reported, not the initial overlap.
+	ShapeCastCallback all;
+	all.closest = false;
+	world.ShapeCast(&all, &circle, transform, translation);
+	CHECK(all.count == 11);
+
+	// Casting down onto the compound hits its right polygon.
+	transform.p.Set(25.0f, 5.0f);
+	ShapeCastCallback down;
+	world.ShapeCast(&down, &circle, transform, b2Vec2(0.0f, -10.0f));
+	CHECK(down.count == 1);
+	CHECK(down.fixture == compoundFixture);
+	CHECK(b2Abs(10.0f * down.fraction - 4.25f) < b2_linearSlop);
+	CHECK(b2Abs(down.normal.y - 1.0f) < 1.0e-4f);
+
+	// Casting between the compound polygons misses.
+	transform.p.Set(24.0f, 5.0f);
+	circle.m_radius = 0.1f;
+	ShapeCastCallback miss;
+	world.ShapeCast(&miss, &circle, transform, b2Vec2(0.0f, -10.0f));
+	CHECK(miss.count == 0);
+}
+
+DOCTEST_TEST_CASE("shape overlap query")
+{
+	b2World world(b2Vec2(0.0f, 0.0f));
+
+	b2CircleShape circle;
+	circle.m_radius = 0.37f;
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.25f);
+
+	srand(49);
+	for (int32 i = 0; i < 100; ++i)
+	{
+		b2BodyDef bodyDef;
+		bodyDef.position.Set(0.1f * (rand() % 100), 0.1f * (rand() % 100));
+		bodyDef.angle = 0.1f * (rand() % 63);
+		b2Body* body = world.CreateBody(&bodyDef);
+		if (i % 2 == 0)
+		{
+			body->CreateFixture(&circle, 0.0f);
+		}
+		else
+		{
+			body->CreateFixture(&box, 0.0f);
+		}
+	}
+
+	class OverlapCallback : public b2QueryCallback
+	{
+	public:
+		bool ReportFixture(b2Fixture* fixture) override
+		{
+			const b2Transform& xf = fixture->GetBody()->GetTransform();
+			exact = exact && b2TestOverlap(fixture->GetShape(), 0, shape, 0, xf, transform);
+			++count;
+			return true;
+		}
+
+		const b2Shape* shape = nullptr;
+		b2Transform transform;
+		int32 count = 0;
+		bool exact = true;
+	};
+
+	b2CircleShape queryCircle;
+	queryCircle.m_radius = 0.93f;
+	b2PolygonShape queryBox;
+	queryBox.SetAsBox(1.0f, 0.5f);
+
+	// Every reported fixture overlaps and no overlapping fixture is missed.
+	int32 totalCount = 0;
+	for (int32 i = 0; i < 40; ++i)
+	{
+		OverlapCallback callback;
+		callback.shape = i % 2 == 0 ? (const b2Shape*)&queryCircle : (const b2Shape*)&queryBox;
+		callback.transform.Set(b2Vec2(0.1f * (rand() % 100), 0.1f * (rand() % 100)), 0.1f * (rand() % 63));
+		world.QueryShape(&callback, callback.shape, callback.transform);
+		CHECK(callback.exact);
+
+		int32 count = 0;
+		for (b2Body* b = world.GetBodyList(); b; b = b->GetNext())
+		{
+			const b2Shape* shape = b->GetFixtureList()->GetShape();
+			count += b2TestOverlap(shape, 0, callback.shape, 0, b->GetTransform(), callback.transform) ? 1 : 0;
+		}
+
+		CHECK(callback.count == count);
+		totalCount += count;
+	}
+
+	CHECK(totalCount > 0);
+
+	// The bounding boxes overlap near the corner but the shapes do not.
+	b2BodyDef bodyDef;
+	bodyDef.position.Set(20.0f, 20.0f);
+	world.CreateBody(&bodyDef)->CreateFixture(&box, 0.0f);
+
+	OverlapCallback corner;
+	corner.shape = &circle;
+	corner.transform.Set(b2Vec2(20.8f, 20.55f), 0.0f);
+	world.QueryShape(&corner, &circle, corner.transform);
+	CHECK(corner.count == 0);
+
+	corner.transform.Set(b2Vec2(20.7f, 20.4f), 0.0f);
+	world.QueryShape(&corner, &circle, corner.transform);
+	CHECK(corner.count == 1);
+}
+
+DOCTEST_TEST_CASE("query snapshots")
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+
+	b2BodyDef bodyDef;
+	b2Body* ground = world.CreateBody(&bodyDef);
+	b2EdgeShape edge;
+	edge.SetTwoSided(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+	b2Fixture* groundFixture = ground->CreateFixture(&edge, 0.0f);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.25f, 0.25f);
+	bodyDef.type = b2_dynamicBody;
+	for (int32 i = 0; i < 200; ++i)
+	{
+		bodyDef.position.Set(-20.0f + 0.2f * (i % 200), 1.0f + 0.6f * (i % 10));
+		world.CreateBody(&bodyDef)->CreateFixture(&box, 1.0f);
+	}
+
+	world.SetQuerySnapshots(true);
+
+	// Rays below the boxes always find the static ground where it was published.
+	class GroundRayCast : public b2RayCastCallback
+	{
+	public:
+		float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override
+		{
+			B2_NOT_USED(point);
+			B2_NOT_USED(normal);
+			if (fixture == ground)
+			{
+				this->fraction = fraction;
+			}
+			return -1.0f;
+		}
+
+		const b2Fixture* ground = nullptr;
+		float fraction = -1.0f;
+	};
+
+	class CountQuery : public b2QueryCallback
+	{
+	public:
+		bool ReportFixture(b2Fixture* fixture) override
+		{
+			valid = valid && fixture->GetShape() != nullptr;
+			++count;
+			return true;
+		}
+
+		int32 count = 0;
+		bool valid = true;
+	};
+
+	std::atomic<bool> running(true);
+	std::atomic<int32> failures(0);
+	std::atomic<int32> queries(0);
+
+	auto reader = [&]()
+	{
+		while (running.load())
+		{
+			GroundRayCast ray;
+			ray.ground = groundFixture;
+			world.RayCastSnapshot(&ray, b2Vec2(-30.0f, 0.5f), b2Vec2(-30.0f, -0.5f));
+			if (b2Abs(ray.fraction - 0.5f) > 1.0e-4f)
+			{
+				failures.fetch_add(1);
+			}
+
+			CountQuery query;
+			b2AABB aabb;
+			aabb.lowerBound.Set(-50.0f, -50.0f);
+			aabb.upperBound.Set(50.0f, 50.0f);
+			world.QuerySnapshotAABB(&query, aabb);
+			if (query.valid == false || query.count < 101)
+			{
+				failures.fetch_add(1);
+			}
+
+			queries.fetch_add(1);
+		}
+	};
+
+	std::thread threads[4];
+	for (int32 i = 0; i < 4; ++i)
+	{
+		threads[i] = std::thread(reader);
+	}
+
+	// Step and destroy bodies while the readers run.
+	for (int32 i = 0; i < 120; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+
+		if (i % 2 == 0)
+		{
+			b2Body* body = world.GetBodyList();
+			if (body != ground)
+			{
+				world.DestroyBody(body);
+			}
+		}
+	}
+
+	running.store(false);
+	for (int32 i = 0; i < 4; ++i)
+	{
+		threads[i].join();
+	}
+
+	CHECK(failures.load() == 0);
+	CHECK(queries.load() > 0);
+
+	// The snapshot holds the transforms of the last step.
+	for (b2Body* b = world.GetBodyList(); b; b = b->GetNext())
+	{
+		if (b == ground)
+		{
+			continue;
+		}
+
+		class FixtureFinder : public b2QueryCallback
+		{
+		public:
+			bool ReportFixture(b2Fixture* fixture) override
+			{
+				found = found || fixture == target;
+				return found == false;
+			}
+
+			b2Fixture* target = nullptr;
+			bool found = false;
+		};
+
+		FixtureFinder finder;
+		finder.target = b->GetFixtureList();
+		b2AABB aabb;
+		b->GetFixtureList()->GetShape()->ComputeAABB(&aabb, b->GetTransform(), 0);
+		world.QuerySnapshotAABB(&finder, aabb);
+		CHECK(finder.found);
+	}
+
+	world.SetQuerySnapshots(false);
+	CHECK(world.GetQuerySnapshots() == false);
+}
+
+DOCTEST_TEST_CASE("query snapshots with disabled bodies")
+{
+	b2World world(b2Vec2(0.0f, 0.0f));
+	world.SetQuerySnapshots(true);
+
+	b2CircleShape circle;
+	circle.m_radius = 0.25f;
+	b2PolygonShape box;
+	box.SetAsBox(0.25f, 0.25f);
+
+	const int32 bodyCount = 50;
+	b2Body* bodies[bodyCount];
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2BodyDef bodyDef;
+		bodyDef.position.Set(1.0f * i, 0.0f);
+		bodies[i] = world.CreateBody(&bodyDef);
+		bodies[i]->CreateFixture(&circle, 0.0f);
+	}
+
+	world.Step(1.0f / 60.0f, 8, 3);
+
+	class AllRayCast : public b2RayCastCallback
+	{
+	public:
+		float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override
+		{
+			B2_NOT_USED(point);
+			B2_NOT_USED(normal);
+			B2_NOT_USED(fraction);
+			valid = valid && fixture->GetShape() != nullptr;
+			++count;
+			return 1.0f;
+		}
+
+		int32 count = 0;
+		bool valid = true;
+	};
+
+	std::atomic<bool> running(true);
+	std::atomic<int32> failures(0);
+
+	auto reader = [&]()
+	{
+		while (running.load())
+		{
+			AllRayCast ray;
+			world.RayCastSnapshot(&ray, b2Vec2(-1.0f, 0.0f), b2Vec2(bodyCount + 1.0f, 0.0f));
+			if (ray.valid == false || ray.count > bodyCount)
+			{
+				failures.fetch_add(1);
+			}
+		}
+	};
+
+	std::thread threads[4];
+	for (int32 i = 0; i < 4; ++i)
+	{
+		threads[i] = std::thread(reader);
+	}
+
+	// The published snapshot still holds the fixtures of disabled bodies. Switching
+	// between circles and boxes keeps the freed shapes from being reused at once.
+	for (int32 round = 0; round < 20; ++round)
+	{
+		for (int32 i = 0; i < bodyCount; ++i)
+		{
+			b2Body* body = bodies[i];
+			body->SetEnabled(false);
+			body->DestroyFixture(body->GetFixtureList());
+			if (round % 2 == 0)
+			{
+				body->CreateFixture(&box, 0.0f);
+			}
+			else
+			{
+				body->CreateFixture(&circle, 0.0f);
+			}
+			body->SetEnabled(true);
+		}
+
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+
+	running.store(false);
+	for (int32 i = 0; i < 4; ++i)
+	{
+		threads[i].join();
+	}
+
+	CHECK(failures.load() == 0);
+
+	AllRayCast ray;
+	world.RayCastSnapshot(&ray, b2Vec2(-1.0f, 0.0f), b2Vec2(bodyCount + 1.0f, 0.0f));
+	CHECK(ray.count == bodyCount);
+}
+
+DOCTEST_TEST_CASE("query snapshots with bulk destroys")
+{
+	b2World world(b2Vec2(0.0f, 0.0f));
+	world.SetQuerySnapshots(true);
+
+	b2CircleShape circle;
+	circle.m_radius = 0.25f;
+
+	const int32 bodyCount = 200;
+	b2Body* bodies[bodyCount];
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2BodyDef bodyDef;
+		bodyDef.position.Set(1.0f * (i % 20), 1.0f * (i / 20));
+		bodyDef.userData.pointer = 1;
+		bodies[i] = world.CreateBody(&bodyDef);
+		bodies[i]->CreateFixture(&circle, 0.0f);
+	}
+
+	world.Step(1.0f / 60.0f, 8, 3);
+
+	b2AABB aabb;
+	aabb.lowerBound.Set(-1.0f, -1.0f);
+	aabb.upperBound.Set(21.0f, 11.0f);
+
+	// Holds the snapshot by stopping in the first report until released. Every
+	// reported fixture and its body must stay readable.
+	class HoldingQuery : public b2QueryCallback
+	{
+	public:
+		bool ReportFixture(b2Fixture* fixture) override
+		{
+			if (count == 0)
+			{
+				holding->store(true);
+				auto start = std::chrono::steady_clock::now();
+				while (release->load() == false)
+				{
+					if (std::chrono::steady_clock::now() - start > std::chrono::seconds(5))
+					{
+						timedOut = true;
+						break;
+					}
+					std::this_thread::yield();
+				}
+			}
+
+			valid = valid && fixture->GetShape()->m_radius == 0.25f;
+			valid = valid && fixture->GetBody()->GetUserData().pointer == 1;
+			++count;
+			return true;
+		}
+
+		std::atomic<bool>* holding = nullptr;
+		std::atomic<bool>* release = nullptr;
+		int32 count = 0;
+		bool valid = true;
+		bool timedOut = false;
+	};
+
+	std::atomic<bool> holding(false);
+	std::atomic<bool> release(false);
+
+	HoldingQuery holder;
+	holder.holding = &holding;
+	holder.release = &release;
+
+	std::thread reader([&]() { world.QuerySnapshotAABB(&holder, aabb); });
+
+	while (holding.load() == false)
+	{
+		std::this_thread::yield();
+	}
+
+	// Destroying does not wait for the held snapshot.
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		world.DestroyBody(bodies[i]);
+	}
+	CHECK(world.GetBodyCount() == 0);
+
+	release.store(true);
+	reader.join();
+
+	CHECK(holder.timedOut == false);
+	CHECK(holder.valid);
+	CHECK(holder.count == bodyCount);
+
+	// The snapshot keeps the destroyed fixtures until the next publish.
+	HoldingQuery query;
+	query.holding = &holding;
+	query.release = &release;
+	world.QuerySnapshotAABB(&query, aabb);
+	CHECK(query.valid);
+	CHECK(query.count == bodyCount);
+
+	world.Step(1.0f / 60.0f, 8, 3);
+
+	HoldingQuery after;
+	after.holding = &holding;
+	after.release = &release;
+	world.QuerySnapshotAABB(&after, aabb);
+	CHECK(after.count == 0);
+}